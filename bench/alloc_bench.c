@@ -0,0 +1,137 @@
+#include "bench.h"
+#include "rt_alloc.h"
+
+/* Small-object churn on 1, 2, 4 ... up to every core: each thread keeps
+ * WORKING_SET live objects of 16..256 bytes and replaces a random one per
+ * operation, N operations per thread (10M unless given on the command line).
+ * malloc/free against rt_salloc/rt_sfree, in Mops/s over all threads and as
+ * scaling against one thread. The handoff pass allocates on every thread and
+ * frees each batch on the neighbouring thread, the producer/consumer case
+ * that ends up on the central lists. */
+
+#define DEFAULT_COUNT 10000000
+#define WORKING_SET 4096
+#define MAX_THREADS 64
+
+typedef struct {
+    const char *name;
+    void *(*alloc)(size_t size);
+    void (*free)(void *ptr);
+} Allocator;
+
+typedef struct {
+    const Allocator *allocator;
+    size_t count;
+    uint64_t seed;
+    void **objects; // handoff: count objects, freed by the next thread
+} Task;
+
+static DWORD churn(void *param)
+{
+    Task *task = param;
+    const Allocator *a = task->allocator;
+    void *live[WORKING_SET] = {0};
+    uint64_t seed = task->seed;
+
+    for (size_t i = 0; i < task->count; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        const size_t slot = (size_t)(seed % WORKING_SET);
+        a->free(live[slot]);
+        live[slot] = a->alloc(16 + (size_t)(seed >> 56) % 241);
+        if (live[slot]) *(volatile char*)live[slot] = 1;
+    }
+    for (size_t i = 0; i < WORKING_SET; ++i) a->free(live[i]);
+    return 0;
+}
+
+static DWORD produce(void *param)
+{
+    Task *task = param;
+    uint64_t seed = task->seed;
+    for (size_t i = 0; i < task->count; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        task->objects[i] = task->allocator->alloc(16 + (size_t)(seed >> 56) % 241);
+    }
+    return 0;
+}
+
+static DWORD consume(void *param)
+{
+    Task *task = param;
+    for (size_t i = 0; i < task->count; ++i) task->allocator->free(task->objects[i]);
+    return 0;
+}
+
+static double run(const Allocator *allocator, size_t threads, size_t count, Task *tasks)
+{
+    for (size_t i = 0; i < threads; ++i) {
+        tasks[i] = (Task){ allocator, count, bench_next() | 1, NULL };
+    }
+    const double start = bench_now_ns();
+    rt_thread_run_tasks(tasks, sizeof(Task), threads, churn);
+    return bench_now_ns() - start;
+}
+
+static double run_handoff(const Allocator *allocator, size_t threads, size_t count, Task *tasks, void **objects)
+{
+    for (size_t i = 0; i < threads; ++i) {
+        tasks[i] = (Task){ allocator, count, bench_next() | 1, objects + i * count };
+    }
+    double start = bench_now_ns();
+    rt_thread_run_tasks(tasks, sizeof(Task), threads, produce);
+    double elapsed = bench_now_ns() - start;
+
+    // thread i now frees what thread i + 1 allocated
+    for (size_t i = 0; i < threads; ++i) tasks[i].objects = objects + ((i + 1) % threads) * count;
+    start = bench_now_ns();
+    rt_thread_run_tasks(tasks, sizeof(Task), threads, consume);
+    return elapsed + bench_now_ns() - start;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [operations per thread]\n", argv[0]);
+        return 2;
+    }
+
+    static const Allocator allocators[] = {
+        { "malloc", malloc, free },
+        { "rt_salloc", rt_salloc, rt_sfree },
+    };
+    size_t cpus = rt_thread_cpu_count();
+    if (cpus > MAX_THREADS) cpus = MAX_THREADS;
+
+    // the handoff pass holds a tenth of the operations live per thread
+    const size_t handoff_count = count / 10 ? count / 10 : 1;
+    Task tasks[MAX_THREADS];
+    void **objects = malloc(cpus * handoff_count * sizeof(void*));
+    if (!objects) return 1;
+
+    printf("%zu operations per thread, %d live objects of 16..256 bytes, %zu cores\n", count, WORKING_SET, cpus);
+    printf("%-10s %7s %12s %8s %14s\n", "allocator", "threads", "churn Mops/s", "scaling", "handoff Mops/s");
+    for (size_t a = 0; a < sizeof(allocators) / sizeof(allocators[0]); ++a) {
+        double single = 0;
+        for (size_t threads = 1;; threads = threads * 2 < cpus ? threads * 2 : cpus) {
+            const double churn_ns = run(&allocators[a], threads, count, tasks);
+            const double handoff_ns = run_handoff(&allocators[a], threads, handoff_count, tasks, objects);
+            const double mops = (double)(count * threads) * 1e3 / churn_ns;
+            if (threads == 1) single = mops;
+            printf("%-10s %7zu %12.1f %7.2fx %14.1f\n", allocators[a].name, threads, mops, mops / single,
+                   (double)(handoff_count * threads * 2) * 1e3 / handoff_ns);
+            if (threads == cpus) break;
+        }
+    }
+
+    RT_SAllocStats stats;
+    rt_salloc_stats(&stats);
+    printf("rt_salloc: %zu spans, %zu central transfers, %zu forwarded to malloc\n",
+           stats.spans, stats.central_transfers, stats.fallback_allocs);
+    free(objects);
+    return 0;
+}
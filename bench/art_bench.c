@@ -0,0 +1,150 @@
+#include "bench.h"
+
+/* RT_ArtTree against RT_HashMap on N file paths, 1M unless given on the
+ * command line, built from a few roots and directory names so they share
+ * long prefixes the way real paths do. Each structure runs in its own
+ * process and prints ns per insert, per lookup of a present and of an
+ * absent path, bytes per key from peak RSS, and ms per prefix query (all
+ * paths under a directory), which the hash map can only answer by walking
+ * every key. Every lookup and prefix count is checked against the corpus. */
+
+#define DEFAULT_COUNT 1000000
+#define LOOKUPS 1000000
+#define PREFIXES 20
+#define PATH_MAX_LEN 128
+
+static const char *const roots[] = {
+    "C:\\Windows\\System32", "C:\\Windows\\WinSxS", "C:\\Program Files\\Common Files",
+    "C:\\Users\\Public\\Documents", "C:\\ProgramData\\Microsoft", "D:\\src\\project",
+};
+static const char *const dirs[] = {
+    "drivers", "en-US", "config", "bin", "lib", "include", "modules", "cache",
+    "assets", "x64", "Release", "Debug", "plugins", "logs", "temp", "data",
+};
+static const char *const extensions[] = { "dll", "sys", "exe", "txt", "h", "c", "json", "log" };
+
+typedef char Path[PATH_MAX_LEN];
+
+// unique by the number in the file name
+static void make_path(char *out, size_t index)
+{
+    const uint64_t r = bench_next();
+    int length = snprintf(out, PATH_MAX_LEN, "%s", roots[r % (sizeof(roots) / sizeof(roots[0]))]);
+    for (uint64_t depth = 1 + (r >> 8) % 4, bits = r >> 16; depth > 0; --depth, bits >>= 4) {
+        length += snprintf(out + length, PATH_MAX_LEN - (size_t)length, "\\%s", dirs[bits & 15]);
+    }
+    snprintf(out + length, PATH_MAX_LEN - (size_t)length, "\\file%07zu.%s", index, extensions[(r >> 40) & 7]);
+}
+
+typedef struct {
+    const char *prefix;
+    size_t length;
+    size_t count;
+} PrefixCount;
+
+static bool count_prefix(const char *key, void *value, void *user_data)
+{
+    (void)key;
+    (void)value;
+    ((PrefixCount*)user_data)->count++;
+    return false;
+}
+
+static size_t map_prefix(RT_HashMap *map, const char *prefix, size_t length)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < map->buckets_count; ++i) {
+        for (RT_HTNode *node = rt_hashmap_node_first(&map->buckets[i]); node; node = rt_hashmap_node_next(node)) {
+            count += strncmp(node->key, prefix, length) == 0;
+        }
+    }
+    return count;
+}
+
+static int run(bool art, size_t count)
+{
+    Path *paths = malloc(count * sizeof(Path));
+    if (!paths) return 1;
+    for (size_t i = 0; i < count; ++i) make_path(paths[i], i);
+
+    // directories of random paths, and how many paths each holds
+    Path prefixes[PREFIXES];
+    size_t expected[PREFIXES] = {0};
+    for (size_t q = 0; q < PREFIXES; ++q) {
+        memcpy(prefixes[q], paths[bench_next() % count], sizeof(Path));
+        strrchr(prefixes[q], '\\')[1] = '\0';
+        const size_t length = strlen(prefixes[q]);
+        for (size_t i = 0; i < count; ++i) expected[q] += strncmp(paths[i], prefixes[q], length) == 0;
+    }
+
+    RT_ArtTree tree = {0};
+    RT_HashMap map = {0};
+    const size_t base = bench_peak_rss();
+    bool ok = art ? rt_art_init(&tree, sizeof(uint64_t)) : rt_hashmap_init(&map, RT_HASHMAP_INIT_BUCKETS_COUNT);
+    double start = bench_now_ns();
+    for (uint64_t i = 0; i < count && ok; ++i) {
+        ok = art ? rt_art_insert(&tree, paths[i], &i) : rt_hashmap_insert(&map, paths[i], &i, sizeof(i));
+    }
+    const double insert = bench_now_ns() - start;
+    const size_t built = bench_peak_rss();
+
+    uint64_t value = 0;
+    size_t at = 0;
+    start = bench_now_ns();
+    for (size_t i = 0; i < LOOKUPS && ok; ++i) {
+        at = (at + 7919) % count;
+        ok = (art ? rt_art_get(&tree, paths[at], &value) : rt_hashmap_get(&map, paths[at], &value, sizeof(value)))
+            && value == at;
+    }
+    const double hit = bench_now_ns() - start;
+
+    // the same paths with the last digit of the number pushed out of range
+    start = bench_now_ns();
+    for (size_t i = 0; i < LOOKUPS && ok; ++i) {
+        at = (at + 7919) % count;
+        char *dot = strrchr(paths[at], '.');
+        dot[-1] ^= 0x40;
+        ok = art ? !rt_art_contains(&tree, paths[at]) : !rt_hashmap_contains(&map, paths[at]);
+        dot[-1] ^= 0x40;
+    }
+    const double miss = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (size_t q = 0; q < PREFIXES && ok; ++q) {
+        PrefixCount found = { prefixes[q], strlen(prefixes[q]), 0 };
+        if (art) rt_art_foreach_prefix(&tree, found.prefix, &found, count_prefix);
+        else found.count = map_prefix(&map, found.prefix, found.length);
+        ok = found.count == expected[q];
+    }
+    const double prefix = bench_now_ns() - start;
+
+    if (ok) {
+        printf("%-10s insert %6.1f ns  hit %6.1f ns  miss %6.1f ns  %6.1f bytes/key  prefix %8.3f ms\n",
+               art ? "RT_ArtTree" : "RT_HashMap", insert / count, hit / LOOKUPS, miss / LOOKUPS,
+               (double)(built - base) / (double)count, prefix / 1e6 / PREFIXES);
+    }
+    if (art) rt_art_free(&tree);
+    else rt_hashmap_free(&map);
+    free(paths);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0 || count > 9999999) {
+        fprintf(stderr, "usage: %s [paths]\n", argv[0]);
+        return 2;
+    }
+
+    // child: "<self> <count> <art|hashmap>"
+    if (argc > 2) return run(strcmp(argv[2], "art") == 0, count);
+
+    Path sample;
+    make_path(sample, 0);
+    printf("%zu paths like %s, bytes/key from peak RSS\n", count, sample);
+    bool ok = bench_spawn(argv[0], count, "hashmap");
+    ok = bench_spawn(argv[0], count, "art") && ok;
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#ifndef _INC_RT_BENCH
+#define _INC_RT_BENCH
+
+#include <string.h>
+#include <psapi.h>
+
+#include "rt.h"
+
+/* Shared by the bench drivers. Every driver takes its problem size as the
+ * first argument and uses the same fixed seed, so two runs on one machine
+ * see the same data. Peak RSS is per process: drivers comparing memory
+ * footprints run each variant in a child (bench_spawn) so one variant's
+ * peak doesn't hide the next one's. */
+
+static uint64_t bench_seed = 0x2545F4914F6CDD1Dull;
+
+static inline uint64_t bench_next(void)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 7;
+    bench_seed ^= bench_seed << 17;
+    return bench_seed;
+}
+
+static inline uint32_t bench_next_u32(void)
+{
+    return (uint32_t)(bench_next() >> 32);
+}
+
+static inline double bench_now_ns(void)
+{
+    static double ns_per_tick = 0;
+    if (ns_per_tick == 0) {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        ns_per_tick = 1e9 / (double)f.QuadPart;
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * ns_per_tick;
+}
+
+// argv[index] as a size, fallback when missing, 0 when malformed
+static inline size_t bench_arg(int argc, char **argv, int index, size_t fallback)
+{
+    if (argc <= index) return fallback;
+    char *end;
+    const unsigned long long value = strtoull(argv[index], &end, 10);
+    return (*end || end == argv[index]) ? 0 : (size_t)value;
+}
+
+static inline size_t bench_peak_rss(void)
+{
+    PROCESS_MEMORY_COUNTERS counters = { .cb = sizeof(counters) };
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+}
+
+static inline void bench_fill(void *data, size_t size)
+{
+    uint8_t *bytes = data;
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        const uint64_t value = bench_next();
+        memcpy(bytes + i, &value, 8);
+    }
+    for (size_t i = size & ~(size_t)7; i < size; ++i) bytes[i] = (uint8_t)bench_next();
+}
+
+static inline bool bench_write_file(const char *path, const void *data, size_t size)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    const bool written = fwrite(data, 1, size, f) == size;
+    return fclose(f) == 0 && written;
+}
+
+// reruns this driver as "<self> <count> <mode>" and waits for it
+static inline bool bench_spawn(const char *self, size_t count, const char *mode)
+{
+    char command[MAX_PATH + 64];
+    const int len = snprintf(command, sizeof(command), "\"%s\" %zu %s", self, count, mode);
+    if (len < 0 || (size_t)len >= sizeof(command)) return false;
+    fflush(stdout);
+    return system(command) == 0;
+}
+
+static inline double bench_mb(size_t bytes)
+{
+    return (double)bytes / (1024.0 * 1024.0);
+}
+
+#endif // _INC_RT_BENCH
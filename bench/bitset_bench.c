@@ -0,0 +1,176 @@
+#include "bench.h"
+
+/* Two sets of N uint32_t IDs each, 1M unless given on the command line,
+ * as RT_Bitset, RT_Roaring and RT_HashMap keyed by the decimal ID (the
+ * usual stand-in for a set in this library). Dense sets draw from 2N IDs,
+ * sparse ones from the whole 32-bit range, where a bitset would need
+ * 512 MiB and is skipped. Prints ns per add and per lookup (every other one
+ * looks up a member), ms for intersection and union, and bytes per member
+ * from peak RSS; each structure runs in its own process. */
+
+#define DEFAULT_COUNT 1000000
+#define LOOKUPS 1000000
+#define KEY_LEN 11
+
+typedef struct {
+    const char *name;
+    size_t size;
+    bool (*init)(void *set, uint64_t universe);
+    void (*release)(void *set);
+    bool (*add)(void *set, uint32_t id);
+    bool (*contains)(void *set, uint32_t id);
+    bool (*intersect)(void *dst, void *a, void *b); // dst starts empty
+    bool (*unite)(void *dst, void *a, void *b);
+    uint64_t (*count)(void *set);
+} SetOps;
+
+static bool bitset_init(void *set, uint64_t universe) { return rt_bitset_init(set, (size_t)universe); }
+static void bitset_release(void *set) { rt_bitset_free(set); }
+static bool bitset_add(void *set, uint32_t id) { return rt_bitset_set(set, id); }
+static bool bitset_contains(void *set, uint32_t id) { return rt_bitset_test(set, id); }
+static bool bitset_and(void *dst, void *a, void *b) { return rt_bitset_or(dst, a) && rt_bitset_and(dst, b); }
+static bool bitset_or(void *dst, void *a, void *b) { return rt_bitset_or(dst, a) && rt_bitset_or(dst, b); }
+static uint64_t bitset_count(void *set) { return rt_bitset_count(set); }
+
+static bool roaring_init(void *set, uint64_t universe) { (void)universe; return rt_roaring_init(set); }
+static void roaring_release(void *set) { rt_roaring_free(set); }
+static bool roaring_add(void *set, uint32_t id) { return rt_roaring_add(set, id); }
+static bool roaring_contains(void *set, uint32_t id) { return rt_roaring_contains(set, id); }
+static bool roaring_and(void *dst, void *a, void *b) { return rt_roaring_and(dst, a, b); }
+static bool roaring_or(void *dst, void *a, void *b) { return rt_roaring_or(dst, a, b); }
+static uint64_t roaring_count(void *set) { return rt_roaring_cardinality(set); }
+
+static bool hashmap_init(void *set, uint64_t universe)
+{
+    (void)universe;
+    memset(set, 0, sizeof(RT_HashMap));
+    return rt_hashmap_init(set, RT_HASHMAP_INIT_BUCKETS_COUNT);
+}
+
+static void hashmap_release(void *set) { rt_hashmap_free(set); }
+
+static bool hashmap_add(void *set, uint32_t id)
+{
+    char key[KEY_LEN];
+    char present = 1;
+    snprintf(key, sizeof(key), "%u", id);
+    return rt_hashmap_insert(set, key, &present, sizeof(present));
+}
+
+static bool hashmap_contains(void *set, uint32_t id)
+{
+    char key[KEY_LEN];
+    snprintf(key, sizeof(key), "%u", id);
+    return rt_hashmap_contains(set, key);
+}
+
+// inserts the keys of src, only those also in `filter` when it is set
+static bool hashmap_insert_from(RT_HashMap *dst, RT_HashMap *src, RT_HashMap *filter)
+{
+    char present = 1;
+    for (size_t i = 0; i < src->buckets_count; ++i) {
+        for (RT_HTNode *node = rt_hashmap_node_first(&src->buckets[i]); node; node = rt_hashmap_node_next(node)) {
+            if (filter && !rt_hashmap_contains(filter, node->key)) continue;
+            if (!rt_hashmap_insert(dst, node->key, &present, sizeof(present))) return false;
+        }
+    }
+    return true;
+}
+
+static bool hashmap_and(void *dst, void *a, void *b) { return hashmap_insert_from(dst, a, b); }
+static bool hashmap_or(void *dst, void *a, void *b) { return hashmap_insert_from(dst, a, NULL) && hashmap_insert_from(dst, b, NULL); }
+static uint64_t hashmap_count(void *set) { return ((RT_HashMap*)set)->size; }
+
+static const SetOps sets[] = {
+    { "bitset", sizeof(RT_Bitset), bitset_init, bitset_release, bitset_add, bitset_contains, bitset_and, bitset_or, bitset_count },
+    { "roaring", sizeof(RT_Roaring), roaring_init, roaring_release, roaring_add, roaring_contains, roaring_and, roaring_or, roaring_count },
+    { "hashmap", sizeof(RT_HashMap), hashmap_init, hashmap_release, hashmap_add, hashmap_contains, hashmap_and, hashmap_or, hashmap_count },
+};
+
+static int run(const SetOps *ops, size_t count, bool dense)
+{
+    const uint64_t universe = dense ? (uint64_t)count * 2 : (uint64_t)UINT32_MAX + 1;
+    uint32_t *ids = malloc(count * 2 * sizeof(uint32_t));
+    if (!ids) return 1;
+    for (size_t i = 0; i < count * 2; ++i) ids[i] = (uint32_t)(bench_next() % universe);
+
+    // a, b, a & b, a | b
+    char *storage = calloc(4, ops->size);
+    if (!storage) {
+        free(ids);
+        return 1;
+    }
+    void *a = storage, *b = storage + ops->size, *both = storage + 2 * ops->size, *either = storage + 3 * ops->size;
+
+    const size_t base = bench_peak_rss();
+    bool ok = ops->init(a, universe) && ops->init(b, universe);
+    double start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = ops->add(a, ids[i]) && ops->add(b, ids[count + i]);
+    const double add = bench_now_ns() - start;
+    const size_t built = bench_peak_rss();
+
+    size_t hits = 0;
+    start = bench_now_ns();
+    for (size_t i = 0; i < LOOKUPS && ok; ++i) {
+        const uint32_t id = i & 1 ? ids[bench_next() % count] : (uint32_t)(bench_next() % universe);
+        hits += ops->contains(a, id);
+    }
+    const double lookup = bench_now_ns() - start;
+
+    ok = ok && ops->init(both, universe) && ops->init(either, universe);
+    start = bench_now_ns();
+    ok = ok && ops->intersect(both, a, b);
+    const double intersect = bench_now_ns() - start;
+    start = bench_now_ns();
+    ok = ok && ops->unite(either, a, b);
+    const double unite = bench_now_ns() - start;
+    ok = ok && ops->count(a) + ops->count(b) == ops->count(both) + ops->count(either);
+
+    if (ok) {
+        printf("%-7s %-6s add %6.1f ns  lookup %6.1f ns (%2.0f%% hit)  and %8.2f ms  or %8.2f ms  %7.2f bytes/member\n",
+               ops->name, dense ? "dense" : "sparse", add / (2.0 * count), lookup / LOOKUPS, 100.0 * hits / LOOKUPS,
+               intersect / 1e6, unite / 1e6, (double)(built - base) / (double)(ops->count(a) + ops->count(b)));
+    }
+    ops->release(a);
+    ops->release(b);
+    ops->release(both);
+    ops->release(either);
+    free(storage);
+    free(ids);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0 || count > UINT32_MAX / 2) {
+        fprintf(stderr, "usage: %s [members]\n", argv[0]);
+        return 2;
+    }
+
+    // child: "<self> <count> <set>:<dense|sparse>"
+    if (argc > 2) {
+        const char *colon = strchr(argv[2], ':');
+        for (size_t i = 0; colon && i < sizeof(sets) / sizeof(sets[0]); ++i) {
+            const size_t name_len = strlen(sets[i].name);
+            if ((size_t)(colon - argv[2]) == name_len && strncmp(argv[2], sets[i].name, name_len) == 0) {
+                return run(&sets[i], count, strcmp(colon + 1, "dense") == 0);
+            }
+        }
+        fprintf(stderr, "unknown run %s\n", argv[2]);
+        return 2;
+    }
+
+    printf("two sets of %zu random IDs, bytes/member from peak RSS\n", count);
+    bool ok = true;
+    for (int dense = 1; dense >= 0; --dense) {
+        for (size_t i = 0; i < sizeof(sets) / sizeof(sets[0]); ++i) {
+            if (!dense && sets[i].init == bitset_init) continue;
+            char mode[32];
+            snprintf(mode, sizeof(mode), "%s:%s", sets[i].name, dense ? "dense" : "sparse");
+            ok = bench_spawn(argv[0], count, mode) && ok;
+        }
+    }
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+#include "bench.h"
+
+/* RT_BTree against RT_HashMap on N random keys, 1M unless given on the
+ * command line. Point lookups use the same 16-digit hex string keys in both,
+ * plus a uint64_t tree on the raw keys. Range queries have no hash map
+ * equivalent; the baseline copies the keys out, sorts them and answers
+ * each range by binary search and a scan. Every range covers about
+ * RANGE_HITS keys. */
+
+#define DEFAULT_COUNT 1000000
+#define LOOKUPS 1000000
+#define RANGES 10000
+#define RANGE_HITS 100
+#define KEY_LEN 17
+
+static int compare_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static size_t lower_bound(const uint64_t *keys, size_t count, uint64_t key)
+{
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (keys[mid] < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static bool bench_lookups(const uint64_t *keys, const char (*skeys)[KEY_LEN], size_t count)
+{
+    RT_HashMap map = {0};
+    RT_BTree stree = {0}, tree = {0};
+    bool ok = rt_hashmap_init(&map, RT_HASHMAP_INIT_BUCKETS_COUNT)
+        && rt_btree_init(&stree, RT_BTREE_KEY_STR, sizeof(uint64_t))
+        && rt_btree_init(&tree, RT_BTREE_KEY_U64, sizeof(uint64_t));
+
+    double start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_hashmap_insert(&map, skeys[i], (void*)&keys[i], sizeof(uint64_t));
+    const double map_insert = bench_now_ns() - start;
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_btree_insert(&stree, skeys[i], &keys[i]);
+    const double stree_insert = bench_now_ns() - start;
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_btree_insert_u64(&tree, keys[i], &keys[i]);
+    const double tree_insert = bench_now_ns() - start;
+
+    uint64_t value;
+    size_t at = 0;
+    start = bench_now_ns();
+    for (size_t i = 0; i < LOOKUPS && ok; ++i) {
+        at = (at + 7919) % count;
+        ok = rt_hashmap_get(&map, skeys[at], &value, sizeof(value)) && value == keys[at];
+    }
+    const double map_get = bench_now_ns() - start;
+    start = bench_now_ns();
+    for (size_t i = 0; i < LOOKUPS && ok; ++i) {
+        at = (at + 7919) % count;
+        ok = rt_btree_get(&stree, skeys[at], &value) && value == keys[at];
+    }
+    const double stree_get = bench_now_ns() - start;
+    start = bench_now_ns();
+    for (size_t i = 0; i < LOOKUPS && ok; ++i) {
+        at = (at + 7919) % count;
+        ok = rt_btree_get_u64(&tree, keys[at], &value) && value == keys[at];
+    }
+    const double tree_get = bench_now_ns() - start;
+
+    if (ok) {
+        printf("%-18s %10s %10s\n", "point", "insert", "lookup");
+        printf("%-18s %7.1f ns %7.1f ns\n", "RT_HashMap str", map_insert / count, map_get / LOOKUPS);
+        printf("%-18s %7.1f ns %7.1f ns\n", "RT_BTree str", stree_insert / count, stree_get / LOOKUPS);
+        printf("%-18s %7.1f ns %7.1f ns\n", "RT_BTree u64", tree_insert / count, tree_get / LOOKUPS);
+    }
+    rt_hashmap_free(&map);
+    rt_btree_free(&stree);
+    rt_btree_free(&tree);
+    return ok;
+}
+
+static bool bench_ranges(const uint64_t *keys, size_t count)
+{
+    RT_BTree tree = {0};
+    uint64_t *sorted = malloc(count * sizeof(uint64_t));
+    bool ok = sorted && rt_btree_init(&tree, RT_BTREE_KEY_U64, 0);
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_btree_insert_u64(&tree, keys[i], NULL);
+
+    // keys are uniform, so a span of RANGE_HITS average gaps holds about that many
+    const uint64_t span = UINT64_MAX / count * RANGE_HITS;
+    uint64_t lows[RANGES];
+    for (size_t i = 0; i < RANGES; ++i) lows[i] = bench_next() % (UINT64_MAX - span);
+
+    double start = bench_now_ns();
+    if (ok) {
+        memcpy(sorted, keys, count * sizeof(uint64_t));
+        qsort(sorted, count, sizeof(uint64_t), compare_u64);
+    }
+    const double sort = bench_now_ns() - start;
+
+    uint64_t sum_scan = 0, sum_tree = 0;
+    size_t hits = 0;
+    start = bench_now_ns();
+    for (size_t q = 0; q < RANGES && ok; ++q) {
+        for (size_t i = lower_bound(sorted, count, lows[q]); i < count && sorted[i] < lows[q] + span; ++i) {
+            sum_scan += sorted[i];
+            hits++;
+        }
+    }
+    const double scan = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (size_t q = 0; q < RANGES && ok; ++q) {
+        RT_BTreeIter it = rt_btree_lower_bound_u64(&tree, lows[q]);
+        for (; rt_btree_iter_valid(&it) && rt_btree_iter_key_u64(&it) < lows[q] + span; rt_btree_iter_next(&it)) {
+            sum_tree += rt_btree_iter_key_u64(&it);
+        }
+    }
+    const double walk = bench_now_ns() - start;
+    ok = ok && sum_scan == sum_tree;
+
+    if (ok) {
+        printf("%zu ranges, %.1f keys each\n", (size_t)RANGES, (double)hits / RANGES);
+        printf("sort-then-scan   sort %8.2f ms + %7.1f ns/range (%8.1f ns/range over one batch)\n",
+               sort / 1e6, scan / RANGES, (sort + scan) / RANGES);
+        printf("RT_BTree                          %7.1f ns/range\n", walk / RANGES);
+    }
+    free(sorted);
+    rt_btree_free(&tree);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return 2;
+    }
+
+    uint64_t *keys = malloc(count * sizeof(uint64_t));
+    char (*skeys)[KEY_LEN] = malloc(count * KEY_LEN);
+    bool ok = keys && skeys;
+    for (size_t i = 0; i < count && ok; ++i) {
+        keys[i] = bench_next();
+        snprintf(skeys[i], KEY_LEN, "%016llx", (unsigned long long)keys[i]);
+    }
+
+    printf("%zu random keys\n", count);
+    ok = ok && bench_lookups(keys, (const char (*)[KEY_LEN])skeys, count) && bench_ranges(keys, count);
+    free(keys);
+    free(skeys);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
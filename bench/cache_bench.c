@@ -0,0 +1,124 @@
+#include <math.h>
+
+#include "bench.h"
+
+/* Read-through traffic on RT_Cache: a get per request and a put on every
+ * miss, over KEYS keys drawn from a Zipfian distribution (skew 0.8, 0.99
+ * and 1.2). The cache holds about a tenth of the keys. N requests per
+ * thread, 10M unless given on the command line, on one thread and on every
+ * core (each thread replays the same trace from its own offset). Prints the
+ * hit ratio and Mops/s for LRU, CLOCK and S3-FIFO. */
+
+#define DEFAULT_COUNT 10000000
+#define KEYS 1000000
+#define VALUE_SIZE 100
+#define KEY_LEN 12
+#define MAX_THREADS 64
+
+typedef char Key[KEY_LEN];
+
+typedef struct {
+    RT_Cache *cache;
+    const Key *keys;
+    const uint32_t *trace;
+    size_t count;
+    size_t offset;
+} Task;
+
+static DWORD replay(void *param)
+{
+    Task *task = param;
+    char value[VALUE_SIZE] = {0};
+    for (size_t i = 0; i < task->count; ++i) {
+        const char *key = task->keys[task->trace[(task->offset + i) % task->count]];
+        if (!rt_cache_get(task->cache, key, value, sizeof(value))) {
+            rt_cache_put(task->cache, key, value, sizeof(value), 0);
+        }
+    }
+    return 0;
+}
+
+// rank r (0 = hottest) is drawn with probability proportional to 1 / (r + 1)^skew
+static void make_trace(uint32_t *trace, size_t count, double skew, double *cdf)
+{
+    double sum = 0;
+    for (size_t r = 0; r < KEYS; ++r) cdf[r] = sum += 1.0 / pow((double)(r + 1), skew);
+    for (size_t i = 0; i < count; ++i) {
+        const double u = (double)(bench_next() >> 11) / 9007199254740992.0 * sum;
+        size_t lo = 0, hi = KEYS - 1;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (cdf[mid] < u) lo = mid + 1;
+            else hi = mid;
+        }
+        trace[i] = (uint32_t)lo;
+    }
+}
+
+static bool run(int policy, size_t threads, const Key *keys, const uint32_t *trace, size_t count,
+                double *hit_ratio, double *mops)
+{
+    RT_Cache cache;
+    if (!rt_cache_init(&cache, (size_t)KEYS / 10 * (VALUE_SIZE + KEY_LEN + sizeof(RT_CacheEntry) + 64), 0, policy)) {
+        return false;
+    }
+
+    Task tasks[MAX_THREADS];
+    for (size_t i = 0; i < threads; ++i) tasks[i] = (Task){ &cache, keys, trace, count, count / threads * i };
+    const double start = bench_now_ns();
+    rt_thread_run_tasks(tasks, sizeof(Task), threads, replay);
+    const double elapsed = bench_now_ns() - start;
+
+    RT_CacheStats stats;
+    rt_cache_stats(&cache, &stats);
+    rt_cache_free(&cache);
+    *hit_ratio = (double)stats.hits / (double)(stats.hits + stats.misses);
+    *mops = (double)(count * threads) * 1e3 / elapsed;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [requests per thread]\n", argv[0]);
+        return 2;
+    }
+
+    size_t cpus = rt_thread_cpu_count();
+    if (cpus > MAX_THREADS) cpus = MAX_THREADS;
+    Key *keys = malloc(KEYS * sizeof(Key));
+    uint32_t *trace = malloc(count * sizeof(uint32_t));
+    double *cdf = malloc(KEYS * sizeof(double));
+    bool ok = keys && trace && cdf;
+    for (size_t i = 0; i < KEYS && ok; ++i) snprintf(keys[i], KEY_LEN, "key%u", (unsigned)i);
+
+    static const struct {
+        const char *name;
+        int policy;
+    } policies[] = {
+        { "LRU", RT_CACHE_LRU }, { "CLOCK", RT_CACHE_CLOCK }, { "S3-FIFO", RT_CACHE_S3FIFO },
+    };
+    static const double skews[] = { 0.8, 0.99, 1.2 };
+
+    printf("%d keys, cache for ~%d, %zu requests per thread\n", KEYS, KEYS / 10, count);
+    printf("%-5s %-8s %9s %13s %13s\n", "skew", "policy", "hit ratio", "1 thread", "all cores");
+    for (size_t s = 0; s < sizeof(skews) / sizeof(skews[0]) && ok; ++s) {
+        make_trace(trace, count, skews[s], cdf);
+        for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]) && ok; ++p) {
+            double hit_ratio, single, multi, ignored;
+            ok = run(policies[p].policy, 1, keys, trace, count, &hit_ratio, &single)
+                && run(policies[p].policy, cpus, keys, trace, count, &ignored, &multi);
+            if (ok) {
+                printf("%-5.2f %-8s %8.2f%% %7.2f Mops/s %7.2f Mops/s (%zu)\n",
+                       skews[s], policies[p].name, 100 * hit_ratio, single, multi, cpus);
+            }
+        }
+    }
+
+    free(keys);
+    free(trace);
+    free(cdf);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
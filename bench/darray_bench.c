@@ -0,0 +1,97 @@
+#include "bench.h"
+
+/* Bulk load of N uint64_t values into an RT_DynamicArray, 10M unless given
+ * on the command line: one push at a time with the default growth factor
+ * and with 1.5, after rt_darray_reserve, and in blocks with rt_darray_push_n.
+ * Each loader runs in its own process so the peak RSS printed next to the
+ * load time is that loader's alone. Peak RSS counts touched pages, so it
+ * may sit below the capacity; a realloc that copies holds both blocks. */
+
+#define DEFAULT_COUNT 10000000
+#define BLOCK 4096
+
+typedef struct {
+    const char *name;
+    bool (*load)(RT_DynamicArray *arr, size_t count);
+} Loader;
+
+static bool load_push(RT_DynamicArray *arr, size_t count)
+{
+    bool ok = true;
+    for (uint64_t i = 0; i < count && ok; ++i) ok = rt_darray_push(arr, &i);
+    return ok;
+}
+
+static bool load_push_slow_growth(RT_DynamicArray *arr, size_t count)
+{
+    return rt_darray_set_growth(arr, 1.5) && load_push(arr, count);
+}
+
+static bool load_reserve(RT_DynamicArray *arr, size_t count)
+{
+    return rt_darray_reserve(arr, count) && load_push(arr, count);
+}
+
+static bool load_push_n(RT_DynamicArray *arr, size_t count)
+{
+    uint64_t block[BLOCK];
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; i += BLOCK) {
+        const size_t n = count - i < BLOCK ? count - i : BLOCK;
+        for (size_t j = 0; j < n; ++j) block[j] = i + j;
+        ok = rt_darray_push_n(arr, block, n);
+    }
+    return ok;
+}
+
+static const Loader loaders[] = {
+    { "push", load_push },
+    { "push-1.5", load_push_slow_growth },
+    { "reserve", load_reserve },
+    { "push_n", load_push_n },
+};
+
+static int run_loader(const Loader *loader, size_t count)
+{
+    RT_DynamicArray arr;
+    if (!rt_darray_init(&arr, sizeof(uint64_t))) return 1;
+
+    const size_t base = bench_peak_rss();
+    const double start = bench_now_ns();
+    bool ok = loader->load(&arr, count);
+    const double elapsed = bench_now_ns() - start;
+    ok = ok && arr.size == count && ((uint64_t*)arr.data)[count - 1] == count - 1;
+
+    if (ok) {
+        printf("%-9s %9.2f ms %7.2f ns/elem %9.1f MB peak %9.1f MB capacity\n",
+               loader->name, elapsed / 1e6, elapsed / count,
+               bench_mb(bench_peak_rss() - base), bench_mb(arr.capacity * arr.element_size));
+    }
+    rt_darray_free(&arr);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [elements]\n", argv[0]);
+        return 2;
+    }
+
+    if (argc > 2) {
+        for (size_t i = 0; i < sizeof(loaders) / sizeof(loaders[0]); ++i) {
+            if (strcmp(argv[2], loaders[i].name) == 0) return run_loader(&loaders[i], count);
+        }
+        fprintf(stderr, "unknown loader %s\n", argv[2]);
+        return 2;
+    }
+
+    printf("%zu uint64_t values, peak RSS above the empty process\n", count);
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(loaders) / sizeof(loaders[0]); ++i) {
+        ok = bench_spawn(argv[0], count, loaders[i].name) && ok;
+    }
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
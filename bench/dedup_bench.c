@@ -0,0 +1,133 @@
+#include "bench.h"
+
+/* Chunking and deduplication on versioned data: N MiB of random bytes, 64
+ * unless given on the command line, then VERSIONS more versions each made
+ * from the last by EDITS scattered edits (an overwrite, insert or delete
+ * of EDIT_SIZE bytes). Prints the rate of cutting alone and of cutting
+ * plus fingerprinting, then writes every version to an RT_DedupStore and
+ * prints the dedup ratio against that of fixed-size blocks of the same
+ * average, and the write and restore rates. The restore of the last
+ * version must equal it. MB/s are snapshot bytes per second. */
+
+#define DEFAULT_MIB 64
+#define VERSIONS 19
+#define EDITS 50
+#define EDIT_SIZE 16
+#define PACK_PATH "dedup_bench.pack"
+#define RECIPE_PATH "dedup_bench.recipe"
+
+static int compare_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_hash(const void *a, const void *b)
+{
+    const RT_Hash128 *x = a, *y = b;
+    if (x->hi != y->hi) return x->hi < y->hi ? -1 : 1;
+    return (x->lo > y->lo) - (x->lo < y->lo);
+}
+
+// copies src to dst with EDITS edits at random places, returns the new size
+static size_t edit(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    uint64_t at[EDITS];
+    for (size_t i = 0; i < EDITS; ++i) at[i] = bench_next() % (size - EDIT_SIZE);
+    qsort(at, EDITS, sizeof(at[0]), compare_u64);
+
+    size_t from = 0, to = 0;
+    for (size_t i = 0; i < EDITS; ++i) {
+        if (at[i] < from) continue;
+        memcpy(dst + to, src + from, at[i] - from);
+        to += at[i] - from;
+        from = at[i];
+        switch (bench_next() % 3) {
+        case 0: bench_fill(dst + to, EDIT_SIZE); to += EDIT_SIZE; from += EDIT_SIZE; break;
+        case 1: bench_fill(dst + to, EDIT_SIZE); to += EDIT_SIZE; break;
+        case 2: from += EDIT_SIZE; break;
+        }
+    }
+    memcpy(dst + to, src + from, size - from);
+    return to + size - from;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t mib = bench_arg(argc, argv, 1, DEFAULT_MIB);
+    if (mib == 0) {
+        fprintf(stderr, "usage: %s [MiB]\n", argv[0]);
+        return 2;
+    }
+
+    const size_t capacity = (mib << 20) + (size_t)(VERSIONS + 1) * EDITS * EDIT_SIZE;
+    uint8_t *versions[2] = { malloc(capacity), malloc(capacity) };
+    const size_t blocks_max = (VERSIONS + 1) * (capacity / RT_CHUNK_AVG + 1);
+    RT_Hash128 *blocks = malloc(blocks_max * sizeof(RT_Hash128));
+    bool ok = versions[0] && versions[1] && blocks;
+    size_t size = mib << 20;
+    if (ok) bench_fill(versions[0], size);
+
+    RT_Chunker chunker;
+    rt_chunker_init(&chunker, 0);
+    size_t cuts = 0;
+    double start = bench_now_ns();
+    for (size_t at = 0; at < size && ok; ++cuts) at += rt_chunker_cut(&chunker, versions[0] + at, size - at);
+    const double cut = bench_now_ns() - start;
+
+    RT_ChunkList chunks = {0};
+    start = bench_now_ns();
+    ok = ok && rt_chunker_split(&chunker, versions[0], size, 0, &chunks);
+    const double split = bench_now_ns() - start;
+    ok = ok && chunks.size == cuts;
+
+    remove(PACK_PATH);
+    RT_DedupStore store;
+    ok = ok && rt_dedup_open(&store, PACK_PATH, 0);
+    const bool opened = ok;
+    double write = 0;
+    size_t block_count = 0, written = 0;
+    for (size_t v = 0; v <= VERSIONS && ok; ++v) {
+        uint8_t *data = versions[v & 1];
+        if (v > 0) size = edit(data, versions[!(v & 1)], size);
+        start = bench_now_ns();
+        ok = rt_dedup_write(&store, data, size, RECIPE_PATH);
+        write += bench_now_ns() - start;
+        written += size;
+        for (size_t at = 0; at < size; at += RT_CHUNK_AVG) {
+            blocks[block_count++] = rt_hash128(data + at, size - at < RT_CHUNK_AVG ? size - at : RT_CHUNK_AVG, 0);
+        }
+    }
+
+    // fixed-size blocks: every distinct block stored once
+    qsort(blocks, block_count, sizeof(RT_Hash128), compare_hash);
+    size_t distinct = 0;
+    for (size_t i = 0; i < block_count; ++i) distinct += i == 0 || compare_hash(&blocks[i - 1], &blocks[i]) != 0;
+
+    RT_FileBuffer restored = {0};
+    start = bench_now_ns();
+    ok = ok && rt_dedup_restore(PACK_PATH, RECIPE_PATH, &restored);
+    const double restore = bench_now_ns() - start;
+    ok = ok && restored.size == size && memcmp(restored.data, versions[VERSIONS & 1], size) == 0;
+
+    if (ok) {
+        printf("%zu MiB and %d versions of %d edits, %zu-byte average chunks\n", mib, VERSIONS, EDITS, chunker.avg);
+        printf("cutting         %8.1f MB/s  average chunk %.1f KiB\n", (mib << 20) * 1e3 / cut, (double)(mib << 20) / cuts / 1024);
+        printf("+ fingerprints  %8.1f MB/s\n", (mib << 20) * 1e3 / split);
+        printf("%.1f MiB written, %.1f MiB pack: dedup ratio %.1f (fixed blocks %.1f), %.1f%% deduped\n",
+               bench_mb(store.written), bench_mb(store.stored), (double)store.written / (double)store.stored,
+               (double)block_count / (double)distinct, 100.0 * (double)store.deduped / (double)store.written);
+        printf("snapshot write  %8.1f MB/s\n", written * 1e3 / write);
+        printf("restore         %8.1f MB/s\n", size * 1e3 / restore);
+    }
+    if (opened) rt_dedup_close(&store);
+    rt_fbuffer_free(&restored);
+    RT_ChunkList_free(&chunks);
+    remove(PACK_PATH);
+    remove(RECIPE_PATH);
+    free(versions[0]);
+    free(versions[1]);
+    free(blocks);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
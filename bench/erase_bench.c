@@ -0,0 +1,111 @@
+#include "bench.h"
+
+/* Removing 10, 25 and 50% of N random uint32_t values, 10M unless given on
+ * the command line, with every batch erase against calling rt_array_del on
+ * each match front to back. A naive delete of the element at original
+ * position p shifts N - p - 1 elements whatever came before, so the loop
+ * costs the sum of that over the matches. It is timed for DEL_SAMPLES
+ * deletions and projected to the full removal at the measured ns per
+ * element moved. */
+
+#define DEFAULT_COUNT 10000000
+#define DEL_SAMPLES 200
+
+static bool below(const void *elem, void *user_data)
+{
+    return *(const uint32_t*)elem < *(const uint32_t*)user_data;
+}
+
+static bool at_or_above(const void *elem, void *user_data)
+{
+    return *(const uint32_t*)elem >= *(const uint32_t*)user_data;
+}
+
+// time of the naive loop over the first DEL_SAMPLES matches, projected to all of them
+static double naive_projection(RT_Array *arr, const uint32_t *values, size_t count, uint32_t limit)
+{
+    double moved = 0, sample_moved = 0;
+    size_t matches = 0;
+    for (size_t p = 0; p < count; ++p) {
+        if (values[p] >= limit) continue;
+        moved += (double)(count - p - 1);
+        if (matches++ < DEL_SAMPLES) sample_moved += (double)(count - p - 1);
+    }
+
+    memcpy(arr->data, values, count * sizeof(uint32_t));
+    arr->size = count;
+    size_t deleted = 0;
+    const double start = bench_now_ns();
+    for (size_t i = 0; i < arr->size && deleted < DEL_SAMPLES;) {
+        if (((uint32_t*)arr->data)[i] < limit) {
+            rt_array_del(arr, i);
+            deleted++;
+        } else {
+            i++;
+        }
+    }
+    const double elapsed = bench_now_ns() - start;
+    return sample_moved > 0 ? elapsed / sample_moved * moved : elapsed;
+}
+
+static bool bench_fraction(RT_Array *arr, const uint32_t *values, size_t count, size_t *indices, unsigned percent)
+{
+    uint32_t limit = (uint32_t)((uint64_t)UINT32_MAX * percent / 100);
+    size_t matches = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] < limit) indices[matches++] = i;
+    }
+
+    double ms[6];
+    bool ok = true;
+    for (int variant = 0; variant < 5 && ok; ++variant) {
+        memcpy(arr->data, values, count * sizeof(uint32_t));
+        arr->size = count;
+        const double start = bench_now_ns();
+        size_t removed = 0;
+        switch (variant) {
+        case 0: removed = rt_array_erase_if(arr, &limit, below); break;
+        case 1: removed = rt_array_retain(arr, &limit, at_or_above); break;
+        case 2: removed = rt_array_erase_indices(arr, indices, matches); break;
+        case 3: removed = rt_array_erase_where(arr, RT_ELEM_U32, RT_CMP_LT, &limit, 1); break;
+        case 4: removed = rt_array_erase_where(arr, RT_ELEM_U32, RT_CMP_LT, &limit, 0); break;
+        }
+        ms[variant] = (bench_now_ns() - start) / 1e6;
+        ok = removed == matches && arr->size == count - matches;
+    }
+    if (!ok) return false;
+    ms[5] = naive_projection(arr, values, count, limit) / 1e6;
+
+    printf("%3u%%", percent);
+    for (int variant = 0; variant < 5; ++variant) printf(" %9.2f", ms[variant]);
+    printf(" %12.0f  (%.0fx erase_if)\n", ms[5], ms[5] / ms[0]);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [elements]\n", argv[0]);
+        return 2;
+    }
+
+    RT_Array arr = {0};
+    uint32_t *values = malloc(count * sizeof(uint32_t));
+    size_t *indices = malloc(count * sizeof(size_t));
+    bool ok = values && indices && rt_array_init(&arr, count, sizeof(uint32_t));
+    for (size_t i = 0; i < count && ok; ++i) values[i] = bench_next_u32();
+
+    printf("%zu uint32_t values, ms; rt_array_del projected from %d deletions\n", count, DEL_SAMPLES);
+    printf("%4s %9s %9s %9s %9s %9s %12s\n", "", "erase_if", "retain", "indices", "where/1", "where/all", "rt_array_del");
+    static const unsigned percents[] = { 10, 25, 50 };
+    for (size_t i = 0; i < sizeof(percents) / sizeof(percents[0]) && ok; ++i) {
+        ok = bench_fraction(&arr, values, count, indices, percents[i]);
+    }
+
+    rt_array_free(&arr);
+    free(values);
+    free(indices);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
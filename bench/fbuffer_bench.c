@@ -0,0 +1,79 @@
+#include "bench.h"
+
+/* rt_file_read (heap copy) against rt_file_map (view) on a file of N MiB,
+ * 1024 unless given on the command line. Each run is its own process and
+ * prints the time to the first byte, the time to finish its access
+ * pattern and the peak RSS it added: "full" sums every 8-byte word, "sparse"
+ * touches one byte in every SPARSE_STRIDE. The file is written just before,
+ * so both read from the page cache; drop it first to time the disk. */
+
+#define DEFAULT_MIB 1024
+#define SPARSE_STRIDE (64 * 4096)
+#define PATH "fbuffer_bench.bin"
+
+static int run(bool map, bool sparse)
+{
+    RT_FileBuffer buffer = {0};
+    const size_t base = bench_peak_rss();
+    const double start = bench_now_ns();
+    bool ok = map
+        ? rt_file_map(PATH, &buffer, RT_FBUFFER_MAP_READ | (sparse ? RT_FBUFFER_MAP_RANDOM : RT_FBUFFER_MAP_SEQUENTIAL))
+        : rt_file_read(PATH, &buffer);
+    ok = ok && buffer.size > 0;
+    volatile uint8_t first = ok ? buffer.data[0] : 0;
+    const double first_byte = bench_now_ns() - start;
+
+    uint64_t sum = first;
+    if (ok && sparse) {
+        for (size_t i = 0; i < buffer.size; i += SPARSE_STRIDE) sum += buffer.data[i];
+    } else if (ok) {
+        for (size_t i = 0; i + 8 <= buffer.size; i += 8) {
+            uint64_t word;
+            memcpy(&word, buffer.data + i, 8);
+            sum += word;
+        }
+    }
+    const double done = bench_now_ns() - start;
+
+    if (ok) {
+        printf("%-4s %-6s first byte %9.3f ms  done %9.2f ms  peak RSS +%7.1f MiB  (sum %llx)\n",
+               map ? "map" : "read", sparse ? "sparse" : "full", first_byte / 1e6, done / 1e6,
+               bench_mb(bench_peak_rss() - base), (unsigned long long)sum);
+    }
+    rt_fbuffer_free(&buffer);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t mib = bench_arg(argc, argv, 1, DEFAULT_MIB);
+    if (mib == 0) {
+        fprintf(stderr, "usage: %s [MiB]\n", argv[0]);
+        return 2;
+    }
+
+    // child: "<self> <MiB> <read|map>:<full|sparse>"
+    if (argc > 2) {
+        const char *colon = strchr(argv[2], ':');
+        if (!colon) return 2;
+        return run(strncmp(argv[2], "map", 3) == 0, strcmp(colon + 1, "sparse") == 0);
+    }
+
+    FILE *f = fopen(PATH, "wb");
+    bool ok = f != NULL;
+    uint8_t *chunk = malloc(1 << 20);
+    ok = ok && chunk;
+    for (size_t i = 0; i < mib && ok; ++i) {
+        bench_fill(chunk, 1 << 20);
+        ok = fwrite(chunk, 1, 1 << 20, f) == 1 << 20;
+    }
+    if (f && fclose(f) != 0) ok = false;
+    free(chunk);
+
+    printf("%zu MiB file\n", mib);
+    static const char *const modes[] = { "read:full", "map:full", "read:sparse", "map:sparse" };
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]) && ok; ++i) ok = bench_spawn(argv[0], mib, modes[i]);
+    remove(PATH);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
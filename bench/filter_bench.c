@@ -0,0 +1,106 @@
+#include "bench.h"
+
+/* Negative lookups: N keys, 1M unless given on the command line, go into an
+ * RT_HashMap and an RT_FilteredMap, then LOOKUPS keys that were never added
+ * are looked up in both; the speedup is the point of the filter. Present
+ * keys are timed too, where the filter only adds work. The bare Bloom and
+ * cuckoo filters are timed on the same absent keys with their measured
+ * false-positive rate. */
+
+#define DEFAULT_COUNT 1000000
+#define LOOKUPS 1000000
+#define KEY_LEN 24
+
+typedef char Key[KEY_LEN];
+
+static void make_keys(Key *keys, size_t count, const char *prefix)
+{
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(keys[i], KEY_LEN, "%s:%llu", prefix, (unsigned long long)(bench_next() >> 16));
+    }
+}
+
+static double time_map(RT_HashMap *map, const Key *keys, size_t expect_hits)
+{
+    size_t hits = 0;
+    const double start = bench_now_ns();
+    for (size_t i = 0; i < LOOKUPS; ++i) hits += rt_hashmap_contains(map, keys[i]);
+    const double elapsed = bench_now_ns() - start;
+    return hits == expect_hits ? elapsed / LOOKUPS : -1;
+}
+
+static double time_fmap(RT_FilteredMap *fmap, const Key *keys, size_t expect_hits)
+{
+    size_t hits = 0;
+    const double start = bench_now_ns();
+    for (size_t i = 0; i < LOOKUPS; ++i) hits += rt_fmap_contains(fmap, keys[i]);
+    const double elapsed = bench_now_ns() - start;
+    return hits == expect_hits ? elapsed / LOOKUPS : -1;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [keys]\n", argv[0]);
+        return 2;
+    }
+
+    Key *present = malloc(count * sizeof(Key));
+    Key *absent = malloc(LOOKUPS * sizeof(Key));
+    Key *probes = malloc(LOOKUPS * sizeof(Key));
+    RT_HashMap map = {0};
+    RT_FilteredMap fmap = {0};
+    RT_BloomFilter bloom = {0};
+    RT_CuckooFilter cuckoo = {0};
+    bool ok = present && absent && probes
+        && rt_hashmap_init(&map, RT_HASHMAP_INIT_BUCKETS_COUNT) && rt_fmap_init(&fmap, count)
+        && rt_bloom_init(&bloom, count, RT_FMAP_FPP) && rt_cuckoo_init(&cuckoo, count, RT_FMAP_FPP);
+
+    // different prefixes, so no absent key can collide with a present one
+    if (ok) {
+        make_keys(present, count, "in");
+        make_keys(absent, LOOKUPS, "out");
+        for (size_t i = 0; i < LOOKUPS; ++i) memcpy(probes[i], present[bench_next() % count], sizeof(Key));
+    }
+    uint32_t value = 1;
+    for (size_t i = 0; i < count && ok; ++i) {
+        ok = rt_hashmap_insert(&map, present[i], &value, sizeof(value))
+            && rt_fmap_insert(&fmap, present[i], &value, sizeof(value))
+            && rt_cuckoo_add(&cuckoo, present[i]);
+        rt_bloom_add(&bloom, present[i]);
+    }
+
+    if (ok) {
+        const double map_miss = time_map(&map, absent, 0), fmap_miss = time_fmap(&fmap, absent, 0);
+        const double map_hit = time_map(&map, probes, LOOKUPS), fmap_hit = time_fmap(&fmap, probes, LOOKUPS);
+        ok = map_miss > 0 && fmap_miss > 0 && map_hit > 0 && fmap_hit > 0;
+
+        size_t bloom_fp = 0, cuckoo_fp = 0;
+        double start = bench_now_ns();
+        for (size_t i = 0; i < LOOKUPS; ++i) bloom_fp += rt_bloom_contains(&bloom, absent[i]);
+        const double bloom_miss = (bench_now_ns() - start) / LOOKUPS;
+        start = bench_now_ns();
+        for (size_t i = 0; i < LOOKUPS; ++i) cuckoo_fp += rt_cuckoo_contains(&cuckoo, absent[i]);
+        const double cuckoo_miss = (bench_now_ns() - start) / LOOKUPS;
+
+        if (ok) {
+            printf("%zu keys, %d lookups each\n", count, LOOKUPS);
+            printf("%-15s %9s %9s\n", "", "absent", "present");
+            printf("%-15s %6.1f ns %6.1f ns\n", "RT_HashMap", map_miss, map_hit);
+            printf("%-15s %6.1f ns %6.1f ns   %.1fx on absent keys\n", "RT_FilteredMap", fmap_miss, fmap_hit, map_miss / fmap_miss);
+            printf("%-15s %6.1f ns             %.4f%% false positives\n", "bloom", bloom_miss, 100.0 * bloom_fp / LOOKUPS);
+            printf("%-15s %6.1f ns             %.4f%% false positives\n", "cuckoo", cuckoo_miss, 100.0 * cuckoo_fp / LOOKUPS);
+        }
+    }
+
+    rt_hashmap_free(&map);
+    rt_fmap_free(&fmap);
+    rt_bloom_free(&bloom);
+    rt_cuckoo_free(&cuckoo);
+    free(present);
+    free(absent);
+    free(probes);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
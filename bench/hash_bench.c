@@ -0,0 +1,152 @@
+#include "bench.h"
+
+/* CRC32C and content hash throughput. Per core: rt_crc32c against a
+ * byte-at-a-time table CRC, which must agree, and rt_hash64, both on a
+ * CACHED_SIZE buffer hashed over and over (in cache) and once over N MiB,
+ * 256 unless given on the command line (from RAM), plus rt_hash64 on
+ * 32-byte keys. Then scaling: 1, 2, 4... threads up to the core count each
+ * hash their own slice of the N MiB, and the slice CRCs joined with
+ * rt_crc32c_combine must equal the one-thread CRC; rt_crc32c_parallel is
+ * timed last. GB/s are input bytes per second, summed over threads. */
+
+#define DEFAULT_MIB 256
+#define CACHED_SIZE 0x8000
+#define CACHED_ROUNDS 8192
+#define KEY_SIZE 32
+#define MAX_THREADS 64
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    bool crc;
+    uint32_t crc32c;
+    uint64_t hash;
+} Task;
+
+static uint32_t table[256];
+
+static void make_table(void)
+{
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) crc = crc & 1 ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+        table[i] = crc;
+    }
+}
+
+static uint32_t crc32c_bytes(uint32_t crc, const uint8_t *data, size_t size)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
+    return ~crc;
+}
+
+static DWORD worker(void *param)
+{
+    Task *task = param;
+    if (task->crc) task->crc32c = rt_crc32c(0, task->data, task->size);
+    else task->hash = rt_hash64(task->data, task->size, 0);
+    return 0;
+}
+
+// runs `threads` workers over equal slices of data; the CRC of the whole comes back joined
+static double run(bool crc, size_t threads, const uint8_t *data, size_t size, uint32_t *crc32c)
+{
+    Task tasks[MAX_THREADS];
+    const size_t slice = size / threads;
+    for (size_t i = 0; i < threads; ++i) {
+        tasks[i] = (Task){ data + slice * i, i + 1 < threads ? slice : size - slice * i, crc, 0, 0 };
+    }
+    const double start = bench_now_ns();
+    rt_thread_run_tasks(tasks, sizeof(Task), threads, worker);
+    const double elapsed = bench_now_ns() - start;
+
+    *crc32c = tasks[0].crc32c;
+    for (size_t i = 1; i < threads; ++i) *crc32c = rt_crc32c_combine(*crc32c, tasks[i].crc32c, tasks[i].size);
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t mib = bench_arg(argc, argv, 1, DEFAULT_MIB);
+    if (mib == 0) {
+        fprintf(stderr, "usage: %s [MiB]\n", argv[0]);
+        return 2;
+    }
+
+    make_table();
+    size_t cpus = rt_thread_cpu_count();
+    if (cpus > MAX_THREADS) cpus = MAX_THREADS;
+    const size_t size = mib << 20;
+    uint8_t *data = malloc(size);
+    bool ok = data && size >= CACHED_SIZE && rt_crc32c(0, "123456789", 9) == 0xE3069283;
+    if (ok) bench_fill(data, size);
+
+    // per core, in cache
+    uint32_t fast = 0, slow = 0;
+    uint64_t hash = 0;
+    double start = bench_now_ns();
+    for (size_t i = 0; i < CACHED_ROUNDS && ok; ++i) fast = rt_crc32c(fast, data, CACHED_SIZE);
+    const double cached_crc = bench_now_ns() - start;
+    hash += fast;
+    start = bench_now_ns();
+    for (size_t i = 0; i < CACHED_ROUNDS / 16 && ok; ++i) slow = crc32c_bytes(slow, data, CACHED_SIZE);
+    const double cached_table = (bench_now_ns() - start) * 16;
+    uint32_t chained = 0;
+    for (size_t i = 0; i < CACHED_ROUNDS / 16 && ok; ++i) chained = rt_crc32c(chained, data, CACHED_SIZE);
+    ok = ok && slow == chained;
+    start = bench_now_ns();
+    for (size_t i = 0; i < CACHED_ROUNDS && ok; ++i) hash += rt_hash64(data, CACHED_SIZE, i);
+    const double cached_hash = bench_now_ns() - start;
+
+    // per core, from RAM
+    start = bench_now_ns();
+    const uint32_t whole = ok ? rt_crc32c(0, data, size) : 0;
+    const double ram_crc = bench_now_ns() - start;
+    ok = ok && crc32c_bytes(0, data, size) == whole;
+    start = bench_now_ns();
+    hash += ok ? rt_hash64(data, size, 0) : 0;
+    const double ram_hash = bench_now_ns() - start;
+
+    const size_t keys = size / KEY_SIZE;
+    start = bench_now_ns();
+    for (size_t i = 0; i < keys && ok; ++i) hash += rt_hash64(data + i * KEY_SIZE, KEY_SIZE, 0);
+    const double key_hash = bench_now_ns() - start;
+
+    // streaming in odd pieces gives the one-shot hash
+    RT_HashState state;
+    rt_hash_init(&state, 0);
+    for (size_t at = 0, step = 1; at < size && ok; at += step, step = step * 3 % 100003 + 1) {
+        rt_hash_update(&state, data + at, step < size - at ? step : size - at);
+    }
+    ok = ok && rt_hash_final64(&state) == rt_hash64(data, size, 0);
+
+    if (ok) {
+        const double cached = (double)CACHED_SIZE * CACHED_ROUNDS;
+        printf("per core, %d KiB in cache / %zu MiB from RAM (check %llx)\n", CACHED_SIZE >> 10, mib, (unsigned long long)hash);
+        printf("%-14s %6.2f GB/s %6.2f GB/s\n", "rt_crc32c", cached / cached_crc, size / ram_crc);
+        printf("%-14s %6.2f GB/s\n", "byte table", cached / cached_table);
+        printf("%-14s %6.2f GB/s %6.2f GB/s  %.1f M %d-byte keys/s\n", "rt_hash64", cached / cached_hash,
+               size / ram_hash, keys * 1e3 / key_hash, KEY_SIZE);
+        printf("%-8s %14s %14s\n", "threads", "rt_crc32c", "rt_hash64");
+    }
+
+    for (size_t threads = 1; ok; threads *= 2) {
+        if (threads > cpus) threads = cpus;
+        uint32_t joined, ignored;
+        const double crc = run(true, threads, data, size, &joined);
+        const double hashed = run(false, threads, data, size, &ignored);
+        ok = joined == whole;
+        if (ok) printf("%-8zu %9.2f GB/s %9.2f GB/s\n", threads, size / crc, size / hashed);
+        if (threads == cpus) break;
+    }
+
+    start = bench_now_ns();
+    ok = ok && rt_crc32c_parallel(0, data, size) == whole;
+    const double parallel = bench_now_ns() - start;
+    if (ok) printf("rt_crc32c_parallel %.2f GB/s on %zu cores\n", size / parallel, cpus);
+
+    free(data);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include "bench.h"
+
+/* Priority queue insertion at N elements, 1M unless given on the command
+ * line: a 2-ary and a 4-ary RT_Heap (push, pop, heapify), against keeping
+ * an RT_List sorted. A sorted insert walks half the list on average, so
+ * filling a list of N that way is quadratic; the list is built in order
+ * instead and LIST_SAMPLES random inserts are timed at full size. */
+
+#define DEFAULT_COUNT 1000000
+#define LIST_SAMPLES 1000
+
+static int compare_u32(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static bool bench_heap(size_t arity, const uint32_t *values, size_t count)
+{
+    RT_Heap heap = {0};
+    if (!rt_heap_init_ex(&heap, sizeof(uint32_t), arity, compare_u32)) return false;
+
+    bool ok = true;
+    double start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_heap_push(&heap, &values[i]);
+    const double push = bench_now_ns() - start;
+
+    uint32_t last = 0, value;
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) {
+        ok = rt_heap_pop(&heap, &value) && value >= last;
+        last = value;
+    }
+    const double pop = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    if (ok) ok = rt_heap_heapify(&heap, values, count);
+    const double heapify = bench_now_ns() - start;
+
+    rt_heap_free(&heap);
+    if (!ok) return false;
+    printf("%zu-ary heap    push %6.1f ns   pop %6.1f ns   heapify %7.2f ms\n",
+           arity, push / count, pop / count, heapify / 1e6);
+    return true;
+}
+
+static bool list_insert_sorted(RT_List *list, uint32_t value)
+{
+    RT_ListNode *at = list->head;
+    while (at && *(const uint32_t*)at->data < value) at = at->next;
+    if (!at) return rt_list_push_back(list, &value);
+
+    RT_ListNode *node = RT_MALLOC(sizeof(RT_ListNode));
+    if (!node) return false;
+    node->data = RT_MALLOC(sizeof(uint32_t));
+    if (!node->data) {
+        RT_FREE(node);
+        return false;
+    }
+    memcpy(node->data, &value, sizeof(value));
+
+    node->next = at;
+    node->prev = at->prev;
+    if (at->prev) at->prev->next = node;
+    else list->head = node;
+    at->prev = node;
+    list->size++;
+    return true;
+}
+
+static bool bench_list(const uint32_t *values, size_t count)
+{
+    uint32_t *sorted = malloc(count * sizeof(uint32_t));
+    if (!sorted) return false;
+    memcpy(sorted, values, count * sizeof(uint32_t));
+    qsort(sorted, count, sizeof(uint32_t), compare_u32);
+
+    RT_List list;
+    rt_list_init(&list, sizeof(uint32_t));
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_list_push_back(&list, &sorted[i]);
+    free(sorted);
+
+    const double start = bench_now_ns();
+    for (size_t i = 0; i < LIST_SAMPLES && ok; ++i) ok = list_insert_sorted(&list, bench_next_u32());
+    const double insert = bench_now_ns() - start;
+
+    rt_list_free(&list);
+    if (!ok) return false;
+    printf("sorted RT_List insert %8.1f ns (mean of %d at %zu elements)\n", insert / LIST_SAMPLES, LIST_SAMPLES, count);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [elements]\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t *values = malloc(count * sizeof(uint32_t));
+    if (!values) return 1;
+    for (size_t i = 0; i < count; ++i) values[i] = bench_next_u32();
+
+    printf("%zu random u32 values\n", count);
+    const bool ok = bench_heap(2, values, count) && bench_heap(4, values, count) && bench_list(values, count);
+    free(values);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include "bench.h"
+
+/* Hex dump throughput over N MiB of random bytes, 256 unless given on the
+ * command line: rt_hexdump_format in memory against a per-row sprintf
+ * formatter (what rt_file_hexdump used to do), whose output must match,
+ * then rt_file_hexdump file to file. GB/s are input bytes per second. */
+
+#define DEFAULT_MIB 256
+#define IN_PATH "hexdump_bench.bin"
+#define OUT_PATH "hexdump_bench.txt"
+
+static size_t format_sprintf(char *out, const uint8_t *data, size_t size)
+{
+    char *at = out;
+    for (size_t i = 0; i < size; i += RT_HEXDUMP_ROW) {
+        const size_t row = size - i < RT_HEXDUMP_ROW ? size - i : RT_HEXDUMP_ROW;
+        at += sprintf(at, "%08llx | ", (unsigned long long)i);
+        for (size_t j = 0; j < row; ++j) at += sprintf(at, "%02X ", data[i + j]);
+        for (size_t j = row; j < RT_HEXDUMP_ROW; ++j) at += sprintf(at, "   ");
+        at += sprintf(at, "| ");
+        for (size_t j = 0; j < row; ++j) *at++ = data[i + j] >= 0x20 && data[i + j] < 0x7F ? (char)data[i + j] : '.';
+        *at++ = '\n';
+    }
+    return (size_t)(at - out);
+}
+
+int main(int argc, char **argv)
+{
+    const size_t mib = bench_arg(argc, argv, 1, DEFAULT_MIB);
+    if (mib == 0) {
+        fprintf(stderr, "usage: %s [MiB]\n", argv[0]);
+        return 2;
+    }
+
+    const size_t size = mib << 20;
+    uint8_t *data = malloc(size);
+    char *text = malloc(rt_hexdump_bound(size));
+    char *expected = malloc(rt_hexdump_bound(size));
+    bool ok = data && text && expected;
+    if (ok) bench_fill(data, size);
+
+    double start = bench_now_ns();
+    const size_t length = ok ? rt_hexdump_format(text, data, size, 0) : 0;
+    const double format = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    const size_t expected_length = ok ? format_sprintf(expected, data, size) : 0;
+    const double naive = bench_now_ns() - start;
+    ok = ok && length == expected_length && memcmp(text, expected, length) == 0;
+
+    ok = ok && bench_write_file(IN_PATH, data, size);
+    remove(OUT_PATH);
+    start = bench_now_ns();
+    ok = ok && rt_file_hexdump(IN_PATH, OUT_PATH) == size;
+    const double file = bench_now_ns() - start;
+
+    if (ok) {
+        printf("%zu MiB input, %.1f MiB of text\n", mib, bench_mb(length));
+        printf("%-18s %6.2f GB/s\n", "sprintf per row", size / naive);
+        printf("%-18s %6.2f GB/s  %.1fx\n", "rt_hexdump_format", size / format, naive / format);
+        printf("%-18s %6.2f GB/s  file to file\n", "rt_file_hexdump", size / file);
+    }
+    remove(IN_PATH);
+    remove(OUT_PATH);
+    free(data);
+    free(text);
+    free(expected);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
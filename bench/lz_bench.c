@@ -0,0 +1,131 @@
+#include "bench.h"
+
+/* LZ compression ratio and throughput on three inputs of N MiB, 64 unless
+ * given on the command line: "binary" is an array of log-like records (a
+ * counter, a rising timestamp, a type, a name from a short list and a
+ * random value), "hexdump" is the rt_hexdump_format text of those records
+ * and "random" does not compress at all. Each is compressed one
+ * RT_LZ_BLOCK_SIZE block at a time with rt_lz_compress on one core, then
+ * as a frame with rt_lz_frame_compress on every core, and must decompress
+ * back to the input both ways. MB/s are raw bytes per second. */
+
+#define DEFAULT_MIB 64
+
+typedef struct {
+    uint32_t id;
+    uint32_t time;
+    uint16_t type;
+    char name[14];
+    double value;
+} Record;
+
+static void make_records(uint8_t *out, size_t size)
+{
+    static const char *const names[] = { "open", "read", "write", "close", "seek", "flush", "stat", "unlink" };
+    Record record = {0};
+    for (size_t at = 0; at < size; at += sizeof(record)) {
+        const uint64_t r = bench_next();
+        record.id++;
+        record.time += (uint32_t)(r & 0xFF);
+        record.type = (uint16_t)(r >> 8 & 3);
+        memset(record.name, 0, sizeof(record.name));
+        strcpy(record.name, names[r >> 16 & 7]);
+        record.value = (double)(r >> 32) / 4096.0;
+        memcpy(out + at, &record, size - at < sizeof(record) ? size - at : sizeof(record));
+    }
+}
+
+static bool blocks(const uint8_t *data, size_t size, uint8_t *packed, uint8_t *unpacked,
+                   size_t *compressed, double *comp, double *decomp)
+{
+    size_t *sizes = malloc((size / RT_LZ_BLOCK_SIZE + 1) * sizeof(size_t));
+    if (!sizes) return false;
+    const size_t bound = rt_lz_bound(RT_LZ_BLOCK_SIZE);
+
+    bool ok = true;
+    *compressed = 0;
+    double start = bench_now_ns();
+    for (size_t at = 0, i = 0; at < size && ok; at += RT_LZ_BLOCK_SIZE, ++i) {
+        const size_t raw = size - at < RT_LZ_BLOCK_SIZE ? size - at : RT_LZ_BLOCK_SIZE;
+        sizes[i] = rt_lz_compress(data + at, raw, packed + i * bound, bound);
+        ok = sizes[i] > 0;
+        *compressed += sizes[i];
+    }
+    *comp = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (size_t at = 0, i = 0; at < size && ok; at += RT_LZ_BLOCK_SIZE, ++i) {
+        const size_t raw = size - at < RT_LZ_BLOCK_SIZE ? size - at : RT_LZ_BLOCK_SIZE;
+        ok = rt_lz_decompress(packed + i * bound, sizes[i], unpacked + at, raw);
+    }
+    *decomp = bench_now_ns() - start;
+
+    free(sizes);
+    return ok && memcmp(unpacked, data, size) == 0;
+}
+
+static bool frame(const uint8_t *data, size_t size, size_t *compressed, double *comp, double *decomp)
+{
+    RT_FileBuffer packed = {0}, unpacked = {0};
+    double start = bench_now_ns();
+    bool ok = rt_lz_frame_compress(&packed, data, size);
+    *comp = bench_now_ns() - start;
+    start = bench_now_ns();
+    ok = ok && rt_lz_frame_decompress(&unpacked, packed.data, packed.size);
+    *decomp = bench_now_ns() - start;
+    ok = ok && unpacked.size == size && memcmp(unpacked.data, data, size) == 0;
+    *compressed = packed.size;
+    rt_fbuffer_free(&packed);
+    rt_fbuffer_free(&unpacked);
+    return ok;
+}
+
+static void report(const char *input, const char *how, size_t size, size_t compressed, double comp, double decomp)
+{
+    printf("%-8s %-7s ratio %5.2f  comp %7.1f MB/s  decomp %7.1f MB/s\n", input, how,
+           (double)size / (double)compressed, size * 1e3 / comp, size * 1e3 / decomp);
+}
+
+int main(int argc, char **argv)
+{
+    const size_t mib = bench_arg(argc, argv, 1, DEFAULT_MIB);
+    if (mib == 0) {
+        fprintf(stderr, "usage: %s [MiB]\n", argv[0]);
+        return 2;
+    }
+
+    const size_t size = mib << 20;
+    const size_t blocks_size = (size / RT_LZ_BLOCK_SIZE + 1) * rt_lz_bound(RT_LZ_BLOCK_SIZE);
+    uint8_t *inputs[3] = { malloc(size), malloc(size), malloc(size) };
+    char *text = malloc(rt_hexdump_bound(size / 4 + 1));
+    uint8_t *packed = malloc(blocks_size);
+    uint8_t *unpacked = malloc(size);
+    bool ok = inputs[0] && inputs[1] && inputs[2] && text && packed && unpacked;
+    if (ok) {
+        make_records(inputs[0], size);
+        // a row of text is a little over four times its bytes, so a quarter of the records is enough
+        const size_t length = rt_hexdump_format(text, inputs[0], size / 4 + 1, 0);
+        ok = length >= size;
+        memcpy(inputs[1], text, size);
+        bench_fill(inputs[2], size);
+    }
+
+    static const char *const names[] = { "binary", "hexdump", "random" };
+    const size_t cpus = rt_thread_cpu_count();
+    printf("%zu MiB per input, blocks of %d KiB, frames on %zu cores\n", mib, RT_LZ_BLOCK_SIZE >> 10, cpus);
+    for (size_t i = 0; i < 3 && ok; ++i) {
+        size_t compressed;
+        double comp, decomp;
+        ok = blocks(inputs[i], size, packed, unpacked, &compressed, &comp, &decomp);
+        if (ok) report(names[i], "blocks", size, compressed, comp, decomp);
+        ok = ok && frame(inputs[i], size, &compressed, &comp, &decomp);
+        if (ok) report(names[i], "frame", size, compressed, comp, decomp);
+    }
+
+    for (size_t i = 0; i < 3; ++i) free(inputs[i]);
+    free(text);
+    free(packed);
+    free(unpacked);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#include "bench.h"
+
+/* N short arrays of uint32_t, 200K unless given on the command line, each
+ * built with init + push of 4, 16 and 64 values and freed again: the
+ * RT_DynamicArray, RT_SmallArray and a typed small array with 16 inline
+ * elements. 16 values still fit inline, 64 spill to the heap. Each run is
+ * its own process, so peak RSS covers that container alone; the headers are
+ * one zeroed block first touched by init and count towards it. */
+
+#define DEFAULT_COUNT 200000
+
+RT_DEFINE_SMALL_ARRAY(bench_sarray_u32, uint32_t, 16)
+
+typedef struct {
+    const char *name;
+    size_t size; // struct size, the headers are one block
+    bool (*build)(void *arr, size_t length);
+    void (*release)(void *arr);
+} Container;
+
+static bool build_darray(void *arr, size_t length)
+{
+    if (!rt_darray_init(arr, sizeof(uint32_t))) return false;
+    bool ok = true;
+    for (uint32_t i = 0; i < length && ok; ++i) ok = rt_darray_push(arr, &i);
+    return ok;
+}
+
+static bool build_sarray(void *arr, size_t length)
+{
+    if (!rt_sarray_init(arr, sizeof(uint32_t))) return false;
+    bool ok = true;
+    for (uint32_t i = 0; i < length && ok; ++i) ok = rt_sarray_push(arr, &i);
+    return ok;
+}
+
+static bool build_typed(void *arr, size_t length)
+{
+    bench_sarray_u32_init(arr);
+    bool ok = true;
+    for (uint32_t i = 0; i < length && ok; ++i) ok = bench_sarray_u32_push(arr, i);
+    return ok;
+}
+
+static void release_darray(void *arr) { rt_darray_free(arr); }
+static void release_sarray(void *arr) { rt_sarray_free(arr); }
+static void release_typed(void *arr) { bench_sarray_u32_free(arr); }
+
+static const Container containers[] = {
+    { "darray", sizeof(RT_DynamicArray), build_darray, release_darray },
+    { "sarray", sizeof(RT_SmallArray), build_sarray, release_sarray },
+    { "typed", sizeof(bench_sarray_u32), build_typed, release_typed },
+};
+
+static int run(const Container *c, size_t count, size_t length)
+{
+    char *arrays = calloc(count, c->size);
+    if (!arrays) return 1;
+
+    const size_t base = bench_peak_rss();
+    bool ok = true;
+    double start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = c->build(arrays + i * c->size, length);
+    const double build = bench_now_ns() - start;
+    const size_t peak = bench_peak_rss();
+
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) c->release(arrays + i * c->size);
+    const double release = bench_now_ns() - start;
+
+    if (ok) {
+        printf("%-7s %3zu values %7.1f ns build %6.1f ns free %7.0f bytes/array\n", c->name, length,
+               build / count, release / count, (double)(peak - base) / count);
+    }
+    free(arrays);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [arrays]\n", argv[0]);
+        return 2;
+    }
+
+    // child: "<self> <count> <container>:<length>"
+    if (argc > 2) {
+        const char *colon = strchr(argv[2], ':');
+        const size_t length = colon ? strtoull(colon + 1, NULL, 10) : 0;
+        for (size_t i = 0; colon && i < sizeof(containers) / sizeof(containers[0]); ++i) {
+            const size_t name_len = strlen(containers[i].name);
+            if ((size_t)(colon - argv[2]) == name_len && strncmp(argv[2], containers[i].name, name_len) == 0) {
+                return run(&containers[i], count, length);
+            }
+        }
+        fprintf(stderr, "unknown run %s\n", argv[2]);
+        return 2;
+    }
+
+    printf("%zu arrays of uint32_t, bytes/array is peak RSS growth, headers included\n", count);
+    static const size_t lengths[] = { 4, 16, 64 };
+    bool ok = true;
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+        for (size_t i = 0; i < sizeof(containers) / sizeof(containers[0]); ++i) {
+            char mode[32];
+            snprintf(mode, sizeof(mode), "%s:%zu", containers[i].name, lengths[l]);
+            ok = bench_spawn(argv[0], count, mode) && ok;
+        }
+    }
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#include "bench.h"
+
+/* Signature scanning throughput over N MiB of random bytes, 256 unless given
+ * on the command line, with PLANTS copies of every signature below written
+ * in at spaced offsets. One fixed signature against a memchr + memcmp
+ * memmem, one wildcard signature against a naive masked loop, then sets of
+ * 2 to 16 signatures and rt_file_scan on the whole set. Single signatures
+ * must count what the reference counts; for the sets every match is
+ * checked against its mask and every planted copy must be found. GB/s are
+ * input bytes per second. */
+
+#define DEFAULT_MIB 256
+#define PLANTS 64
+#define PATH "scan_bench.bin"
+
+static const char *const signatures[] = {
+    "48 89 5C 24 08 57 48 83 EC 20",
+    "E8 ?? ?? ?? ?? 48 8B D8 48 85 C0",
+    "48 8B 05 ?? ?? ?? ?? 48 85 C0 74",
+    "40 53 48 83 EC 20 8B D9",
+    "FF 15 ?? ?? ?? ?? 85 C0 75",
+    "4? 8B 0D ?? ?? ?? ?? E8",
+    "0F B6 ?? 24 ?? 3C 2F",
+    "48 8D 0D ?? ?? ?? ?? E9 ?? ?? ?? ??",
+    "83 F8 FF 74 ?? 48 8B",
+    "C7 44 24 ?? 00 00 00 00 E8",
+    "48 83 C4 28 C3 CC CC",
+    "33 C0 48 8B 5C 24 30 48 83 C4 20 5F C3",
+    "41 B8 ?? ?? ?? ?? 48 8B CB E8",
+    "66 0F 1F 44 00 00",
+    "89 ?5 ?? ?? ?? ?? 8B 45",
+    "B9 ?? ?? ?? ?? FF 15",
+};
+#define SIGNATURES (sizeof(signatures) / sizeof(signatures[0]))
+
+static bool matches_at(const RT_ScanPattern *pattern, const uint8_t *data)
+{
+    for (size_t j = 0; j < pattern->size; ++j) {
+        if ((data[j] & pattern->mask[j]) != pattern->bytes[j]) return false;
+    }
+    return true;
+}
+
+static size_t count_memmem(const uint8_t *data, size_t size, const uint8_t *needle, size_t length)
+{
+    size_t count = 0;
+    const uint8_t *at = data, *end = data + size - length + 1;
+    while ((at = memchr(at, needle[0], (size_t)(end - at))) != NULL) {
+        if (memcmp(at, needle, length) == 0) ++count;
+        ++at;
+    }
+    return count;
+}
+
+static size_t count_naive(const RT_ScanPattern *pattern, const uint8_t *data, size_t size)
+{
+    size_t count = 0;
+    for (size_t i = 0; i + pattern->size <= size; ++i) count += matches_at(pattern, data + i);
+    return count;
+}
+
+static size_t count_pattern(const RT_ScanMatchList *matches, size_t pattern)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < matches->size; ++i) count += matches->data[i].pattern == pattern;
+    return count;
+}
+
+static bool contains(const RT_ScanMatchList *matches, uint64_t offset, size_t pattern)
+{
+    size_t lo = 0, hi = matches->size;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const RT_ScanMatch *m = &matches->data[mid];
+        if (m->offset < offset || (m->offset == offset && m->pattern < pattern)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < matches->size && matches->data[lo].offset == offset && matches->data[lo].pattern == pattern;
+}
+
+// every reported match must hold, and the planted copies of the first `count` signatures must be there
+static bool check(const RT_Scanner *scanner, size_t count, const RT_ScanMatchList *matches,
+                  const uint8_t *data, size_t size, size_t stride)
+{
+    for (size_t i = 0; i < matches->size; ++i) {
+        const RT_ScanMatch *m = &matches->data[i];
+        if (m->pattern >= count || m->offset + scanner->patterns[m->pattern].size > size) return false;
+        if (!matches_at(&scanner->patterns[m->pattern], data + m->offset)) return false;
+    }
+    for (size_t k = 0; k < SIGNATURES * PLANTS; ++k) {
+        if (k % SIGNATURES < count && !contains(matches, k * stride, k % SIGNATURES)) return false;
+    }
+    return true;
+}
+
+// scans for the first `count` signatures; only the find is timed
+static bool scan(const RT_Scanner *all, size_t count, const uint8_t *data, size_t size,
+                 RT_ScanMatchList *matches, double *elapsed)
+{
+    RT_Scanner scanner;
+    if (!rt_scanner_init(&scanner)) return false;
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_scanner_add(&scanner, signatures[i]) == i;
+    matches->size = 0;
+    const double start = bench_now_ns();
+    ok = ok && rt_scanner_find(&scanner, data, size, 0, matches);
+    *elapsed = bench_now_ns() - start;
+    ok = ok && check(all, count, matches, data, size, size / (SIGNATURES * PLANTS));
+    rt_scanner_free(&scanner);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t mib = bench_arg(argc, argv, 1, DEFAULT_MIB);
+    if (mib == 0) {
+        fprintf(stderr, "usage: %s [MiB]\n", argv[0]);
+        return 2;
+    }
+
+    const size_t size = mib << 20;
+    const size_t stride = size / (SIGNATURES * PLANTS);
+    uint8_t *data = malloc(size);
+    RT_Scanner all = {0}, single = {0};
+    bool ok = data && rt_scanner_init(&all);
+    for (size_t i = 0; i < SIGNATURES && ok; ++i) ok = rt_scanner_add(&all, signatures[i]) == i;
+    if (ok) {
+        bench_fill(data, size);
+        for (size_t k = 0; k < SIGNATURES * PLANTS; ++k) {
+            const RT_ScanPattern *pattern = &all.patterns[k % SIGNATURES];
+            for (size_t j = 0; j < pattern->size; ++j) {
+                data[k * stride + j] = (data[k * stride + j] & ~pattern->mask[j]) | pattern->bytes[j];
+            }
+        }
+    }
+
+    RT_ScanMatchList matches = {0};
+    printf("%zu MiB, %d copies of each signature\n", mib, PLANTS);
+
+    // one fixed signature
+    const RT_ScanPattern *fixed = &all.patterns[0];
+    double start = bench_now_ns();
+    const size_t expected = ok ? count_memmem(data, size, fixed->bytes, fixed->size) : 0;
+    const double memmem_ns = bench_now_ns() - start;
+    double elapsed;
+    ok = ok && scan(&all, 1, data, size, &matches, &elapsed);
+    ok = ok && matches.size == expected;
+    if (ok) printf("%-24s %6.2f GB/s  memchr + memcmp %6.2f GB/s\n", "1 fixed signature", size / elapsed, size / memmem_ns);
+
+    // one wildcard signature, alone in its scanner
+    ok = ok && rt_scanner_init(&single);
+    ok = ok && rt_scanner_add(&single, signatures[1]) == 0;
+    start = bench_now_ns();
+    const size_t naive = ok ? count_naive(&single.patterns[0], data, size) : 0;
+    const double naive_ns = bench_now_ns() - start;
+    matches.size = 0;
+    start = bench_now_ns();
+    ok = ok && rt_scanner_find(&single, data, size, 0, &matches);
+    elapsed = bench_now_ns() - start;
+    ok = ok && matches.size == naive && naive >= PLANTS;
+    if (ok) printf("%-24s %6.2f GB/s  masked loop     %6.2f GB/s\n", "1 wildcard signature", size / elapsed, size / naive_ns);
+
+    for (size_t count = 2; count <= SIGNATURES && ok; count *= 2) {
+        ok = scan(&all, count, data, size, &matches, &elapsed);
+        if (ok) printf("%2zu signatures            %6.2f GB/s  %zu matches\n", count, size / elapsed, matches.size);
+    }
+
+    ok = ok && bench_write_file(PATH, data, size);
+    matches.size = 0;
+    start = bench_now_ns();
+    ok = ok && rt_file_scan(PATH, &all, &matches);
+    elapsed = bench_now_ns() - start;
+    ok = ok && count_pattern(&matches, 0) == expected && check(&all, SIGNATURES, &matches, data, size, stride);
+    if (ok) printf("%-24s %6.2f GB/s  all %zu, file in page cache\n", "rt_file_scan", size / elapsed, SIGNATURES);
+
+    remove(PATH);
+    RT_ScanMatchList_free(&matches);
+    rt_scanner_free(&single);
+    rt_scanner_free(&all);
+    free(data);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include "bench.h"
+
+/* rt_array_find, count, min and max over 1, 2, 4 and 8-byte elements against
+ * the callback path (rt_array_find_if with a compare callback), N MiB of
+ * data per width, 256 unless given on the command line. The key is absent
+ * so every pass scans the whole array. Prints GB/s; the callback column
+ * runs the same scan one indirect call per element. */
+
+#define DEFAULT_MIB 256
+#define REPEAT 3
+
+typedef struct {
+    const void *key;
+    size_t width;
+    size_t seen;
+    uint64_t max;
+} Scan;
+
+static bool match_key(const void *elem, void *user_data)
+{
+    Scan *scan = user_data;
+    scan->seen++;
+    return memcmp(elem, scan->key, scan->width) == 0;
+}
+
+static bool track_max(const void *elem, void *user_data)
+{
+    Scan *scan = user_data;
+    uint64_t value = 0;
+    memcpy(&value, elem, scan->width);
+    if (value > scan->max) scan->max = value;
+    return false;
+}
+
+static double gbps(size_t bytes, double ns)
+{
+    return (double)bytes * REPEAT / ns;
+}
+
+static bool bench_width(RT_Array *arr, size_t width, RT_ElemType type)
+{
+    arr->elem_size = width;
+    arr->size = arr->capacity / width;
+    const size_t bytes = arr->size * width;
+
+    // values below the top bit of each lane, the key sets it
+    uint8_t *data = arr->data;
+    for (size_t i = width - 1; i < bytes; i += width) data[i] &= 0x7F;
+    uint64_t key = (uint64_t)0x80 << (8 * (width - 1));
+
+    bool ok = true;
+    double start = bench_now_ns();
+    for (int r = 0; r < REPEAT; ++r) ok = ok && rt_array_find(arr, &key) == RT_NPOS;
+    const double find = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (int r = 0; r < REPEAT; ++r) ok = ok && rt_array_count(arr, &key) == 0;
+    const double count = bench_now_ns() - start;
+
+    Scan scan = { &key, width, 0, 0 };
+    start = bench_now_ns();
+    for (int r = 0; r < REPEAT; ++r) rt_array_find_if(arr, &scan, match_key);
+    const double callback_find = bench_now_ns() - start;
+    ok = ok && scan.seen == arr->size * REPEAT;
+
+    // max is unsigned here, the callback tracks it the same way
+    uint64_t max = 0;
+    start = bench_now_ns();
+    for (int r = 0; r < REPEAT; ++r) ok = ok && rt_array_max(arr, type, &max);
+    const double simd_max = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (int r = 0; r < REPEAT; ++r) rt_array_find_if(arr, &scan, track_max);
+    const double callback_max = bench_now_ns() - start;
+    ok = ok && max == scan.max;
+
+    if (!ok) return false;
+    printf("%zu-byte  find %6.2f  count %6.2f  callback %6.2f   max %6.2f  callback %6.2f GB/s\n",
+           width, gbps(bytes, find), gbps(bytes, count), gbps(bytes, callback_find),
+           gbps(bytes, simd_max), gbps(bytes, callback_max));
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t mib = bench_arg(argc, argv, 1, DEFAULT_MIB);
+    if (mib == 0) {
+        fprintf(stderr, "usage: %s [MiB]\n", argv[0]);
+        return 2;
+    }
+
+    RT_Array arr = {0};
+    if (!rt_array_init(&arr, mib << 20, 1)) return 1;
+    bench_fill(arr.data, arr.capacity);
+
+    static const struct {
+        size_t width;
+        RT_ElemType type;
+    } widths[] = {
+        { 1, RT_ELEM_U8 }, { 2, RT_ELEM_U16 }, { 4, RT_ELEM_U32 }, { 8, RT_ELEM_U64 },
+    };
+
+    printf("%zu MiB per pass, mean of %d passes\n", mib, REPEAT);
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]) && ok; ++i) {
+        ok = bench_width(&arr, widths[i].width, widths[i].type);
+    }
+    rt_array_free(&arr);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include "bench.h"
+
+/* Churn at N live 16-byte elements, 1M unless given on the command line:
+ * every operation removes a random live element and inserts a new one.
+ * RT_SlotMap removes through the handle; RT_Array removes with rt_array_del
+ * at a known index, its best case, and shifts the tail down. The array
+ * costs O(N) per removal, so it runs ARRAY_SAMPLES operations instead of N.
+ * A dense pass over all elements follows each churn. */
+
+#define DEFAULT_COUNT 1000000
+#define ARRAY_SAMPLES 2000
+
+typedef struct {
+    uint64_t id;
+    uint64_t value;
+} Entity;
+
+static uint64_t dense_sum(const Entity *data, size_t count)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) sum += data[i].value;
+    return sum;
+}
+
+static bool bench_slotmap(size_t count)
+{
+    RT_SlotMap map;
+    RT_SlotHandle *handles = malloc(count * sizeof(RT_SlotHandle));
+    if (!handles) return false;
+    if (!rt_slotmap_init(&map, count, sizeof(Entity))) {
+        free(handles);
+        return false;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; ++i) {
+        const Entity e = { i, i };
+        handles[i] = rt_slotmap_insert(&map, &e);
+        ok = handles[i] != RT_SLOT_HANDLE_NULL;
+    }
+
+    double start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) {
+        const size_t victim = bench_next() % count;
+        const Entity e = { count + i, i };
+        ok = rt_slotmap_remove(&map, handles[victim], NULL);
+        handles[victim] = rt_slotmap_insert(&map, &e);
+        ok = ok && handles[victim] != RT_SLOT_HANDLE_NULL;
+    }
+    const double churn = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    const uint64_t sum = dense_sum(map.data, map.size);
+    const double pass = bench_now_ns() - start;
+    ok = ok && map.size == count;
+
+    if (ok) {
+        printf("RT_SlotMap  %10.1f ns/op  pass %7.2f ms  (%zu ops, sum %llu)\n",
+               churn / count, pass / 1e6, count, (unsigned long long)sum);
+    }
+    rt_slotmap_free(&map);
+    free(handles);
+    return ok;
+}
+
+static bool bench_array(size_t count)
+{
+    RT_Array arr = {0};
+    if (!rt_array_init(&arr, count, sizeof(Entity))) return false;
+
+    bool ok = true;
+    for (size_t i = 0; i < count && ok; ++i) {
+        const Entity e = { i, i };
+        ok = rt_array_push(&arr, &e);
+    }
+
+    const size_t samples = count < ARRAY_SAMPLES ? count : ARRAY_SAMPLES;
+    double start = bench_now_ns();
+    for (size_t i = 0; i < samples && ok; ++i) {
+        const Entity e = { count + i, i };
+        ok = rt_array_del(&arr, bench_next() % count) && rt_array_push(&arr, &e);
+    }
+    const double churn = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    const uint64_t sum = dense_sum(arr.data, arr.size);
+    const double pass = bench_now_ns() - start;
+    ok = ok && arr.size == count;
+
+    if (ok) {
+        printf("rt_array_del %9.1f ns/op  pass %7.2f ms  (%zu sampled ops, sum %llu)\n",
+               churn / samples, pass / 1e6, samples, (unsigned long long)sum);
+    }
+    rt_array_free(&arr);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0 || count > UINT32_MAX) {
+        fprintf(stderr, "usage: %s [live elements]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%zu live %zu-byte elements, one remove + insert per op\n", count, sizeof(Entity));
+    const bool ok = bench_slotmap(count) && bench_array(count);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include "bench.h"
+
+/* Sequential read throughput of a file larger than the page cache: N MiB,
+ * physical memory plus 1 GiB unless given on the command line, so no pass
+ * finds the file cached. A plain fread loop against RT_FileReader with the
+ * system cache and with RT_FREADER_UNBUFFERED, all in 1 MiB chunks and all
+ * summing every 8-byte word so there is work to overlap with the I/O.
+ * Needs that much free disk space next to the binary. */
+
+#define CHUNK 0x100000
+#define PATH "stream_bench.bin"
+
+static uint64_t sum_words(const uint8_t *data, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        sum += word;
+    }
+    return sum;
+}
+
+static bool write_file(size_t mib)
+{
+    uint8_t *chunk = malloc(CHUNK);
+    RT_FileWriter writer;
+    if (!chunk || !rt_fwriter_open(&writer, PATH, 0, 0)) {
+        free(chunk);
+        return false;
+    }
+    bench_fill(chunk, CHUNK);
+    bool ok = true;
+    for (size_t i = 0; i < mib && ok; ++i) {
+        memcpy(chunk, &i, sizeof(i));
+        ok = rt_fwriter_write(&writer, chunk, CHUNK);
+    }
+    ok = rt_fwriter_close(&writer) && ok;
+    free(chunk);
+    return ok;
+}
+
+static bool pass_fread(uint64_t *sum, uint64_t *bytes)
+{
+    uint8_t *chunk = malloc(CHUNK);
+    FILE *f = fopen(PATH, "rb");
+    if (!chunk || !f) {
+        free(chunk);
+        if (f) fclose(f);
+        return false;
+    }
+    size_t got;
+    while ((got = fread(chunk, 1, CHUNK, f)) > 0) {
+        *sum += sum_words(chunk, got);
+        *bytes += got;
+    }
+    const bool ok = !ferror(f);
+    fclose(f);
+    free(chunk);
+    return ok;
+}
+
+static bool pass_freader(int flags, uint64_t *sum, uint64_t *bytes)
+{
+    RT_FileReader reader;
+    if (!rt_freader_open(&reader, PATH, CHUNK, 0, flags)) return false;
+    RT_FileChunk chunk;
+    while (rt_freader_next(&reader, &chunk)) {
+        *sum += sum_words(chunk.data, chunk.size);
+        *bytes += chunk.size;
+    }
+    const bool ok = !rt_freader_failed(&reader);
+    rt_freader_close(&reader);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    MEMORYSTATUSEX memory = { .dwLength = sizeof(memory) };
+    const size_t ram_mib = GlobalMemoryStatusEx(&memory) ? (size_t)(memory.ullTotalPhys >> 20) : 0;
+    const size_t mib = bench_arg(argc, argv, 1, ram_mib + 1024);
+    if (mib == 0) {
+        fprintf(stderr, "usage: %s [MiB]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%zu MiB file, %zu MiB of physical memory\n", mib, ram_mib);
+    bool ok = write_file(mib);
+    uint64_t sums[3] = {0};
+    for (int variant = 0; variant < 3 && ok; ++variant) {
+        uint64_t bytes = 0;
+        const double start = bench_now_ns();
+        switch (variant) {
+        case 0: ok = pass_fread(&sums[variant], &bytes); break;
+        case 1: ok = pass_freader(0, &sums[variant], &bytes); break;
+        case 2: ok = pass_freader(RT_FREADER_UNBUFFERED, &sums[variant], &bytes); break;
+        }
+        const double elapsed = bench_now_ns() - start;
+        ok = ok && bytes == (uint64_t)mib * CHUNK && sums[variant] == sums[0];
+
+        static const char *const names[] = { "fread", "RT_FileReader", "unbuffered" };
+        if (ok) printf("%-14s %8.1f MB/s\n", names[variant], (double)bytes / 1e6 / (elapsed / 1e9));
+    }
+    remove(PATH);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
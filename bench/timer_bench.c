@@ -0,0 +1,141 @@
+#include "bench.h"
+
+/* N timers, 1M unless given on the command line. Throughput: schedule all
+ * with random delays from one second to a day, so every wheel level is
+ * used, then cancel them in random order; an RT_IndexedHeap keyed by the
+ * deadline, the usual alternative, does the same push/remove. Jitter: a
+ * started 1 ms wheel fires all N one-shot timers spread over SPREAD_MS and
+ * every callback records how late it ran against its exact deadline. */
+
+#define DEFAULT_COUNT 1000000
+#define MIN_DELAY_MS 1000 // leaves time to schedule everything before the first one is due
+#define SPREAD_MS 3000
+#define DAY_MS (24ull * 3600 * 1000)
+
+typedef struct {
+    double deadline_ns;
+    double fired_ns;
+} Shot;
+
+static void record(void *user_data)
+{
+    ((Shot*)user_data)->fired_ns = bench_now_ns();
+}
+
+static void nothing(void *user_data)
+{
+    (void)user_data;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    const double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void shuffle(RT_SlotHandle *handles, size_t count)
+{
+    for (size_t i = count - 1; i > 0; --i) {
+        const size_t j = bench_next() % (i + 1);
+        const RT_SlotHandle t = handles[i];
+        handles[i] = handles[j];
+        handles[j] = t;
+    }
+}
+
+static bool bench_throughput(size_t count, RT_SlotHandle *handles, uint64_t *delays)
+{
+    for (size_t i = 0; i < count; ++i) delays[i] = MIN_DELAY_MS + bench_next() % DAY_MS;
+
+    RT_TimerWheel wheel;
+    if (!rt_timer_wheel_init(&wheel, 1)) return false;
+    bool ok = true;
+    double start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) {
+        handles[i] = rt_timer_schedule(&wheel, delays[i], 0, nothing, NULL);
+        ok = handles[i] != RT_SLOT_HANDLE_NULL;
+    }
+    const double wheel_schedule = bench_now_ns() - start;
+    shuffle(handles, count);
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_timer_cancel(&wheel, handles[i]);
+    const double wheel_cancel = bench_now_ns() - start;
+    ok = ok && rt_timer_wheel_size(&wheel) == 0;
+    rt_timer_wheel_free(&wheel);
+
+    RT_IndexedHeap heap = {0};
+    if (!ok || !rt_iheap_init(&heap, sizeof(uint64_t), compare_u64)) return false;
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) {
+        const uint64_t deadline = rt_timer_now_ms() + delays[i];
+        handles[i] = rt_iheap_push(&heap, &deadline);
+        ok = handles[i] != RT_SLOT_HANDLE_NULL;
+    }
+    const double heap_schedule = bench_now_ns() - start;
+    shuffle(handles, count);
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_iheap_remove(&heap, handles[i], NULL);
+    const double heap_cancel = bench_now_ns() - start;
+    rt_iheap_free(&heap);
+
+    if (ok) {
+        printf("%-14s schedule %6.1f ns  cancel %6.1f ns\n", "timer wheel", wheel_schedule / count, wheel_cancel / count);
+        printf("%-14s schedule %6.1f ns  cancel %6.1f ns\n", "indexed heap", heap_schedule / count, heap_cancel / count);
+    }
+    return ok;
+}
+
+static bool bench_jitter(size_t count, Shot *shots, double *lateness)
+{
+    RT_TimerWheel wheel;
+    if (!rt_timer_wheel_init(&wheel, 1)) return false;
+    bool ok = rt_timer_wheel_start(&wheel);
+
+    const double start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) {
+        const uint64_t delay = MIN_DELAY_MS + bench_next() % SPREAD_MS;
+        shots[i] = (Shot){ bench_now_ns() + (double)delay * 1e6, 0 };
+        ok = rt_timer_schedule(&wheel, delay, 0, record, &shots[i]) != RT_SLOT_HANDLE_NULL;
+    }
+    const double scheduled = bench_now_ns() - start;
+    while (ok && rt_timer_wheel_size(&wheel) > 0) Sleep(10);
+    rt_timer_wheel_free(&wheel);
+    if (!ok) return false;
+
+    for (size_t i = 0; i < count; ++i) lateness[i] = (shots[i].fired_ns - shots[i].deadline_ns) / 1e6;
+    qsort(lateness, count, sizeof(double), compare_double);
+    printf("expiry of %zu timers over %d ms (scheduled in %.0f ms), lateness in ms:\n", count, SPREAD_MS, scheduled / 1e6);
+    printf("  min %6.3f  p50 %6.3f  p99 %6.3f  p99.9 %6.3f  max %6.3f\n", lateness[0], lateness[count / 2],
+           lateness[count / 100 * 99], lateness[count / 1000 * 999], lateness[count - 1]);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0 || count > UINT32_MAX / 2) {
+        fprintf(stderr, "usage: %s [timers]\n", argv[0]);
+        return 2;
+    }
+
+    RT_SlotHandle *handles = malloc(count * sizeof(RT_SlotHandle));
+    uint64_t *delays = malloc(count * sizeof(uint64_t));
+    Shot *shots = malloc(count * sizeof(Shot));
+    double *lateness = malloc(count * sizeof(double));
+    bool ok = handles && delays && shots && lateness;
+
+    printf("%zu timers\n", count);
+    ok = ok && bench_throughput(count, handles, delays) && bench_jitter(count, shots, lateness);
+    free(handles);
+    free(delays);
+    free(shots);
+    free(lateness);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+#include "bench.h"
+
+/* The rt_typed.h containers against the void* ones they mirror, N uint32_t
+ * elements (10M unless given on the command line): darray push, get and pop,
+ * ring buffer write/read, and list push_back/pop_front. Prints ns per
+ * operation for both and the gain of the typed version. */
+
+#define DEFAULT_COUNT 10000000
+#define RING 4096
+
+RT_DEFINE_DARRAY(bench_darray_u32, uint32_t)
+RT_DEFINE_RBUFFER(bench_rbuffer_u32, uint32_t)
+RT_DEFINE_LIST(bench_list_u32, uint32_t)
+
+static uint32_t sink;
+
+static void report(const char *op, double generic, double typed, size_t count)
+{
+    printf("%-18s %8.2f ns %8.2f ns %6.2fx\n", op, generic / count, typed / count, generic / typed);
+}
+
+static bool bench_darray(size_t count)
+{
+    RT_DynamicArray arr;
+    bench_darray_u32 typed = {0};
+    if (!rt_darray_init(&arr, sizeof(uint32_t))) return false;
+    if (!bench_darray_u32_init(&typed)) {
+        rt_darray_free(&arr);
+        return false;
+    }
+
+    bool ok = true;
+    double start = bench_now_ns();
+    for (uint32_t i = 0; i < count && ok; ++i) ok = rt_darray_push(&arr, &i);
+    double generic = bench_now_ns() - start;
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < count && ok; ++i) ok = bench_darray_u32_push(&typed, i);
+    report("darray push", generic, bench_now_ns() - start, count);
+
+    uint32_t value, sum = 0;
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) {
+        ok = rt_darray_get(&arr, i, &value);
+        sum += value;
+    }
+    generic = bench_now_ns() - start;
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) {
+        ok = bench_darray_u32_get(&typed, i, &value);
+        sum -= value;
+    }
+    report("darray get", generic, bench_now_ns() - start, count);
+    ok = ok && sum == 0;
+
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_darray_pop(&arr, &value);
+    generic = bench_now_ns() - start;
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = bench_darray_u32_pop(&typed, &value);
+    report("darray pop", generic, bench_now_ns() - start, count);
+
+    rt_darray_free(&arr);
+    bench_darray_u32_free(&typed);
+    return ok;
+}
+
+static bool bench_rbuffer(size_t count)
+{
+    RT_RingBuffer buffer;
+    bench_rbuffer_u32 typed = {0};
+    if (!rt_rbuffer_init(&buffer, RING, sizeof(uint32_t))) return false;
+    if (!bench_rbuffer_u32_init(&typed, RING)) {
+        rt_rbuffer_free(&buffer);
+        return false;
+    }
+
+    // keep the buffers half full, one write and one read per element
+    bool ok = true;
+    uint32_t value;
+    for (uint32_t i = 0; i < RING / 2 && ok; ++i) {
+        ok = rt_rbuffer_write(&buffer, &i) && bench_rbuffer_u32_write(&typed, i);
+    }
+
+    double start = bench_now_ns();
+    for (uint32_t i = 0; i < count && ok; ++i) ok = rt_rbuffer_write(&buffer, &i) && rt_rbuffer_read(&buffer, &value);
+    const double generic = bench_now_ns() - start;
+    sink += value;
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < count && ok; ++i) ok = bench_rbuffer_u32_write(&typed, i) && bench_rbuffer_u32_read(&typed, &value);
+    report("rbuffer write+read", generic, bench_now_ns() - start, count);
+    sink += value;
+
+    rt_rbuffer_free(&buffer);
+    bench_rbuffer_u32_free(&typed);
+    return ok;
+}
+
+static bool bench_list(size_t count)
+{
+    RT_List list;
+    bench_list_u32 typed;
+    rt_list_init(&list, sizeof(uint32_t));
+    bench_list_u32_init(&typed);
+
+    bool ok = true;
+    double start = bench_now_ns();
+    for (uint32_t i = 0; i < count && ok; ++i) ok = rt_list_push_back(&list, &i);
+    double generic = bench_now_ns() - start;
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < count && ok; ++i) ok = bench_list_u32_push_back(&typed, i);
+    report("list push_back", generic, bench_now_ns() - start, count);
+
+    uint32_t value;
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = rt_list_pop_front(&list, &value);
+    generic = bench_now_ns() - start;
+    start = bench_now_ns();
+    for (size_t i = 0; i < count && ok; ++i) ok = bench_list_u32_pop_front(&typed, &value);
+    report("list pop_front", generic, bench_now_ns() - start, count);
+
+    rt_list_free(&list);
+    bench_list_u32_free(&typed);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t count = bench_arg(argc, argv, 1, DEFAULT_COUNT);
+    if (count == 0 || count > UINT32_MAX) {
+        fprintf(stderr, "usage: %s [elements]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%zu uint32_t elements\n%-18s %11s %11s %7s\n", count, "operation", "void*", "typed", "gain");
+    const bool ok = bench_darray(count) && bench_rbuffer(count) && bench_list(count);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
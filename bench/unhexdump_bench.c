@@ -0,0 +1,92 @@
+#include "bench.h"
+
+/* Hex dump parsing throughput: N MiB of random bytes, 256 unless given on
+ * the command line, are formatted once, then parsed back by a sscanf loop
+ * over the lines, by rt_hexdump_parse in memory and by rt_file_unhexdump
+ * from a file. Every result must equal the input. Rates are given in text
+ * read and bytes produced per second. */
+
+#define DEFAULT_MIB 256
+#define PATH "unhexdump_bench.txt"
+
+static size_t parse_sscanf(uint8_t *out, const char *text, size_t length)
+{
+    size_t written = 0;
+    const char *end = text + length;
+    for (const char *line = text; line < end;) {
+        const char *next = memchr(line, '\n', (size_t)(end - line));
+        next = next ? next + 1 : end;
+
+        // sscanf may measure its whole input, so hand it one line at a time
+        char copy[RT_HEXDUMP_LINE_MAX + 1];
+        const size_t len = (size_t)(next - line) < sizeof(copy) - 1 ? (size_t)(next - line) : sizeof(copy) - 1;
+        memcpy(copy, line, len);
+        copy[len] = '\0';
+
+        const char *hex = strchr(copy, '|');
+        if (!hex) return 0;
+        hex += 2;
+        unsigned value;
+        int used;
+        while (*hex != '|' && sscanf(hex, "%2x%n", &value, &used) == 1) {
+            out[written++] = (uint8_t)value;
+            hex += used + 1;
+        }
+        line = next;
+    }
+    return written;
+}
+
+static void report(const char *name, size_t text, size_t bytes, double ns)
+{
+    printf("%-18s %7.1f MB/s text %7.1f MB/s bytes\n", name, text / 1e6 / (ns / 1e9), bytes / 1e6 / (ns / 1e9));
+}
+
+int main(int argc, char **argv)
+{
+    const size_t mib = bench_arg(argc, argv, 1, DEFAULT_MIB);
+    if (mib == 0) {
+        fprintf(stderr, "usage: %s [MiB]\n", argv[0]);
+        return 2;
+    }
+
+    const size_t size = mib << 20;
+    uint8_t *data = malloc(size);
+    uint8_t *parsed = malloc(size + RT_HEXDUMP_ROW);
+    char *text = malloc(rt_hexdump_bound(size));
+    bool ok = data && parsed && text;
+    if (ok) bench_fill(data, size);
+    const size_t length = ok ? rt_hexdump_format(text, data, size, 0) : 0;
+
+    double start = bench_now_ns();
+    ok = ok && parse_sscanf(parsed, text, length) == size && memcmp(parsed, data, size) == 0;
+    const double naive = bench_now_ns() - start;
+
+    RT_HexdumpParse state = {0};
+    memset(parsed, 0, size);
+    start = bench_now_ns();
+    ok = ok && rt_hexdump_parse(&state, parsed, size + RT_HEXDUMP_ROW, text, length);
+    const double parse = bench_now_ns() - start;
+    ok = ok && state.written == size && memcmp(parsed, data, size) == 0;
+
+    RT_FileBuffer buffer = {0};
+    ok = ok && bench_write_file(PATH, text, length);
+    start = bench_now_ns();
+    ok = ok && rt_file_unhexdump(PATH, &buffer);
+    const double file = bench_now_ns() - start;
+    ok = ok && buffer.size == size && memcmp(buffer.data, data, size) == 0;
+
+    if (ok) {
+        printf("%.1f MiB of text for %zu MiB\n", bench_mb(length), mib);
+        report("sscanf per byte", length, size, naive);
+        report("rt_hexdump_parse", length, size, parse);
+        report("rt_file_unhexdump", length, size, file);
+    }
+    rt_fbuffer_free(&buffer);
+    remove(PATH);
+    free(data);
+    free(parsed);
+    free(text);
+    if (!ok) fprintf(stderr, "benchmark failed\n");
+    return ok ? 0 : 1;
+}
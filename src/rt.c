@@ -1,3 +1,5 @@
+#include <stdarg.h>
+
 #include "rt.h"
 
 void rt_print_delim()
@@ -78,61 +80,424 @@ bool rt_file_read(const char *path, RT_FileBuffer *buffer)
     return rt_fbuffer_read_file(buffer, path);
 }
 
+bool rt_file_map(const char *path, RT_FileBuffer *buffer, int flags)
+{
+    return rt_fbuffer_map_file(buffer, path, flags);
+}
+
 bool rt_file_write(const char *path, RT_FileBuffer *buffer)
 {
     return rt_fbuffer_write_file(buffer, path);
 }
 
+typedef struct _RT__HexdumpTask {
+    const uint8_t *data;
+    size_t size;
+    uint64_t offset;
+    char *out;
+    size_t length;
+} RT__HexdumpTask;
+
+static DWORD rt__hexdump_worker(void *param)
+{
+    RT__HexdumpTask *task = param;
+    task->length = rt_hexdump_format(task->out, task->data, task->size, task->offset);
+    return 0;
+}
+
 size_t rt_file_hexdump(const char *path_in, const char *path_out)
 {
     if (!path_in) return 0;
     const char *out = path_out ? path_out : "dump";
-    const int bytes_per_row = 16;
-    char line[256] = {0};
-    char *line_ptr = line;
-
-    RT_FileBuffer fb = {0};
-    rt_fbuffer_reserve(&fb, 0x100000); // try to reserve 1mb of space
 
-    FILE *fdump = fopen(out, "wb");
-    if (!fdump) return 0;
+    RT_FileReader reader;
+    if (!rt_freader_open(&reader, path_in, RT_HEXDUMP_CHUNK, 0, 0)) return 0;
 
-    // if failed to reserve, this function will allocate space anyway
-    if (rt_fbuffer_read_file(&fb, path_in) == 0) return 0; // if failed, well, then RIP
+    size_t workers = rt_thread_cpu_count();
+    if (workers > RT_THREAD_MAX_TASKS) workers = RT_THREAD_MAX_TASKS;
+    if (workers > RT_HEXDUMP_CHUNK / RT_HEXDUMP_TASK_MIN) workers = RT_HEXDUMP_CHUNK / RT_HEXDUMP_TASK_MIN;
+    if (workers == 0) workers = 1;
 
+    RT_FileWriter writer = {0};
+    RT__HexdumpTask *tasks = RT_MALLOC(workers * sizeof(RT__HexdumpTask));
+    char *text = RT_MALLOC(rt_hexdump_bound(RT_HEXDUMP_CHUNK));
+    bool ok = tasks && text && rt_fwriter_open(&writer, out, 0, 0);
     size_t dc = 0; // dumped bytes counter
-    for (size_t i = 0; i < fb.size; i += bytes_per_row) {
-        line_ptr += sprintf(line_ptr, "%08zx | ", i);
 
-        int bytes_printed = 0; // printed bytes counter (in this row)
-        for (int j = 0; j < bytes_per_row && i+j < fb.size; ++j, ++dc) { // hex
-            line_ptr += sprintf(line_ptr, "%02X ", fb.data[i + j]);
-            bytes_printed++;
+    // rows are independent: every round splits a chunk into row-aligned
+    // pieces, formats them side by side and writes them out in order
+    RT_FileChunk chunk;
+    while (ok && rt_freader_next(&reader, &chunk)) {
+        const size_t rows = (chunk.size + RT_HEXDUMP_ROW - 1) / RT_HEXDUMP_ROW;
+        size_t count = chunk.size / RT_HEXDUMP_TASK_MIN;
+        if (count > workers) count = workers;
+        if (count == 0) count = 1;
+
+        for (size_t t = 0, row = 0; t < count; ++t) {
+            const size_t end = rows * (t + 1) / count;
+            const size_t from = row * RT_HEXDUMP_ROW;
+            const size_t to = end * RT_HEXDUMP_ROW < chunk.size ? end * RT_HEXDUMP_ROW : chunk.size;
+            tasks[t].data = chunk.data + from;
+            tasks[t].size = to - from;
+            tasks[t].offset = chunk.offset + from;
+            tasks[t].out = text + row * RT_HEXDUMP_LINE_MAX;
+            row = end;
+        }
+
+        if (count == 1) rt__hexdump_worker(tasks);
+        else rt_thread_run_tasks(tasks, sizeof(RT__HexdumpTask), count, rt__hexdump_worker);
+
+        for (size_t t = 0; t < count && ok; ++t) ok = rt_fwriter_write(&writer, tasks[t].out, tasks[t].length);
+        dc += chunk.size;
+    }
+    if (rt_freader_failed(&reader)) ok = false;
+
+    if (writer.buffer && !rt_fwriter_close(&writer)) ok = false;
+    rt_freader_close(&reader);
+    RT_FREE(tasks);
+    RT_FREE(text);
+    return ok ? dc : 0;
+}
+
+typedef struct _RT__UnhexdumpTask {
+    const char *text;
+    size_t length;
+    uint64_t start;
+    uint8_t *out;
+    size_t capacity;
+    RT_HexdumpParse state;
+    bool ok;
+} RT__UnhexdumpTask;
+
+static DWORD rt__unhexdump_worker(void *param)
+{
+    RT__UnhexdumpTask *task = param;
+    task->ok = rt_hexdump_parse(&task->state, task->out, task->capacity, task->text, task->length) &&
+               task->state.consumed == task->length;
+    return 0;
+}
+
+// parses whole lines into the buffer at the offsets they name, the buffer
+// size following state->offset
+static bool rt__unhexdump_text(RT_FileBuffer *buffer, RT_HexdumpParse *state,
+                               RT__UnhexdumpTask *tasks, size_t workers, const char *text, size_t length)
+{
+    if (length == 0) return true;
+
+    size_t count = length / RT_HEXDUMP_TASK_MIN;
+    if (count > workers) count = workers;
+    if (count == 0) count = 1;
+
+    // cut after newlines; a piece whose first line names no offset (blank or
+    // malformed) stays with the previous one, which then reports it
+    size_t pieces = 0;
+    for (size_t t = 0, from = 0; t < count && from < length; ++t) {
+        size_t to = length;
+        if (t + 1 < count && length * (t + 1) / count > from) {
+            const size_t cut = length * (t + 1) / count;
+            const char *eol = memchr(text + cut, '\n', length - cut);
+            to = eol ? (size_t)(eol - text) + 1 : length;
         }
 
-        int padding = bytes_per_row - bytes_printed; // padding to fill space
-        if (padding > 0) {
-            int spaces = padding * 3;
-            memset(line_ptr, ' ', spaces);
-            line_ptr += spaces;
+        uint64_t start = state->offset;
+        if (pieces > 0) {
+            if (!rt_hexdump_line_offset(text + from, to - from, &start)) {
+                tasks[pieces - 1].length += to - from;
+                from = to;
+                continue;
+            }
+        }
+        tasks[pieces].text = text + from;
+        tasks[pieces].length = to - from;
+        tasks[pieces].start = start;
+        pieces++;
+        from = to;
+    }
+
+    // every piece lands where its offsets say; a piece cannot hold more than
+    // its text allows, which also keeps a bogus offset from growing the buffer
+    for (size_t t = 1; t < pieces; ++t) {
+        if (tasks[t].start < tasks[t - 1].start ||
+            tasks[t].start - tasks[t - 1].start > rt_hexdump_parse_bound(tasks[t - 1].length)) return false;
+    }
+    const uint64_t end = tasks[pieces - 1].start + rt_hexdump_parse_bound(tasks[pieces - 1].length);
+    if (end > SIZE_MAX || !rt_fbuffer_reserve(buffer, (size_t)end)) return false;
+
+    for (size_t t = 0; t < pieces; ++t) {
+        const uint64_t limit = t + 1 < pieces ? tasks[t + 1].start : end;
+        tasks[t].out = buffer->data + tasks[t].start;
+        tasks[t].capacity = (size_t)(limit - tasks[t].start);
+        tasks[t].state = t == 0 ? *state : (RT_HexdumpParse){ .offset = tasks[t].start };
+    }
+
+    if (pieces == 1) rt__unhexdump_worker(tasks);
+    else rt_thread_run_tasks(tasks, sizeof(RT__UnhexdumpTask), pieces, rt__unhexdump_worker);
+
+    // the pieces must join up: each one ends where the next starts, on a full row
+    for (size_t t = 0; t < pieces; ++t) {
+        if (!tasks[t].ok) return false;
+        if (t + 1 < pieces && (tasks[t].state.offset != tasks[t + 1].start || tasks[t].state.done)) return false;
+    }
+
+    *state = tasks[pieces - 1].state;
+    buffer->size = (size_t)state->offset;
+    return true;
+}
+
+bool rt_file_unhexdump(const char *path, RT_FileBuffer *buffer)
+{
+    if (!path || !buffer) return false;
+
+    RT_FileReader reader;
+    if (!rt_freader_open(&reader, path, RT_HEXDUMP_CHUNK, 0, 0)) return false;
+    rt_fbuffer_clear(buffer);
+
+    size_t workers = rt_thread_cpu_count();
+    if (workers > RT_THREAD_MAX_TASKS) workers = RT_THREAD_MAX_TASKS;
+    if (workers > RT_HEXDUMP_CHUNK / RT_HEXDUMP_TASK_MIN) workers = RT_HEXDUMP_CHUNK / RT_HEXDUMP_TASK_MIN;
+    if (workers == 0) workers = 1;
+
+    RT__UnhexdumpTask *tasks = RT_MALLOC(workers * sizeof(RT__UnhexdumpTask));
+    RT_HexdumpParse state = {0}; // the dump starts at offset 0
+    char carry[RT_HEXDUMP_LINE_MAX * 2 + 1]; // a line cut by a chunk boundary
+    size_t carried = 0;
+    bool ok = tasks != NULL;
+
+    RT_FileChunk chunk;
+    while (ok && rt_freader_next(&reader, &chunk)) {
+        const char *text = (const char*)chunk.data;
+        size_t length = chunk.size;
+
+        if (carried > 0) {
+            const char *eol = memchr(text, '\n', length);
+            const size_t take = eol ? (size_t)(eol - text) + 1 : length;
+            if (carried + take >= sizeof(carry)) {
+                ok = false;
+                break;
+            }
+            memcpy(carry + carried, text, take);
+            carried += take;
+            text += take;
+            length -= take;
+            if (!eol) continue;
+
+            ok = rt__unhexdump_text(buffer, &state, tasks, 1, carry, carried);
+            carried = 0;
         }
 
-        line_ptr += sprintf(line_ptr, "| ");
+        size_t whole = length;
+        while (whole > 0 && text[whole - 1] != '\n') whole--;
+        if (length - whole >= sizeof(carry)) ok = false;
+        if (!ok) break;
+
+        carried = length - whole;
+        memcpy(carry, text + whole, carried);
+        ok = rt__unhexdump_text(buffer, &state, tasks, workers, text, whole);
+    }
+    if (rt_freader_failed(&reader)) ok = false;
+
+    // the last line may lack its newline
+    if (ok && carried > 0) {
+        carry[carried++] = '\n';
+        ok = rt__unhexdump_text(buffer, &state, tasks, 1, carry, carried);
+    }
+
+    rt_freader_close(&reader);
+    RT_FREE(tasks);
+    if (!ok) rt_fbuffer_clear(buffer);
+    return ok;
+}
+
+bool rt_file_diff(const char *path_a, const char *path_b, RT_DiffList *list, size_t gap)
+{
+    if (!path_a || !path_b || !list) return false;
+    list->size = 0;
+
+    // mapped files are compared in place, split across all threads at once
+    RT_FileBuffer a = {0}, b = {0};
+    if (rt_fbuffer_map_file(&a, path_a, RT_FBUFFER_MAP_READ | RT_FBUFFER_MAP_SEQUENTIAL) &&
+        rt_fbuffer_map_file(&b, path_b, RT_FBUFFER_MAP_READ | RT_FBUFFER_MAP_SEQUENTIAL)) {
+        const bool ok = rt_fbuffer_diff(list, &a, &b, gap);
+        rt_fbuffer_free(&a);
+        rt_fbuffer_free(&b);
+        return ok;
+    }
+    rt_fbuffer_free(&a);
+    rt_fbuffer_free(&b);
+
+    // otherwise both are streamed in lockstep, equal chunk sizes keep the
+    // chunks at the same offsets
+    RT_FileReader reader_a, reader_b;
+    if (!rt_freader_open(&reader_a, path_a, RT_DIFF_CHUNK, 0, 0)) return false;
+    if (!rt_freader_open(&reader_b, path_b, RT_DIFF_CHUNK, 0, 0)) {
+        rt_freader_close(&reader_a);
+        return false;
+    }
 
-        for (size_t j = 0; j < bytes_per_row && i+j < fb.size; ++j) { // ascii
-            uint8_t c = fb.data[i + j];
-            line_ptr += sprintf(line_ptr, "%c", (c >= 0x20 && c <= 0x7E) ? c : '.');
+    bool ok = true;
+    RT_FileChunk chunk_a, chunk_b;
+    while (ok && rt_freader_next(&reader_a, &chunk_a) && rt_freader_next(&reader_b, &chunk_b)) {
+        if (chunk_a.offset != chunk_b.offset) {
+            ok = false;
+            break;
         }
+        const size_t common = chunk_a.size < chunk_b.size ? chunk_a.size : chunk_b.size;
+        ok = rt_diff_range(list, chunk_a.data, chunk_b.data, common, chunk_a.offset, gap);
+        if (chunk_a.size != chunk_b.size) break; // one of them ended
+    }
+    if (rt_freader_failed(&reader_a) || rt_freader_failed(&reader_b)) ok = false;
 
-        *line_ptr++ = '\n';
-        *line_ptr = '\0';
-        line_ptr = line;
-        
-        fputs(line, fdump);
+    const uint64_t size_a = rt_freader_size(&reader_a);
+    const uint64_t size_b = rt_freader_size(&reader_b);
+    const uint64_t common = size_a < size_b ? size_a : size_b;
+    if (ok) ok = rt_diff_append(list, common, (size_a < size_b ? size_b : size_a) - common, gap);
+
+    rt_freader_close(&reader_a);
+    rt_freader_close(&reader_b);
+    return ok;
+}
+
+// maps a file for reading, empty files included
+static bool rt__file_view(const char *path, RT_FileBuffer *buffer)
+{
+    if (rt_fbuffer_map_file(buffer, path, RT_FBUFFER_MAP_READ)) return true;
+    if (rt_fbuffer_read_file(buffer, path)) return true;
+
+    struct stat file_stat;
+    return stat(path, &file_stat) == 0 && file_stat.st_size == 0;
+}
+
+bool rt_file_diff_dump(const char *path_a, const char *path_b, const char *path_out, size_t gap, int format)
+{
+    const char *out = path_out ? path_out : "diff";
+
+    RT_DiffList list = {0};
+    RT_FileBuffer a = {0}, b = {0};
+    RT_FileWriter writer = {0};
+    bool ok = rt_file_diff(path_a, path_b, &list, gap);
+
+    // the hexdump shows the bytes themselves, so it needs both files at hand
+    if (ok && format == RT_DIFF_HEXDUMP && list.size > 0) {
+        ok = rt__file_view(path_a, &a) && rt__file_view(path_b, &b);
+    }
+
+    if (ok) ok = rt_fwriter_open(&writer, out, 0, 0);
+    if (ok) {
+        ok = format == RT_DIFF_HEXDUMP
+            ? rt_diff_write_hexdump(&writer, &list, a.data, a.size, b.data, b.size)
+            : rt_diff_write_ranges(&writer, &list);
+    }
+
+    if (writer.buffer && !rt_fwriter_close(&writer)) ok = false;
+    rt_fbuffer_free(&a);
+    rt_fbuffer_free(&b);
+    RT_DiffList_free(&list);
+    return ok;
+}
+
+bool rt_file_scan(const char *path, const RT_Scanner *scanner, RT_ScanMatchList *matches)
+{
+    if (!path || !scanner || !matches) return false;
+    if (scanner->count == 0) return true;
+
+    RT_FileBuffer view = {0};
+    if (rt_fbuffer_map_file(&view, path, RT_FBUFFER_MAP_READ | RT_FBUFFER_MAP_SEQUENTIAL)) {
+        const bool ok = rt_fbuffer_scan(scanner, &view, matches);
+        rt_fbuffer_free(&view);
+        return ok;
+    }
+
+    RT_FileReader reader;
+    if (!rt_freader_open(&reader, path, RT_SCAN_CHUNK, 0, 0)) return false;
+
+    // a chunk reports the matches starting before its last `keep` bytes;
+    // those bytes and the head of the next chunk are scanned together, so
+    // matches across the seam are found without copying whole chunks
+    const size_t keep = scanner->max_size - 1;
+    uint8_t *seam = RT_MALLOC(keep * 2 + 1);
+    size_t tail = 0;       // bytes of the previous chunk held in `seam`
+    uint64_t tail_at = 0;  // their file offset
+    bool ok = seam != NULL;
+
+    RT_FileChunk chunk;
+    while (ok && rt_freader_next(&reader, &chunk)) {
+        if (tail > 0) {
+            const size_t head = chunk.size < keep ? chunk.size : keep;
+            memcpy(seam + tail, chunk.data, head);
+            ok = rt_scanner_find_range(scanner, seam, tail + head, 0, tail, tail_at, matches);
+        }
+
+        const size_t held = chunk.size < keep ? chunk.size : keep;
+        ok = ok && rt_scanner_find_range(scanner, chunk.data, chunk.size, 0, chunk.size - held, chunk.offset, matches);
+        memcpy(seam, chunk.data + chunk.size - held, held);
+        tail = held;
+        tail_at = chunk.offset + chunk.size - held;
+    }
+    if (rt_freader_failed(&reader)) ok = false;
+    if (ok && tail > 0) ok = rt_scanner_find_range(scanner, seam, tail, 0, tail, tail_at, matches);
+
+    rt_freader_close(&reader);
+    RT_FREE(seam);
+    return ok;
+}
+
+bool rt_file_crc32c(const char *path, uint32_t *crc)
+{
+    if (!path || !crc) return false;
+
+    RT_FileBuffer view = {0};
+    if (rt_fbuffer_map_file(&view, path, RT_FBUFFER_MAP_READ | RT_FBUFFER_MAP_SEQUENTIAL)) {
+        *crc = rt_fbuffer_crc32c(&view);
+        rt_fbuffer_free(&view);
+        return true;
+    }
+
+    RT_FileReader reader;
+    if (!rt_freader_open(&reader, path, RT_CRC32C_CHUNK, 0, 0)) return false;
+
+    uint32_t value = 0;
+    RT_FileChunk chunk;
+    while (rt_freader_next(&reader, &chunk)) value = rt_crc32c_parallel(value, chunk.data, chunk.size);
+
+    const bool ok = !rt_freader_failed(&reader);
+    rt_freader_close(&reader);
+    if (ok) *crc = value;
+    return ok;
+}
+
+bool rt_file_write_compressed(const char *path, RT_FileBuffer *buffer)
+{
+    if (!path || !buffer) return false;
+
+    RT_FileWriter writer;
+    if (!rt_fwriter_open(&writer, path, 0, RT_FWRITER_COMPRESS)) return false;
+    rt_fwriter_write(&writer, buffer->data, buffer->size);
+    return rt_fwriter_close(&writer);
+}
+
+bool rt_file_read_decompressed(const char *path, RT_FileBuffer *buffer)
+{
+    if (!path || !buffer) return false;
+
+    RT_FileBuffer packed = {0};
+    if (!rt__file_view(path, &packed)) return false;
+
+    // whatever the buffer held is replaced on either path
+    rt_fbuffer_free(buffer);
+    if (!rt_lz_is_frame(packed.data, packed.size)) {
+        // not a frame, the plain contents then, in a writable heap copy
+        if (!rt_fbuffer_is_mapped(&packed)) {
+            *buffer = packed;
+            return true;
+        }
+        const bool ok = rt_fbuffer_set(buffer, packed.data, packed.size);
+        rt_fbuffer_free(&packed);
+        return ok;
     }
 
-    fclose(fdump);
-    return dc;
+    const bool ok = rt_lz_frame_decompress(buffer, packed.data, packed.size);
+    rt_fbuffer_free(&packed);
+    return ok;
 }
 
 bool rt_mkdir_if_not_exists(const char *path)
@@ -232,28 +597,85 @@ bool rt_mkdir_if_not_exists(const char *path)
 //     return true;
 // }
 
+/* Dump lines are collected in a block and handed to the stream once it
+ * fills, so the CRT still sees every byte: text-mode streams keep their
+ * "\n" -> "\r\n" translation and nothing bypasses what it buffers. */
+#define RT__TEXT_BLOCK 0x4000
+
+typedef struct _RT__TextBlock {
+    FILE *out;
+    size_t size;
+    char data[RT__TEXT_BLOCK];
+} RT__TextBlock;
+
+static void rt__text_flush(RT__TextBlock *block)
+{
+    if (block->size) fwrite(block->data, 1, block->size, block->out);
+    block->size = 0;
+}
+
+static void rt__text_printf(RT__TextBlock *block, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(block->data + block->size, RT__TEXT_BLOCK - block->size, format, args);
+    va_end(args);
+    if (len >= 0 && (size_t)len < RT__TEXT_BLOCK - block->size) {
+        block->size += (size_t)len;
+        return;
+    }
+
+    // did not fit: flush and format again; a line longer than the block, or
+    // one vsnprintf could not format, goes through the CRT directly
+    rt__text_flush(block);
+    if (len >= 0 && (size_t)len < RT__TEXT_BLOCK) {
+        va_start(args, format);
+        len = vsnprintf(block->data, RT__TEXT_BLOCK, format, args);
+        va_end(args);
+        if (len >= 0 && (size_t)len < RT__TEXT_BLOCK) {
+            block->size = (size_t)len;
+            return;
+        }
+    }
+    va_start(args, format);
+    vfprintf(block->out, format, args);
+    va_end(args);
+}
+
 void rt_process_list_dump(RT_ProcessList *list, FILE *out)
 {
     if (!list || !list->items || list->size == 0) return;
-    if (!out) out = stdout;
 
-    fprintf(out, "=== Process List (%zu total) ===\n", list->size);
+    RT__TextBlock *block = RT_MALLOC(sizeof(RT__TextBlock));
+    if (!block) return;
+    block->out = out ? out : stdout;
+    block->size = 0;
+
+    char delim[RT_DELIM_SIZE_LINE + 2];
+    memset(delim, '-', RT_DELIM_SIZE_LINE);
+    delim[RT_DELIM_SIZE_LINE] = '\n';
+    delim[RT_DELIM_SIZE_LINE + 1] = '\0';
+
+    rt__text_printf(block, "=== Process List (%zu total) ===\n", list->size);
     for (size_t i = 0; i < list->size; ++i) {
         RT_Process *proc = &list->items[i];
-        fprintf(out, "[%3zu] PID: %-5lu | PPID: %-5lu | Threads: %-3lu | Name: %s\n", 
+        rt__text_printf(block, "[%3zu] PID: %-5lu | PPID: %-5lu | Threads: %-3lu | Name: %s\n", 
                i, proc->processId, proc->parentProcessId, proc->threadsCount, proc->name);
 
         if (!proc->modules.items || proc->modules.size == 0) {
-            fprintf(out, "      |--- [No modules loaded or access denied]\n");
+            rt__text_printf(block, "      |--- [No modules loaded or access denied]\n");
             continue;
         }
 
         RT_ModuleList *modList = &proc->modules;
         for (size_t j = 0; j < modList->size; ++j) {
             RT_Module *mod = &proc->modules.items[j];
-            fprintf(out, "      |--- [%02zu] %s (0x%p)\n", j, mod->name, mod->modBaseAddr);
+            rt__text_printf(block, "      |--- [%02zu] %s (0x%p)\n", j, mod->name, mod->modBaseAddr);
         }
 
-        rt_print_delim();
+        rt__text_printf(block, "%s", delim);
     }
+
+    rt__text_flush(block);
+    RT_FREE(block);
 }
\ No newline at end of file
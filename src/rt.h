@@ -9,6 +9,20 @@
 #include <sys/stat.h>
 
 #include "rt_collections.h"
+#include "rt_typed.h"
+#include "rt_btree.h"
+#include "rt_art.h"
+#include "rt_bitset.h"
+#include "rt_filter.h"
+#include "rt_timer.h"
+#include "rt_cache.h"
+#include "rt_stream.h"
+#include "rt_hex.h"
+#include "rt_diff.h"
+#include "rt_scan.h"
+#include "rt_hash.h"
+#include "rt_lz.h"
+#include "rt_dedup.h"
 #include "rt_thread.h"
 
 #define WIN32_LEAN_AND_MEAN
@@ -19,23 +33,16 @@
 #include <windows.h>
 #include <TlHelp32.h>
 #include <direct.h>
+#include <io.h>
 #include <shellapi.h>
 #define RT_MAX_PATH MAX_PATH
 #define RT_MAX_MODULE_NAME32 MAX_MODULE_NAME32
 
-#ifdef RT_MALLOC
-#   define RT_MALLOC malloc
-#endif // RT_MALLOC
-
 #ifdef RT_ASSERT
 #   include <assert.h>
 #   define RT_ASSERT assert
 #endif // RT_ASSERT
 
-#ifdef RT_FREE
-#define RT_FREE free
-#endif // RT_FREE
-
 #ifndef nullptr
 #   ifndef __cplusplus
 #       define nullptr ((void*)0)
@@ -78,9 +85,17 @@ typedef struct {
     size_t capacity;
 } RT_ProcessList;
 
-bool rt_file_read(const char *path, RT_FileBuffer *buffer);
+bool rt_file_read(const char *path, RT_FileBuffer *buffer); // a private heap copy
+bool rt_file_map(const char *path, RT_FileBuffer *buffer, int flags); // a view instead, RT_FBUFFER_MAP_*
 bool rt_file_write(const char *path, RT_FileBuffer *buffer);
 size_t rt_file_hexdump(const char *path_in, const char *path_out);
+bool rt_file_unhexdump(const char *path, RT_FileBuffer *buffer); // parses rt_file_hexdump output back
+bool rt_file_diff(const char *path_a, const char *path_b, RT_DiffList *list, size_t gap);
+bool rt_file_diff_dump(const char *path_a, const char *path_b, const char *path_out, size_t gap, int format); // RT_DIFF_RANGES or RT_DIFF_HEXDUMP
+bool rt_file_scan(const char *path, const RT_Scanner *scanner, RT_ScanMatchList *matches);
+bool rt_file_crc32c(const char *path, uint32_t *crc);
+bool rt_file_write_compressed(const char *path, RT_FileBuffer *buffer); // as an rt_lz frame
+bool rt_file_read_decompressed(const char *path, RT_FileBuffer *buffer); // unpacks rt_lz frames, other files as they are
 size_t rt_file_get_size(const char *path);
 bool rt_mkdir_if_not_exists(const char *path);
 void rt_print_delim();
@@ -0,0 +1,333 @@
+#include <windows.h>
+#include <malloc.h>
+#include <string.h>
+#include "rt_alloc.h"
+
+#if defined(_MSC_VER)
+#   define RT_THREAD_LOCAL __declspec(thread)
+#else
+#   define RT_THREAD_LOCAL __thread
+#endif
+
+#define RT_SALLOC_SPAN_COUNT (RT_SALLOC_ARENA_SIZE / RT_SALLOC_SPAN_SIZE)
+
+typedef struct _RT_SFreeObj {
+    struct _RT_SFreeObj *next;
+} RT_SFreeObj;
+
+typedef struct _RT_SCacheBin {
+    RT_SFreeObj *head;
+    size_t count;
+} RT_SCacheBin;
+
+typedef struct _RT_SCache {
+    RT_SCacheBin bins[RT_SALLOC_CLASS_COUNT];
+} RT_SCache;
+
+typedef struct _RT_SCentral {
+    SRWLOCK lock;
+    RT_SFreeObj *head;
+    size_t count;
+} RT_SCentral;
+
+static const uint16_t rt__salloc_class_size[RT_SALLOC_CLASS_COUNT] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256,
+    320, 384, 448, 512,
+    640, 768, 896, 1024
+};
+
+static uint8_t rt__salloc_class_lut[RT_SALLOC_MAX_SMALL / 16 + 1];
+static uint8_t *rt__salloc_span_class; // class index + 1 per committed span
+static char *rt__salloc_arena;
+static size_t rt__salloc_arena_used;
+static SRWLOCK rt__salloc_arena_lock = SRWLOCK_INIT;
+static volatile LONG rt__salloc_state; // 0 - not ready, 1 - ready, -1 - malloc only
+static DWORD rt__salloc_fls = FLS_OUT_OF_INDEXES;
+static RT_SCentral rt__salloc_central[RT_SALLOC_CLASS_COUNT];
+static volatile LONG rt__salloc_stat_spans;
+static volatile LONG rt__salloc_stat_transfers;
+static volatile LONG rt__salloc_stat_fallbacks;
+static RT_THREAD_LOCAL RT_SCache *rt__salloc_tcache;
+
+static void rt__salloc_release(RT_SCacheBin *bin, size_t cls, size_t count);
+
+static void WINAPI rt__salloc_thread_exit(void *param)
+{
+    RT_SCache *cache = param;
+    if (!cache) return;
+
+    for (size_t c = 0; c < RT_SALLOC_CLASS_COUNT; ++c) {
+        rt__salloc_release(&cache->bins[c], c, cache->bins[c].count);
+    }
+    free(cache);
+}
+
+static bool rt__salloc_init(void)
+{
+    if (rt__salloc_state) return rt__salloc_state > 0;
+
+    AcquireSRWLockExclusive(&rt__salloc_arena_lock);
+    if (rt__salloc_state == 0) {
+        LONG state = -1;
+
+        rt__salloc_span_class = calloc(RT_SALLOC_SPAN_COUNT, sizeof(uint8_t));
+        rt__salloc_arena = VirtualAlloc(NULL, RT_SALLOC_ARENA_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+        rt__salloc_fls = FlsAlloc(rt__salloc_thread_exit);
+
+        if (rt__salloc_span_class && rt__salloc_arena && rt__salloc_fls != FLS_OUT_OF_INDEXES) {
+            for (size_t i = 0, c = 0; i < sizeof(rt__salloc_class_lut); ++i) {
+                while (rt__salloc_class_size[c] < i * 16) c++;
+                rt__salloc_class_lut[i] = (uint8_t)c;
+            }
+            state = 1;
+        }
+
+        InterlockedExchange(&rt__salloc_state, state);
+    }
+    ReleaseSRWLockExclusive(&rt__salloc_arena_lock);
+
+    return rt__salloc_state > 0;
+}
+
+static inline bool rt__salloc_owns(const void *ptr)
+{
+    return rt__salloc_arena
+        && (const char*)ptr >= rt__salloc_arena
+        && (const char*)ptr < rt__salloc_arena + RT_SALLOC_ARENA_SIZE;
+}
+
+static inline size_t rt__salloc_class_of(const void *ptr)
+{
+    size_t span = ((const char*)ptr - rt__salloc_arena) / RT_SALLOC_SPAN_SIZE;
+    return rt__salloc_span_class[span] - 1;
+}
+
+static RT_SCache *rt__salloc_get_cache(void)
+{
+    if (rt__salloc_tcache) return rt__salloc_tcache;
+
+    RT_SCache *cache = calloc(1, sizeof(RT_SCache));
+    if (!cache) return NULL;
+
+    if (!FlsSetValue(rt__salloc_fls, cache)) {
+        free(cache);
+        return NULL;
+    }
+
+    rt__salloc_tcache = cache;
+    return cache;
+}
+
+static void *rt__salloc_fallback(size_t size)
+{
+    InterlockedIncrement(&rt__salloc_stat_fallbacks);
+    return malloc(size);
+}
+
+static char *rt__salloc_span_new(size_t cls)
+{
+    char *span = NULL;
+
+    AcquireSRWLockExclusive(&rt__salloc_arena_lock);
+    if (rt__salloc_arena_used + RT_SALLOC_SPAN_SIZE <= RT_SALLOC_ARENA_SIZE) {
+        span = VirtualAlloc(
+            rt__salloc_arena + rt__salloc_arena_used,
+            RT_SALLOC_SPAN_SIZE,
+            MEM_COMMIT,
+            PAGE_READWRITE
+        );
+        if (span) {
+            rt__salloc_span_class[rt__salloc_arena_used / RT_SALLOC_SPAN_SIZE] = (uint8_t)(cls + 1);
+            rt__salloc_arena_used += RT_SALLOC_SPAN_SIZE;
+        }
+    }
+    ReleaseSRWLockExclusive(&rt__salloc_arena_lock);
+
+    if (span) InterlockedIncrement(&rt__salloc_stat_spans);
+    return span;
+}
+
+static bool rt__salloc_refill(RT_SCacheBin *bin, size_t cls)
+{
+    RT_SCentral *central = &rt__salloc_central[cls];
+
+    AcquireSRWLockExclusive(&central->lock);
+    if (central->head) {
+        RT_SFreeObj *first = central->head;
+        RT_SFreeObj *last = first;
+        size_t n = 1;
+        while (n < RT_SALLOC_BATCH && last->next) {
+            last = last->next;
+            n++;
+        }
+
+        central->head = last->next;
+        central->count -= n;
+        ReleaseSRWLockExclusive(&central->lock);
+
+        last->next = bin->head;
+        bin->head = first;
+        bin->count += n;
+        InterlockedIncrement(&rt__salloc_stat_transfers);
+        return true;
+    }
+    ReleaseSRWLockExclusive(&central->lock);
+
+    char *span = rt__salloc_span_new(cls);
+    if (!span) return false;
+
+    // first batch goes straight to the caller, the rest of the span to the central list
+    const size_t osize = rt__salloc_class_size[cls];
+    const size_t total = RT_SALLOC_SPAN_SIZE / osize;
+    const size_t local = total < RT_SALLOC_BATCH ? total : RT_SALLOC_BATCH;
+
+    for (size_t i = 0; i < total; ++i) {
+        RT_SFreeObj *obj = (RT_SFreeObj*)(span + i * osize);
+        obj->next = (i + 1 < total && i + 1 != local)
+            ? (RT_SFreeObj*)(span + (i + 1) * osize)
+            : NULL;
+    }
+
+    ((RT_SFreeObj*)(span + (local - 1) * osize))->next = bin->head;
+    bin->head = (RT_SFreeObj*)span;
+    bin->count += local;
+
+    if (total > local) {
+        RT_SFreeObj *first = (RT_SFreeObj*)(span + local * osize);
+        RT_SFreeObj *last = (RT_SFreeObj*)(span + (total - 1) * osize);
+
+        AcquireSRWLockExclusive(&central->lock);
+        last->next = central->head;
+        central->head = first;
+        central->count += total - local;
+        ReleaseSRWLockExclusive(&central->lock);
+    }
+
+    return true;
+}
+
+static void rt__salloc_release(RT_SCacheBin *bin, size_t cls, size_t count)
+{
+    if (count == 0 || !bin->head) return;
+    if (count > bin->count) count = bin->count;
+
+    RT_SFreeObj *first = bin->head;
+    RT_SFreeObj *last = first;
+    for (size_t i = 1; i < count; ++i) last = last->next;
+
+    bin->head = last->next;
+    bin->count -= count;
+
+    RT_SCentral *central = &rt__salloc_central[cls];
+    AcquireSRWLockExclusive(&central->lock);
+    last->next = central->head;
+    central->head = first;
+    central->count += count;
+    ReleaseSRWLockExclusive(&central->lock);
+
+    InterlockedIncrement(&rt__salloc_stat_transfers);
+}
+
+void *rt_salloc(size_t size)
+{
+    if (size == 0) size = 1;
+    if (size > RT_SALLOC_MAX_SMALL || !rt__salloc_init()) return rt__salloc_fallback(size);
+
+    RT_SCache *cache = rt__salloc_get_cache();
+    if (!cache) return rt__salloc_fallback(size);
+
+    const size_t cls = rt__salloc_class_lut[(size + 15) >> 4];
+    RT_SCacheBin *bin = &cache->bins[cls];
+
+    if (!bin->head && !rt__salloc_refill(bin, cls)) return rt__salloc_fallback(size);
+
+    RT_SFreeObj *obj = bin->head;
+    bin->head = obj->next;
+    bin->count--;
+
+    return obj;
+}
+
+void *rt_scalloc(size_t count, size_t size)
+{
+    if (size && count > SIZE_MAX / size) return NULL;
+
+    void *p = rt_salloc(count * size);
+    if (p) memset(p, 0, count * size);
+
+    return p;
+}
+
+void *rt_srealloc(void *ptr, size_t size)
+{
+    if (!ptr) return rt_salloc(size);
+    if (size == 0) {
+        rt_sfree(ptr);
+        return NULL;
+    }
+    if (!rt__salloc_owns(ptr)) return realloc(ptr, size);
+
+    const size_t old_size = rt__salloc_class_size[rt__salloc_class_of(ptr)];
+    if (size <= old_size && size > old_size / 2) return ptr;
+
+    void *p = rt_salloc(size);
+    if (!p) return NULL;
+
+    memcpy(p, ptr, size < old_size ? size : old_size);
+    rt_sfree(ptr);
+
+    return p;
+}
+
+void rt_sfree(void *ptr)
+{
+    if (!ptr) return;
+    if (!rt__salloc_owns(ptr)) {
+        free(ptr);
+        return;
+    }
+
+    const size_t cls = rt__salloc_class_of(ptr);
+    RT_SFreeObj *obj = ptr;
+    RT_SCache *cache = rt__salloc_get_cache();
+
+    if (!cache) { // no cache for this thread, hand the object to the central list
+        RT_SCacheBin tmp = { .head = obj, .count = 1 };
+        obj->next = NULL;
+        rt__salloc_release(&tmp, cls, 1);
+        return;
+    }
+
+    RT_SCacheBin *bin = &cache->bins[cls];
+    obj->next = bin->head;
+    bin->head = obj;
+    bin->count++;
+
+    if (bin->count > RT_SALLOC_CACHE_MAX) rt__salloc_release(bin, cls, RT_SALLOC_BATCH);
+}
+
+size_t rt_salloc_usable_size(const void *ptr)
+{
+    if (!ptr) return 0;
+    if (!rt__salloc_owns(ptr)) return _msize((void*)ptr);
+    return rt__salloc_class_size[rt__salloc_class_of(ptr)];
+}
+
+void rt_salloc_thread_flush(void)
+{
+    RT_SCache *cache = rt__salloc_tcache;
+    if (!cache) return;
+
+    for (size_t c = 0; c < RT_SALLOC_CLASS_COUNT; ++c) {
+        rt__salloc_release(&cache->bins[c], c, cache->bins[c].count);
+    }
+}
+
+void rt_salloc_stats(RT_SAllocStats *stats)
+{
+    if (!stats) return;
+    stats->spans = (size_t)rt__salloc_stat_spans;
+    stats->central_transfers = (size_t)rt__salloc_stat_transfers;
+    stats->fallback_allocs = (size_t)rt__salloc_stat_fallbacks;
+}
@@ -0,0 +1,42 @@
+#ifndef _INC_RT_ALLOC
+#define _INC_RT_ALLOC
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Small-object allocator
+ * Objects up to RT_SALLOC_MAX_SMALL bytes are served from per-thread caches
+ * split into size classes. Caches exchange objects with a central free list
+ * in batches of RT_SALLOC_BATCH, so a thread only takes a lock once per batch.
+ * An object may be freed from any thread: it lands in the freeing thread's
+ * cache and flows back to the central list once that cache overflows.
+ * Bigger requests (and requests made after the arena is exhausted) are
+ * forwarded to malloc, rt_sfree tells both kinds apart by address. */
+#define RT_SALLOC_SPAN_SIZE 0x10000 // 64 KiB, VirtualAlloc granularity
+#define RT_SALLOC_MAX_SMALL 1024
+#define RT_SALLOC_CLASS_COUNT 20
+#define RT_SALLOC_BATCH 32
+#define RT_SALLOC_CACHE_MAX (RT_SALLOC_BATCH * 2)
+
+#if SIZE_MAX > 0xFFFFFFFFu
+#   define RT_SALLOC_ARENA_SIZE ((size_t)16 << 30) // reserved, committed per span
+#else
+#   define RT_SALLOC_ARENA_SIZE ((size_t)256 << 20)
+#endif
+
+typedef struct _RT_SAllocStats {
+    size_t spans;             // spans committed from the arena
+    size_t central_transfers; // batches moved between caches and central lists
+    size_t fallback_allocs;   // requests forwarded to malloc
+} RT_SAllocStats;
+
+void *rt_salloc(size_t size);
+void *rt_scalloc(size_t count, size_t size);
+void *rt_srealloc(void *ptr, size_t size);
+void rt_sfree(void *ptr);
+size_t rt_salloc_usable_size(const void *ptr);
+void rt_salloc_thread_flush(void);
+void rt_salloc_stats(RT_SAllocStats *stats);
+
+#endif // _INC_RT_ALLOC
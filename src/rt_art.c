@@ -0,0 +1,672 @@
+#include "rt_art.h"
+#include "rt_simd.h"
+
+#if defined(RT_SIMD_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#   define RT__ART_SSE2 1
+#endif
+
+#define RT__ART_MAX_PREFIX 10 // prefix bytes kept in the node, longer prefixes are checked at the leaf
+
+#define RT__ART_NODE4   1
+#define RT__ART_NODE16  2
+#define RT__ART_NODE48  3
+#define RT__ART_NODE256 4
+
+// leaves are tagged in the low pointer bit
+#define RT__ART_IS_LEAF(p) ((uintptr_t)(p) & 1)
+#define RT__ART_LEAF(p) ((RT__ArtLeaf *)((uintptr_t)(p) & ~(uintptr_t)1))
+#define RT__ART_TAG(l) ((void *)((uintptr_t)(l) | 1))
+
+#define RT__ART_MIN(a, b) ((a) < (b) ? (a) : (b))
+
+typedef struct _RT__ArtNode {
+    uint8_t type;
+    uint16_t count;
+    uint32_t prefix_len;
+    uint8_t prefix[RT__ART_MAX_PREFIX];
+} RT__ArtNode;
+
+typedef struct _RT__ArtNode4 {
+    RT__ArtNode n;
+    uint8_t keys[4];
+    void *children[4];
+} RT__ArtNode4;
+
+typedef struct _RT__ArtNode16 {
+    RT__ArtNode n;
+    uint8_t keys[16];
+    void *children[16];
+} RT__ArtNode16;
+
+typedef struct _RT__ArtNode48 {
+    RT__ArtNode n;
+    uint8_t index[256]; // slot + 1, 0 = empty
+    void *children[48];
+} RT__ArtNode48;
+
+typedef struct _RT__ArtNode256 {
+    RT__ArtNode n;
+    void *children[256];
+} RT__ArtNode256;
+
+// value, then the key including its NUL terminator
+typedef struct _RT__ArtLeaf {
+    size_t key_len;
+    uint8_t data[];
+} RT__ArtLeaf;
+
+static inline const uint8_t *rt__art_leaf_key(const RT_ArtTree *tree, const RT__ArtLeaf *leaf)
+{
+    return leaf->data + tree->value_size;
+}
+
+static inline bool rt__art_leaf_matches(const RT_ArtTree *tree, const RT__ArtLeaf *leaf, const uint8_t *key, size_t len)
+{
+    return leaf->key_len == len && memcmp(rt__art_leaf_key(tree, leaf), key, len) == 0;
+}
+
+static RT__ArtLeaf *rt__art_leaf_new(RT_ArtTree *tree, const uint8_t *key, size_t len, const void *value)
+{
+    RT__ArtLeaf *leaf = RT_MALLOC(sizeof(RT__ArtLeaf) + tree->value_size + len);
+    if (!leaf) return NULL;
+
+    leaf->key_len = len;
+    if (tree->value_size) memcpy(leaf->data, value, tree->value_size);
+    memcpy(leaf->data + tree->value_size, key, len);
+
+    return leaf;
+}
+
+static RT__ArtNode *rt__art_node_new(uint8_t type)
+{
+    size_t size;
+    switch (type) {
+    case RT__ART_NODE4: size = sizeof(RT__ArtNode4); break;
+    case RT__ART_NODE16: size = sizeof(RT__ArtNode16); break;
+    case RT__ART_NODE48: size = sizeof(RT__ArtNode48); break;
+    default: size = sizeof(RT__ArtNode256); break;
+    }
+
+    RT__ArtNode *n = RT_CALLOC(1, size);
+    if (n) n->type = type;
+    return n;
+}
+
+static void rt__art_copy_header(RT__ArtNode *dst, const RT__ArtNode *src)
+{
+    dst->count = src->count;
+    dst->prefix_len = src->prefix_len;
+    memcpy(dst->prefix, src->prefix, RT__ART_MIN(src->prefix_len, RT__ART_MAX_PREFIX));
+}
+
+static void rt__art_node_free(void *node)
+{
+    if (!node) return;
+    if (RT__ART_IS_LEAF(node)) {
+        RT_FREE(RT__ART_LEAF(node));
+        return;
+    }
+
+    RT__ArtNode *n = node;
+    switch (n->type) {
+    case RT__ART_NODE4:
+        for (size_t i = 0; i < n->count; ++i) rt__art_node_free(((RT__ArtNode4 *)n)->children[i]);
+        break;
+    case RT__ART_NODE16:
+        for (size_t i = 0; i < n->count; ++i) rt__art_node_free(((RT__ArtNode16 *)n)->children[i]);
+        break;
+    case RT__ART_NODE48:
+        for (size_t i = 0; i < 48; ++i) rt__art_node_free(((RT__ArtNode48 *)n)->children[i]);
+        break;
+    case RT__ART_NODE256:
+        for (size_t i = 0; i < 256; ++i) rt__art_node_free(((RT__ArtNode256 *)n)->children[i]);
+        break;
+    }
+
+    RT_FREE(n);
+}
+
+static void **rt__art_find_child(RT__ArtNode *n, uint8_t c)
+{
+    switch (n->type) {
+    case RT__ART_NODE4: {
+        RT__ArtNode4 *p = (RT__ArtNode4 *)n;
+        for (size_t i = 0; i < n->count; ++i) {
+            if (p->keys[i] == c) return &p->children[i];
+        }
+        return NULL;
+    }
+    case RT__ART_NODE16: {
+        RT__ArtNode16 *p = (RT__ArtNode16 *)n;
+#ifdef RT__ART_SSE2
+        __m128i eq = _mm_cmpeq_epi8(_mm_set1_epi8((char)c), _mm_loadu_si128((const __m128i *)p->keys));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(eq) & ((1u << n->count) - 1);
+        return mask ? &p->children[rt__ctz32(mask)] : NULL;
+#else
+        for (size_t i = 0; i < n->count; ++i) {
+            if (p->keys[i] == c) return &p->children[i];
+        }
+        return NULL;
+#endif // RT__ART_SSE2
+    }
+    case RT__ART_NODE48: {
+        RT__ArtNode48 *p = (RT__ArtNode48 *)n;
+        return p->index[c] ? &p->children[p->index[c] - 1] : NULL;
+    }
+    case RT__ART_NODE256: {
+        RT__ArtNode256 *p = (RT__ArtNode256 *)n;
+        return p->children[c] ? &p->children[c] : NULL;
+    }
+    }
+    return NULL;
+}
+
+static RT__ArtLeaf *rt__art_minimum(void *node)
+{
+    while (node && !RT__ART_IS_LEAF(node)) {
+        RT__ArtNode *n = node;
+        size_t i = 0;
+        switch (n->type) {
+        case RT__ART_NODE4: node = ((RT__ArtNode4 *)n)->children[0]; break;
+        case RT__ART_NODE16: node = ((RT__ArtNode16 *)n)->children[0]; break;
+        case RT__ART_NODE48:
+            while (!((RT__ArtNode48 *)n)->index[i]) i++;
+            node = ((RT__ArtNode48 *)n)->children[((RT__ArtNode48 *)n)->index[i] - 1];
+            break;
+        case RT__ART_NODE256:
+            while (!((RT__ArtNode256 *)n)->children[i]) i++;
+            node = ((RT__ArtNode256 *)n)->children[i];
+            break;
+        }
+    }
+    return node ? RT__ART_LEAF(node) : NULL;
+}
+
+// number of stored prefix bytes matching the key (optimistic: skips what is not stored)
+static inline size_t rt__art_check_prefix(const RT__ArtNode *n, const uint8_t *key, size_t len, size_t depth)
+{
+    size_t max = RT__ART_MIN(RT__ART_MIN(n->prefix_len, RT__ART_MAX_PREFIX), len - depth);
+    size_t i = 0;
+    while (i < max && n->prefix[i] == key[depth + i]) i++;
+    return i;
+}
+
+// exact length of the matching prefix, reading past the stored bytes from a leaf
+static size_t rt__art_prefix_mismatch(RT_ArtTree *tree, RT__ArtNode *n, const uint8_t *key, size_t len, size_t depth)
+{
+    size_t i = rt__art_check_prefix(n, key, len, depth);
+    if (i < RT__ART_MAX_PREFIX || n->prefix_len <= RT__ART_MAX_PREFIX) return i;
+
+    RT__ArtLeaf *leaf = rt__art_minimum(n);
+    const uint8_t *lkey = rt__art_leaf_key(tree, leaf);
+    size_t max = RT__ART_MIN(RT__ART_MIN(leaf->key_len, len) - depth, n->prefix_len);
+    while (i < max && lkey[depth + i] == key[depth + i]) i++;
+    return i;
+}
+
+static void rt__art_node4_add(RT__ArtNode4 *p, uint8_t c, void *child)
+{
+    size_t pos = 0, count = p->n.count;
+    while (pos < count && p->keys[pos] < c) pos++;
+
+    memmove(&p->keys[pos + 1], &p->keys[pos], count - pos);
+    memmove(&p->children[pos + 1], &p->children[pos], (count - pos) * sizeof(void *));
+    p->keys[pos] = c;
+    p->children[pos] = child;
+    p->n.count++;
+}
+
+static void rt__art_node16_add(RT__ArtNode16 *p, uint8_t c, void *child)
+{
+    size_t pos = 0, count = p->n.count;
+    while (pos < count && p->keys[pos] < c) pos++;
+
+    memmove(&p->keys[pos + 1], &p->keys[pos], count - pos);
+    memmove(&p->children[pos + 1], &p->children[pos], (count - pos) * sizeof(void *));
+    p->keys[pos] = c;
+    p->children[pos] = child;
+    p->n.count++;
+}
+
+static void rt__art_node48_add(RT__ArtNode48 *p, uint8_t c, void *child)
+{
+    size_t slot = 0;
+    while (p->children[slot]) slot++;
+
+    p->children[slot] = child;
+    p->index[c] = (uint8_t)(slot + 1);
+    p->n.count++;
+}
+
+// may replace the node behind `ref` with a bigger one
+static bool rt__art_add_child(void **ref, RT__ArtNode *n, uint8_t c, void *child)
+{
+    switch (n->type) {
+    case RT__ART_NODE4: {
+        RT__ArtNode4 *p = (RT__ArtNode4 *)n;
+        if (n->count < 4) {
+            rt__art_node4_add(p, c, child);
+            return true;
+        }
+
+        RT__ArtNode16 *g = (RT__ArtNode16 *)rt__art_node_new(RT__ART_NODE16);
+        if (!g) return false;
+        rt__art_copy_header(&g->n, n);
+        memcpy(g->keys, p->keys, 4);
+        memcpy(g->children, p->children, 4 * sizeof(void *));
+        rt__art_node16_add(g, c, child);
+        *ref = g;
+        RT_FREE(n);
+        return true;
+    }
+    case RT__ART_NODE16: {
+        RT__ArtNode16 *p = (RT__ArtNode16 *)n;
+        if (n->count < 16) {
+            rt__art_node16_add(p, c, child);
+            return true;
+        }
+
+        RT__ArtNode48 *g = (RT__ArtNode48 *)rt__art_node_new(RT__ART_NODE48);
+        if (!g) return false;
+        rt__art_copy_header(&g->n, n);
+        memcpy(g->children, p->children, 16 * sizeof(void *));
+        for (size_t i = 0; i < 16; ++i) g->index[p->keys[i]] = (uint8_t)(i + 1);
+        rt__art_node48_add(g, c, child);
+        *ref = g;
+        RT_FREE(n);
+        return true;
+    }
+    case RT__ART_NODE48: {
+        RT__ArtNode48 *p = (RT__ArtNode48 *)n;
+        if (n->count < 48) {
+            rt__art_node48_add(p, c, child);
+            return true;
+        }
+
+        RT__ArtNode256 *g = (RT__ArtNode256 *)rt__art_node_new(RT__ART_NODE256);
+        if (!g) return false;
+        rt__art_copy_header(&g->n, n);
+        for (size_t i = 0; i < 256; ++i) {
+            if (p->index[i]) g->children[i] = p->children[p->index[i] - 1];
+        }
+        g->children[c] = child;
+        g->n.count++;
+        *ref = g;
+        RT_FREE(n);
+        return true;
+    }
+    case RT__ART_NODE256: {
+        RT__ArtNode256 *p = (RT__ArtNode256 *)n;
+        p->children[c] = child;
+        n->count++;
+        return true;
+    }
+    }
+    return false;
+}
+
+/* Removes the child behind `child` from `n`. Nodes shrink below their growth
+ * point so a key hovering at the boundary does not reallocate every time; a
+ * failed shrink just keeps the bigger node. */
+static void rt__art_remove_child(void **ref, RT__ArtNode *n, uint8_t c, void **child)
+{
+    switch (n->type) {
+    case RT__ART_NODE4: {
+        RT__ArtNode4 *p = (RT__ArtNode4 *)n;
+        size_t pos = (size_t)(child - p->children), tail = n->count - pos - 1;
+        memmove(&p->keys[pos], &p->keys[pos + 1], tail);
+        memmove(&p->children[pos], &p->children[pos + 1], tail * sizeof(void *));
+        n->count--;
+
+        if (n->count == 1) { // fold this node into its only child
+            void *only = p->children[0];
+            if (!RT__ART_IS_LEAF(only)) {
+                RT__ArtNode *o = only;
+                size_t prefix = n->prefix_len;
+                if (prefix < RT__ART_MAX_PREFIX) n->prefix[prefix++] = p->keys[0];
+                if (prefix < RT__ART_MAX_PREFIX) {
+                    size_t sub = RT__ART_MIN(o->prefix_len, RT__ART_MAX_PREFIX - prefix);
+                    memcpy(n->prefix + prefix, o->prefix, sub);
+                    prefix += sub;
+                }
+                memcpy(o->prefix, n->prefix, RT__ART_MIN(prefix, RT__ART_MAX_PREFIX));
+                o->prefix_len += n->prefix_len + 1;
+            }
+            *ref = only;
+            RT_FREE(n);
+        }
+        return;
+    }
+    case RT__ART_NODE16: {
+        RT__ArtNode16 *p = (RT__ArtNode16 *)n;
+        size_t pos = (size_t)(child - p->children), tail = n->count - pos - 1;
+        memmove(&p->keys[pos], &p->keys[pos + 1], tail);
+        memmove(&p->children[pos], &p->children[pos + 1], tail * sizeof(void *));
+        n->count--;
+
+        if (n->count == 3) {
+            RT__ArtNode4 *s = (RT__ArtNode4 *)rt__art_node_new(RT__ART_NODE4);
+            if (!s) return;
+            rt__art_copy_header(&s->n, n);
+            memcpy(s->keys, p->keys, 3);
+            memcpy(s->children, p->children, 3 * sizeof(void *));
+            *ref = s;
+            RT_FREE(n);
+        }
+        return;
+    }
+    case RT__ART_NODE48: {
+        RT__ArtNode48 *p = (RT__ArtNode48 *)n;
+        p->children[p->index[c] - 1] = NULL;
+        p->index[c] = 0;
+        n->count--;
+
+        if (n->count == 12) {
+            RT__ArtNode16 *s = (RT__ArtNode16 *)rt__art_node_new(RT__ART_NODE16);
+            if (!s) return;
+            rt__art_copy_header(&s->n, n);
+            size_t j = 0;
+            for (size_t i = 0; i < 256; ++i) {
+                if (!p->index[i]) continue;
+                s->keys[j] = (uint8_t)i;
+                s->children[j++] = p->children[p->index[i] - 1];
+            }
+            *ref = s;
+            RT_FREE(n);
+        }
+        return;
+    }
+    case RT__ART_NODE256: {
+        RT__ArtNode256 *p = (RT__ArtNode256 *)n;
+        p->children[c] = NULL;
+        n->count--;
+
+        if (n->count == 37) {
+            RT__ArtNode48 *s = (RT__ArtNode48 *)rt__art_node_new(RT__ART_NODE48);
+            if (!s) return;
+            rt__art_copy_header(&s->n, n);
+            size_t j = 0;
+            for (size_t i = 0; i < 256; ++i) {
+                if (!p->children[i]) continue;
+                s->children[j] = p->children[i];
+                s->index[i] = (uint8_t)++j;
+            }
+            *ref = s;
+            RT_FREE(n);
+        }
+        return;
+    }
+    }
+}
+
+static bool rt__art_walk(RT_ArtTree *tree, void *node, void *data, RT_ArtCallback callback)
+{
+    if (!node) return false;
+
+    if (RT__ART_IS_LEAF(node)) {
+        RT__ArtLeaf *leaf = RT__ART_LEAF(node);
+        return callback((const char *)rt__art_leaf_key(tree, leaf), tree->value_size ? leaf->data : NULL, data);
+    }
+
+    RT__ArtNode *n = node;
+    switch (n->type) {
+    case RT__ART_NODE4:
+        for (size_t i = 0; i < n->count; ++i) {
+            if (rt__art_walk(tree, ((RT__ArtNode4 *)n)->children[i], data, callback)) return true;
+        }
+        break;
+    case RT__ART_NODE16:
+        for (size_t i = 0; i < n->count; ++i) {
+            if (rt__art_walk(tree, ((RT__ArtNode16 *)n)->children[i], data, callback)) return true;
+        }
+        break;
+    case RT__ART_NODE48: {
+        RT__ArtNode48 *p = (RT__ArtNode48 *)n;
+        for (size_t i = 0; i < 256; ++i) {
+            if (p->index[i] && rt__art_walk(tree, p->children[p->index[i] - 1], data, callback)) return true;
+        }
+        break;
+    }
+    case RT__ART_NODE256: {
+        RT__ArtNode256 *p = (RT__ArtNode256 *)n;
+        for (size_t i = 0; i < 256; ++i) {
+            if (rt__art_walk(tree, p->children[i], data, callback)) return true;
+        }
+        break;
+    }
+    }
+    return false;
+}
+
+bool rt_art_init(RT_ArtTree *tree, size_t value_size)
+{
+    if (!tree) return false;
+
+    tree->root = NULL;
+    tree->size = 0;
+    tree->value_size = value_size;
+    return true;
+}
+
+void rt_art_free(RT_ArtTree *tree)
+{
+    if (!tree) return;
+
+    rt__art_node_free(tree->root);
+    tree->root = NULL;
+    tree->size = 0;
+}
+
+bool rt_art_insert(RT_ArtTree *tree, const char *key, const void *value)
+{
+    if (!tree || !key || (tree->value_size && !value)) return false;
+
+    // the terminator is part of the key, so no key is a prefix of another
+    const uint8_t *k = (const uint8_t *)key;
+    size_t len = strlen(key) + 1, depth = 0;
+    void **ref = &tree->root;
+
+    for (;;) {
+        void *node = *ref;
+
+        if (!node) {
+            RT__ArtLeaf *leaf = rt__art_leaf_new(tree, k, len, value);
+            if (!leaf) return false;
+            *ref = RT__ART_TAG(leaf);
+            tree->size++;
+            return true;
+        }
+
+        if (RT__ART_IS_LEAF(node)) {
+            RT__ArtLeaf *old = RT__ART_LEAF(node);
+            if (rt__art_leaf_matches(tree, old, k, len)) { // update if exists
+                if (tree->value_size) memcpy(old->data, value, tree->value_size);
+                return true;
+            }
+
+            // split the leaf: a Node4 holding the common part as its prefix
+            RT__ArtNode4 *n4 = (RT__ArtNode4 *)rt__art_node_new(RT__ART_NODE4);
+            RT__ArtLeaf *leaf = rt__art_leaf_new(tree, k, len, value);
+            if (!n4 || !leaf) {
+                RT_FREE(n4);
+                RT_FREE(leaf);
+                return false;
+            }
+
+            const uint8_t *okey = rt__art_leaf_key(tree, old);
+            size_t lcp = depth, limit = RT__ART_MIN(old->key_len, len);
+            while (lcp < limit && okey[lcp] == k[lcp]) lcp++;
+
+            n4->n.prefix_len = (uint32_t)(lcp - depth);
+            memcpy(n4->n.prefix, k + depth, RT__ART_MIN(n4->n.prefix_len, RT__ART_MAX_PREFIX));
+            rt__art_node4_add(n4, okey[lcp], node);
+            rt__art_node4_add(n4, k[lcp], RT__ART_TAG(leaf));
+            *ref = n4;
+            tree->size++;
+            return true;
+        }
+
+        RT__ArtNode *n = node;
+        if (n->prefix_len) {
+            size_t mismatch = rt__art_prefix_mismatch(tree, n, k, len, depth);
+            if (mismatch < n->prefix_len) { // split the prefix
+                RT__ArtNode4 *n4 = (RT__ArtNode4 *)rt__art_node_new(RT__ART_NODE4);
+                RT__ArtLeaf *leaf = rt__art_leaf_new(tree, k, len, value);
+                if (!n4 || !leaf) {
+                    RT_FREE(n4);
+                    RT_FREE(leaf);
+                    return false;
+                }
+
+                n4->n.prefix_len = (uint32_t)mismatch;
+                memcpy(n4->n.prefix, n->prefix, RT__ART_MIN(mismatch, RT__ART_MAX_PREFIX));
+                if (n->prefix_len <= RT__ART_MAX_PREFIX) {
+                    rt__art_node4_add(n4, n->prefix[mismatch], n);
+                    n->prefix_len -= (uint32_t)mismatch + 1;
+                    memmove(n->prefix, n->prefix + mismatch + 1, RT__ART_MIN(n->prefix_len, RT__ART_MAX_PREFIX));
+                } else {
+                    const uint8_t *mkey = rt__art_leaf_key(tree, rt__art_minimum(n));
+                    n->prefix_len -= (uint32_t)mismatch + 1;
+                    rt__art_node4_add(n4, mkey[depth + mismatch], n);
+                    memcpy(n->prefix, mkey + depth + mismatch + 1, RT__ART_MIN(n->prefix_len, RT__ART_MAX_PREFIX));
+                }
+                rt__art_node4_add(n4, k[depth + mismatch], RT__ART_TAG(leaf));
+                *ref = n4;
+                tree->size++;
+                return true;
+            }
+            depth += n->prefix_len;
+        }
+
+        void **child = rt__art_find_child(n, k[depth]);
+        if (child) {
+            ref = child;
+            depth++;
+            continue;
+        }
+
+        RT__ArtLeaf *leaf = rt__art_leaf_new(tree, k, len, value);
+        if (!leaf) return false;
+        if (!rt__art_add_child(ref, n, k[depth], RT__ART_TAG(leaf))) {
+            RT_FREE(leaf);
+            return false;
+        }
+        tree->size++;
+        return true;
+    }
+}
+
+bool rt_art_get(RT_ArtTree *tree, const char *key, void *out)
+{
+    if (!tree || !key) return false;
+
+    const uint8_t *k = (const uint8_t *)key;
+    size_t len = strlen(key) + 1, depth = 0;
+    void *node = tree->root;
+
+    while (node) {
+        if (RT__ART_IS_LEAF(node)) {
+            RT__ArtLeaf *leaf = RT__ART_LEAF(node);
+            if (!rt__art_leaf_matches(tree, leaf, k, len)) return false;
+            if (out && tree->value_size) memcpy(out, leaf->data, tree->value_size);
+            return true;
+        }
+
+        RT__ArtNode *n = node;
+        if (n->prefix_len) {
+            if (rt__art_check_prefix(n, k, len, depth) != RT__ART_MIN(n->prefix_len, RT__ART_MAX_PREFIX)) return false;
+            depth += n->prefix_len;
+        }
+        if (depth >= len) return false;
+
+        void **child = rt__art_find_child(n, k[depth++]);
+        node = child ? *child : NULL;
+    }
+
+    return false;
+}
+
+bool rt_art_remove(RT_ArtTree *tree, const char *key)
+{
+    if (!tree || !key || !tree->root) return false;
+
+    const uint8_t *k = (const uint8_t *)key;
+    size_t len = strlen(key) + 1, depth = 0;
+    void **ref = &tree->root;
+
+    if (RT__ART_IS_LEAF(*ref)) {
+        RT__ArtLeaf *leaf = RT__ART_LEAF(*ref);
+        if (!rt__art_leaf_matches(tree, leaf, k, len)) return false;
+        RT_FREE(leaf);
+        *ref = NULL;
+        tree->size--;
+        return true;
+    }
+
+    for (;;) {
+        RT__ArtNode *n = *ref;
+        if (n->prefix_len) {
+            if (rt__art_check_prefix(n, k, len, depth) != RT__ART_MIN(n->prefix_len, RT__ART_MAX_PREFIX)) return false;
+            depth += n->prefix_len;
+        }
+        if (depth >= len) return false;
+
+        void **child = rt__art_find_child(n, k[depth]);
+        if (!child) return false;
+
+        if (RT__ART_IS_LEAF(*child)) {
+            RT__ArtLeaf *leaf = RT__ART_LEAF(*child);
+            if (!rt__art_leaf_matches(tree, leaf, k, len)) return false;
+            rt__art_remove_child(ref, n, k[depth], child);
+            RT_FREE(leaf);
+            tree->size--;
+            return true;
+        }
+
+        ref = child;
+        depth++;
+    }
+}
+
+void rt_art_foreach(RT_ArtTree *tree, void *data, RT_ArtCallback callback)
+{
+    if (!tree || !callback) return;
+
+    rt__art_walk(tree, tree->root, data, callback);
+}
+
+void rt_art_foreach_prefix(RT_ArtTree *tree, const char *prefix, void *data, RT_ArtCallback callback)
+{
+    if (!tree || !prefix || !callback) return;
+
+    const uint8_t *p = (const uint8_t *)prefix;
+    size_t plen = strlen(prefix), depth = 0;
+    void *node = tree->root;
+
+    while (node) {
+        if (RT__ART_IS_LEAF(node)) {
+            RT__ArtLeaf *leaf = RT__ART_LEAF(node);
+            if (leaf->key_len > plen && memcmp(rt__art_leaf_key(tree, leaf), p, plen) == 0) {
+                rt__art_walk(tree, node, data, callback);
+            }
+            return;
+        }
+
+        RT__ArtNode *n = node;
+        if (depth + n->prefix_len >= plen) {
+            // the query ends inside this node: one leaf confirms the whole subtree
+            size_t max = RT__ART_MIN(RT__ART_MIN(n->prefix_len, RT__ART_MAX_PREFIX), plen - depth);
+            if (memcmp(n->prefix, p + depth, max) != 0) return;
+
+            RT__ArtLeaf *leaf = rt__art_minimum(n);
+            if (memcmp(rt__art_leaf_key(tree, leaf), p, plen) == 0) rt__art_walk(tree, node, data, callback);
+            return;
+        }
+
+        if (rt__art_check_prefix(n, p, plen, depth) != RT__ART_MIN(n->prefix_len, RT__ART_MAX_PREFIX)) return;
+        depth += n->prefix_len;
+
+        void **child = rt__art_find_child(n, p[depth++]);
+        node = child ? *child : NULL;
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef _INC_RT_ART
+#define _INC_RT_ART
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+
+/* Adaptive radix tree for string keys
+ * Inner nodes grow and shrink between 4, 16, 48 and 256 children, and chains
+ * of single-child nodes are compressed into a prefix, so keys that share a
+ * long path (file paths, module names) share the inner nodes as well. A
+ * lookup touches one byte per level and compares the full key once, at the
+ * leaf. Iteration is in strcmp order. Values have a fixed size per tree. */
+typedef struct _RT_ArtTree {
+    void *root;
+    size_t size;
+    size_t value_size;
+} RT_ArtTree;
+
+// return true to stop the walk
+typedef bool (*RT_ArtCallback)(const char *key, void *value, void *user_data);
+
+bool rt_art_init(RT_ArtTree *tree, size_t value_size);
+void rt_art_free(RT_ArtTree *tree);
+bool rt_art_insert(RT_ArtTree *tree, const char *key, const void *value);
+bool rt_art_get(RT_ArtTree *tree, const char *key, void *out);
+bool rt_art_remove(RT_ArtTree *tree, const char *key);
+void rt_art_foreach(RT_ArtTree *tree, void *data, RT_ArtCallback callback);
+void rt_art_foreach_prefix(RT_ArtTree *tree, const char *prefix, void *data, RT_ArtCallback callback);
+
+static inline bool rt_art_contains(RT_ArtTree *tree, const char *key)
+{
+    return rt_art_get(tree, key, NULL);
+}
+
+static inline bool rt_art_is_empty(RT_ArtTree *tree)
+{
+    return !tree || tree->size == 0;
+}
+
+#endif // _INC_RT_ART
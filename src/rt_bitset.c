@@ -0,0 +1,938 @@
+#include "rt_bitset.h"
+#include "rt_simd.h"
+
+#define RT__BITSET_WORDS(nbits) (((nbits) + 63) >> 6)
+
+/* Bitset */
+static inline void rt__bitset_trim(RT_Bitset *bs)
+{
+    if (bs->nbits & 63) bs->words[bs->nwords - 1] &= ((uint64_t)1 << (bs->nbits & 63)) - 1;
+}
+
+bool rt_bitset_init(RT_Bitset *bs, size_t nbits)
+{
+    if (!bs) return false;
+
+    bs->words = NULL;
+    bs->nbits = 0;
+    bs->nwords = 0;
+    if (nbits == 0) return true;
+
+    bs->words = RT_CALLOC(RT__BITSET_WORDS(nbits), sizeof(uint64_t));
+    if (!bs->words) return false;
+
+    bs->nbits = nbits;
+    bs->nwords = RT__BITSET_WORDS(nbits);
+    return true;
+}
+
+void rt_bitset_free(RT_Bitset *bs)
+{
+    if (!bs) return;
+
+    RT_FREE(bs->words);
+    bs->words = NULL;
+    bs->nbits = 0;
+    bs->nwords = 0;
+}
+
+bool rt_bitset_resize(RT_Bitset *bs, size_t nbits)
+{
+    if (!bs) return false;
+
+    const size_t nwords = RT__BITSET_WORDS(nbits);
+    if (nwords == 0) {
+        rt_bitset_free(bs);
+        return true;
+    }
+    if (nwords != bs->nwords) {
+        uint64_t *words = RT_REALLOC(bs->words, nwords * sizeof(uint64_t));
+        if (!words) return false;
+        if (nwords > bs->nwords) memset(words + bs->nwords, 0, (nwords - bs->nwords) * sizeof(uint64_t));
+        bs->words = words;
+        bs->nwords = nwords;
+    }
+    bs->nbits = nbits;
+    rt__bitset_trim(bs);
+    return true;
+}
+
+void rt_bitset_set_all(RT_Bitset *bs)
+{
+    if (!bs || !bs->nwords) return;
+
+    memset(bs->words, 0xFF, bs->nwords * sizeof(uint64_t));
+    rt__bitset_trim(bs);
+}
+
+void rt_bitset_clear_all(RT_Bitset *bs)
+{
+    if (!bs || !bs->nwords) return;
+
+    memset(bs->words, 0, bs->nwords * sizeof(uint64_t));
+}
+
+size_t rt_bitset_count(const RT_Bitset *bs)
+{
+    if (!bs) return 0;
+
+    return rt__simd_popcount(bs->words, bs->nwords);
+}
+
+size_t rt_bitset_rank(const RT_Bitset *bs, size_t bit)
+{
+    if (!bs) return 0;
+    if (bit >= bs->nbits) return rt_bitset_count(bs);
+
+    size_t count = rt__simd_popcount(bs->words, bit >> 6);
+    if (bit & 63) count += rt__popcount64(bs->words[bit >> 6] & (((uint64_t)1 << (bit & 63)) - 1));
+    return count;
+}
+
+size_t rt_bitset_next(const RT_Bitset *bs, size_t from)
+{
+    if (!bs || from >= bs->nbits) return RT_NPOS;
+
+    size_t i = from >> 6;
+    uint64_t w = bs->words[i] & (~(uint64_t)0 << (from & 63));
+    while (!w) {
+        if (++i >= bs->nwords) return RT_NPOS;
+        w = bs->words[i];
+    }
+    return (i << 6) + rt__ctz64(w);
+}
+
+static bool rt__bitset_op(RT_Bitset *dst, const RT_Bitset *src, RT__BitOp op)
+{
+    if (!dst || !src) return false;
+
+    // bits of src past its end are clear, so the smaller set decides the rest
+    if ((op == RT__BIT_OR || op == RT__BIT_XOR) && src->nbits > dst->nbits) {
+        if (!rt_bitset_resize(dst, src->nbits)) return false;
+    }
+
+    const size_t n = dst->nwords < src->nwords ? dst->nwords : src->nwords;
+    rt__simd_bitwise(dst->words, dst->words, src->words, n, op);
+    if (op == RT__BIT_AND && dst->nwords > n) {
+        memset(dst->words + n, 0, (dst->nwords - n) * sizeof(uint64_t));
+    }
+    return true;
+}
+
+bool rt_bitset_and(RT_Bitset *dst, const RT_Bitset *src)
+{
+    return rt__bitset_op(dst, src, RT__BIT_AND);
+}
+
+bool rt_bitset_or(RT_Bitset *dst, const RT_Bitset *src)
+{
+    return rt__bitset_op(dst, src, RT__BIT_OR);
+}
+
+bool rt_bitset_xor(RT_Bitset *dst, const RT_Bitset *src)
+{
+    return rt__bitset_op(dst, src, RT__BIT_XOR);
+}
+
+bool rt_bitset_andnot(RT_Bitset *dst, const RT_Bitset *src)
+{
+    return rt__bitset_op(dst, src, RT__BIT_ANDNOT);
+}
+
+/* Roaring bitmap */
+#define RT__ROARING_BITMAP_BYTES (RT_ROARING_BITMAP_WORDS * sizeof(uint64_t))
+
+// a bitmap turns back into an array only at half the array limit, so a set
+// hovering around the limit does not convert on every add/remove
+#define RT__ROARING_SHRINK_AT (RT_ROARING_ARRAY_MAX / 2)
+
+// per operation buffers for containers that have to be expanded first
+typedef struct _RT__RoaringScratch {
+    uint64_t bits[2][RT_ROARING_BITMAP_WORDS];
+    uint16_t values[2][RT_ROARING_ARRAY_MAX];
+} RT__RoaringScratch;
+
+static inline uint16_t *rt__rc_values(const RT_RoaringContainer *c) { return (uint16_t*)c->data; }
+static inline uint64_t *rt__rc_bits(const RT_RoaringContainer *c) { return (uint64_t*)c->data; }
+static inline RT_RoaringRun *rt__rc_runs(const RT_RoaringContainer *c) { return (RT_RoaringRun*)c->data; }
+
+static size_t rt__u16_lower_bound(const uint16_t *a, size_t n, uint16_t v)
+{
+    size_t lo = 0;
+    while (n > 0) {
+        size_t half = n >> 1;
+        if (a[lo + half] < v) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+// index of the last run starting at or before v, RT_NPOS if there is none
+static size_t rt__runs_find(const RT_RoaringRun *runs, size_t n, uint16_t v)
+{
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) >> 1;
+        if (runs[mid].start <= v) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo ? lo - 1 : RT_NPOS;
+}
+
+static void rt__bits_set_range(uint64_t *bits, uint32_t first, uint32_t last)
+{
+    const uint32_t fw = first >> 6, lw = last >> 6;
+    const uint64_t fm = ~(uint64_t)0 << (first & 63), lm = ~(uint64_t)0 >> (63 - (last & 63));
+    if (fw == lw) {
+        bits[fw] |= fm & lm;
+        return;
+    }
+    bits[fw] |= fm;
+    for (uint32_t w = fw + 1; w < lw; ++w) bits[w] = ~(uint64_t)0;
+    bits[lw] |= lm;
+}
+
+// counts the runs of a bitmap, and stores them if `out` is given
+static uint32_t rt__bits_runs(const uint64_t *bits, RT_RoaringRun *out)
+{
+    uint32_t n = 0, i = 0;
+    uint64_t w = bits[0];
+    for (;;) {
+        while (!w && i + 1 < RT_ROARING_BITMAP_WORDS) w = bits[++i];
+        if (!w) break;
+        const uint32_t start = (i << 6) + rt__ctz64(w);
+        w |= w - 1; // fill the zeros below the run
+        while (w == ~(uint64_t)0 && i + 1 < RT_ROARING_BITMAP_WORDS) w = bits[++i];
+        const uint32_t end = w == ~(uint64_t)0 ? 0x10000 : (i << 6) + rt__ctz64(~w);
+        if (out) {
+            out[n].start = (uint16_t)start;
+            out[n].length = (uint16_t)(end - 1 - start);
+        }
+        n++;
+        if (end == 0x10000) break;
+        w &= w + 1; // drop the run
+    }
+    return n;
+}
+
+static uint32_t rt__values_runs(const uint16_t *values, uint32_t size, RT_RoaringRun *out)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < size; ++i) {
+        if (i && values[i] == values[i - 1] + 1) {
+            if (out) out[n - 1].length++;
+            continue;
+        }
+        if (out) {
+            out[n].start = values[i];
+            out[n].length = 0;
+        }
+        n++;
+    }
+    return n;
+}
+
+static void rt__rc_fill_bits(const RT_RoaringContainer *c, uint64_t *bits)
+{
+    if (c->type == RT_ROARING_BITMAP) {
+        memcpy(bits, c->data, RT__ROARING_BITMAP_BYTES);
+        return;
+    }
+
+    memset(bits, 0, RT__ROARING_BITMAP_BYTES);
+    if (c->type == RT_ROARING_ARRAY) {
+        const uint16_t *values = rt__rc_values(c);
+        for (uint32_t i = 0; i < c->size; ++i) bits[values[i] >> 6] |= (uint64_t)1 << (values[i] & 63);
+    } else {
+        const RT_RoaringRun *runs = rt__rc_runs(c);
+        for (uint32_t i = 0; i < c->size; ++i) {
+            rt__bits_set_range(bits, runs[i].start, (uint32_t)runs[i].start + runs[i].length);
+        }
+    }
+}
+
+static uint32_t rt__rc_fill_values(const RT_RoaringContainer *c, uint16_t *out)
+{
+    uint32_t n = 0;
+    if (c->type == RT_ROARING_ARRAY) {
+        memcpy(out, c->data, c->size * sizeof(uint16_t));
+        n = c->size;
+    } else if (c->type == RT_ROARING_BITMAP) {
+        const uint64_t *bits = rt__rc_bits(c);
+        for (uint32_t i = 0; i < RT_ROARING_BITMAP_WORDS; ++i) {
+            for (uint64_t w = bits[i]; w; w &= w - 1) out[n++] = (uint16_t)((i << 6) + rt__ctz64(w));
+        }
+    } else {
+        const RT_RoaringRun *runs = rt__rc_runs(c);
+        for (uint32_t i = 0; i < c->size; ++i) {
+            for (uint32_t v = runs[i].start; v <= (uint32_t)runs[i].start + runs[i].length; ++v) out[n++] = (uint16_t)v;
+        }
+    }
+    return n;
+}
+
+static bool rt__rc_to_bitmap(RT_RoaringContainer *c)
+{
+    uint64_t *bits = RT_MALLOC(RT__ROARING_BITMAP_BYTES);
+    if (!bits) return false;
+
+    rt__rc_fill_bits(c, bits);
+    RT_FREE(c->data);
+    c->data = bits;
+    c->type = RT_ROARING_BITMAP;
+    c->size = 0;
+    c->capacity = 0;
+    return true;
+}
+
+static bool rt__rc_to_array(RT_RoaringContainer *c)
+{
+    uint16_t *values = RT_MALLOC((c->cardinality ? c->cardinality : 1) * sizeof(uint16_t));
+    if (!values) return false;
+
+    rt__rc_fill_values(c, values);
+    RT_FREE(c->data);
+    c->data = values;
+    c->type = RT_ROARING_ARRAY;
+    c->size = c->cardinality;
+    c->capacity = c->cardinality ? c->cardinality : 1;
+    return true;
+}
+
+static bool rt__rc_to_runs(RT_RoaringContainer *c, uint32_t count)
+{
+    RT_RoaringRun *runs = RT_MALLOC(count * sizeof(RT_RoaringRun));
+    if (!runs) return false;
+
+    if (c->type == RT_ROARING_ARRAY) rt__values_runs(rt__rc_values(c), c->size, runs);
+    else rt__bits_runs(rt__rc_bits(c), runs);
+    RT_FREE(c->data);
+    c->data = runs;
+    c->type = RT_ROARING_RUN;
+    c->size = count;
+    c->capacity = count;
+    return true;
+}
+
+// run containers are read-only, mutations work on the array or bitmap form
+static bool rt__rc_unrun(RT_RoaringContainer *c)
+{
+    if (c->type != RT_ROARING_RUN) return true;
+    return c->cardinality <= RT_ROARING_ARRAY_MAX ? rt__rc_to_array(c) : rt__rc_to_bitmap(c);
+}
+
+// switches the container to its smallest form
+static bool rt__rc_optimize(RT_RoaringContainer *c)
+{
+    uint32_t runs;
+    switch (c->type) {
+    case RT_ROARING_ARRAY: runs = rt__values_runs(rt__rc_values(c), c->size, NULL); break;
+    case RT_ROARING_BITMAP: runs = rt__bits_runs(rt__rc_bits(c), NULL); break;
+    default: runs = c->size; break;
+    }
+
+    const size_t run_cost = runs * sizeof(RT_RoaringRun);
+    const size_t array_cost = c->cardinality <= RT_ROARING_ARRAY_MAX ? c->cardinality * sizeof(uint16_t) : SIZE_MAX;
+    if (run_cost < array_cost && run_cost < RT__ROARING_BITMAP_BYTES) {
+        return c->type == RT_ROARING_RUN || rt__rc_to_runs(c, runs);
+    }
+    if (array_cost <= RT__ROARING_BITMAP_BYTES) {
+        return c->type == RT_ROARING_ARRAY || rt__rc_to_array(c);
+    }
+    return c->type == RT_ROARING_BITMAP || rt__rc_to_bitmap(c);
+}
+
+static bool rt__rc_contains(const RT_RoaringContainer *c, uint16_t low)
+{
+    switch (c->type) {
+    case RT_ROARING_ARRAY: {
+        const size_t i = rt__u16_lower_bound(rt__rc_values(c), c->size, low);
+        return i < c->size && rt__rc_values(c)[i] == low;
+    }
+    case RT_ROARING_BITMAP:
+        return rt__rc_bits(c)[low >> 6] >> (low & 63) & 1;
+    default: {
+        const RT_RoaringRun *runs = rt__rc_runs(c);
+        const size_t i = rt__runs_find(runs, c->size, low);
+        return i != RT_NPOS && low <= (uint32_t)runs[i].start + runs[i].length;
+    }
+    }
+}
+
+static bool rt__rc_add(RT_RoaringContainer *c, uint16_t low)
+{
+    if (c->type == RT_ROARING_RUN) {
+        if (rt__rc_contains(c, low)) return true;
+        if (!rt__rc_unrun(c)) return false;
+    }
+
+    if (c->type == RT_ROARING_ARRAY) {
+        uint16_t *values = rt__rc_values(c);
+        const size_t i = rt__u16_lower_bound(values, c->size, low);
+        if (i < c->size && values[i] == low) return true;
+
+        if (c->size == RT_ROARING_ARRAY_MAX) {
+            if (!rt__rc_to_bitmap(c)) return false;
+            return rt__rc_add(c, low);
+        }
+        if (c->size == c->capacity) {
+            uint32_t capacity = c->capacity ? c->capacity * 2 : 4;
+            if (capacity > RT_ROARING_ARRAY_MAX) capacity = RT_ROARING_ARRAY_MAX;
+            values = RT_REALLOC(c->data, capacity * sizeof(uint16_t));
+            if (!values) return false;
+            c->data = values;
+            c->capacity = capacity;
+        }
+        memmove(values + i + 1, values + i, (c->size - i) * sizeof(uint16_t));
+        values[i] = low;
+        c->size++;
+        c->cardinality++;
+        return true;
+    }
+
+    uint64_t *w = &rt__rc_bits(c)[low >> 6];
+    const uint64_t bit = (uint64_t)1 << (low & 63);
+    c->cardinality += !(*w & bit);
+    *w |= bit;
+    return true;
+}
+
+static bool rt__rc_remove(RT_RoaringContainer *c, uint16_t low)
+{
+    if (!rt__rc_contains(c, low)) return false;
+    if (!rt__rc_unrun(c)) return false;
+
+    if (c->type == RT_ROARING_ARRAY) {
+        uint16_t *values = rt__rc_values(c);
+        const size_t i = rt__u16_lower_bound(values, c->size, low);
+        memmove(values + i, values + i + 1, (c->size - i - 1) * sizeof(uint16_t));
+        c->size--;
+        c->cardinality--;
+        return true;
+    }
+
+    rt__rc_bits(c)[low >> 6] &= ~((uint64_t)1 << (low & 63));
+    c->cardinality--;
+    if (c->cardinality <= RT__ROARING_SHRINK_AT) rt__rc_to_array(c); // stays a bitmap on failure
+    return true;
+}
+
+static uint32_t rt__rc_rank(const RT_RoaringContainer *c, uint16_t low)
+{
+    switch (c->type) {
+    case RT_ROARING_ARRAY:
+        return (uint32_t)rt__u16_lower_bound(rt__rc_values(c), c->size, low);
+    case RT_ROARING_BITMAP: {
+        const uint64_t *bits = rt__rc_bits(c);
+        uint32_t count = (uint32_t)rt__simd_popcount(bits, low >> 6);
+        if (low & 63) count += rt__popcount64(bits[low >> 6] & (((uint64_t)1 << (low & 63)) - 1));
+        return count;
+    }
+    default: {
+        const RT_RoaringRun *runs = rt__rc_runs(c);
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < c->size && runs[i].start < low; ++i) {
+            const uint32_t end = (uint32_t)runs[i].start + runs[i].length;
+            count += (end < low ? end + 1 : low) - runs[i].start;
+        }
+        return count;
+    }
+    }
+}
+
+static bool rt__rc_copy(RT_RoaringContainer *dst, const RT_RoaringContainer *src)
+{
+    size_t bytes;
+    switch (src->type) {
+    case RT_ROARING_ARRAY: bytes = src->size * sizeof(uint16_t); break;
+    case RT_ROARING_BITMAP: bytes = RT__ROARING_BITMAP_BYTES; break;
+    default: bytes = src->size * sizeof(RT_RoaringRun); break;
+    }
+
+    *dst = *src;
+    dst->data = RT_MALLOC(bytes ? bytes : 1);
+    if (!dst->data) return false;
+
+    memcpy(dst->data, src->data, bytes);
+    dst->capacity = src->type == RT_ROARING_BITMAP ? 0 : src->size;
+    return true;
+}
+
+// index of the first container with a key >= `key`
+static size_t rt__roaring_find(const RT_Roaring *set, uint16_t key)
+{
+    size_t lo = 0, hi = set->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) >> 1;
+        if (set->containers[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static RT_RoaringContainer *rt__roaring_insert_at(RT_Roaring *set, size_t pos, uint16_t key)
+{
+    if (set->count == set->capacity) {
+        const size_t capacity = set->capacity ? set->capacity * 2 : 4;
+        RT_RoaringContainer *containers = RT_REALLOC(set->containers, capacity * sizeof(RT_RoaringContainer));
+        if (!containers) return NULL;
+        set->containers = containers;
+        set->capacity = capacity;
+    }
+
+    RT_RoaringContainer *c = &set->containers[pos];
+    memmove(c + 1, c, (set->count - pos) * sizeof(RT_RoaringContainer));
+    memset(c, 0, sizeof(*c));
+    c->key = key;
+    c->type = RT_ROARING_ARRAY;
+    set->count++;
+    return c;
+}
+
+static void rt__roaring_remove_at(RT_Roaring *set, size_t pos)
+{
+    RT_FREE(set->containers[pos].data);
+    memmove(&set->containers[pos], &set->containers[pos + 1], (set->count - pos - 1) * sizeof(RT_RoaringContainer));
+    set->count--;
+}
+
+// container for `key`, created empty if needed
+static RT_RoaringContainer *rt__roaring_get_or_insert(RT_Roaring *set, uint16_t key, size_t *pos)
+{
+    *pos = rt__roaring_find(set, key);
+    if (*pos < set->count && set->containers[*pos].key == key) return &set->containers[*pos];
+    return rt__roaring_insert_at(set, *pos, key);
+}
+
+bool rt_roaring_init(RT_Roaring *set)
+{
+    if (!set) return false;
+
+    set->containers = NULL;
+    set->count = 0;
+    set->capacity = 0;
+    return true;
+}
+
+void rt_roaring_clear(RT_Roaring *set)
+{
+    if (!set) return;
+
+    for (size_t i = 0; i < set->count; ++i) RT_FREE(set->containers[i].data);
+    set->count = 0;
+}
+
+void rt_roaring_free(RT_Roaring *set)
+{
+    if (!set) return;
+
+    rt_roaring_clear(set);
+    RT_FREE(set->containers);
+    set->containers = NULL;
+    set->capacity = 0;
+}
+
+bool rt_roaring_add(RT_Roaring *set, uint32_t value)
+{
+    if (!set) return false;
+
+    size_t pos;
+    RT_RoaringContainer *c = rt__roaring_get_or_insert(set, (uint16_t)(value >> 16), &pos);
+    if (!c) return false;
+    if (rt__rc_add(c, (uint16_t)value)) return true;
+
+    if (c->cardinality == 0) rt__roaring_remove_at(set, pos);
+    return false;
+}
+
+bool rt_roaring_add_range(RT_Roaring *set, uint32_t first, uint32_t last)
+{
+    if (!set || first > last) return false;
+
+    for (uint32_t key = first >> 16; key <= last >> 16; ++key) {
+        const uint32_t lo = key == first >> 16 ? (first & 0xFFFF) : 0;
+        const uint32_t hi = key == last >> 16 ? (last & 0xFFFF) : 0xFFFF;
+
+        size_t pos;
+        RT_RoaringContainer *c = rt__roaring_get_or_insert(set, (uint16_t)key, &pos);
+        if (!c) return false;
+
+        if (lo == 0 && hi == 0xFFFF) {
+            RT_RoaringRun *run = RT_MALLOC(sizeof(RT_RoaringRun));
+            if (!run) goto fail;
+            run->start = 0;
+            run->length = 0xFFFF;
+            RT_FREE(c->data);
+            c->data = run;
+            c->type = RT_ROARING_RUN;
+            c->size = 1;
+            c->capacity = 1;
+            c->cardinality = 0x10000;
+            continue;
+        }
+
+        if (c->type != RT_ROARING_BITMAP && !rt__rc_to_bitmap(c)) goto fail;
+        rt__bits_set_range(rt__rc_bits(c), lo, hi);
+        c->cardinality = (uint32_t)rt__simd_popcount(rt__rc_bits(c), RT_ROARING_BITMAP_WORDS);
+        rt__rc_optimize(c);
+        continue;
+
+    fail:
+        if (c->cardinality == 0) rt__roaring_remove_at(set, pos);
+        return false;
+    }
+    return true;
+}
+
+bool rt_roaring_remove(RT_Roaring *set, uint32_t value)
+{
+    if (!set) return false;
+
+    const size_t pos = rt__roaring_find(set, (uint16_t)(value >> 16));
+    if (pos == set->count || set->containers[pos].key != (uint16_t)(value >> 16)) return false;
+
+    RT_RoaringContainer *c = &set->containers[pos];
+    if (!rt__rc_remove(c, (uint16_t)value)) return false;
+    if (c->cardinality == 0) rt__roaring_remove_at(set, pos);
+    return true;
+}
+
+bool rt_roaring_contains(const RT_Roaring *set, uint32_t value)
+{
+    if (!set) return false;
+
+    const size_t pos = rt__roaring_find(set, (uint16_t)(value >> 16));
+    if (pos == set->count || set->containers[pos].key != (uint16_t)(value >> 16)) return false;
+    return rt__rc_contains(&set->containers[pos], (uint16_t)value);
+}
+
+uint64_t rt_roaring_cardinality(const RT_Roaring *set)
+{
+    if (!set) return 0;
+
+    uint64_t count = 0;
+    for (size_t i = 0; i < set->count; ++i) count += set->containers[i].cardinality;
+    return count;
+}
+
+uint64_t rt_roaring_rank(const RT_Roaring *set, uint32_t value)
+{
+    if (!set) return 0;
+
+    const uint16_t key = (uint16_t)(value >> 16);
+    uint64_t count = 0;
+    size_t i = 0;
+    for (; i < set->count && set->containers[i].key < key; ++i) count += set->containers[i].cardinality;
+    if (i < set->count && set->containers[i].key == key) count += rt__rc_rank(&set->containers[i], (uint16_t)value);
+    return count;
+}
+
+void rt_roaring_run_optimize(RT_Roaring *set)
+{
+    if (!set) return;
+
+    // a container that cannot be converted just keeps its current form
+    for (size_t i = 0; i < set->count; ++i) rt__rc_optimize(&set->containers[i]);
+}
+
+size_t rt_roaring_memory_usage(const RT_Roaring *set)
+{
+    if (!set) return 0;
+
+    size_t bytes = sizeof(*set) + set->capacity * sizeof(RT_RoaringContainer);
+    for (size_t i = 0; i < set->count; ++i) {
+        const RT_RoaringContainer *c = &set->containers[i];
+        switch (c->type) {
+        case RT_ROARING_ARRAY: bytes += c->capacity * sizeof(uint16_t); break;
+        case RT_ROARING_BITMAP: bytes += RT__ROARING_BITMAP_BYTES; break;
+        default: bytes += c->capacity * sizeof(RT_RoaringRun); break;
+        }
+    }
+    return bytes;
+}
+
+/* Set operations
+ * Run containers are expanded into scratch buffers first, so the kernels
+ * only see arrays and bitmaps. Array/array merges stay arrays while the
+ * result fits, everything else goes through a bitmap. */
+static const RT_RoaringContainer *rt__rc_view(const RT_RoaringContainer *c, RT_RoaringContainer *tmp, uint64_t *bits, uint16_t *values)
+{
+    if (c->type != RT_ROARING_RUN) return c;
+
+    *tmp = *c;
+    if (c->cardinality <= RT_ROARING_ARRAY_MAX) {
+        rt__rc_fill_values(c, values);
+        tmp->data = values;
+        tmp->type = RT_ROARING_ARRAY;
+        tmp->size = c->cardinality;
+    } else {
+        rt__rc_fill_bits(c, bits);
+        tmp->data = bits;
+        tmp->type = RT_ROARING_BITMAP;
+        tmp->size = 0;
+    }
+    return tmp;
+}
+
+static uint32_t rt__u16_intersect(const uint16_t *a, uint32_t na, const uint16_t *b, uint32_t nb, uint16_t *out)
+{
+    uint32_t n = 0, i = 0, j = 0;
+    if (na > nb) {
+        const uint16_t *t = a; a = b; b = t;
+        uint32_t tn = na; na = nb; nb = tn;
+    }
+
+    // much smaller side: binary search the other instead of walking it
+    if ((size_t)na * 32 < nb) {
+        for (; i < na && j < nb; ++i) {
+            j += (uint32_t)rt__u16_lower_bound(b + j, nb - j, a[i]);
+            if (j < nb && b[j] == a[i]) out[n++] = a[i];
+        }
+        return n;
+    }
+
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) i++;
+        else if (a[i] > b[j]) j++;
+        else {
+            out[n++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return n;
+}
+
+static uint32_t rt__u16_merge(const uint16_t *a, uint32_t na, const uint16_t *b, uint32_t nb, uint16_t *out, RT__BitOp op)
+{
+    uint32_t n = 0, i = 0, j = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            out[n++] = a[i++];
+        } else if (a[i] > b[j]) {
+            if (op != RT__BIT_ANDNOT) out[n++] = b[j];
+            j++;
+        } else {
+            if (op == RT__BIT_OR) out[n++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    while (i < na) out[n++] = a[i++];
+    if (op != RT__BIT_ANDNOT) {
+        while (j < nb) out[n++] = b[j++];
+    }
+    return n;
+}
+
+static bool rt__rc_op(RT_RoaringContainer *out, const RT_RoaringContainer *a, const RT_RoaringContainer *b, RT__BitOp op, RT__RoaringScratch *scratch)
+{
+    const bool a_array = a->type == RT_ROARING_ARRAY, b_array = b->type == RT_ROARING_ARRAY;
+
+    if (a_array && (b_array || op == RT__BIT_AND || op == RT__BIT_ANDNOT)) {
+        const bool filter = !b_array;
+        uint32_t limit = a->size;
+        if (b_array && (op == RT__BIT_OR || op == RT__BIT_XOR)) limit += b->size;
+        if (limit <= RT_ROARING_ARRAY_MAX) {
+            uint16_t *values = RT_MALLOC((limit ? limit : 1) * sizeof(uint16_t));
+            if (!values) return false;
+
+            const uint16_t *av = rt__rc_values(a);
+            uint32_t n = 0;
+            if (filter) {
+                // array against bitmap: probe the bits
+                const uint64_t *bits = rt__rc_bits(b);
+                const uint64_t keep = op == RT__BIT_AND ? 1 : 0;
+                for (uint32_t i = 0; i < a->size; ++i) {
+                    values[n] = av[i];
+                    n += (bits[av[i] >> 6] >> (av[i] & 63) & 1) == keep;
+                }
+            } else if (op == RT__BIT_AND) {
+                n = rt__u16_intersect(av, a->size, rt__rc_values(b), b->size, values);
+            } else {
+                n = rt__u16_merge(av, a->size, rt__rc_values(b), b->size, values, op);
+            }
+            out->data = values;
+            out->type = RT_ROARING_ARRAY;
+            out->size = n;
+            out->capacity = limit ? limit : 1;
+            out->cardinality = n;
+            return true;
+        }
+    }
+    if (b_array && !a_array && op == RT__BIT_AND) return rt__rc_op(out, b, a, op, scratch);
+
+    uint64_t *bits = RT_MALLOC(RT__ROARING_BITMAP_BYTES);
+    if (!bits) return false;
+
+    const uint64_t *ab = rt__rc_bits(a), *bb = rt__rc_bits(b);
+    if (a_array) {
+        rt__rc_fill_bits(a, scratch->bits[0]);
+        ab = scratch->bits[0];
+    }
+    if (b_array) {
+        rt__rc_fill_bits(b, scratch->bits[1]);
+        bb = scratch->bits[1];
+    }
+    out->data = bits;
+    out->type = RT_ROARING_BITMAP;
+    out->size = 0;
+    out->capacity = 0;
+    out->cardinality = (uint32_t)rt__simd_bitwise(bits, ab, bb, RT_ROARING_BITMAP_WORDS, op);
+    if (out->cardinality && out->cardinality <= RT_ROARING_ARRAY_MAX) rt__rc_to_array(out);
+    return true;
+}
+
+static bool rt__roaring_push(RT_Roaring *set, const RT_RoaringContainer *c)
+{
+    RT_RoaringContainer *slot = rt__roaring_insert_at(set, set->count, c->key);
+    if (!slot) return false;
+
+    *slot = *c;
+    return true;
+}
+
+static bool rt__roaring_op(RT_Roaring *dst, const RT_Roaring *a, const RT_Roaring *b, RT__BitOp op)
+{
+    if (!dst || !a || !b) return false;
+
+    RT__RoaringScratch *scratch = RT_MALLOC(sizeof(RT__RoaringScratch));
+    if (!scratch) return false;
+
+    RT_Roaring result;
+    rt_roaring_init(&result);
+
+    size_t i = 0, j = 0;
+    while (i < a->count || j < b->count) {
+        const RT_RoaringContainer *ca = i < a->count ? &a->containers[i] : NULL;
+        const RT_RoaringContainer *cb = j < b->count ? &b->containers[j] : NULL;
+        RT_RoaringContainer out = {0};
+
+        if (ca && (!cb || ca->key < cb->key)) {
+            i++;
+            if (op == RT__BIT_AND) continue;
+            if (!rt__rc_copy(&out, ca)) goto fail;
+        } else if (!ca || cb->key < ca->key) {
+            j++;
+            if (op == RT__BIT_AND || op == RT__BIT_ANDNOT) continue;
+            if (!rt__rc_copy(&out, cb)) goto fail;
+        } else {
+            RT_RoaringContainer ta, tb;
+            ca = rt__rc_view(ca, &ta, scratch->bits[0], scratch->values[0]);
+            cb = rt__rc_view(cb, &tb, scratch->bits[1], scratch->values[1]);
+            out.key = ca->key;
+            i++;
+            j++;
+            if (!rt__rc_op(&out, ca, cb, op, scratch)) goto fail;
+        }
+
+        if (out.cardinality == 0) {
+            RT_FREE(out.data);
+            continue;
+        }
+        if (!rt__roaring_push(&result, &out)) {
+            RT_FREE(out.data);
+            goto fail;
+        }
+    }
+
+    RT_FREE(scratch);
+    rt_roaring_free(dst);
+    *dst = result;
+    return true;
+
+fail:
+    RT_FREE(scratch);
+    rt_roaring_free(&result);
+    return false;
+}
+
+bool rt_roaring_and(RT_Roaring *dst, const RT_Roaring *a, const RT_Roaring *b)
+{
+    return rt__roaring_op(dst, a, b, RT__BIT_AND);
+}
+
+bool rt_roaring_or(RT_Roaring *dst, const RT_Roaring *a, const RT_Roaring *b)
+{
+    return rt__roaring_op(dst, a, b, RT__BIT_OR);
+}
+
+bool rt_roaring_xor(RT_Roaring *dst, const RT_Roaring *a, const RT_Roaring *b)
+{
+    return rt__roaring_op(dst, a, b, RT__BIT_XOR);
+}
+
+bool rt_roaring_andnot(RT_Roaring *dst, const RT_Roaring *a, const RT_Roaring *b)
+{
+    return rt__roaring_op(dst, a, b, RT__BIT_ANDNOT);
+}
+
+/* Iteration */
+static void rt__roaring_iter_enter(RT_RoaringIter *it, size_t container)
+{
+    it->container = container;
+    it->index = 0;
+    it->offset = 0;
+    it->word = 0;
+    if (container < it->set->count && it->set->containers[container].type == RT_ROARING_BITMAP) {
+        it->word = rt__rc_bits(&it->set->containers[container])[0];
+    }
+}
+
+void rt_roaring_iter_init(RT_RoaringIter *it, const RT_Roaring *set)
+{
+    if (!it) return;
+
+    it->set = set;
+    if (set) rt__roaring_iter_enter(it, 0);
+    else it->container = 0;
+}
+
+bool rt_roaring_iter_next(RT_RoaringIter *it, uint32_t *value)
+{
+    if (!it || !it->set) return false;
+
+    while (it->container < it->set->count) {
+        const RT_RoaringContainer *c = &it->set->containers[it->container];
+        const uint32_t high = (uint32_t)c->key << 16;
+
+        switch (c->type) {
+        case RT_ROARING_ARRAY:
+            if (it->index < c->size) {
+                if (value) *value = high | rt__rc_values(c)[it->index];
+                it->index++;
+                return true;
+            }
+            break;
+        case RT_ROARING_BITMAP:
+            for (;;) {
+                if (it->word) {
+                    if (value) *value = high | ((it->index << 6) + rt__ctz64(it->word));
+                    it->word &= it->word - 1;
+                    return true;
+                }
+                if (++it->index >= RT_ROARING_BITMAP_WORDS) break;
+                it->word = rt__rc_bits(c)[it->index];
+            }
+            break;
+        default:
+            if (it->index < c->size) {
+                const RT_RoaringRun *run = &rt__rc_runs(c)[it->index];
+                if (value) *value = high | (run->start + it->offset);
+                if (it->offset++ == run->length) {
+                    it->index++;
+                    it->offset = 0;
+                }
+                return true;
+            }
+            break;
+        }
+
+        rt__roaring_iter_enter(it, it->container + 1);
+    }
+    return false;
+}
@@ -0,0 +1,134 @@
+#ifndef _INC_RT_BITSET
+#define _INC_RT_BITSET
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+
+/* Bitset
+ * One bit per possible member of a dense ID range (PIDs, block numbers).
+ * Test/set are a shift and a mask, count and rank are popcounts over the
+ * words, and the set operations work a word (or four, with AVX2) at a time.
+ * Bits past nbits are kept clear. */
+typedef struct _RT_Bitset {
+    uint64_t *words;
+    size_t nbits;
+    size_t nwords;
+} RT_Bitset;
+
+bool rt_bitset_init(RT_Bitset *bs, size_t nbits);
+void rt_bitset_free(RT_Bitset *bs);
+bool rt_bitset_resize(RT_Bitset *bs, size_t nbits); // new bits start cleared
+void rt_bitset_set_all(RT_Bitset *bs);
+void rt_bitset_clear_all(RT_Bitset *bs);
+size_t rt_bitset_count(const RT_Bitset *bs);
+size_t rt_bitset_rank(const RT_Bitset *bs, size_t bit); // set bits below `bit`
+size_t rt_bitset_next(const RT_Bitset *bs, size_t from); // first set bit >= from, RT_NPOS if none
+
+/* In-place dst = dst op src. OR and XOR grow dst to src's size, AND clears
+ * the bits of dst past the end of src. */
+bool rt_bitset_and(RT_Bitset *dst, const RT_Bitset *src);
+bool rt_bitset_or(RT_Bitset *dst, const RT_Bitset *src);
+bool rt_bitset_xor(RT_Bitset *dst, const RT_Bitset *src);
+bool rt_bitset_andnot(RT_Bitset *dst, const RT_Bitset *src);
+
+static inline bool rt_bitset_test(const RT_Bitset *bs, size_t bit)
+{
+    return bit < bs->nbits && (bs->words[bit >> 6] >> (bit & 63) & 1);
+}
+
+static inline bool rt_bitset_set(RT_Bitset *bs, size_t bit)
+{
+    if (bit >= bs->nbits) return false;
+    bs->words[bit >> 6] |= (uint64_t)1 << (bit & 63);
+    return true;
+}
+
+static inline bool rt_bitset_reset(RT_Bitset *bs, size_t bit)
+{
+    if (bit >= bs->nbits) return false;
+    bs->words[bit >> 6] &= ~((uint64_t)1 << (bit & 63));
+    return true;
+}
+
+static inline bool rt_bitset_flip(RT_Bitset *bs, size_t bit)
+{
+    if (bit >= bs->nbits) return false;
+    bs->words[bit >> 6] ^= (uint64_t)1 << (bit & 63);
+    return true;
+}
+
+/* Roaring bitmap
+ * Compressed set of 32-bit values. Values are bucketed by their high 16 bits
+ * into containers, each stored as whichever form suits its contents:
+ *   - array:  sorted uint16_t low halves, up to RT_ROARING_ARRAY_MAX of them
+ *   - bitmap: 65536 bits, for denser buckets
+ *   - run:    sorted [start, start + length] intervals, built by
+ *             rt_roaring_run_optimize() and rt_roaring_add_range()
+ * A sparse set costs about 2 bytes per member, a dense one 1 bit. Adding to
+ * or removing from a run container turns it back into an array or bitmap.
+ * Set operations between bitmap containers use the bitset kernels. */
+#define RT_ROARING_ARRAY_MAX 4096
+#define RT_ROARING_BITMAP_WORDS 1024
+
+#define RT_ROARING_ARRAY  0
+#define RT_ROARING_BITMAP 1
+#define RT_ROARING_RUN    2
+
+typedef struct _RT_RoaringRun {
+    uint16_t start;
+    uint16_t length; // the run covers start..start + length inclusive
+} RT_RoaringRun;
+
+typedef struct _RT_RoaringContainer {
+    void *data;           // uint16_t[], uint64_t[RT_ROARING_BITMAP_WORDS] or RT_RoaringRun[]
+    uint32_t cardinality;
+    uint32_t size;        // array values or runs
+    uint32_t capacity;    // array values or runs allocated
+    uint16_t key;         // high 16 bits of every value in here
+    uint8_t type;
+} RT_RoaringContainer;
+
+typedef struct _RT_Roaring {
+    RT_RoaringContainer *containers; // sorted by key
+    size_t count;
+    size_t capacity;
+} RT_Roaring;
+
+typedef struct _RT_RoaringIter {
+    const RT_Roaring *set;
+    size_t container;
+    uint32_t index;  // array slot, bitmap word or run
+    uint32_t offset; // position inside the current run
+    uint64_t word;   // bits of the current bitmap word not visited yet
+} RT_RoaringIter;
+
+bool rt_roaring_init(RT_Roaring *set);
+void rt_roaring_free(RT_Roaring *set);
+void rt_roaring_clear(RT_Roaring *set);
+bool rt_roaring_add(RT_Roaring *set, uint32_t value);
+bool rt_roaring_add_range(RT_Roaring *set, uint32_t first, uint32_t last); // inclusive
+bool rt_roaring_remove(RT_Roaring *set, uint32_t value);
+bool rt_roaring_contains(const RT_Roaring *set, uint32_t value);
+uint64_t rt_roaring_cardinality(const RT_Roaring *set);
+uint64_t rt_roaring_rank(const RT_Roaring *set, uint32_t value); // members below `value`
+void rt_roaring_run_optimize(RT_Roaring *set);
+size_t rt_roaring_memory_usage(const RT_Roaring *set);
+
+/* dst = a op b. dst must be initialized and may be a or b. */
+bool rt_roaring_and(RT_Roaring *dst, const RT_Roaring *a, const RT_Roaring *b);
+bool rt_roaring_or(RT_Roaring *dst, const RT_Roaring *a, const RT_Roaring *b);
+bool rt_roaring_xor(RT_Roaring *dst, const RT_Roaring *a, const RT_Roaring *b);
+bool rt_roaring_andnot(RT_Roaring *dst, const RT_Roaring *a, const RT_Roaring *b);
+
+// ascending order, the set must not change during the walk
+void rt_roaring_iter_init(RT_RoaringIter *it, const RT_Roaring *set);
+bool rt_roaring_iter_next(RT_RoaringIter *it, uint32_t *value);
+
+static inline bool rt_roaring_is_empty(const RT_Roaring *set)
+{
+    return !set || set->count == 0;
+}
+
+#endif // _INC_RT_BITSET
@@ -0,0 +1,784 @@
+#include "rt_btree.h"
+
+// a full leaf holds ORDER + 1 keys when it splits, the left half keeps this many
+#define RT__BT_LEAF_SPLIT ((RT_BTREE_ORDER + 1) / 2)
+
+typedef struct _RT__BTKey {
+    uint64_t k;    // integer key or big-endian 8 byte prefix
+    const char *s; // full key, string trees only
+} RT__BTKey;
+
+static inline uint64_t rt__bt_prefix(const char *s)
+{
+    uint64_t p = 0;
+    for (int i = 0; i < 8 && s[i]; ++i) {
+        p |= (uint64_t)(unsigned char)s[i] << (56 - 8 * i);
+    }
+    return p;
+}
+
+static inline RT__BTKey rt__bt_key_str(const char *s)
+{
+    RT__BTKey key = {rt__bt_prefix(s), s};
+    return key;
+}
+
+static inline RT__BTKey rt__bt_key_u64(uint64_t k)
+{
+    RT__BTKey key = {k, NULL};
+    return key;
+}
+
+static char *rt__bt_strdup(const char *s)
+{
+    size_t size = strlen(s) + 1;
+    char *copy = RT_MALLOC(size);
+    if (copy) memcpy(copy, s, size);
+    return copy;
+}
+
+static inline int rt__bt_cmp(const RT_BTNode *node, size_t i, const RT__BTKey *key)
+{
+    uint64_t k = node->keys[i];
+    if (k != key->k) return k < key->k ? -1 : 1;
+
+    // equal prefixes with a NUL inside them are equal strings
+    if (!key->s || (k & 0xFF) == 0) return 0;
+    return strcmp(node->skeys[i] + 8, key->s + 8);
+}
+
+// first slot whose key is >= key (upper: > key)
+static inline size_t rt__bt_search(const RT_BTNode *node, const RT__BTKey *key, bool upper)
+{
+    size_t lo = 0, len = node->count;
+
+    if (!key->s) { // integer keys: branch-free over the contiguous key array
+        const uint64_t *keys = node->keys;
+        uint64_t k = key->k;
+        if (upper) {
+            while (len > 1) {
+                size_t half = len / 2;
+                lo += (keys[lo + half - 1] <= k) ? half : 0;
+                len -= half;
+            }
+            return lo + (len == 1 && keys[lo] <= k);
+        }
+        while (len > 1) {
+            size_t half = len / 2;
+            lo += (keys[lo + half - 1] < k) ? half : 0;
+            len -= half;
+        }
+        return lo + (len == 1 && keys[lo] < k);
+    }
+
+    while (len > 0) {
+        size_t half = len / 2;
+        int c = rt__bt_cmp(node, lo + half, key);
+        if (c < 0 || (upper && c == 0)) {
+            lo += half + 1;
+            len -= half + 1;
+        } else {
+            len = half;
+        }
+    }
+    return lo;
+}
+
+static RT_BTNode *rt__bt_node_new(RT_BTree *tree, bool leaf)
+{
+    size_t slots = RT_BTREE_ORDER + 1;
+    size_t size = sizeof(RT_BTNode);
+    size_t skeys_offset = size;
+    if (tree->key_type == RT_BTREE_KEY_STR) size += slots * sizeof(char *);
+    size_t tail_offset = size;
+    size += leaf ? slots * tree->value_size : (slots + 1) * sizeof(RT_BTNode *);
+
+    RT_BTNode *node = RT_MALLOC(size);
+    if (!node) return NULL;
+
+    memset(node, 0, sizeof(RT_BTNode));
+    node->leaf = leaf;
+    if (tree->key_type == RT_BTREE_KEY_STR) node->skeys = (char **)((uint8_t *)node + skeys_offset);
+    if (leaf) {
+        node->values = tree->value_size ? (uint8_t *)node + tail_offset : NULL;
+    } else {
+        node->children = (RT_BTNode **)((uint8_t *)node + tail_offset);
+    }
+
+    return node;
+}
+
+static void rt__bt_node_free(RT_BTNode *node)
+{
+    if (!node) return;
+
+    if (node->skeys) {
+        for (size_t i = 0; i < node->count; ++i) RT_FREE(node->skeys[i]);
+    }
+    if (!node->leaf) {
+        for (size_t i = 0; i <= node->count; ++i) rt__bt_node_free(node->children[i]);
+    }
+
+    RT_FREE(node);
+}
+
+static void rt__bt_free_range(RT_BTNode **nodes, size_t from, size_t to)
+{
+    for (size_t i = from; i < to; ++i) rt__bt_node_free(nodes[i]);
+}
+
+static RT_BTNode *rt__bt_descend(RT_BTree *tree, const RT__BTKey *key, RT_BTNode **path, size_t *slots, size_t *depth)
+{
+    RT_BTNode *node = tree->root;
+    size_t d = 0;
+
+    while (!node->leaf) {
+        size_t i = rt__bt_search(node, key, true);
+        if (path) {
+            path[d] = node;
+            slots[d] = i;
+        }
+        d++;
+        node = node->children[i];
+    }
+
+    if (depth) *depth = d;
+    return node;
+}
+
+static void rt__bt_leaf_insert_at(RT_BTree *tree, RT_BTNode *leaf, size_t pos, uint64_t k, char *s, const void *value)
+{
+    size_t tail = leaf->count - pos, vs = tree->value_size;
+
+    memmove(&leaf->keys[pos + 1], &leaf->keys[pos], tail * sizeof(uint64_t));
+    leaf->keys[pos] = k;
+    if (leaf->skeys) {
+        memmove(&leaf->skeys[pos + 1], &leaf->skeys[pos], tail * sizeof(char *));
+        leaf->skeys[pos] = s;
+    }
+    if (vs) {
+        memmove(leaf->values + (pos + 1) * vs, leaf->values + pos * vs, tail * vs);
+        memcpy(leaf->values + pos * vs, value, vs);
+    }
+
+    leaf->count++;
+}
+
+// does not free the key string
+static void rt__bt_leaf_erase_at(RT_BTree *tree, RT_BTNode *leaf, size_t pos)
+{
+    size_t tail = leaf->count - pos - 1, vs = tree->value_size;
+
+    memmove(&leaf->keys[pos], &leaf->keys[pos + 1], tail * sizeof(uint64_t));
+    if (leaf->skeys) memmove(&leaf->skeys[pos], &leaf->skeys[pos + 1], tail * sizeof(char *));
+    if (vs) memmove(leaf->values + pos * vs, leaf->values + (pos + 1) * vs, tail * vs);
+
+    leaf->count--;
+}
+
+// separator goes to slot `pos`, the new child right after it
+static void rt__bt_internal_insert_at(RT_BTNode *node, size_t pos, uint64_t k, char *s, RT_BTNode *child)
+{
+    size_t tail = node->count - pos;
+
+    memmove(&node->keys[pos + 1], &node->keys[pos], tail * sizeof(uint64_t));
+    node->keys[pos] = k;
+    if (node->skeys) {
+        memmove(&node->skeys[pos + 1], &node->skeys[pos], tail * sizeof(char *));
+        node->skeys[pos] = s;
+    }
+    memmove(&node->children[pos + 2], &node->children[pos + 1], tail * sizeof(RT_BTNode *));
+    node->children[pos + 1] = child;
+
+    node->count++;
+}
+
+// drops separator `pos` and the child right after it
+static void rt__bt_internal_erase_at(RT_BTNode *node, size_t pos)
+{
+    size_t tail = node->count - pos - 1;
+
+    memmove(&node->keys[pos], &node->keys[pos + 1], tail * sizeof(uint64_t));
+    if (node->skeys) memmove(&node->skeys[pos], &node->skeys[pos + 1], tail * sizeof(char *));
+    memmove(&node->children[pos + 1], &node->children[pos + 2], tail * sizeof(RT_BTNode *));
+
+    node->count--;
+}
+
+/* Moves the upper half of an overflowing node into `right`. For leaves the
+ * caller has already copied the separator string into *sep_s. */
+static void rt__bt_split(RT_BTree *tree, RT_BTNode *node, RT_BTNode *right, uint64_t *sep_k, char **sep_s)
+{
+    size_t n = node->count;
+
+    if (node->leaf) {
+        size_t lcount = RT__BT_LEAF_SPLIT, rcount = n - lcount, vs = tree->value_size;
+
+        memcpy(right->keys, node->keys + lcount, rcount * sizeof(uint64_t));
+        if (node->skeys) memcpy(right->skeys, node->skeys + lcount, rcount * sizeof(char *));
+        if (vs) memcpy(right->values, node->values + lcount * vs, rcount * vs);
+        node->count = (uint32_t)lcount;
+        right->count = (uint32_t)rcount;
+
+        right->prev = node;
+        right->next = node->next;
+        if (node->next) node->next->prev = right;
+        else tree->last = right;
+        node->next = right;
+
+        *sep_k = right->keys[0];
+        return;
+    }
+
+    size_t mid = n / 2, rcount = n - mid - 1;
+
+    memcpy(right->keys, node->keys + mid + 1, rcount * sizeof(uint64_t));
+    if (node->skeys) memcpy(right->skeys, node->skeys + mid + 1, rcount * sizeof(char *));
+    memcpy(right->children, node->children + mid + 1, (rcount + 1) * sizeof(RT_BTNode *));
+
+    *sep_k = node->keys[mid];
+    *sep_s = node->skeys ? node->skeys[mid] : NULL;
+    node->count = (uint32_t)mid;
+    right->count = (uint32_t)rcount;
+}
+
+static bool rt__bt_insert(RT_BTree *tree, const RT__BTKey *key, const void *value)
+{
+    RT_BTNode *path[RT_BTREE_MAX_DEPTH];
+    size_t slots[RT_BTREE_MAX_DEPTH];
+    size_t depth, vs = tree->value_size;
+
+    RT_BTNode *leaf = rt__bt_descend(tree, key, path, slots, &depth);
+    size_t pos = rt__bt_search(leaf, key, false);
+
+    if (pos < leaf->count && rt__bt_cmp(leaf, pos, key) == 0) { // update if exists
+        if (vs) memcpy(leaf->values + pos * vs, value, vs);
+        return true;
+    }
+
+    // allocate everything the insert needs up front so a failure leaves the tree untouched
+    RT_BTNode *spare[RT_BTREE_MAX_DEPTH + 1];
+    size_t splits = 0, nodes, allocated = 0;
+    char *skey = NULL, *sep = NULL;
+
+    if (leaf->count >= RT_BTREE_ORDER) {
+        splits = 1;
+        while (splits <= depth && path[depth - splits]->count >= RT_BTREE_ORDER) splits++;
+    }
+    nodes = splits + (splits > depth); // splitting the root adds a level
+
+    for (; allocated < nodes; ++allocated) {
+        spare[allocated] = rt__bt_node_new(tree, allocated == 0);
+        if (!spare[allocated]) break;
+    }
+    if (key->s) {
+        skey = rt__bt_strdup(key->s);
+        if (splits) { // the key that will start the right leaf after the insert
+            size_t at = RT__BT_LEAF_SPLIT;
+            sep = rt__bt_strdup(pos > at ? leaf->skeys[at] : pos == at ? key->s : leaf->skeys[at - 1]);
+        }
+    }
+    if (allocated < nodes || (key->s && (!skey || (splits && !sep)))) {
+        rt__bt_free_range(spare, 0, allocated);
+        RT_FREE(skey);
+        RT_FREE(sep);
+        return false;
+    }
+
+    rt__bt_leaf_insert_at(tree, leaf, pos, key->k, skey, value);
+    tree->size++;
+
+    RT_BTNode *node = leaf;
+    for (size_t i = 0; i < splits; ++i) {
+        RT_BTNode *right = spare[i];
+        uint64_t sep_k;
+        char *sep_s = sep;
+
+        rt__bt_split(tree, node, right, &sep_k, &sep_s);
+
+        if (i < depth) {
+            RT_BTNode *parent = path[depth - 1 - i];
+            rt__bt_internal_insert_at(parent, slots[depth - 1 - i], sep_k, sep_s, right);
+            node = parent;
+        } else {
+            RT_BTNode *root = spare[i + 1];
+            root->keys[0] = sep_k;
+            if (root->skeys) root->skeys[0] = sep_s;
+            root->children[0] = node;
+            root->children[1] = right;
+            root->count = 1;
+            tree->root = root;
+        }
+    }
+
+    return true;
+}
+
+static void rt__bt_borrow_left(RT_BTree *tree, RT_BTNode *parent, size_t i)
+{
+    RT_BTNode *node = parent->children[i];
+    RT_BTNode *left = parent->children[i - 1];
+    size_t last = left->count - 1, vs = tree->value_size;
+
+    if (node->leaf) {
+        char *sep = NULL;
+        if (left->skeys && !(sep = rt__bt_strdup(left->skeys[last]))) return; // stay underfull
+
+        rt__bt_leaf_insert_at(tree, node, 0, left->keys[last], left->skeys ? left->skeys[last] : NULL,
+                              vs ? left->values + last * vs : NULL);
+        left->count--;
+
+        parent->keys[i - 1] = node->keys[0];
+        if (sep) {
+            RT_FREE(parent->skeys[i - 1]);
+            parent->skeys[i - 1] = sep;
+        }
+        return;
+    }
+
+    size_t n = node->count;
+    memmove(&node->keys[1], &node->keys[0], n * sizeof(uint64_t));
+    memmove(&node->children[1], &node->children[0], (n + 1) * sizeof(RT_BTNode *));
+    node->keys[0] = parent->keys[i - 1];
+    node->children[0] = left->children[last + 1];
+    parent->keys[i - 1] = left->keys[last];
+    if (node->skeys) {
+        memmove(&node->skeys[1], &node->skeys[0], n * sizeof(char *));
+        node->skeys[0] = parent->skeys[i - 1];
+        parent->skeys[i - 1] = left->skeys[last];
+    }
+
+    node->count++;
+    left->count--;
+}
+
+static void rt__bt_borrow_right(RT_BTree *tree, RT_BTNode *parent, size_t i)
+{
+    RT_BTNode *node = parent->children[i];
+    RT_BTNode *right = parent->children[i + 1];
+    size_t vs = tree->value_size;
+
+    if (node->leaf) {
+        char *sep = NULL;
+        if (right->skeys && !(sep = rt__bt_strdup(right->skeys[1]))) return; // stay underfull
+
+        rt__bt_leaf_insert_at(tree, node, node->count, right->keys[0], right->skeys ? right->skeys[0] : NULL,
+                              vs ? right->values : NULL);
+        rt__bt_leaf_erase_at(tree, right, 0);
+
+        parent->keys[i] = right->keys[0];
+        if (sep) {
+            RT_FREE(parent->skeys[i]);
+            parent->skeys[i] = sep;
+        }
+        return;
+    }
+
+    size_t n = node->count, rn = right->count;
+    node->keys[n] = parent->keys[i];
+    node->children[n + 1] = right->children[0];
+    parent->keys[i] = right->keys[0];
+    if (node->skeys) {
+        node->skeys[n] = parent->skeys[i];
+        parent->skeys[i] = right->skeys[0];
+        memmove(&right->skeys[0], &right->skeys[1], (rn - 1) * sizeof(char *));
+    }
+    memmove(&right->keys[0], &right->keys[1], (rn - 1) * sizeof(uint64_t));
+    memmove(&right->children[0], &right->children[1], rn * sizeof(RT_BTNode *));
+
+    node->count++;
+    right->count--;
+}
+
+// folds children[i + 1] into children[i]
+static void rt__bt_merge(RT_BTree *tree, RT_BTNode *parent, size_t i)
+{
+    RT_BTNode *left = parent->children[i];
+    RT_BTNode *right = parent->children[i + 1];
+    size_t ln = left->count, rn = right->count, vs = tree->value_size;
+
+    if (left->leaf) {
+        memcpy(&left->keys[ln], right->keys, rn * sizeof(uint64_t));
+        if (left->skeys) memcpy(&left->skeys[ln], right->skeys, rn * sizeof(char *));
+        if (vs) memcpy(left->values + ln * vs, right->values, rn * vs);
+        left->count += (uint32_t)rn;
+
+        left->next = right->next;
+        if (right->next) right->next->prev = left;
+        else tree->last = left;
+
+        if (parent->skeys) RT_FREE(parent->skeys[i]);
+    } else {
+        left->keys[ln] = parent->keys[i];
+        memcpy(&left->keys[ln + 1], right->keys, rn * sizeof(uint64_t));
+        if (left->skeys) {
+            left->skeys[ln] = parent->skeys[i];
+            memcpy(&left->skeys[ln + 1], right->skeys, rn * sizeof(char *));
+        }
+        memcpy(&left->children[ln + 1], right->children, (rn + 1) * sizeof(RT_BTNode *));
+        left->count += (uint32_t)rn + 1;
+    }
+
+    rt__bt_internal_erase_at(parent, i);
+    RT_FREE(right); // keys and children now belong to left
+}
+
+static void rt__bt_rebalance(RT_BTree *tree, RT_BTNode *parent, size_t i)
+{
+    RT_BTNode *left = i > 0 ? parent->children[i - 1] : NULL;
+    RT_BTNode *right = i < parent->count ? parent->children[i + 1] : NULL;
+
+    if (left && left->count > RT_BTREE_MIN_KEYS) rt__bt_borrow_left(tree, parent, i);
+    else if (right && right->count > RT_BTREE_MIN_KEYS) rt__bt_borrow_right(tree, parent, i);
+    else if (left) rt__bt_merge(tree, parent, i - 1);
+    else if (right) rt__bt_merge(tree, parent, i);
+}
+
+static bool rt__bt_remove(RT_BTree *tree, const RT__BTKey *key)
+{
+    RT_BTNode *path[RT_BTREE_MAX_DEPTH];
+    size_t slots[RT_BTREE_MAX_DEPTH];
+    size_t depth;
+
+    RT_BTNode *leaf = rt__bt_descend(tree, key, path, slots, &depth);
+    size_t pos = rt__bt_search(leaf, key, false);
+    if (pos >= leaf->count || rt__bt_cmp(leaf, pos, key) != 0) return false;
+
+    if (leaf->skeys) RT_FREE(leaf->skeys[pos]);
+    rt__bt_leaf_erase_at(tree, leaf, pos);
+    tree->size--;
+
+    RT_BTNode *node = leaf;
+    while (depth > 0 && node->count < RT_BTREE_MIN_KEYS) {
+        depth--;
+        rt__bt_rebalance(tree, path[depth], slots[depth]);
+        node = path[depth];
+    }
+
+    RT_BTNode *root = tree->root;
+    if (!root->leaf && root->count == 0) {
+        tree->root = root->children[0];
+        RT_FREE(root);
+    }
+
+    return true;
+}
+
+static bool rt__bt_get(RT_BTree *tree, const RT__BTKey *key, void *out)
+{
+    RT_BTNode *leaf = rt__bt_descend(tree, key, NULL, NULL, NULL);
+    size_t pos = rt__bt_search(leaf, key, false);
+    if (pos >= leaf->count || rt__bt_cmp(leaf, pos, key) != 0) return false;
+
+    if (out && tree->value_size) memcpy(out, leaf->values + pos * tree->value_size, tree->value_size);
+    return true;
+}
+
+/* Builds the tree bottom-up from strictly ascending keys: leaves are packed
+ * full and evenly, then each internal level is laid over the one below. */
+static bool rt__bt_bulk_load(RT_BTree *tree, const uint64_t *ukeys, const char *const *skeys, const void *values, size_t count)
+{
+    bool str = tree->key_type == RT_BTREE_KEY_STR;
+    size_t vs = tree->value_size;
+
+    if (tree->size != 0) return false;
+    if (count == 0) return true;
+    if ((str ? !skeys : !ukeys) || (vs && !values)) return false;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (str) {
+            if (!skeys[i] || (i > 0 && strcmp(skeys[i - 1], skeys[i]) >= 0)) return false;
+        } else if (i > 0 && ukeys[i - 1] >= ukeys[i]) {
+            return false;
+        }
+    }
+
+    size_t width = (count + RT_BTREE_ORDER - 1) / RT_BTREE_ORDER;
+    RT_BTNode **level = RT_MALLOC(width * sizeof(RT_BTNode *));
+    RT_BTNode **lefts = RT_MALLOC(width * sizeof(RT_BTNode *)); // leftmost leaf under each node
+    if (!level || !lefts) goto fail;
+
+    const uint8_t *src = values;
+    RT_BTNode *prev = NULL;
+    size_t next = 0;
+
+    for (size_t j = 0; j < width; ++j) {
+        size_t n = count / width + (j < count % width);
+        RT_BTNode *leaf = rt__bt_node_new(tree, true);
+        if (!leaf) {
+            rt__bt_free_range(level, 0, j);
+            goto fail;
+        }
+        level[j] = lefts[j] = leaf;
+
+        if (vs) memcpy(leaf->values, src + next * vs, n * vs);
+        for (size_t i = 0; i < n; ++i, ++next) {
+            if (str) {
+                leaf->skeys[i] = rt__bt_strdup(skeys[next]);
+                if (!leaf->skeys[i]) {
+                    rt__bt_free_range(level, 0, j + 1);
+                    goto fail;
+                }
+                leaf->keys[i] = rt__bt_prefix(skeys[next]);
+            } else {
+                leaf->keys[i] = ukeys[next];
+            }
+            leaf->count = (uint32_t)i + 1;
+        }
+
+        leaf->prev = prev;
+        if (prev) prev->next = leaf;
+        prev = leaf;
+    }
+
+    while (width > 1) {
+        size_t parents = (width + RT_BTREE_ORDER) / (RT_BTREE_ORDER + 1);
+        size_t consumed = 0;
+
+        for (size_t p = 0; p < parents; ++p) {
+            size_t n = width / parents + (p < width % parents);
+            RT_BTNode *node = rt__bt_node_new(tree, false);
+            if (!node) {
+                rt__bt_free_range(level, 0, p);
+                rt__bt_free_range(level, consumed, width);
+                goto fail;
+            }
+
+            node->children[0] = level[consumed];
+            for (size_t c = 1; c < n; ++c) {
+                const RT_BTNode *min = lefts[consumed + c];
+                node->children[c] = level[consumed + c];
+                node->keys[c - 1] = min->keys[0];
+                if (str && !(node->skeys[c - 1] = rt__bt_strdup(min->skeys[0]))) {
+                    rt__bt_free_range(level, 0, p);
+                    rt__bt_node_free(node);
+                    rt__bt_free_range(level, consumed + c, width);
+                    goto fail;
+                }
+                node->count = (uint32_t)c;
+            }
+
+            level[p] = node;
+            lefts[p] = lefts[consumed];
+            consumed += n;
+        }
+
+        width = parents;
+    }
+
+    rt__bt_node_free(tree->root);
+    tree->root = level[0];
+    tree->first = lefts[0];
+    tree->last = prev;
+    tree->size = count;
+
+    RT_FREE(level);
+    RT_FREE(lefts);
+    return true;
+
+fail:
+    RT_FREE(level);
+    RT_FREE(lefts);
+    return false;
+}
+
+static inline void rt__bt_iter_settle(RT_BTreeIter *it)
+{
+    while (it->node && it->index >= it->node->count) {
+        it->node = it->node->next;
+        it->index = 0;
+    }
+}
+
+static RT_BTreeIter rt__bt_bound(RT_BTree *tree, const RT__BTKey *key, bool upper)
+{
+    RT_BTreeIter it = {NULL, 0, tree->value_size};
+
+    it.node = rt__bt_descend(tree, key, NULL, NULL, NULL);
+    it.index = rt__bt_search(it.node, key, upper);
+
+    return it;
+}
+
+bool rt_btree_init(RT_BTree *tree, RT_BTreeKeyType key_type, size_t value_size)
+{
+    if (!tree || (key_type != RT_BTREE_KEY_STR && key_type != RT_BTREE_KEY_U64)) return false;
+
+    tree->key_type = key_type;
+    tree->value_size = value_size;
+    tree->size = 0;
+    tree->root = rt__bt_node_new(tree, true);
+    if (!tree->root) return false;
+
+    tree->first = tree->last = tree->root;
+    return true;
+}
+
+void rt_btree_free(RT_BTree *tree)
+{
+    if (!tree) return;
+
+    rt__bt_node_free(tree->root);
+    tree->root = tree->first = tree->last = NULL;
+    tree->size = 0;
+}
+
+bool rt_btree_insert(RT_BTree *tree, const char *key, const void *value)
+{
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_STR || !key) return false;
+    if (tree->value_size && !value) return false;
+
+    RT__BTKey k = rt__bt_key_str(key);
+    return rt__bt_insert(tree, &k, value);
+}
+
+bool rt_btree_insert_u64(RT_BTree *tree, uint64_t key, const void *value)
+{
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_U64) return false;
+    if (tree->value_size && !value) return false;
+
+    RT__BTKey k = rt__bt_key_u64(key);
+    return rt__bt_insert(tree, &k, value);
+}
+
+bool rt_btree_get(RT_BTree *tree, const char *key, void *out)
+{
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_STR || !key) return false;
+
+    RT__BTKey k = rt__bt_key_str(key);
+    return rt__bt_get(tree, &k, out);
+}
+
+bool rt_btree_get_u64(RT_BTree *tree, uint64_t key, void *out)
+{
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_U64) return false;
+
+    RT__BTKey k = rt__bt_key_u64(key);
+    return rt__bt_get(tree, &k, out);
+}
+
+bool rt_btree_remove(RT_BTree *tree, const char *key)
+{
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_STR || !key) return false;
+
+    RT__BTKey k = rt__bt_key_str(key);
+    return rt__bt_remove(tree, &k);
+}
+
+bool rt_btree_remove_u64(RT_BTree *tree, uint64_t key)
+{
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_U64) return false;
+
+    RT__BTKey k = rt__bt_key_u64(key);
+    return rt__bt_remove(tree, &k);
+}
+
+bool rt_btree_bulk_load(RT_BTree *tree, const char *const *keys, const void *values, size_t count)
+{
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_STR) return false;
+    return rt__bt_bulk_load(tree, NULL, keys, values, count);
+}
+
+bool rt_btree_bulk_load_u64(RT_BTree *tree, const uint64_t *keys, const void *values, size_t count)
+{
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_U64) return false;
+    return rt__bt_bulk_load(tree, keys, NULL, values, count);
+}
+
+RT_BTreeIter rt_btree_begin(RT_BTree *tree)
+{
+    RT_BTreeIter it = {NULL, 0, 0};
+    if (!tree) return it;
+
+    it.node = tree->first;
+    it.value_size = tree->value_size;
+    rt__bt_iter_settle(&it);
+    return it;
+}
+
+RT_BTreeIter rt_btree_lower_bound(RT_BTree *tree, const char *key)
+{
+    RT_BTreeIter it = {NULL, 0, 0};
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_STR || !key) return it;
+
+    RT__BTKey k = rt__bt_key_str(key);
+    it = rt__bt_bound(tree, &k, false);
+    rt__bt_iter_settle(&it);
+    return it;
+}
+
+RT_BTreeIter rt_btree_lower_bound_u64(RT_BTree *tree, uint64_t key)
+{
+    RT_BTreeIter it = {NULL, 0, 0};
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_U64) return it;
+
+    RT__BTKey k = rt__bt_key_u64(key);
+    it = rt__bt_bound(tree, &k, false);
+    rt__bt_iter_settle(&it);
+    return it;
+}
+
+RT_BTreeIter rt_btree_upper_bound(RT_BTree *tree, const char *key)
+{
+    RT_BTreeIter it = {NULL, 0, 0};
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_STR || !key) return it;
+
+    RT__BTKey k = rt__bt_key_str(key);
+    it = rt__bt_bound(tree, &k, true);
+    rt__bt_iter_settle(&it);
+    return it;
+}
+
+RT_BTreeIter rt_btree_upper_bound_u64(RT_BTree *tree, uint64_t key)
+{
+    RT_BTreeIter it = {NULL, 0, 0};
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_U64) return it;
+
+    RT__BTKey k = rt__bt_key_u64(key);
+    it = rt__bt_bound(tree, &k, true);
+    rt__bt_iter_settle(&it);
+    return it;
+}
+
+// greatest key <= key
+RT_BTreeIter rt_btree_floor(RT_BTree *tree, const char *key)
+{
+    RT_BTreeIter it = {NULL, 0, 0};
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_STR || !key) return it;
+
+    RT__BTKey k = rt__bt_key_str(key);
+    it = rt__bt_bound(tree, &k, true);
+    rt_btree_iter_prev(&it);
+    return it;
+}
+
+RT_BTreeIter rt_btree_floor_u64(RT_BTree *tree, uint64_t key)
+{
+    RT_BTreeIter it = {NULL, 0, 0};
+    if (!tree || !tree->root || tree->key_type != RT_BTREE_KEY_U64) return it;
+
+    RT__BTKey k = rt__bt_key_u64(key);
+    it = rt__bt_bound(tree, &k, true);
+    rt_btree_iter_prev(&it);
+    return it;
+}
+
+void rt_btree_iter_next(RT_BTreeIter *it)
+{
+    if (!rt_btree_iter_valid(it)) return;
+
+    it->index++;
+    rt__bt_iter_settle(it);
+}
+
+void rt_btree_iter_prev(RT_BTreeIter *it)
+{
+    if (!it || !it->node) return;
+
+    while (it->index == 0) {
+        it->node = it->node->prev;
+        if (!it->node) return;
+        it->index = it->node->count;
+    }
+    it->index--;
+}
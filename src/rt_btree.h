@@ -0,0 +1,115 @@
+#ifndef _INC_RT_BTREE
+#define _INC_RT_BTREE
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+
+/* Ordered map (B+tree)
+ * Wide nodes keep their keys in one contiguous uint64_t array. Integer trees
+ * store the key itself there. String trees store the first 8 bytes of the
+ * key big-endian, so most comparisons never touch the full key string.
+ * Values have a fixed size per tree and live inline in the leaves, and
+ * leaves are chained for range scans. */
+#define RT_BTREE_ORDER 32 // max keys per node
+#define RT_BTREE_MIN_KEYS (RT_BTREE_ORDER / 2)
+#define RT_BTREE_MAX_DEPTH 32
+
+typedef enum _RT_BTreeKeyType {
+    RT_BTREE_KEY_STR,
+    RT_BTREE_KEY_U64
+} RT_BTreeKeyType;
+
+typedef struct _RT_BTNode {
+    uint32_t count;
+    uint32_t leaf;
+    struct _RT_BTNode *next; // leaf chain
+    struct _RT_BTNode *prev;
+    char **skeys;            // full string keys (string trees only)
+    struct _RT_BTNode **children;
+    uint8_t *values;
+    uint64_t keys[RT_BTREE_ORDER + 1]; // one spare slot, nodes split after overflowing
+} RT_BTNode;
+
+typedef struct _RT_BTree {
+    RT_BTNode *root;
+    RT_BTNode *first; // leftmost leaf
+    RT_BTNode *last;  // rightmost leaf
+    size_t size;
+    size_t value_size;
+    RT_BTreeKeyType key_type;
+} RT_BTree;
+
+typedef struct _RT_BTreeIter {
+    RT_BTNode *node;
+    size_t index;
+    size_t value_size;
+} RT_BTreeIter;
+
+bool rt_btree_init(RT_BTree *tree, RT_BTreeKeyType key_type, size_t value_size);
+void rt_btree_free(RT_BTree *tree);
+bool rt_btree_insert(RT_BTree *tree, const char *key, const void *value);
+bool rt_btree_insert_u64(RT_BTree *tree, uint64_t key, const void *value);
+bool rt_btree_get(RT_BTree *tree, const char *key, void *out);
+bool rt_btree_get_u64(RT_BTree *tree, uint64_t key, void *out);
+bool rt_btree_remove(RT_BTree *tree, const char *key);
+bool rt_btree_remove_u64(RT_BTree *tree, uint64_t key);
+bool rt_btree_bulk_load(RT_BTree *tree, const char *const *keys, const void *values, size_t count);
+bool rt_btree_bulk_load_u64(RT_BTree *tree, const uint64_t *keys, const void *values, size_t count);
+
+RT_BTreeIter rt_btree_begin(RT_BTree *tree);
+RT_BTreeIter rt_btree_lower_bound(RT_BTree *tree, const char *key);
+RT_BTreeIter rt_btree_lower_bound_u64(RT_BTree *tree, uint64_t key);
+RT_BTreeIter rt_btree_upper_bound(RT_BTree *tree, const char *key);
+RT_BTreeIter rt_btree_upper_bound_u64(RT_BTree *tree, uint64_t key);
+RT_BTreeIter rt_btree_floor(RT_BTree *tree, const char *key);
+RT_BTreeIter rt_btree_floor_u64(RT_BTree *tree, uint64_t key);
+void rt_btree_iter_next(RT_BTreeIter *it);
+void rt_btree_iter_prev(RT_BTreeIter *it);
+
+static inline bool rt_btree_contains(RT_BTree *tree, const char *key)
+{
+    return rt_btree_get(tree, key, NULL);
+}
+
+static inline bool rt_btree_contains_u64(RT_BTree *tree, uint64_t key)
+{
+    return rt_btree_get_u64(tree, key, NULL);
+}
+
+static inline bool rt_btree_is_empty(RT_BTree *tree)
+{
+    return !tree || tree->size == 0;
+}
+
+static inline bool rt_btree_iter_valid(const RT_BTreeIter *it)
+{
+    return it && it->node && it->index < it->node->count;
+}
+
+static inline const char *rt_btree_iter_key(const RT_BTreeIter *it)
+{
+    return rt_btree_iter_valid(it) && it->node->skeys ? it->node->skeys[it->index] : NULL;
+}
+
+static inline uint64_t rt_btree_iter_key_u64(const RT_BTreeIter *it)
+{
+    return rt_btree_iter_valid(it) ? it->node->keys[it->index] : 0;
+}
+
+static inline void *rt_btree_iter_value(const RT_BTreeIter *it)
+{
+    return rt_btree_iter_valid(it) && it->value_size
+        ? it->node->values + it->index * it->value_size
+        : NULL;
+}
+
+/* Prefix scan: start at rt_btree_lower_bound(tree, prefix), loop while this holds */
+static inline bool rt_btree_iter_has_prefix(const RT_BTreeIter *it, const char *prefix)
+{
+    const char *key = rt_btree_iter_key(it);
+    return key && prefix && strncmp(key, prefix, strlen(prefix)) == 0;
+}
+
+#endif // _INC_RT_BTREE
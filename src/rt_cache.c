@@ -0,0 +1,437 @@
+#include "rt_cache.h"
+
+#define RT__CACHE_SMALL 0 // S3-FIFO probation, the only queue of LRU and CLOCK
+#define RT__CACHE_MAIN 1
+#define RT__CACHE_OVERHEAD (sizeof(RT_HTNode) + sizeof(RT_CacheEntry))
+#define RT__CACHE_GHOST_INIT_BUCKETS 16
+
+static inline size_t rt__cache_mix(size_t hash)
+{
+    uint64_t x = (uint64_t)hash * 0x9E3779B97F4A7C15ull;
+    return (size_t)(x ^ x >> 32);
+}
+
+static inline RT_CacheShard *rt__cache_shard(RT_Cache *cache, size_t hash)
+{
+    return &cache->shards[rt__cache_mix(hash) >> 8 & (cache->shard_count - 1)];
+}
+
+static inline void *rt__cache_value(RT_CacheEntry *entry)
+{
+    return entry + 1;
+}
+
+static inline bool rt__cache_expired(const RT_CacheEntry *entry, uint64_t now)
+{
+    return entry->expires && entry->expires <= now;
+}
+
+static RT_HTNode *rt__cache_find(RT_HashMap *map, const char *key, size_t hash)
+{
+    RT_HTNode *node = map->buckets[hash % map->buckets_count].head;
+    while (node && strcmp(node->key, key) != 0) node = node->next;
+    return node;
+}
+
+static void rt__cache_push(RT_CacheQueue *queue, RT_CacheEntry *entry)
+{
+    entry->prev = NULL;
+    entry->next = queue->head;
+    if (queue->head) queue->head->prev = entry;
+    else queue->tail = entry;
+    queue->head = entry;
+    queue->bytes += entry->charge;
+    queue->count++;
+}
+
+static void rt__cache_unlink(RT_CacheQueue *queue, RT_CacheEntry *entry)
+{
+    if (entry->prev) entry->prev->next = entry->next;
+    else queue->head = entry->next;
+    if (entry->next) entry->next->prev = entry->prev;
+    else queue->tail = entry->prev;
+    queue->bytes -= entry->charge;
+    queue->count--;
+}
+
+// unlinks the entry from its queue and its map bucket and frees it
+static void rt__cache_drop(RT_CacheShard *shard, RT_CacheEntry *entry)
+{
+    rt__cache_unlink(&shard->queues[entry->queue], entry);
+    shard->bytes -= entry->charge;
+
+    RT_HTNode *node = entry->node;
+    RT_HTBucket *bucket = &shard->map.buckets[entry->hash % shard->map.buckets_count];
+    RT_HTNode **link = &bucket->head;
+    while (*link != node) link = &(*link)->next;
+    *link = node->next;
+    bucket->count--;
+    shard->map.size--;
+
+    RT_FREE(node->key);
+    RT_FREE(node->value);
+    RT_FREE(node);
+}
+
+static inline size_t *rt__cache_ghost_ways(RT_CacheShard *shard, size_t hash)
+{
+    return shard->ghost + (rt__cache_mix(hash) & (shard->ghost_buckets - 1)) * RT_CACHE_GHOST_WAYS;
+}
+
+static bool rt__cache_ghost_take(RT_CacheShard *shard, size_t hash)
+{
+    if (!shard->ghost) return false;
+
+    hash |= 1; // 0 marks a free way
+    size_t *ways = rt__cache_ghost_ways(shard, hash);
+    for (size_t i = 0; i < RT_CACHE_GHOST_WAYS; ++i) {
+        if (ways[i] == hash) {
+            ways[i] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+// the ghost grows with the shard, so it remembers about as many keys as are cached
+static void rt__cache_ghost_put(RT_CacheShard *shard, size_t hash)
+{
+    if (!shard->ghost || shard->map.size > shard->ghost_buckets * RT_CACHE_GHOST_WAYS) {
+        size_t *old = shard->ghost;
+        const size_t old_buckets = shard->ghost_buckets;
+        size_t buckets = old ? old_buckets * 2 : RT__CACHE_GHOST_INIT_BUCKETS;
+        while (buckets * RT_CACHE_GHOST_WAYS < shard->map.size) buckets *= 2;
+
+        size_t *ghost = RT_CALLOC(buckets * RT_CACHE_GHOST_WAYS, sizeof(size_t));
+        if (ghost) {
+            shard->ghost = ghost;
+            shard->ghost_buckets = buckets;
+            for (size_t i = 0; old && i < old_buckets * RT_CACHE_GHOST_WAYS; ++i) {
+                if (old[i]) rt__cache_ghost_ways(shard, old[i])[shard->ghost_next++ % RT_CACHE_GHOST_WAYS] = old[i];
+            }
+            RT_FREE(old);
+        }
+        if (!shard->ghost) return;
+    }
+
+    hash |= 1;
+    rt__cache_ghost_ways(shard, hash)[shard->ghost_next++ % RT_CACHE_GHOST_WAYS] = hash;
+}
+
+// a hit: LRU moves the entry to the front, the others only count it
+static inline void rt__cache_touch(RT_Cache *cache, RT_CacheShard *shard, RT_CacheEntry *entry)
+{
+    if (cache->policy == RT_CACHE_LRU) {
+        if (shard->queues[0].head == entry) return;
+        rt__cache_unlink(&shard->queues[0], entry);
+        rt__cache_push(&shard->queues[0], entry);
+    } else if (entry->freq < (cache->policy == RT_CACHE_CLOCK ? 1 : RT_CACHE_S3FIFO_FREQ_MAX)) {
+        entry->freq++;
+    }
+}
+
+// evicts until `needed` more bytes fit in the budget
+static void rt__cache_evict(RT_Cache *cache, RT_CacheShard *shard, size_t needed, uint64_t now)
+{
+    RT_CacheQueue *small = &shard->queues[RT__CACHE_SMALL];
+    RT_CacheQueue *main = &shard->queues[RT__CACHE_MAIN];
+    const size_t small_budget = shard->budget / 100 * RT_CACHE_S3FIFO_SMALL_PERCENT;
+
+    while (shard->bytes + needed > shard->budget) {
+        RT_CacheQueue *queue = small;
+        RT_CacheEntry *victim;
+
+        if (cache->policy == RT_CACHE_S3FIFO) {
+            if (small->count && (small->bytes > small_budget || !main->count)) {
+                victim = small->tail;
+                if (rt__cache_expired(victim, now)) {
+                    shard->expirations++;
+                } else if (victim->freq) { // hit while on probation
+                    rt__cache_unlink(small, victim);
+                    victim->freq = 0;
+                    victim->queue = RT__CACHE_MAIN;
+                    rt__cache_push(main, victim);
+                    continue;
+                } else {
+                    rt__cache_ghost_put(shard, victim->hash);
+                    shard->evictions++;
+                }
+                rt__cache_drop(shard, victim);
+                continue;
+            }
+            queue = main;
+        }
+
+        victim = queue->tail;
+        if (rt__cache_expired(victim, now)) {
+            shard->expirations++;
+        } else if (victim->freq) { // second chance, LRU never sets freq
+            rt__cache_unlink(queue, victim);
+            victim->freq--;
+            rt__cache_push(queue, victim);
+            continue;
+        } else {
+            shard->evictions++;
+        }
+        rt__cache_drop(shard, victim);
+    }
+}
+
+bool rt_cache_init(RT_Cache *cache, size_t capacity, size_t shards, int policy)
+{
+    if (!cache || capacity == 0) return false;
+    if (policy != RT_CACHE_LRU && policy != RT_CACHE_CLOCK && policy != RT_CACHE_S3FIFO) return false;
+    if (shards == 0) shards = RT_CACHE_SHARDS;
+
+    size_t count = 1;
+    while (count < shards) count <<= 1;
+
+    cache->shards = RT_CALLOC(count, sizeof(RT_CacheShard));
+    if (!cache->shards) return false;
+
+    for (size_t i = 0; i < count; ++i) {
+        RT_CacheShard *shard = &cache->shards[i];
+        if (!rt_hashmap_init(&shard->map, 0)) {
+            while (i--) rt_hashmap_free(&cache->shards[i].map);
+            RT_FREE(cache->shards);
+            cache->shards = NULL;
+            return false;
+        }
+        InitializeSRWLock(&shard->lock);
+        shard->budget = capacity / count;
+    }
+
+    cache->shard_count = count;
+    cache->policy = policy;
+    return true;
+}
+
+void rt_cache_free(RT_Cache *cache)
+{
+    if (!cache || !cache->shards) return;
+
+    for (size_t i = 0; i < cache->shard_count; ++i) {
+        rt_hashmap_free(&cache->shards[i].map);
+        RT_FREE(cache->shards[i].ghost);
+    }
+    RT_FREE(cache->shards);
+    cache->shards = NULL;
+    cache->shard_count = 0;
+}
+
+void rt_cache_clear(RT_Cache *cache)
+{
+    if (!cache || !cache->shards) return;
+
+    for (size_t i = 0; i < cache->shard_count; ++i) {
+        RT_CacheShard *shard = &cache->shards[i];
+        AcquireSRWLockExclusive(&shard->lock);
+        for (size_t q = 0; q < 2; ++q) {
+            while (shard->queues[q].tail) rt__cache_drop(shard, shard->queues[q].tail);
+        }
+        if (shard->ghost) memset(shard->ghost, 0, shard->ghost_buckets * RT_CACHE_GHOST_WAYS * sizeof(size_t));
+        ReleaseSRWLockExclusive(&shard->lock);
+    }
+}
+
+// swaps the entry for one with room for `value_size` bytes, keeping its queue position
+static RT_CacheEntry *rt__cache_resize(RT_CacheShard *shard, RT_CacheEntry *entry, size_t value_size)
+{
+    RT_CacheEntry *fresh = RT_MALLOC(sizeof(RT_CacheEntry) + value_size);
+    if (!fresh) return NULL;
+
+    RT_CacheQueue *queue = &shard->queues[entry->queue];
+    *fresh = *entry;
+    if (fresh->prev) fresh->prev->next = fresh;
+    else queue->head = fresh;
+    if (fresh->next) fresh->next->prev = fresh;
+    else queue->tail = fresh;
+
+    fresh->node->value = fresh;
+    fresh->node->value_size = sizeof(RT_CacheEntry) + value_size;
+    RT_FREE(entry);
+    return fresh;
+}
+
+bool rt_cache_put(RT_Cache *cache, const char *key, const void *value, size_t value_size, uint64_t ttl_ms)
+{
+    if (!cache || !cache->shards || !key || !value || value_size == 0) return false;
+
+    const size_t hash = rt__hashmap_hash(key);
+    const size_t ksize = strlen(key) + 1;
+    const size_t charge = RT__CACHE_OVERHEAD + ksize + value_size;
+    RT_CacheShard *shard = rt__cache_shard(cache, hash);
+    if (charge > shard->budget) return false;
+
+    const uint64_t now = GetTickCount64();
+    bool ok = false;
+
+    AcquireSRWLockExclusive(&shard->lock);
+
+    RT_HTNode *node = rt__cache_find(&shard->map, key, hash);
+    if (node) {
+        RT_CacheEntry *entry = node->value;
+        if (node->value_size != sizeof(RT_CacheEntry) + value_size) {
+            entry = rt__cache_resize(shard, entry, value_size);
+            if (!entry) goto done;
+        }
+
+        memcpy(rt__cache_value(entry), value, value_size);
+        entry->expires = ttl_ms ? now + ttl_ms : 0;
+        shard->queues[entry->queue].bytes += charge - entry->charge;
+        shard->bytes += charge - entry->charge;
+        entry->charge = charge;
+        rt__cache_touch(cache, shard, entry);
+        rt__cache_evict(cache, shard, 0, now);
+        ok = true;
+        goto done;
+    }
+
+    rt__cache_evict(cache, shard, charge, now);
+    if (rt__hashmap_need_rehash(&shard->map)) {
+        rt_hashmap_rehash(&shard->map, shard->map.buckets_count * 2);
+    }
+
+    node = rt__hashmap_node_alloc(ksize, sizeof(RT_CacheEntry) + value_size);
+    if (!node) goto done;
+
+    memcpy(node->key, key, ksize);
+    RT_HTBucket *bucket = &shard->map.buckets[hash % shard->map.buckets_count];
+    node->next = bucket->head;
+    bucket->head = node;
+    bucket->count++;
+    shard->map.size++;
+
+    RT_CacheEntry *entry = node->value;
+    entry->node = node;
+    entry->hash = hash;
+    entry->charge = charge;
+    entry->expires = ttl_ms ? now + ttl_ms : 0;
+    entry->freq = 0;
+    entry->queue = cache->policy == RT_CACHE_S3FIFO && rt__cache_ghost_take(shard, hash)
+        ? RT__CACHE_MAIN
+        : RT__CACHE_SMALL;
+    memcpy(rt__cache_value(entry), value, value_size);
+
+    rt__cache_push(&shard->queues[entry->queue], entry);
+    shard->bytes += charge;
+    shard->insertions++;
+    ok = true;
+
+    done:
+        ReleaseSRWLockExclusive(&shard->lock);
+        return ok;
+}
+
+bool rt_cache_get(RT_Cache *cache, const char *key, void *out, size_t out_size)
+{
+    if (!cache || !cache->shards || !key || !out || out_size == 0) return false;
+
+    const size_t hash = rt__hashmap_hash(key);
+    RT_CacheShard *shard = rt__cache_shard(cache, hash);
+    const bool exclusive = cache->policy == RT_CACHE_LRU;
+    bool found = false;
+
+    if (exclusive) AcquireSRWLockExclusive(&shard->lock);
+    else AcquireSRWLockShared(&shard->lock);
+
+    RT_HTNode *node = rt__cache_find(&shard->map, key, hash);
+    if (node) {
+        RT_CacheEntry *entry = node->value;
+        if (entry->expires && rt__cache_expired(entry, GetTickCount64())) {
+            if (exclusive) { // shared holders leave it to eviction or purge
+                rt__cache_drop(shard, entry);
+                shard->expirations++;
+            }
+        } else if (out_size >= node->value_size - sizeof(RT_CacheEntry)) {
+            memcpy(out, rt__cache_value(entry), node->value_size - sizeof(RT_CacheEntry));
+            rt__cache_touch(cache, shard, entry);
+            found = true;
+        }
+    }
+
+    if (exclusive) ReleaseSRWLockExclusive(&shard->lock);
+    else ReleaseSRWLockShared(&shard->lock);
+
+    InterlockedIncrement64(found ? &shard->hits : &shard->misses);
+    return found;
+}
+
+bool rt_cache_remove(RT_Cache *cache, const char *key)
+{
+    if (!cache || !cache->shards || !key) return false;
+
+    const size_t hash = rt__hashmap_hash(key);
+    RT_CacheShard *shard = rt__cache_shard(cache, hash);
+
+    AcquireSRWLockExclusive(&shard->lock);
+    RT_HTNode *node = rt__cache_find(&shard->map, key, hash);
+    if (node) rt__cache_drop(shard, node->value);
+    ReleaseSRWLockExclusive(&shard->lock);
+
+    return node != NULL;
+}
+
+bool rt_cache_contains(RT_Cache *cache, const char *key)
+{
+    if (!cache || !cache->shards || !key) return false;
+
+    const size_t hash = rt__hashmap_hash(key);
+    RT_CacheShard *shard = rt__cache_shard(cache, hash);
+
+    AcquireSRWLockShared(&shard->lock);
+    RT_HTNode *node = rt__cache_find(&shard->map, key, hash);
+    RT_CacheEntry *entry = node ? node->value : NULL;
+    const bool found = entry && !(entry->expires && rt__cache_expired(entry, GetTickCount64()));
+    ReleaseSRWLockShared(&shard->lock);
+
+    return found;
+}
+
+size_t rt_cache_purge_expired(RT_Cache *cache)
+{
+    if (!cache || !cache->shards) return 0;
+
+    const uint64_t now = GetTickCount64();
+    size_t purged = 0;
+
+    for (size_t i = 0; i < cache->shard_count; ++i) {
+        RT_CacheShard *shard = &cache->shards[i];
+        AcquireSRWLockExclusive(&shard->lock);
+        for (size_t q = 0; q < 2; ++q) {
+            RT_CacheEntry *entry = shard->queues[q].head;
+            while (entry) {
+                RT_CacheEntry *next = entry->next;
+                if (rt__cache_expired(entry, now)) {
+                    rt__cache_drop(shard, entry);
+                    shard->expirations++;
+                    purged++;
+                }
+                entry = next;
+            }
+        }
+        ReleaseSRWLockExclusive(&shard->lock);
+    }
+
+    return purged;
+}
+
+void rt_cache_stats(RT_Cache *cache, RT_CacheStats *out)
+{
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!cache || !cache->shards) return;
+
+    for (size_t i = 0; i < cache->shard_count; ++i) {
+        RT_CacheShard *shard = &cache->shards[i];
+        AcquireSRWLockShared(&shard->lock);
+        out->hits += (uint64_t)shard->hits;
+        out->misses += (uint64_t)shard->misses;
+        out->insertions += shard->insertions;
+        out->evictions += shard->evictions;
+        out->expirations += shard->expirations;
+        out->size += shard->map.size;
+        out->bytes += shard->bytes;
+        ReleaseSRWLockShared(&shard->lock);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef _INC_RT_CACHE
+#define _INC_RT_CACHE
+
+#include <windows.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+
+/* Bounded cache
+ * String keys map to copies of their values, like RT_HashMap, but the total
+ * size is capped: every entry is charged its key, value and bookkeeping bytes
+ * and entries are evicted once a shard goes over its share of the budget.
+ * Get, put and evict are O(1). Entries may carry a time to live; expired ones
+ * are dropped when they are looked up or reach the eviction end of a queue.
+ *
+ * The cache is split into power-of-two shards by key hash, each with its own
+ * lock, map and queues, so threads working on different keys rarely meet.
+ * Eviction policies:
+ *   - LRU:     a hit moves the entry to the front of the queue
+ *   - CLOCK:   a hit only sets a reference bit, eviction gives referenced
+ *              entries a second pass around the queue
+ *   - S3-FIFO: new keys start in a small probation queue (10% of the budget)
+ *              and are promoted to the main queue if hit before they leave
+ *              it; keys evicted from probation are remembered by hash, and
+ *              coming back soon after puts them straight into main
+ * CLOCK and S3-FIFO only bump a counter on a hit, so their lookups share
+ * the shard lock (a bump lost to a concurrent reader costs nothing), and
+ * S3-FIFO keeps one-hit wonders from flushing the working set. */
+#define RT_CACHE_LRU    0
+#define RT_CACHE_CLOCK  1
+#define RT_CACHE_S3FIFO 2
+
+#define RT_CACHE_SHARDS 16
+#define RT_CACHE_S3FIFO_SMALL_PERCENT 10
+#define RT_CACHE_S3FIFO_FREQ_MAX 3
+#define RT_CACHE_GHOST_WAYS 4
+
+// bookkeeping that precedes each value inside its map node
+typedef struct _RT_CacheEntry {
+    struct _RT_CacheEntry *prev; // towards the front of the queue
+    struct _RT_CacheEntry *next;
+    RT_HTNode *node;             // owns the key
+    size_t hash;
+    size_t charge;               // bytes counted against the budget
+    uint64_t expires;            // GetTickCount64() deadline, 0 = never
+    uint8_t freq;                // hits since queued or last second chance
+    uint8_t queue;
+} RT_CacheEntry;
+
+typedef struct _RT_CacheQueue {
+    RT_CacheEntry *head; // most recently queued
+    RT_CacheEntry *tail; // next to evict
+    size_t bytes;
+    size_t count;
+} RT_CacheQueue;
+
+typedef struct _RT_CacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+    uint64_t expirations;
+    size_t size;
+    size_t bytes;
+} RT_CacheStats;
+
+typedef struct _RT_CacheShard {
+    SRWLOCK lock;
+    RT_HashMap map;
+    RT_CacheQueue queues[2];  // S3-FIFO: probation and main, the others only use [0]
+    size_t *ghost;            // S3-FIFO: hashes of keys evicted from probation
+    size_t ghost_buckets;     // power of two, RT_CACHE_GHOST_WAYS hashes each
+    size_t ghost_next;        // way to overwrite next
+    size_t budget;
+    size_t bytes;
+    volatile LONGLONG hits;   // also counted under the shared lock
+    volatile LONGLONG misses;
+    uint64_t insertions;
+    uint64_t evictions;
+    uint64_t expirations;
+    char pad[64];             // keeps neighbouring shards' locks off each other's cache lines
+} RT_CacheShard;
+
+typedef struct _RT_Cache {
+    RT_CacheShard *shards;
+    size_t shard_count;       // power of two
+    int policy;
+} RT_Cache;
+
+/* capacity is in bytes. shards is rounded up to a power of two,
+ * 0 = RT_CACHE_SHARDS. */
+bool rt_cache_init(RT_Cache *cache, size_t capacity, size_t shards, int policy);
+void rt_cache_free(RT_Cache *cache);
+void rt_cache_clear(RT_Cache *cache);
+
+/* Inserts or replaces, evicting as needed. ttl_ms 0 = no expiry. Fails if the
+ * entry alone does not fit in a shard's budget. */
+bool rt_cache_put(RT_Cache *cache, const char *key, const void *value, size_t value_size, uint64_t ttl_ms);
+bool rt_cache_get(RT_Cache *cache, const char *key, void *out, size_t out_size);
+bool rt_cache_remove(RT_Cache *cache, const char *key);
+bool rt_cache_contains(RT_Cache *cache, const char *key); // does not count as a hit
+size_t rt_cache_purge_expired(RT_Cache *cache);
+void rt_cache_stats(RT_Cache *cache, RT_CacheStats *out); // sums over the shards
+
+#endif // _INC_RT_CACHE
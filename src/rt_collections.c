@@ -1,4 +1,6 @@
 #include "rt_collections.h"
+#include "rt_simd.h"
+#include "rt_thread.h"
 
 bool 
 rt__ensure_capacity(void **data, size_t *data_cap, size_t expected_cap, size_t init_cap)
@@ -7,7 +9,7 @@ rt__ensure_capacity(void **data, size_t *data_cap, size_t expected_cap, size_t i
         size_t c = *data_cap ? *data_cap : init_cap;
         while (c < expected_cap) c *= 2;
 
-        void *p = *data ? realloc(*data, c) : malloc(c);
+        void *p = *data ? RT_REALLOC(*data, c) : RT_MALLOC(c);
         if (!p) return false;
 
         *data = p;
@@ -23,7 +25,7 @@ bool rt_array_init(RT_Array *arr, size_t size, size_t elem_size)
     if (!arr || size == 0 || elem_size == 0 || arr->data) return false;
 
     arr->capacity = size > 0 ? size * elem_size : RT_ARRAY_INIT_CAP;
-    arr->data = malloc(arr->capacity);
+    arr->data = RT_MALLOC(arr->capacity);
     if (!arr->data) return false;
     arr->elem_size = elem_size;
     arr->size = 0;
@@ -34,7 +36,7 @@ bool rt_array_init(RT_Array *arr, size_t size, size_t elem_size)
 void rt_array_free(RT_Array *arr)
 {
     if (!arr || !arr->data) return;
-    free(arr->data);
+    RT_FREE(arr->data);
     arr->data = NULL;
     arr->capacity = 0;
     arr->size = 0;
@@ -108,16 +110,237 @@ void rt_array_foreach(RT_Array *arr, bool (*callback)(void *arr_elem, size_t ele
     }
 }
 
+static bool rt__darray_realloc(RT_DynamicArray *arr, size_t new_cap)
+{
+    if (new_cap > SIZE_MAX / arr->element_size) return false;
+
+    void *new_data = RT_REALLOC(arr->data, new_cap * arr->element_size);
+    if (!new_data) return false;
+
+    arr->data = new_data;
+    arr->capacity = new_cap;
+    return true;
+}
+
+static bool rt__darray_grow(RT_DynamicArray *arr, size_t min_cap)
+{
+    if (arr->capacity >= min_cap) return true;
+
+    double growth = arr->growth_factor > 1.0 ? arr->growth_factor : RT_DARRAY_GROWTH_FACTOR;
+    double grown = (double)arr->capacity * growth;
+    size_t new_cap = grown < (double)SIZE_MAX ? (size_t)grown : SIZE_MAX;
+
+    if (new_cap <= arr->capacity) new_cap = arr->capacity + 1;
+    if (new_cap < min_cap) new_cap = min_cap;
+
+    return rt__darray_realloc(arr, new_cap);
+}
+
+// byte offset of `values` when it points at the array's own elements,
+// SIZE_MAX otherwise; a grow moves them, so callers rebase from it
+static inline size_t rt__darray_offset_of(const RT_DynamicArray *arr, const void *values)
+{
+    const uintptr_t p = (uintptr_t)values, data = (uintptr_t)arr->data;
+    return data && p >= data && p < data + arr->size * arr->element_size ? (size_t)(p - data) : SIZE_MAX;
+}
+
+/* Searches are bytewise (like rt_list_find); 1/2/4/8-byte elements use SIMD kernels. */
+static size_t rt__find_all(const void *data, size_t n, size_t esize, const void *value, RT_DynamicArray *indices)
+{
+    if (!indices->data && !rt_darray_init(indices, sizeof(size_t))) return 0;
+    if (indices->element_size != sizeof(size_t)) return 0;
+
+    size_t found = 0;
+    size_t i = rt__simd_find_eq(data, n, esize, value, 0);
+    while (i < n) {
+        if (!rt_darray_push(indices, &i)) break;
+        found++;
+        i = rt__simd_find_eq(data, n, esize, value, i + 1);
+    }
+
+    return found;
+}
+
+size_t rt_array_find(RT_Array *arr, const void *value)
+{
+    if (!arr || !value || rt_array_is_empty(arr)) return RT_NPOS;
+
+    size_t i = rt__simd_find_eq(arr->data, arr->size, arr->elem_size, value, 0);
+    return i < arr->size ? i : RT_NPOS;
+}
+
+size_t rt_array_count(RT_Array *arr, const void *value)
+{
+    if (!arr || !value || rt_array_is_empty(arr)) return 0;
+    return rt__simd_count_eq(arr->data, arr->size, arr->elem_size, value);
+}
+
+size_t rt_array_find_all(RT_Array *arr, const void *value, RT_DynamicArray *indices)
+{
+    if (!arr || !value || !indices || rt_array_is_empty(arr)) return 0;
+    return rt__find_all(arr->data, arr->size, arr->elem_size, value, indices);
+}
+
+bool rt_array_min(RT_Array *arr, RT_ElemType type, void *out)
+{
+    if (!arr || !out || arr->elem_size != rt_elem_type_size(type)) return false;
+    return rt__simd_minmax(arr->data, arr->size, type, out, NULL);
+}
+
+bool rt_array_max(RT_Array *arr, RT_ElemType type, void *out)
+{
+    if (!arr || !out || arr->elem_size != rt_elem_type_size(type)) return false;
+    return rt__simd_minmax(arr->data, arr->size, type, NULL, out);
+}
+
+/* One-pass compaction: surviving runs are moved down with one memmove each
+ * and the predicate runs exactly once per element. Returns the new size. */
+static size_t rt__compact_if(void *data, size_t n, size_t esize, void *user,
+    bool (*callback)(const void *arr_elem, void *user_data), bool erase_on)
+{
+    char *p = data;
+    size_t i = 0;
+
+    while (i < n && callback(p + i * esize, user) != erase_on) i++; // untouched prefix
+    size_t j = i++;
+
+    while (i < n) {
+        if (callback(p + i * esize, user) == erase_on) {
+            i++;
+            continue;
+        }
+
+        size_t end = i + 1;
+        while (end < n && callback(p + end * esize, user) != erase_on) end++;
+        memmove(p + j * esize, p + i * esize, (end - i) * esize);
+        j += end - i;
+        i = end + 1; // `end` is either n or an erased element
+    }
+
+    return j;
+}
+
+static size_t rt__erase_indices(void *data, size_t n, size_t esize, const size_t *indices, size_t count)
+{
+    for (size_t k = 0; k < count; ++k) {
+        if (indices[k] >= n || (k > 0 && indices[k] < indices[k - 1])) return n;
+    }
+
+    char *p = data;
+    size_t j = indices[0], k = 0;
+
+    while (k < count) {
+        size_t from = indices[k];
+        while (k < count && indices[k] == from) k++; // duplicates
+        size_t start = from + 1;
+        size_t end = k < count ? indices[k] : n;
+        memmove(p + j * esize, p + start * esize, (end - start) * esize);
+        j += end - start;
+    }
+
+    return j;
+}
+
+typedef struct _RT__CompactTask {
+    char *data;
+    size_t n;
+    size_t kept;
+    RT_ElemType type;
+    RT_CmpOp op;
+    const void *value;
+} RT__CompactTask;
+
+static DWORD rt__compact_worker(void *param)
+{
+    RT__CompactTask *task = param;
+    task->kept = rt__simd_compact(task->data, task->n, task->type, task->op, task->value);
+    return 0;
+}
+
+/* Large arrays: every thread compacts its own chunk in place, then the
+ * chunks are slid down next to each other. */
+static size_t rt__erase_where(void *data, size_t n, RT_ElemType type, RT_CmpOp op, const void *value, size_t threads)
+{
+    if (threads == 0) threads = rt_thread_cpu_count();
+    if (threads > RT_THREAD_MAX_TASKS) threads = RT_THREAD_MAX_TASKS;
+    if (threads < 2 || n < RT_COMPACT_PARALLEL_MIN) return rt__simd_compact(data, n, type, op, value);
+
+    const size_t esize = rt_elem_type_size(type);
+    RT__CompactTask tasks[RT_THREAD_MAX_TASKS];
+
+    for (size_t t = 0; t < threads; ++t) {
+        size_t lo = n * t / threads, hi = n * (t + 1) / threads;
+        tasks[t].data = (char*)data + lo * esize;
+        tasks[t].n = hi - lo;
+        tasks[t].type = type;
+        tasks[t].op = op;
+        tasks[t].value = value;
+    }
+    rt_thread_run_tasks(tasks, sizeof(RT__CompactTask), threads, rt__compact_worker);
+
+    size_t j = tasks[0].kept;
+    for (size_t t = 1; t < threads; ++t) {
+        memmove((char*)data + j * esize, tasks[t].data, tasks[t].kept * esize);
+        j += tasks[t].kept;
+    }
+
+    return j;
+}
+
+size_t rt_array_erase_if(RT_Array *arr, void *data, bool (*callback)(const void *arr_elem, void *user_data))
+{
+    if (!arr || !callback || rt_array_is_empty(arr)) return 0;
+
+    size_t n = rt__compact_if(arr->data, arr->size, arr->elem_size, data, callback, true);
+    size_t removed = arr->size - n;
+    arr->size = n;
+    return removed;
+}
+
+size_t rt_array_retain(RT_Array *arr, void *data, bool (*callback)(const void *arr_elem, void *user_data))
+{
+    if (!arr || !callback || rt_array_is_empty(arr)) return 0;
+
+    size_t n = rt__compact_if(arr->data, arr->size, arr->elem_size, data, callback, false);
+    size_t removed = arr->size - n;
+    arr->size = n;
+    return removed;
+}
+
+size_t rt_array_erase_indices(RT_Array *arr, const size_t *indices, size_t count)
+{
+    if (!arr || !indices || count == 0 || rt_array_is_empty(arr)) return 0;
+
+    size_t n = rt__erase_indices(arr->data, arr->size, arr->elem_size, indices, count);
+    size_t removed = arr->size - n;
+    arr->size = n;
+    return removed;
+}
+
+size_t rt_array_erase_where(RT_Array *arr, RT_ElemType type, RT_CmpOp op, const void *value, size_t threads)
+{
+    if (!arr || !value || rt_array_is_empty(arr) || arr->elem_size != rt_elem_type_size(type)) return 0;
+
+    size_t n = rt__erase_where(arr->data, arr->size, type, op, value, threads);
+    size_t removed = arr->size - n;
+    arr->size = n;
+    return removed;
+}
+
 bool rt_darray_init(RT_DynamicArray *arr, size_t element_size)
 {
     if (!arr || element_size == 0) return false;
 
-    arr->data = malloc(RT_DARRAY_INIT_CAP);
+    size_t cap = RT_DARRAY_INIT_CAP / element_size;
+    if (cap == 0) cap = 1;
+
+    arr->data = RT_MALLOC(cap * element_size);
     if (!arr->data) return false;
 
-    arr->capacity = RT_DARRAY_INIT_CAP;
+    arr->capacity = cap;
     arr->size = 0;
     arr->element_size = element_size;
+    arr->growth_factor = RT_DARRAY_GROWTH_FACTOR;
 
     return true;
 }
@@ -125,7 +348,7 @@ bool rt_darray_init(RT_DynamicArray *arr, size_t element_size)
 void rt_darray_free(RT_DynamicArray *arr)
 {
     if (!arr) return;
-    free(arr->data);
+    RT_FREE(arr->data);
     arr->data = NULL;
     arr->size = 0;
     arr->capacity = 0;
@@ -136,13 +359,9 @@ bool rt_darray_push(RT_DynamicArray *arr, const void *value)
 {
     if (!arr || !value) return false;
 
-    if (arr->size >= arr->capacity) {
-        size_t new_cap = arr->capacity * 2;
-        void *new_data = realloc(arr->data, new_cap * arr->element_size);
-        if (!new_data) return false;
-        arr->data = new_data;
-        arr->capacity = new_cap;
-    }
+    const size_t offset = rt__darray_offset_of(arr, value);
+    if (arr->size >= arr->capacity && !rt__darray_grow(arr, arr->size + 1)) return false;
+    if (offset != SIZE_MAX) value = (char*)arr->data + offset;
 
     memcpy((char*)arr->data + arr->size * arr->element_size, value, arr->element_size);
     arr->size++;
@@ -150,6 +369,49 @@ bool rt_darray_push(RT_DynamicArray *arr, const void *value)
     return true;
 }
 
+bool rt_darray_push_n(RT_DynamicArray *arr, const void *values, size_t count)
+{
+    if (!arr || (!values && count)) return false;
+    if (count == 0) return true;
+    if (count > SIZE_MAX - arr->size) return false;
+
+    const size_t offset = rt__darray_offset_of(arr, values);
+    if (!rt__darray_grow(arr, arr->size + count)) return false;
+    if (offset != SIZE_MAX) values = (char*)arr->data + offset;
+
+    memcpy((char*)arr->data + arr->size * arr->element_size, values, count * arr->element_size);
+    arr->size += count;
+
+    return true;
+}
+
+bool rt_darray_insert_n(RT_DynamicArray *arr, size_t index, const void *values, size_t count)
+{
+    if (!arr || (!values && count) || index > arr->size) return false;
+    if (count == 0) return true;
+    if (count > SIZE_MAX - arr->size) return false;
+
+    const size_t offset = rt__darray_offset_of(arr, values);
+    if (!rt__darray_grow(arr, arr->size + count)) return false;
+
+    const size_t esize = arr->element_size;
+    const size_t bytes = count * esize;
+    char *at = (char*)arr->data + index * esize;
+    memmove(at + bytes, at, (arr->size - index) * esize);
+    if (offset == SIZE_MAX) {
+        memcpy(at, values, bytes);
+    } else {
+        // source bytes before the insertion point stayed, the rest moved up
+        const size_t split = index * esize;
+        const size_t head = offset < split ? (split - offset < bytes ? split - offset : bytes) : 0;
+        memcpy(at, (char*)arr->data + offset, head);
+        memcpy(at + head, (char*)arr->data + offset + head + bytes, bytes - head);
+    }
+    arr->size += count;
+
+    return true;
+}
+
 bool rt_darray_get(RT_DynamicArray *arr, size_t index, void *out)
 {
     if (!arr || !out || index >= arr->size) return false;
@@ -168,19 +430,113 @@ bool rt_darray_pop(RT_DynamicArray *arr, void *out)
 {
     if (!arr || arr->size == 0) return false;
     arr->size--;
-    memcpy(out, (char*)arr->data + arr->size * arr->element_size, arr->element_size);
-
-    if (arr->size > 0 && arr->size <= arr->capacity / 4 && arr->capacity > RT_DARRAY_INIT_CAP) {
-        size_t new_cap = arr->capacity / 2;
-        void *new_data = realloc(arr->data, new_cap * arr->element_size);
-        if (new_data) {
-            arr->data = new_data;
-            arr->capacity = new_cap;
-        }
+    if (out) memcpy(out, (char*)arr->data + arr->size * arr->element_size, arr->element_size);
+
+    // shrink only well below the growth point, and keep one growth step of headroom
+    const double growth = arr->growth_factor > 1.0 ? arr->growth_factor : RT_DARRAY_GROWTH_FACTOR;
+    const size_t min_cap = RT_DARRAY_INIT_CAP / arr->element_size;
+    if (arr->size > 0 && arr->capacity > min_cap
+        && (double)arr->size * growth * growth <= (double)arr->capacity) {
+        size_t new_cap = (size_t)((double)arr->size * growth);
+        if (new_cap < min_cap) new_cap = min_cap;
+        if (new_cap < arr->capacity) rt__darray_realloc(arr, new_cap);
     }
     return true;
 }
 
+bool rt_darray_reserve(RT_DynamicArray *arr, size_t capacity)
+{
+    if (!arr || arr->element_size == 0) return false;
+    if (arr->capacity >= capacity) return true;
+    return rt__darray_realloc(arr, capacity);
+}
+
+bool rt_darray_shrink_to_fit(RT_DynamicArray *arr)
+{
+    if (!arr || arr->element_size == 0) return false;
+    if (arr->capacity == arr->size || arr->size == 0) return true;
+    return rt__darray_realloc(arr, arr->size);
+}
+
+bool rt_darray_set_growth(RT_DynamicArray *arr, double growth_factor)
+{
+    if (!arr || !(growth_factor > 1.0)) return false;
+    arr->growth_factor = growth_factor;
+    return true;
+}
+
+size_t rt_darray_find(RT_DynamicArray *arr, const void *value)
+{
+    if (!arr || !value || arr->size == 0) return RT_NPOS;
+
+    size_t i = rt__simd_find_eq(arr->data, arr->size, arr->element_size, value, 0);
+    return i < arr->size ? i : RT_NPOS;
+}
+
+size_t rt_darray_count(RT_DynamicArray *arr, const void *value)
+{
+    if (!arr || !value || arr->size == 0) return 0;
+    return rt__simd_count_eq(arr->data, arr->size, arr->element_size, value);
+}
+
+size_t rt_darray_find_all(RT_DynamicArray *arr, const void *value, RT_DynamicArray *indices)
+{
+    if (!arr || !value || !indices || indices == arr || arr->size == 0) return 0;
+    return rt__find_all(arr->data, arr->size, arr->element_size, value, indices);
+}
+
+bool rt_darray_min(RT_DynamicArray *arr, RT_ElemType type, void *out)
+{
+    if (!arr || !out || arr->element_size != rt_elem_type_size(type)) return false;
+    return rt__simd_minmax(arr->data, arr->size, type, out, NULL);
+}
+
+bool rt_darray_max(RT_DynamicArray *arr, RT_ElemType type, void *out)
+{
+    if (!arr || !out || arr->element_size != rt_elem_type_size(type)) return false;
+    return rt__simd_minmax(arr->data, arr->size, type, NULL, out);
+}
+
+size_t rt_darray_erase_if(RT_DynamicArray *arr, void *data, bool (*callback)(const void *arr_elem, void *user_data))
+{
+    if (!arr || !arr->data || !callback || arr->size == 0) return 0;
+
+    size_t n = rt__compact_if(arr->data, arr->size, arr->element_size, data, callback, true);
+    size_t removed = arr->size - n;
+    arr->size = n;
+    return removed;
+}
+
+size_t rt_darray_retain(RT_DynamicArray *arr, void *data, bool (*callback)(const void *arr_elem, void *user_data))
+{
+    if (!arr || !arr->data || !callback || arr->size == 0) return 0;
+
+    size_t n = rt__compact_if(arr->data, arr->size, arr->element_size, data, callback, false);
+    size_t removed = arr->size - n;
+    arr->size = n;
+    return removed;
+}
+
+size_t rt_darray_erase_indices(RT_DynamicArray *arr, const size_t *indices, size_t count)
+{
+    if (!arr || !arr->data || !indices || count == 0 || arr->size == 0) return 0;
+
+    size_t n = rt__erase_indices(arr->data, arr->size, arr->element_size, indices, count);
+    size_t removed = arr->size - n;
+    arr->size = n;
+    return removed;
+}
+
+size_t rt_darray_erase_where(RT_DynamicArray *arr, RT_ElemType type, RT_CmpOp op, const void *value, size_t threads)
+{
+    if (!arr || !arr->data || !value || arr->size == 0 || arr->element_size != rt_elem_type_size(type)) return 0;
+
+    size_t n = rt__erase_where(arr->data, arr->size, type, op, value, threads);
+    size_t removed = arr->size - n;
+    arr->size = n;
+    return removed;
+}
+
 void rt_darray_print(RT_DynamicArray *arr)
 {
     for (size_t i = 0; i < arr->size; ++i) {
@@ -191,6 +547,679 @@ void rt_darray_print(RT_DynamicArray *arr)
     printf("\n");
 }
 
+static void rt__sarray_reset(RT_SmallArray *arr)
+{
+    arr->data = arr->inline_data.bytes;
+    arr->size = 0;
+    arr->capacity = RT_SARRAY_INLINE_SIZE / arr->element_size;
+}
+
+// byte offset of `values` among the elements, SIZE_MAX if it points elsewhere
+static inline size_t rt__sarray_offset_of(const RT_SmallArray *arr, const void *values)
+{
+    const uintptr_t p = (uintptr_t)values, data = (uintptr_t)arr->data;
+    return p >= data && p < data + arr->size * arr->element_size ? (size_t)(p - data) : SIZE_MAX;
+}
+
+static bool rt__sarray_grow(RT_SmallArray *arr, size_t min_cap)
+{
+    if (arr->capacity >= min_cap) return true;
+
+    double grown = (double)arr->capacity * RT_DARRAY_GROWTH_FACTOR;
+    size_t new_cap = grown < (double)SIZE_MAX ? (size_t)grown : SIZE_MAX;
+    if (new_cap < min_cap) new_cap = min_cap;
+    if (new_cap > SIZE_MAX / arr->element_size) return false;
+
+    void *new_data;
+    if (rt_sarray_is_inline(arr)) { // spill
+        new_data = RT_MALLOC(new_cap * arr->element_size);
+        if (!new_data) return false;
+        memcpy(new_data, arr->data, arr->size * arr->element_size);
+    } else {
+        new_data = RT_REALLOC(arr->data, new_cap * arr->element_size);
+        if (!new_data) return false;
+    }
+
+    arr->data = new_data;
+    arr->capacity = new_cap;
+    return true;
+}
+
+bool rt_sarray_init(RT_SmallArray *arr, size_t elem_size)
+{
+    if (!arr || elem_size == 0) return false;
+
+    arr->element_size = elem_size;
+    rt__sarray_reset(arr);
+    return true;
+}
+
+void rt_sarray_free(RT_SmallArray *arr)
+{
+    if (!arr || !arr->data) return;
+    if (!rt_sarray_is_inline(arr)) RT_FREE(arr->data);
+    rt__sarray_reset(arr);
+}
+
+bool rt_sarray_push(RT_SmallArray *arr, const void *value)
+{
+    if (!arr || !arr->data || !value) return false;
+
+    const size_t offset = rt__sarray_offset_of(arr, value);
+    if (arr->size >= arr->capacity && !rt__sarray_grow(arr, arr->size + 1)) return false;
+    if (offset != SIZE_MAX) value = (char*)arr->data + offset;
+
+    memcpy((char*)arr->data + arr->size * arr->element_size, value, arr->element_size);
+    arr->size++;
+    return true;
+}
+
+bool rt_sarray_push_n(RT_SmallArray *arr, const void *values, size_t count)
+{
+    if (!arr || !arr->data || (!values && count)) return false;
+    if (count == 0) return true;
+    const size_t offset = rt__sarray_offset_of(arr, values);
+    if (count > SIZE_MAX - arr->size || !rt__sarray_grow(arr, arr->size + count)) return false;
+    if (offset != SIZE_MAX) values = (char*)arr->data + offset;
+
+    memcpy((char*)arr->data + arr->size * arr->element_size, values, count * arr->element_size);
+    arr->size += count;
+    return true;
+}
+
+bool rt_sarray_get(RT_SmallArray *arr, size_t index, void *out)
+{
+    if (!arr || !out || index >= arr->size) return false;
+    memcpy(out, (char*)arr->data + index * arr->element_size, arr->element_size);
+    return true;
+}
+
+bool rt_sarray_set(RT_SmallArray *arr, size_t index, const void *value)
+{
+    if (!arr || !value || index >= arr->size) return false;
+    memcpy((char*)arr->data + index * arr->element_size, value, arr->element_size);
+    return true;
+}
+
+bool rt_sarray_pop(RT_SmallArray *arr, void *out)
+{
+    if (!arr || arr->size == 0) return false;
+
+    arr->size--;
+    if (out) memcpy(out, (char*)arr->data + arr->size * arr->element_size, arr->element_size);
+    return true;
+}
+
+bool rt_sarray_reserve(RT_SmallArray *arr, size_t capacity)
+{
+    if (!arr || !arr->data) return false;
+    return rt__sarray_grow(arr, capacity);
+}
+
+// `dst` must be initialized or zeroed, its old block is freed; `src` is left
+// empty and reusable
+bool rt_sarray_move(RT_SmallArray *dst, RT_SmallArray *src)
+{
+    if (!dst || !src || !src->data || dst == src) return false;
+
+    if (dst->data && !rt_sarray_is_inline(dst)) RT_FREE(dst->data);
+    dst->element_size = src->element_size;
+    dst->size = src->size;
+    dst->capacity = src->capacity;
+    if (rt_sarray_is_inline(src)) {
+        dst->data = dst->inline_data.bytes;
+        memcpy(dst->data, src->data, src->size * src->element_size);
+    } else {
+        dst->data = src->data; // heap block changes hands
+    }
+
+    rt__sarray_reset(src);
+    return true;
+}
+
+// hands the elements over as an RT_DynamicArray; `out` must not own anything
+bool rt_sarray_steal(RT_SmallArray *arr, RT_DynamicArray *out)
+{
+    if (!arr || !arr->data || !out) return false;
+
+    if (rt_sarray_is_inline(arr)) {
+        size_t cap = arr->size ? arr->size : 1;
+        out->data = RT_MALLOC(cap * arr->element_size);
+        if (!out->data) return false;
+        memcpy(out->data, arr->data, arr->size * arr->element_size);
+        out->capacity = cap;
+    } else {
+        out->data = arr->data;
+        out->capacity = arr->capacity;
+    }
+    out->size = arr->size;
+    out->element_size = arr->element_size;
+    out->growth_factor = RT_DARRAY_GROWTH_FACTOR;
+
+    rt__sarray_reset(arr);
+    return true;
+}
+
+static RT_Slot *rt__slotmap_resolve(RT_SlotMap *map, RT_SlotHandle handle)
+{
+    uint32_t slot = (uint32_t)handle;
+    uint32_t generation = (uint32_t)(handle >> 32);
+
+    if (!map || !map->slots || slot >= map->slots_count) return NULL;
+
+    // free slots already carry the next generation, so also check the slot is live
+    RT_Slot *s = &map->slots[slot];
+    if (s->generation != generation || s->index >= map->size || map->dense_slots[s->index] != slot) return NULL;
+    return s;
+}
+
+bool rt_slotmap_init(RT_SlotMap *map, size_t size, size_t elem_size)
+{
+    if (!map || elem_size == 0) return false;
+
+    memset(map, 0, sizeof(*map));
+    map->elem_size = elem_size;
+    map->free_head = RT__SLOTMAP_NO_SLOT;
+
+    size_t cap = size ? size : RT_SLOTMAP_INIT_CAP;
+    if (!rt__ensure_capacity(&map->data, &map->capacity, cap * elem_size, cap * elem_size)
+        || !rt__ensure_capacity((void**)&map->dense_slots, &map->dense_capacity,
+                                cap * sizeof(uint32_t), cap * sizeof(uint32_t))
+        || !rt__ensure_capacity((void**)&map->slots, &map->slots_capacity,
+                                cap * sizeof(RT_Slot), cap * sizeof(RT_Slot))) {
+        rt_slotmap_free(map);
+        return false;
+    }
+
+    return true;
+}
+
+void rt_slotmap_free(RT_SlotMap *map)
+{
+    if (!map) return;
+    RT_FREE(map->data);
+    RT_FREE(map->dense_slots);
+    RT_FREE(map->slots);
+    memset(map, 0, sizeof(*map));
+    map->free_head = RT__SLOTMAP_NO_SLOT;
+}
+
+RT_SlotHandle rt_slotmap_insert(RT_SlotMap *map, const void *value)
+{
+    if (!map || !map->data || !value) return RT_SLOT_HANDLE_NULL;
+
+    size_t n = map->size;
+    if (!rt__ensure_capacity(&map->data, &map->capacity, (n + 1) * map->elem_size, RT_SLOTMAP_INIT_CAP * map->elem_size)
+        || !rt__ensure_capacity((void**)&map->dense_slots, &map->dense_capacity,
+                                (n + 1) * sizeof(uint32_t), RT_SLOTMAP_INIT_CAP * sizeof(uint32_t))) {
+        return RT_SLOT_HANDLE_NULL;
+    }
+
+    uint32_t slot = map->free_head;
+    if (slot != RT__SLOTMAP_NO_SLOT) {
+        map->free_head = map->slots[slot].index;
+    } else {
+        if (map->slots_count >= RT__SLOTMAP_NO_SLOT) return RT_SLOT_HANDLE_NULL;
+        if (!rt__ensure_capacity((void**)&map->slots, &map->slots_capacity,
+                                 (map->slots_count + 1) * sizeof(RT_Slot), RT_SLOTMAP_INIT_CAP * sizeof(RT_Slot))) {
+            return RT_SLOT_HANDLE_NULL;
+        }
+        slot = (uint32_t)map->slots_count++;
+        map->slots[slot].generation = 1;
+    }
+
+    memcpy((char*)map->data + n * map->elem_size, value, map->elem_size);
+    map->dense_slots[n] = slot;
+    map->slots[slot].index = (uint32_t)n;
+    map->size++;
+
+    return ((RT_SlotHandle)map->slots[slot].generation << 32) | slot;
+}
+
+bool rt_slotmap_remove(RT_SlotMap *map, RT_SlotHandle handle, void *out)
+{
+    RT_Slot *s = rt__slotmap_resolve(map, handle);
+    if (!s) return false;
+
+    size_t index = s->index, last = map->size - 1;
+    char *elem = (char*)map->data + index * map->elem_size;
+    if (out) memcpy(out, elem, map->elem_size);
+
+    if (index != last) { // fill the hole with the last element
+        memcpy(elem, (char*)map->data + last * map->elem_size, map->elem_size);
+        map->dense_slots[index] = map->dense_slots[last];
+        map->slots[map->dense_slots[index]].index = (uint32_t)index;
+    }
+    map->size--;
+
+    // a slot whose generation would wrap is retired rather than reused
+    if (++s->generation != 0) {
+        s->index = map->free_head;
+        map->free_head = (uint32_t)handle;
+    }
+
+    return true;
+}
+
+void *rt_slotmap_get_ptr(RT_SlotMap *map, RT_SlotHandle handle)
+{
+    RT_Slot *s = rt__slotmap_resolve(map, handle);
+    return s ? (char*)map->data + s->index * map->elem_size : NULL;
+}
+
+bool rt_slotmap_get(RT_SlotMap *map, RT_SlotHandle handle, void *out)
+{
+    void *elem = rt_slotmap_get_ptr(map, handle);
+    if (!elem || !out) return false;
+
+    memcpy(out, elem, map->elem_size);
+    return true;
+}
+
+bool rt_slotmap_set(RT_SlotMap *map, RT_SlotHandle handle, const void *value)
+{
+    void *elem = rt_slotmap_get_ptr(map, handle);
+    if (!elem || !value) return false;
+
+    memcpy(elem, value, map->elem_size);
+    return true;
+}
+
+void rt_slotmap_clear(RT_SlotMap *map)
+{
+    if (!map || !map->data) return;
+
+    while (map->size > 0) {
+        uint32_t slot = map->dense_slots[map->size - 1];
+        rt_slotmap_remove(map, ((RT_SlotHandle)map->slots[slot].generation << 32) | slot, NULL);
+    }
+}
+
+/* Heaps. The element being sifted waits in a spare slot while the others move
+ * through the hole, so each level costs one element copy instead of a swap. */
+typedef struct _RT__HeapView {
+    char *data;
+    size_t esize;
+    size_t arity;
+    RT_CompareFunc cmp;
+    uint32_t *owners; // indexed heap only
+    RT_Slot *slots;
+} RT__HeapView;
+
+static inline void rt__heap_put(const RT__HeapView *h, size_t to, size_t from, uint32_t owner)
+{
+    memcpy(h->data + to * h->esize, h->data + from * h->esize, h->esize);
+    if (h->owners) {
+        h->owners[to] = owner;
+        h->slots[owner].index = (uint32_t)to;
+    }
+}
+
+// moves the element at `src` (outside the live range) up from `hole`
+static inline void rt__heap_sift_up(const RT__HeapView *h, size_t hole, size_t src, uint32_t owner)
+{
+    const void *value = h->data + src * h->esize;
+    while (hole > 0) {
+        size_t parent = (hole - 1) / h->arity;
+        if (h->cmp(value, h->data + parent * h->esize) >= 0) break;
+        rt__heap_put(h, hole, parent, h->owners ? h->owners[parent] : 0);
+        hole = parent;
+    }
+    rt__heap_put(h, hole, src, owner);
+}
+
+// moves the element at `src` (outside the first n) down from `hole`
+static inline void rt__heap_sift_down(const RT__HeapView *h, size_t n, size_t hole, size_t src, uint32_t owner)
+{
+    const void *value = h->data + src * h->esize;
+    for (;;) {
+        size_t first = hole * h->arity + 1;
+        if (first >= n) break;
+
+        size_t last = n - first > h->arity ? first + h->arity : n;
+        size_t best = first;
+        for (size_t c = first + 1; c < last; ++c) {
+            if (h->cmp(h->data + c * h->esize, h->data + best * h->esize) < 0) best = c;
+        }
+        if (h->cmp(h->data + best * h->esize, value) >= 0) break;
+
+        rt__heap_put(h, hole, best, h->owners ? h->owners[best] : 0);
+        hole = best;
+    }
+    rt__heap_put(h, hole, src, owner);
+}
+
+// byte offset of `p` inside a heap's block, SIZE_MAX if it lies outside;
+// reserving may move the block, so values are rebased from it afterwards
+static inline size_t rt__heap_offset_of(const void *data, size_t capacity, const void *p)
+{
+    const uintptr_t at = (uintptr_t)p, base = (uintptr_t)data;
+    return base && at >= base && at < base + capacity ? (size_t)(at - base) : SIZE_MAX;
+}
+
+static inline RT__HeapView rt__heap_view(const RT_Heap *heap)
+{
+    RT__HeapView h = {heap->data, heap->element_size, heap->arity, heap->cmp, NULL, NULL};
+    return h;
+}
+
+static void rt__heap_build(RT_Heap *heap)
+{
+    // Floyd: sift down every inner node, last one first; data[size] is scratch
+    if (heap->size < 2) return;
+
+    RT__HeapView h = rt__heap_view(heap);
+    const size_t n = heap->size;
+    for (size_t i = (n - 2) / heap->arity + 1; i-- > 0;) {
+        memcpy(h.data + n * h.esize, h.data + i * h.esize, h.esize);
+        rt__heap_sift_down(&h, n, i, n, 0);
+    }
+}
+
+bool rt_heap_init_ex(RT_Heap *heap, size_t elem_size, size_t arity, RT_CompareFunc cmp)
+{
+    if (!heap || elem_size == 0 || arity < 2 || !cmp) return false;
+
+    memset(heap, 0, sizeof(*heap));
+    heap->element_size = elem_size;
+    heap->arity = arity;
+    heap->cmp = cmp;
+
+    return rt__ensure_capacity(&heap->data, &heap->capacity,
+                               RT_HEAP_INIT_CAP * elem_size, RT_HEAP_INIT_CAP * elem_size);
+}
+
+bool rt_heap_init(RT_Heap *heap, size_t elem_size, RT_CompareFunc cmp)
+{
+    return rt_heap_init_ex(heap, elem_size, RT_HEAP_ARITY, cmp);
+}
+
+void rt_heap_free(RT_Heap *heap)
+{
+    if (!heap) return;
+
+    RT_FREE(heap->data);
+    heap->data = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
+}
+
+bool rt_heap_reserve(RT_Heap *heap, size_t count)
+{
+    if (!heap || !heap->data) return false;
+    if (count >= SIZE_MAX / heap->element_size - 2) return false;
+
+    return rt__ensure_capacity(&heap->data, &heap->capacity,
+                               (count + 2) * heap->element_size, RT_HEAP_INIT_CAP * heap->element_size);
+}
+
+bool rt_heap_push(RT_Heap *heap, const void *value)
+{
+    if (!heap || !value) return false;
+
+    const size_t offset = rt__heap_offset_of(heap->data, heap->capacity, value);
+    if (!rt_heap_reserve(heap, heap->size + 1)) return false;
+    if (offset != SIZE_MAX) value = (char*)heap->data + offset;
+
+    RT__HeapView h = rt__heap_view(heap);
+    const size_t n = heap->size;
+    memmove(h.data + (n + 1) * h.esize, value, h.esize); // value may be the spare slot
+    rt__heap_sift_up(&h, n, n + 1, 0);
+    heap->size++;
+
+    return true;
+}
+
+bool rt_heap_push_n(RT_Heap *heap, const void *values, size_t count)
+{
+    if (!heap || !values) return false;
+    if (count > SIZE_MAX - heap->size) return false;
+
+    const size_t offset = rt__heap_offset_of(heap->data, heap->capacity, values);
+    if (!rt_heap_reserve(heap, heap->size + count)) return false;
+
+    // a batch at least as large as the heap is cheaper to append and rebuild;
+    // so is one taken from the heap itself, which pushing would reorder
+    if (count < heap->size && offset == SIZE_MAX) {
+        for (size_t i = 0; i < count; ++i) rt_heap_push(heap, (const char*)values + i * heap->element_size);
+        return true;
+    }
+
+    if (offset != SIZE_MAX) values = (char*)heap->data + offset;
+    memmove((char*)heap->data + heap->size * heap->element_size, values, count * heap->element_size);
+    heap->size += count;
+    rt__heap_build(heap);
+
+    return true;
+}
+
+bool rt_heap_heapify(RT_Heap *heap, const void *values, size_t count)
+{
+    if (!heap || (!values && count)) return false;
+
+    heap->size = 0;
+    return count == 0 || rt_heap_push_n(heap, values, count);
+}
+
+bool rt_heap_pop(RT_Heap *heap, void *out)
+{
+    if (!heap || heap->size == 0) return false;
+
+    RT__HeapView h = rt__heap_view(heap);
+    if (out) memcpy(out, h.data, h.esize);
+
+    // the last element is already in the spare slot once size shrinks
+    const size_t n = --heap->size;
+    if (n > 0) rt__heap_sift_down(&h, n, 0, n, 0);
+
+    return true;
+}
+
+bool rt_heap_top(const RT_Heap *heap, void *out)
+{
+    if (!heap || heap->size == 0 || !out) return false;
+
+    memcpy(out, heap->data, heap->element_size);
+    return true;
+}
+
+static inline RT__HeapView rt__iheap_view(const RT_IndexedHeap *heap)
+{
+    RT__HeapView h = {heap->data, heap->element_size, heap->arity, heap->cmp, heap->owners, heap->slots};
+    return h;
+}
+
+static RT_Slot *rt__iheap_resolve(const RT_IndexedHeap *heap, RT_SlotHandle handle)
+{
+    uint32_t slot = (uint32_t)handle;
+    uint32_t generation = (uint32_t)(handle >> 32);
+
+    if (!heap || !heap->slots || slot >= heap->slots_count) return NULL;
+
+    RT_Slot *s = &heap->slots[slot];
+    if (s->generation != generation || s->index >= heap->size || heap->owners[s->index] != slot) return NULL;
+    return s;
+}
+
+static inline RT_SlotHandle rt__iheap_handle(const RT_IndexedHeap *heap, uint32_t slot)
+{
+    return ((RT_SlotHandle)heap->slots[slot].generation << 32) | slot;
+}
+
+// takes the element at `pos` out, the last one fills the gap
+static void rt__iheap_erase(RT_IndexedHeap *heap, size_t pos)
+{
+    RT__HeapView h = rt__iheap_view(heap);
+    const uint32_t slot = heap->owners[pos];
+    const size_t n = --heap->size;
+
+    if (pos != n) {
+        const uint32_t moved = heap->owners[n];
+        if (pos > 0 && h.cmp(h.data + n * h.esize, h.data + ((pos - 1) / h.arity) * h.esize) < 0) {
+            rt__heap_sift_up(&h, pos, n, moved);
+        } else {
+            rt__heap_sift_down(&h, n, pos, n, moved);
+        }
+    }
+
+    // a slot whose generation would wrap is retired rather than reused
+    RT_Slot *s = &heap->slots[slot];
+    if (++s->generation != 0) {
+        s->index = heap->free_head;
+        heap->free_head = slot;
+    }
+}
+
+bool rt_iheap_init_ex(RT_IndexedHeap *heap, size_t elem_size, size_t arity, RT_CompareFunc cmp)
+{
+    if (!heap || elem_size == 0 || arity < 2 || !cmp) return false;
+
+    memset(heap, 0, sizeof(*heap));
+    heap->element_size = elem_size;
+    heap->arity = arity;
+    heap->cmp = cmp;
+    heap->free_head = RT__SLOTMAP_NO_SLOT;
+
+    if (!rt__ensure_capacity(&heap->data, &heap->capacity,
+                             RT_HEAP_INIT_CAP * elem_size, RT_HEAP_INIT_CAP * elem_size)
+        || !rt__ensure_capacity((void**)&heap->owners, &heap->owners_capacity,
+                                RT_HEAP_INIT_CAP * sizeof(uint32_t), RT_HEAP_INIT_CAP * sizeof(uint32_t))
+        || !rt__ensure_capacity((void**)&heap->slots, &heap->slots_capacity,
+                                RT_HEAP_INIT_CAP * sizeof(RT_Slot), RT_HEAP_INIT_CAP * sizeof(RT_Slot))) {
+        rt_iheap_free(heap);
+        return false;
+    }
+
+    return true;
+}
+
+bool rt_iheap_init(RT_IndexedHeap *heap, size_t elem_size, RT_CompareFunc cmp)
+{
+    return rt_iheap_init_ex(heap, elem_size, RT_HEAP_ARITY, cmp);
+}
+
+void rt_iheap_free(RT_IndexedHeap *heap)
+{
+    if (!heap) return;
+
+    RT_FREE(heap->data);
+    RT_FREE(heap->owners);
+    RT_FREE(heap->slots);
+    heap->data = NULL;
+    heap->owners = NULL;
+    heap->slots = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
+    heap->owners_capacity = 0;
+    heap->slots_count = 0;
+    heap->slots_capacity = 0;
+    heap->free_head = RT__SLOTMAP_NO_SLOT;
+}
+
+RT_SlotHandle rt_iheap_push(RT_IndexedHeap *heap, const void *value)
+{
+    if (!heap || !heap->data || !value) return RT_SLOT_HANDLE_NULL;
+
+    const size_t n = heap->size;
+    const size_t offset = rt__heap_offset_of(heap->data, heap->capacity, value);
+    if (n >= RT__SLOTMAP_NO_SLOT - 1
+        || !rt__ensure_capacity(&heap->data, &heap->capacity,
+                                (n + 2) * heap->element_size, RT_HEAP_INIT_CAP * heap->element_size)
+        || !rt__ensure_capacity((void**)&heap->owners, &heap->owners_capacity,
+                                (n + 1) * sizeof(uint32_t), RT_HEAP_INIT_CAP * sizeof(uint32_t))) {
+        return RT_SLOT_HANDLE_NULL;
+    }
+
+    uint32_t slot = heap->free_head;
+    if (slot != RT__SLOTMAP_NO_SLOT) {
+        heap->free_head = heap->slots[slot].index;
+    } else {
+        if (heap->slots_count >= RT__SLOTMAP_NO_SLOT) return RT_SLOT_HANDLE_NULL;
+        if (!rt__ensure_capacity((void**)&heap->slots, &heap->slots_capacity,
+                                 (heap->slots_count + 1) * sizeof(RT_Slot), RT_HEAP_INIT_CAP * sizeof(RT_Slot))) {
+            return RT_SLOT_HANDLE_NULL;
+        }
+        slot = (uint32_t)heap->slots_count++;
+        heap->slots[slot].generation = 1;
+    }
+
+    if (offset != SIZE_MAX) value = (char*)heap->data + offset;
+
+    RT__HeapView h = rt__iheap_view(heap);
+    memmove(h.data + (n + 1) * h.esize, value, h.esize); // value may be the spare slot
+    heap->size++;
+    rt__heap_sift_up(&h, n, n + 1, slot);
+
+    return rt__iheap_handle(heap, slot);
+}
+
+bool rt_iheap_pop(RT_IndexedHeap *heap, void *out, RT_SlotHandle *handle)
+{
+    if (!heap || heap->size == 0) return false;
+
+    if (out) memcpy(out, heap->data, heap->element_size);
+    if (handle) *handle = rt__iheap_handle(heap, heap->owners[0]);
+    rt__iheap_erase(heap, 0);
+
+    return true;
+}
+
+bool rt_iheap_top(const RT_IndexedHeap *heap, void *out, RT_SlotHandle *handle)
+{
+    if (!heap || heap->size == 0) return false;
+
+    if (out) memcpy(out, heap->data, heap->element_size);
+    if (handle) *handle = rt__iheap_handle(heap, heap->owners[0]);
+
+    return true;
+}
+
+bool rt_iheap_get(const RT_IndexedHeap *heap, RT_SlotHandle handle, void *out)
+{
+    RT_Slot *s = rt__iheap_resolve(heap, handle);
+    if (!s) return false;
+
+    if (out) memcpy(out, (char*)heap->data + s->index * heap->element_size, heap->element_size);
+    return true;
+}
+
+bool rt_iheap_update(RT_IndexedHeap *heap, RT_SlotHandle handle, const void *value)
+{
+    RT_Slot *s = rt__iheap_resolve(heap, handle);
+    if (!s || !value) return false;
+
+    RT__HeapView h = rt__iheap_view(heap);
+    const size_t pos = s->index, n = heap->size;
+    memmove(h.data + n * h.esize, value, h.esize);
+
+    if (h.cmp(h.data + n * h.esize, h.data + pos * h.esize) < 0) {
+        rt__heap_sift_up(&h, pos, n, (uint32_t)handle);
+    } else {
+        rt__heap_sift_down(&h, n, pos, n, (uint32_t)handle);
+    }
+
+    return true;
+}
+
+bool rt_iheap_remove(RT_IndexedHeap *heap, RT_SlotHandle handle, void *out)
+{
+    RT_Slot *s = rt__iheap_resolve(heap, handle);
+    if (!s) return false;
+
+    if (out) memcpy(out, (char*)heap->data + s->index * heap->element_size, heap->element_size);
+    rt__iheap_erase(heap, s->index);
+
+    return true;
+}
+
+void rt_iheap_clear(RT_IndexedHeap *heap)
+{
+    if (!heap || !heap->data) return;
+
+    // pop from the back, no sifting needed
+    while (heap->size > 0) rt__iheap_erase(heap, heap->size - 1);
+}
+
 void rt_list_init(RT_List *list, size_t elem_size)
 {
     if (!list || elem_size == 0) return;
@@ -209,8 +1238,8 @@ void rt_list_free(RT_List *list)
     RT_ListNode *next;
     while (node) {
         next = node->next;
-        free(node->data);
-        free(node);
+        RT_FREE(node->data);
+        RT_FREE(node);
         node = next;
     }
     list->head = NULL;
@@ -222,11 +1251,11 @@ bool rt_list_push(RT_List *list, const void *value, int where)
 {
     if (!list || !value) return false;
 
-    RT_ListNode *node = malloc(sizeof(RT_ListNode));
+    RT_ListNode *node = RT_MALLOC(sizeof(RT_ListNode));
     if (!node) return false;
-    node->data = malloc(list->elem_size);
+    node->data = RT_MALLOC(list->elem_size);
     if (!node->data) {
-        free(node);
+        RT_FREE(node);
         return false;
     }
     node->next = NULL;
@@ -269,8 +1298,8 @@ bool rt_list_pop(RT_List *list, void *out, int where)
         list->tail = node->prev;
     }
 
-    free(node->data);
-    free(node);
+    RT_FREE(node->data);
+    RT_FREE(node);
     list->size--;
     return true;
 }
@@ -285,8 +1314,8 @@ bool rt_list_remove_node(RT_List *list, RT_ListNode *node)
     if (node == list->head) list->head = node->next;    
     if (node == list->tail) list->tail = node->prev;
 
-    free(node->data);
-    free(node);
+    RT_FREE(node->data);
+    RT_FREE(node);
     list->size--;    
     return true;
 }
@@ -346,17 +1375,37 @@ bool rt_list_get_tail(RT_List *list, void *out)
 
 bool rt_list_find(RT_List *list, const void *value, void *out)
 {
-    if (!list || list->size == 0) return false;
-
-    RT_ListNode *node;
-    for (node = list->head; node; node = node->next) {
-        if (memcmp(value, node->data, list->elem_size) == 0) {
-            memcpy(out, node->data, list->elem_size);
-            return true;
+    if (!list || !value || list->size == 0) return false;
+
+    // nodes are scattered so there is nothing to vectorize, but the key is
+    // loaded once and primitive sizes compare with a single load per node
+    RT_ListNode *node = NULL;
+    switch (list->elem_size) {
+    case 4: {
+        uint32_t k, v;
+        memcpy(&k, value, 4);
+        for (node = list->head; node; node = node->next) {
+            memcpy(&v, node->data, 4);
+            if (v == k) break;
+        }
+    } break;
+    case 8: {
+        uint64_t k, v;
+        memcpy(&k, value, 8);
+        for (node = list->head; node; node = node->next) {
+            memcpy(&v, node->data, 8);
+            if (v == k) break;
+        }
+    } break;
+    default:
+        for (node = list->head; node; node = node->next) {
+            if (memcmp(value, node->data, list->elem_size) == 0) break;
         }
     }
 
-    return false;
+    if (!node) return false;
+    if (out) memcpy(out, node->data, list->elem_size);
+    return true;
 }
 
 void rt_list_find_if(RT_List *list, void *data, bool (*callback)(const void *data, void *user_data))
@@ -395,7 +1444,7 @@ bool rt_stack_init(RT_Stack *stack, size_t elem_size)
 {
     if (!stack || elem_size == 0) return false;
 
-    stack->list = malloc(sizeof(RT_List));
+    stack->list = RT_MALLOC(sizeof(RT_List));
     if (!stack->list) return false;
 
     rt_list_init(stack->list, elem_size);
@@ -406,7 +1455,7 @@ void rt_stack_free(RT_Stack *stack)
 {
     if (!stack || !stack->list) return;
     rt_list_free(stack->list);
-    free(stack->list);
+    RT_FREE(stack->list);
 }
 
 bool rt_stack_push(RT_Stack *stack, const void *value)
@@ -437,7 +1486,7 @@ bool rt_deque_init(RT_Deque *deque, size_t elem_size)
 {
     if (!deque || elem_size == 0) return false;
 
-    deque->list = malloc(sizeof(RT_List));
+    deque->list = RT_MALLOC(sizeof(RT_List));
     if (!deque->list) return false;
     rt_list_init(deque->list, elem_size);
 
@@ -449,7 +1498,7 @@ void rt_deque_free(RT_Deque *deque)
     if (!deque) return;
 
     rt_list_free(deque->list);
-    free(deque->list);
+    RT_FREE(deque->list);
     deque->list = NULL;
 }
 
@@ -467,7 +1516,7 @@ bool rt_rbuffer_init(RT_RingBuffer *buffer, size_t size, size_t elem_size)
     if (!buffer || elem_size == 0) return false;
 
     size_t cap = size ? size * elem_size : RT_RBUFFER_INIT_CAP;
-    buffer->data = malloc(cap);
+    buffer->data = RT_MALLOC(cap);
     if (!buffer->data) return false;
 
     buffer->capacity = cap;
@@ -484,7 +1533,7 @@ void rt_rbuffer_free(RT_RingBuffer *buffer)
 {
     if (!buffer || !buffer->data) return;
 
-    free(buffer->data);
+    RT_FREE(buffer->data);
     buffer->data = NULL;
     buffer->size = 0;
     buffer->capacity = 0;
@@ -521,6 +1570,36 @@ bool rt_rbuffer_peek(RT_RingBuffer *buffer, void *out)
     return true;
 }
 
+// drops a mapped view, heap data is left alone
+static void rt__fbuffer_unmap(RT_FileBuffer *buffer)
+{
+    if (!buffer->mapping) return;
+
+    UnmapViewOfFile(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+    buffer->mapping = 0;
+}
+
+// moves the bytes of a mapped view to the heap
+static bool rt__fbuffer_detach(RT_FileBuffer *buffer)
+{
+    if (!buffer->mapping) return true;
+
+    const size_t size = buffer->size;
+    uint8_t *data = RT_MALLOC(size);
+    if (!data) return false;
+
+    memcpy(data, buffer->data, size);
+    rt__fbuffer_unmap(buffer);
+    buffer->data = data;
+    buffer->size = size;
+    buffer->capacity = size;
+
+    return true;
+}
+
 bool rt_fbuffer_init(RT_FileBuffer *buffer)
 {
     if (!buffer) return false;
@@ -528,6 +1607,7 @@ bool rt_fbuffer_init(RT_FileBuffer *buffer)
     buffer->data = NULL;
     buffer->size = 0;
     buffer->capacity = 0;
+    buffer->mapping = 0;
 
     return true;
 }
@@ -535,8 +1615,10 @@ bool rt_fbuffer_init(RT_FileBuffer *buffer)
 void rt_fbuffer_free(RT_FileBuffer *buffer)
 {
     if (!buffer) return;
-    if (buffer->data) {
-        free(buffer->data);
+    if (buffer->mapping) {
+        rt__fbuffer_unmap(buffer);
+    } else if (buffer->data) {
+        RT_FREE(buffer->data);
         buffer->data = NULL;
         buffer->size = 0;
         buffer->capacity = 0;
@@ -547,15 +1629,19 @@ size_t rt_fbuffer_read_file(RT_FileBuffer *buffer, const char *file_path)
 {
     if (!buffer || !file_path) return 0;
 
+    rt__fbuffer_unmap(buffer);
+
     FILE *f = fopen(file_path, "rb");
     if (!f) return 0;
 
-    fseek(f, 0L, SEEK_END);
-    size_t fsize = ftell(f);
+    // ftell is 32-bit on Windows
+    _fseeki64(f, 0, SEEK_END);
+    const long long fend = _ftelli64(f);
     rewind(f);
 
-    if (fsize == 0)
+    if (fend <= 0 || (unsigned long long)fend > SIZE_MAX)
         goto cleanup;
+    const size_t fsize = (size_t)fend;
 
     if (!rt__ensure_capacity(
         (void*)&buffer->data, 
@@ -578,10 +1664,49 @@ cleanup:
     return 0;
 }
 
+size_t rt_fbuffer_map_file(RT_FileBuffer *buffer, const char *file_path, int flags)
+{
+    if (!buffer || !file_path) return 0;
+
+    const bool copy = flags & RT_FBUFFER_MAP_COPY;
+    DWORD hints = FILE_ATTRIBUTE_NORMAL;
+    if (flags & RT_FBUFFER_MAP_SEQUENTIAL) hints = FILE_FLAG_SEQUENTIAL_SCAN;
+    else if (flags & RT_FBUFFER_MAP_RANDOM) hints = FILE_FLAG_RANDOM_ACCESS;
+
+    HANDLE file = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, hints, NULL);
+    if (file == INVALID_HANDLE_VALUE) return 0;
+
+    LARGE_INTEGER fsize;
+    HANDLE mapping = NULL;
+    void *view = NULL;
+
+    // empty files cannot be mapped
+    if (GetFileSizeEx(file, &fsize) && fsize.QuadPart > 0 && (unsigned long long)fsize.QuadPart <= SIZE_MAX) {
+        mapping = CreateFileMappingA(file, NULL, copy ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+        if (mapping) view = MapViewOfFile(mapping, copy ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    }
+
+    // the view keeps the mapping and the file alive on its own
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(file);
+    if (!view) return 0;
+
+    rt_fbuffer_free(buffer);
+    buffer->data = view;
+    buffer->size = (size_t)fsize.QuadPart;
+    buffer->capacity = 0;
+    buffer->mapping = copy ? RT_FBUFFER_MAP_COPY : RT_FBUFFER_MAP_READ;
+
+    return buffer->size;
+}
+
 size_t rt_fbuffer_write_file(RT_FileBuffer *buffer, const char *file_path)
 {
     if (!(buffer && buffer->data) || buffer->size == 0 || !file_path) return false;
 
+    // the view may be of the very file about to be truncated
+    if (!rt__fbuffer_detach(buffer)) return 0;
+
     FILE *f = fopen(file_path, "wb");
     if (!f) return 0;
 
@@ -599,6 +1724,8 @@ bool rt_fbuffer_set(RT_FileBuffer *buffer, const void *data, size_t size)
 {
     if (!buffer || !data || size == 0) return false;
 
+    rt__fbuffer_unmap(buffer);
+
     if (!rt__ensure_capacity(
         (void*)&buffer->data, 
         &buffer->capacity, 
@@ -617,6 +1744,7 @@ bool rt_fbuffer_clone(RT_FileBuffer *dst, const RT_FileBuffer *src)
     if (!(dst && src && src->data) || src->size == 0) return false;
     if (dst == src) return true;
 
+    rt__fbuffer_unmap(dst);
     if (!rt__ensure_capacity(
         (void*)&dst->data, 
         &dst->capacity, 
@@ -646,12 +1774,14 @@ uint8_t* rt_fbuffer_at(const RT_FileBuffer *buffer, size_t offset)
 void rt_fbuffer_clear(RT_FileBuffer *buffer)
 {
     if (!buffer) return;
+    rt__fbuffer_unmap(buffer);
     buffer->size = 0;
 }
 
 bool rt_fbuffer_reserve(RT_FileBuffer *buffer, size_t size)
 {
     if (!buffer || size == 0) return false;
+    if (!rt__fbuffer_detach(buffer)) return false;
     if (buffer->capacity >= size) return true; // there is enough mem already
 
     if (!rt__ensure_capacity(
@@ -667,6 +1797,7 @@ bool rt_fbuffer_reserve(RT_FileBuffer *buffer, size_t size)
 bool rt_fbuffer_resize(RT_FileBuffer *buffer, size_t size)
 {
     if (!buffer || size == 0) return false;
+    if (!rt__fbuffer_detach(buffer)) return false;
 
     if (!rt__ensure_capacity(
         (void*)&buffer->data, 
@@ -683,6 +1814,7 @@ bool rt_fbuffer_resize(RT_FileBuffer *buffer, size_t size)
 bool rt_fbuffer_fill(RT_FileBuffer *buffer, uint8_t byte)
 {
     if (!(buffer && buffer->data) || buffer->size == 0) return false;
+    if (buffer->mapping) return rt_fbuffer_fill_ex(buffer, byte, buffer->size);
     memset(buffer->data, byte, buffer->size);
     return true;
 }
@@ -691,6 +1823,7 @@ bool rt_fbuffer_fill_ex(RT_FileBuffer *buffer, uint8_t byte, size_t size)
 {
     if (!buffer || size == 0) return false;
     
+    rt__fbuffer_unmap(buffer);
     if (!rt__ensure_capacity(
         (void*)&buffer->data, 
         &buffer->capacity, 
@@ -708,7 +1841,7 @@ bool rt_hashmap_init(RT_HashMap *map, size_t buckets_count)
     if (!map) return false;
     if (buckets_count == 0) buckets_count = RT_HASHMAP_INIT_BUCKETS_COUNT;
     
-    map->buckets = calloc(buckets_count, sizeof(RT_HTBucket));
+    map->buckets = RT_CALLOC(buckets_count, sizeof(RT_HTBucket));
     if (!map->buckets) return false;
 
     map->buckets_count = buckets_count;
@@ -726,14 +1859,14 @@ void rt_hashmap_free(RT_HashMap *map)
         RT_HTNode *e = map->buckets[i].head;
         while (e) {
             RT_HTNode *n = e->next;
-            free(e->key);
-            free(e->value);
-            free(e);
+            RT_FREE(e->key);
+            RT_FREE(e->value);
+            RT_FREE(e);
             e = n;
         }
     }
 
-    free(map->buckets);
+    RT_FREE(map->buckets);
     map->buckets = NULL;
     map->hash_func = NULL;
     map->buckets_count = 0;
@@ -802,8 +1935,8 @@ bool rt_hashmap_remove(RT_HashMap *map, const char *key)
 
     while (node) {
         if (strcmp(key, node->key) == 0) {
-            free(node->value);
-            free(node->key);
+            RT_FREE(node->value);
+            RT_FREE(node->key);
 
             if (prev_node) {
                 prev_node->next = node->next;
@@ -811,7 +1944,7 @@ bool rt_hashmap_remove(RT_HashMap *map, const char *key)
                 bucket->head = node->next;
             }
 
-            free(node);
+            RT_FREE(node);
             bucket->count--;
             map->size--;
 
@@ -845,7 +1978,7 @@ bool rt_hashmap_rehash(RT_HashMap *map, size_t new_buckets_count)
 {
     if (!map || new_buckets_count == 0) return false;
 
-    RT_HTBucket *new_buckets = calloc(new_buckets_count, sizeof(RT_HTBucket));
+    RT_HTBucket *new_buckets = RT_CALLOC(new_buckets_count, sizeof(RT_HTBucket));
     if (!new_buckets) return false;
 
     for (size_t i = 0; i < map->buckets_count; ++i) {
@@ -863,7 +1996,7 @@ bool rt_hashmap_rehash(RT_HashMap *map, size_t new_buckets_count)
         }
     }
 
-    free(map->buckets);
+    RT_FREE(map->buckets);
     map->buckets = new_buckets;
     map->buckets_count = new_buckets_count;
     
@@ -8,9 +8,80 @@
 #include <stdint.h>
 #include <string.h>
 
+/* Allocation backend
+ * Define RT_USE_SALLOC when building to serve collections from rt_alloc's
+ * thread-caching allocator, or define RT_MALLOC & co. to plug in your own. */
+#ifndef RT_MALLOC
+#   ifdef RT_USE_SALLOC
+#       include "rt_alloc.h"
+#       define RT_MALLOC rt_salloc
+#       define RT_CALLOC rt_scalloc
+#       define RT_REALLOC rt_srealloc
+#       define RT_FREE rt_sfree
+#   else
+#       define RT_MALLOC malloc
+#       define RT_CALLOC calloc
+#       define RT_REALLOC realloc
+#       define RT_FREE free
+#   endif
+#endif // RT_MALLOC
+
+#define RT_NPOS ((size_t)-1)
+
+/* Primitive element types (typed search, min/max) */
+typedef enum _RT_ElemType {
+    RT_ELEM_I8,
+    RT_ELEM_U8,
+    RT_ELEM_I16,
+    RT_ELEM_U16,
+    RT_ELEM_I32,
+    RT_ELEM_U32,
+    RT_ELEM_I64,
+    RT_ELEM_U64,
+    RT_ELEM_F32,
+    RT_ELEM_F64
+} RT_ElemType;
+
+/* Comparison applied as `element op value` (typed erase) */
+typedef enum _RT_CmpOp {
+    RT_CMP_EQ,
+    RT_CMP_NE,
+    RT_CMP_LT,
+    RT_CMP_LE,
+    RT_CMP_GT,
+    RT_CMP_GE
+} RT_CmpOp;
+
+/* Three-way element comparison (sorting, heaps) */
+typedef int (*RT_CompareFunc)(const void *a, const void *b);
+
+static inline size_t rt_elem_type_size(RT_ElemType type)
+{
+    switch (type) {
+    case RT_ELEM_I8: case RT_ELEM_U8: return 1;
+    case RT_ELEM_I16: case RT_ELEM_U16: return 2;
+    case RT_ELEM_I32: case RT_ELEM_U32: case RT_ELEM_F32: return 4;
+    case RT_ELEM_I64: case RT_ELEM_U64: case RT_ELEM_F64: return 8;
+    }
+    return 0;
+}
+
 bool 
 rt__ensure_capacity(void **data, size_t *data_cap, size_t expected_cap, size_t init_cap);
 
+struct _RT_DynamicArray;
+
+/* Batch erase (arrays & dynamic arrays)
+ * All of these compact the array in one pass, keep the order of the
+ * survivors and return how many elements were removed.
+ * erase_if/retain  - drop elements the callback accepts/rejects
+ * erase_indices    - `indices` ascending, duplicates allowed; nothing is
+ *                    removed if they are unsorted or out of range
+ * erase_where      - drop elements where `elem op value` holds, SIMD on
+ *                    32/64-bit types; arrays of RT_COMPACT_PARALLEL_MIN or
+ *                    more elements are split over `threads` (0 = one per CPU) */
+#define RT_COMPACT_PARALLEL_MIN 0x100000
+
 /* Static array */
 #define RT_ARRAY_INIT_CAP 1024
 #define RT_ARRAY_PRINT_AS(arr, type) \
@@ -37,6 +108,15 @@ bool rt_array_set(RT_Array *arr, size_t index, const void *value);
 bool rt_array_get(RT_Array *arr, size_t index, void *out);
 void rt_array_find_if(RT_Array *arr, void *data, bool (*callback)(const void *arr_data, void *user_data));
 void rt_array_foreach(RT_Array *arr, bool (*callback)(void *arr_elem, size_t elem_index));
+size_t rt_array_find(RT_Array *arr, const void *value);
+size_t rt_array_count(RT_Array *arr, const void *value);
+size_t rt_array_find_all(RT_Array *arr, const void *value, struct _RT_DynamicArray *indices);
+bool rt_array_min(RT_Array *arr, RT_ElemType type, void *out);
+bool rt_array_max(RT_Array *arr, RT_ElemType type, void *out);
+size_t rt_array_erase_if(RT_Array *arr, void *data, bool (*callback)(const void *arr_elem, void *user_data));
+size_t rt_array_retain(RT_Array *arr, void *data, bool (*callback)(const void *arr_elem, void *user_data));
+size_t rt_array_erase_indices(RT_Array *arr, const size_t *indices, size_t count);
+size_t rt_array_erase_where(RT_Array *arr, RT_ElemType type, RT_CmpOp op, const void *value, size_t threads);
 
 static inline bool rt_array_is_empty(RT_Array *arr)
 {
@@ -48,23 +128,259 @@ static inline bool rt_array_is_full(RT_Array *arr)
     return (arr && arr->data) && (arr->size * arr->elem_size) >= arr->capacity;
 }
 
-/* Dynamic array */
+/* Dynamic array
+ * `size` and `capacity` are counted in elements. RT_DARRAY_INIT_CAP is the
+ * initial allocation in bytes. The array grows by `growth_factor` and only
+ * shrinks once it is less than 1/growth_factor^2 full, so push/pop around
+ * a boundary doesn't realloc back and forth. */
 #define RT_DARRAY_INIT_CAP 1024
+#ifndef RT_DARRAY_GROWTH_FACTOR
+#   define RT_DARRAY_GROWTH_FACTOR 2.0
+#endif // RT_DARRAY_GROWTH_FACTOR
 typedef struct _RT_DynamicArray {
     void *data;
     size_t size;
     size_t capacity;
     size_t element_size;
+    double growth_factor;
 } RT_DynamicArray;
 
 bool rt_darray_init(RT_DynamicArray *arr, size_t elem_size);
 void rt_darray_free(RT_DynamicArray *arr);
+/* value(s) may point at the array's own elements, growing rebases them */
 bool rt_darray_push(RT_DynamicArray *arr, const void *value);
+bool rt_darray_push_n(RT_DynamicArray *arr, const void *values, size_t count);
+bool rt_darray_insert_n(RT_DynamicArray *arr, size_t index, const void *values, size_t count);
 bool rt_darray_get(RT_DynamicArray *arr, size_t index, void *out);
 bool rt_darray_set(RT_DynamicArray *arr, size_t index, const void *value);
 bool rt_darray_pop(RT_DynamicArray *arr, void *out);
+bool rt_darray_reserve(RT_DynamicArray *arr, size_t capacity);
+bool rt_darray_shrink_to_fit(RT_DynamicArray *arr);
+bool rt_darray_set_growth(RT_DynamicArray *arr, double growth_factor);
+size_t rt_darray_find(RT_DynamicArray *arr, const void *value);
+size_t rt_darray_count(RT_DynamicArray *arr, const void *value);
+size_t rt_darray_find_all(RT_DynamicArray *arr, const void *value, RT_DynamicArray *indices);
+bool rt_darray_min(RT_DynamicArray *arr, RT_ElemType type, void *out);
+bool rt_darray_max(RT_DynamicArray *arr, RT_ElemType type, void *out);
+size_t rt_darray_erase_if(RT_DynamicArray *arr, void *data, bool (*callback)(const void *arr_elem, void *user_data));
+size_t rt_darray_retain(RT_DynamicArray *arr, void *data, bool (*callback)(const void *arr_elem, void *user_data));
+size_t rt_darray_erase_indices(RT_DynamicArray *arr, const size_t *indices, size_t count);
+size_t rt_darray_erase_where(RT_DynamicArray *arr, RT_ElemType type, RT_CmpOp op, const void *value, size_t threads);
 void rt_darray_print(RT_DynamicArray *arr);
 
+static inline bool rt_darray_insert(RT_DynamicArray *arr, size_t index, const void *value)
+{
+    return rt_darray_insert_n(arr, index, value, 1);
+}
+
+static inline bool rt_darray_append(RT_DynamicArray *dst, const RT_DynamicArray *src)
+{
+    return (dst && src && dst->element_size == src->element_size)
+        && rt_darray_push_n(dst, src->data, src->size);
+}
+
+/* Small array
+ * A dynamic array whose first RT_SARRAY_INLINE_SIZE bytes of elements live
+ * inside the struct, so short arrays never touch the heap; it spills to a
+ * heap block when it outgrows them. `data` may point into the struct itself:
+ * never copy an RT_SmallArray by value, move it with rt_sarray_move. */
+#ifndef RT_SARRAY_INLINE_SIZE
+#   define RT_SARRAY_INLINE_SIZE 64
+#endif // RT_SARRAY_INLINE_SIZE
+typedef struct _RT_SmallArray {
+    void *data;
+    size_t size;
+    size_t capacity;     // elements
+    size_t element_size;
+    union {
+        uint64_t align_u64;
+        double align_f64;
+        void *align_ptr;
+        uint8_t bytes[RT_SARRAY_INLINE_SIZE];
+    } inline_data;
+} RT_SmallArray;
+
+bool rt_sarray_init(RT_SmallArray *arr, size_t elem_size);
+void rt_sarray_free(RT_SmallArray *arr);
+bool rt_sarray_push(RT_SmallArray *arr, const void *value);
+bool rt_sarray_push_n(RT_SmallArray *arr, const void *values, size_t count);
+bool rt_sarray_get(RT_SmallArray *arr, size_t index, void *out);
+bool rt_sarray_set(RT_SmallArray *arr, size_t index, const void *value);
+bool rt_sarray_pop(RT_SmallArray *arr, void *out);
+bool rt_sarray_reserve(RT_SmallArray *arr, size_t capacity);
+bool rt_sarray_move(RT_SmallArray *dst, RT_SmallArray *src);
+bool rt_sarray_steal(RT_SmallArray *arr, RT_DynamicArray *out);
+
+static inline bool rt_sarray_is_inline(const RT_SmallArray *arr)
+{
+    return arr && arr->data == arr->inline_data.bytes;
+}
+
+static inline bool rt_sarray_is_empty(const RT_SmallArray *arr)
+{
+    return !arr || arr->size == 0;
+}
+
+static inline void *rt_sarray_at(const RT_SmallArray *arr, size_t index)
+{
+    return (arr && index < arr->size) ? (char*)arr->data + index * arr->element_size : NULL;
+}
+
+static inline void rt_sarray_clear(RT_SmallArray *arr)
+{
+    if (arr) arr->size = 0;
+}
+
+/* Slot Map
+ * Elements are packed in `data` like an RT_Array, so a pass over them is a
+ * plain loop over [0, size). Callers hold handles instead of indices: a
+ * handle names a slot, and the slot knows where its element currently lives.
+ * Removal moves the last element into the hole (O(1), no memmove) and bumps
+ * the slot's generation, so handles to removed elements stop resolving
+ * instead of silently aliasing whatever reuses the slot. */
+#define RT_SLOTMAP_INIT_CAP 64
+#define RT_SLOT_HANDLE_NULL ((RT_SlotHandle)0) // generations start at 1, so this never resolves
+#define RT__SLOTMAP_NO_SLOT UINT32_MAX
+
+typedef uint64_t RT_SlotHandle; // generation << 32 | slot
+
+typedef struct _RT_Slot {
+    uint32_t index;      // dense index while live, next free slot otherwise
+    uint32_t generation;
+} RT_Slot;
+
+typedef struct _RT_SlotMap {
+    void *data;
+    uint32_t *dense_slots; // owning slot of each element in `data`
+    RT_Slot *slots;
+    size_t elem_size;
+    size_t size;
+    size_t capacity;       // bytes, as in RT_Array
+    size_t dense_capacity; // bytes
+    size_t slots_count;
+    size_t slots_capacity; // bytes
+    uint32_t free_head;
+} RT_SlotMap;
+
+bool rt_slotmap_init(RT_SlotMap *map, size_t size, size_t elem_size);
+void rt_slotmap_free(RT_SlotMap *map);
+RT_SlotHandle rt_slotmap_insert(RT_SlotMap *map, const void *value);
+bool rt_slotmap_remove(RT_SlotMap *map, RT_SlotHandle handle, void *out);
+bool rt_slotmap_get(RT_SlotMap *map, RT_SlotHandle handle, void *out);
+bool rt_slotmap_set(RT_SlotMap *map, RT_SlotHandle handle, const void *value);
+void *rt_slotmap_get_ptr(RT_SlotMap *map, RT_SlotHandle handle);
+void rt_slotmap_clear(RT_SlotMap *map);
+
+static inline bool rt_slotmap_contains(RT_SlotMap *map, RT_SlotHandle handle)
+{
+    return rt_slotmap_get_ptr(map, handle) != NULL;
+}
+
+static inline bool rt_slotmap_is_empty(RT_SlotMap *map)
+{
+    return !map || map->size == 0;
+}
+
+// dense access for iteration, valid for index < size until the next insert/remove
+static inline void *rt_slotmap_at(RT_SlotMap *map, size_t index)
+{
+    return (map && index < map->size) ? (char*)map->data + index * map->elem_size : NULL;
+}
+
+static inline RT_SlotHandle rt_slotmap_handle_at(RT_SlotMap *map, size_t index)
+{
+    if (!map || index >= map->size) return RT_SLOT_HANDLE_NULL;
+
+    uint32_t slot = map->dense_slots[index];
+    return ((RT_SlotHandle)map->slots[slot].generation << 32) | slot;
+}
+
+/* Heap (priority queue)
+ * Min-heap on `cmp` (invert the comparison for a max-heap), stored
+ * contiguously. Every node has `arity` children, RT_HEAP_ARITY by default:
+ * a 4-ary heap is half as deep as a binary one and a node's children share
+ * a cache line, which pays for the extra compares per level on pop.
+ * `capacity` is in bytes, as in RT_Array. One element past `size` is kept
+ * spare as scratch, so values passed in may point into the heap itself. */
+#define RT_HEAP_ARITY 4
+#define RT_HEAP_INIT_CAP 64 // elements
+
+typedef struct _RT_Heap {
+    void *data;
+    size_t size;
+    size_t capacity;
+    size_t element_size;
+    size_t arity;
+    RT_CompareFunc cmp;
+} RT_Heap;
+
+bool rt_heap_init(RT_Heap *heap, size_t elem_size, RT_CompareFunc cmp);
+bool rt_heap_init_ex(RT_Heap *heap, size_t elem_size, size_t arity, RT_CompareFunc cmp);
+void rt_heap_free(RT_Heap *heap);
+bool rt_heap_push(RT_Heap *heap, const void *value);
+bool rt_heap_push_n(RT_Heap *heap, const void *values, size_t count);
+bool rt_heap_pop(RT_Heap *heap, void *out);
+bool rt_heap_top(const RT_Heap *heap, void *out);
+bool rt_heap_heapify(RT_Heap *heap, const void *values, size_t count); // replaces the contents
+bool rt_heap_reserve(RT_Heap *heap, size_t count);
+
+static inline bool rt_heap_is_empty(const RT_Heap *heap)
+{
+    return !heap || heap->size == 0;
+}
+
+static inline void *rt_heap_peek(const RT_Heap *heap)
+{
+    return (heap && heap->size) ? heap->data : NULL;
+}
+
+static inline void rt_heap_clear(RT_Heap *heap)
+{
+    if (heap) heap->size = 0;
+}
+
+/* Indexed heap
+ * RT_Heap whose elements can be reached after insertion: push returns a
+ * handle (generational, like RT_SlotMap's) that stays valid while the
+ * element is in the heap, wherever sifting moves it. update re-prioritizes
+ * an element in either direction (decrease-key), remove takes it out from
+ * anywhere, both in O(log n). */
+typedef struct _RT_IndexedHeap {
+    void *data;
+    uint32_t *owners;      // slot of each element in `data`
+    RT_Slot *slots;        // heap position while live, next free slot otherwise
+    size_t size;
+    size_t capacity;       // bytes
+    size_t owners_capacity;// bytes
+    size_t slots_count;
+    size_t slots_capacity; // bytes
+    size_t element_size;
+    size_t arity;
+    RT_CompareFunc cmp;
+    uint32_t free_head;
+} RT_IndexedHeap;
+
+bool rt_iheap_init(RT_IndexedHeap *heap, size_t elem_size, RT_CompareFunc cmp);
+bool rt_iheap_init_ex(RT_IndexedHeap *heap, size_t elem_size, size_t arity, RT_CompareFunc cmp);
+void rt_iheap_free(RT_IndexedHeap *heap);
+RT_SlotHandle rt_iheap_push(RT_IndexedHeap *heap, const void *value);
+bool rt_iheap_pop(RT_IndexedHeap *heap, void *out, RT_SlotHandle *handle);
+bool rt_iheap_top(const RT_IndexedHeap *heap, void *out, RT_SlotHandle *handle);
+bool rt_iheap_get(const RT_IndexedHeap *heap, RT_SlotHandle handle, void *out);
+bool rt_iheap_update(RT_IndexedHeap *heap, RT_SlotHandle handle, const void *value);
+bool rt_iheap_remove(RT_IndexedHeap *heap, RT_SlotHandle handle, void *out);
+void rt_iheap_clear(RT_IndexedHeap *heap);
+
+static inline bool rt_iheap_is_empty(const RT_IndexedHeap *heap)
+{
+    return !heap || heap->size == 0;
+}
+
+static inline bool rt_iheap_contains(const RT_IndexedHeap *heap, RT_SlotHandle handle)
+{
+    return rt_iheap_get(heap, handle, NULL);
+}
+
 /* D-Linked List */
 #define RT_LIST_BACK 0
 #define RT_LIST_FRONT 1
@@ -234,17 +550,31 @@ static inline bool rt_rbuffer_is_full(RT_RingBuffer *buffer)
     return buffer->size >= buffer->capacity_items;
 }
 
-/* File Buffer */
+/* File Buffer
+ * Holds either heap data or, after rt_fbuffer_map_file(), a view of the file
+ * mapped straight into the address space: nothing is read up front, pages
+ * come in on first touch and clean ones can be dropped by the OS under
+ * pressure. A read-only view faults on writes through `data`, a copy-on-write
+ * view keeps them private. Calls that grow or refill the buffer move it back
+ * to the heap first, copying the bytes only when they are kept, and so does
+ * rt_fbuffer_write_file, since the file written may be the one mapped. A
+ * view follows later changes to the file; read it for a snapshot. */
 #define RT_FBUFFER_INIT_CAP 1024
+#define RT_FBUFFER_MAP_READ       0x1
+#define RT_FBUFFER_MAP_COPY       0x2
+#define RT_FBUFFER_MAP_SEQUENTIAL 0x4 // read-ahead hints
+#define RT_FBUFFER_MAP_RANDOM     0x8
 typedef struct _RT_FileBuffer {
     uint8_t *data;
-    size_t capacity;
+    size_t capacity; // 0 while mapped
     size_t size;
+    int mapping;     // RT_FBUFFER_MAP_READ or _COPY while mapped, 0 for heap data
 } RT_FileBuffer;
 
 bool rt_fbuffer_init(RT_FileBuffer *buffer);
 void rt_fbuffer_free(RT_FileBuffer *buffer);
 size_t rt_fbuffer_read_file(RT_FileBuffer *buffer, const char *file_path);
+size_t rt_fbuffer_map_file(RT_FileBuffer *buffer, const char *file_path, int flags);
 size_t rt_fbuffer_write_file(RT_FileBuffer *buffer, const char *file_path);
 bool rt_fbuffer_set(RT_FileBuffer *buffer, const void *data, size_t size);
 bool rt_fbuffer_clone(RT_FileBuffer *dst, const RT_FileBuffer *src);
@@ -261,6 +591,11 @@ static inline bool rt_fbuffer_is_empty(const RT_FileBuffer *buffer)
     return !buffer || buffer->size == 0;
 }
 
+static inline bool rt_fbuffer_is_mapped(const RT_FileBuffer *buffer)
+{
+    return buffer && buffer->mapping != 0;
+}
+
 /* Hash Table (separate chaining) */
 #define RT_HASHMAP_LFACTOR_MAX 0.75
 #define RT_HASHMAP_LFACTOR_MIN 0.25
@@ -318,13 +653,13 @@ static inline bool rt_hashmap_is_empty(RT_HashMap *map)
 
 static inline RT_HTNode *rt__hashmap_node_alloc(size_t key_size, size_t value_size)
 {
-    RT_HTNode *node = malloc(sizeof(RT_HTNode));
+    RT_HTNode *node = RT_MALLOC(sizeof(RT_HTNode));
     if (!node) goto allocation_failure_node;
 
-    node->key = malloc(key_size);
+    node->key = RT_MALLOC(key_size);
     if (!node->key) goto allocation_failure_key;
 
-    node->value = malloc(value_size);
+    node->value = RT_MALLOC(value_size);
     if (!node->value) goto allocation_failure_value;
     
     node->next = NULL;
@@ -332,9 +667,9 @@ static inline RT_HTNode *rt__hashmap_node_alloc(size_t key_size, size_t value_si
     return node;
 
     allocation_failure_value:
-        free(node->key);
+        RT_FREE(node->key);
     allocation_failure_key:
-        free(node);
+        RT_FREE(node);
     allocation_failure_node:
         return NULL;
 }
@@ -342,8 +677,8 @@ static inline RT_HTNode *rt__hashmap_node_alloc(size_t key_size, size_t value_si
 static inline bool rt__hashmap_update_node_value(RT_HTNode *node, void *value, size_t vsize)
 {
     void *new_value = node->value 
-        ? realloc(node->value, vsize)
-        : malloc(vsize);
+        ? RT_REALLOC(node->value, vsize)
+        : RT_MALLOC(vsize);
     if (!new_value) return false;
 
     memcpy_s(new_value, vsize, value, vsize);
@@ -0,0 +1,584 @@
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "rt_dedup.h"
+#include "rt_stream.h"
+#include "rt_thread.h"
+
+/* Content-defined chunking */
+static uint64_t rt__gear[256];
+static bool rt__gear_ready;
+
+// fixed values, cut points must not change between runs
+static void rt__gear_init(void)
+{
+    if (rt__gear_ready) return;
+
+    uint64_t x = 0x52545F4745415253ull; // "SRAEG_TR"
+    for (int i = 0; i < 256; ++i) {
+        x += 0x9E3779B97F4A7C15ull; // splitmix64
+        uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        rt__gear[i] = z ^ (z >> 31);
+    }
+    rt__gear_ready = true;
+}
+
+void rt_chunker_init(RT_Chunker *chunker, size_t avg)
+{
+    if (!chunker) return;
+    if (avg == 0) avg = RT_CHUNK_AVG;
+    if (avg < RT_CHUNK_AVG_MIN) avg = RT_CHUNK_AVG_MIN;
+    if (avg > RT_CHUNK_AVG_MAX) avg = RT_CHUNK_AVG_MAX;
+
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < avg) bits++;
+
+    // the top bits of the hash depend on the most recent bytes
+    chunker->avg = (size_t)1 << bits;
+    chunker->min = chunker->avg / 4;
+    chunker->max = chunker->avg * 8;
+    chunker->mask_small = ~(~0ull >> (bits + 2));
+    chunker->mask_large = ~(~0ull >> (bits - 2));
+    rt__gear_init();
+}
+
+size_t rt_chunker_cut(const RT_Chunker *chunker, const uint8_t *data, size_t size)
+{
+    if (size <= chunker->min) return size;
+
+    const size_t end = size < chunker->max ? size : chunker->max;
+    const size_t normal = end < chunker->avg ? end : chunker->avg;
+    uint64_t hash = 0;
+    size_t i = chunker->min;
+
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + rt__gear[data[i]];
+        if (!(hash & chunker->mask_small)) return i + 1;
+    }
+    for (; i < end; ++i) {
+        hash = (hash << 1) + rt__gear[data[i]];
+        if (!(hash & chunker->mask_large)) return i + 1;
+    }
+    return end;
+}
+
+typedef struct _RT__ChunkTask {
+    RT_Chunk *chunks;
+    size_t count;
+    const uint8_t *data; // at the offset of chunks[0]
+} RT__ChunkTask;
+
+static DWORD rt__chunk_worker(void *param)
+{
+    RT__ChunkTask *task = param;
+    const uint64_t base = task->count ? task->chunks[0].offset : 0;
+    for (size_t i = 0; i < task->count; ++i) {
+        RT_Chunk *chunk = &task->chunks[i];
+        chunk->fingerprint = rt_hash128(task->data + (chunk->offset - base), chunk->size, 0);
+    }
+    return 0;
+}
+
+// fingerprints chunks[from..] in parallel, `data` holding chunks[from]
+static void rt__chunk_fingerprint(RT_ChunkList *chunks, size_t from, const uint8_t *data, size_t size)
+{
+    const size_t total = chunks->size - from;
+    if (total == 0) return;
+
+    size_t count = rt_thread_cpu_count();
+    if (count > RT_THREAD_MAX_TASKS) count = RT_THREAD_MAX_TASKS;
+    if (count > size / RT_CHUNK_TASK_MIN) count = size / RT_CHUNK_TASK_MIN;
+    if (count > total) count = total;
+    if (count == 0) count = 1;
+
+    RT__ChunkTask single;
+    RT__ChunkTask *tasks = count > 1 ? RT_MALLOC(count * sizeof(RT__ChunkTask)) : NULL;
+    if (!tasks) {
+        tasks = &single;
+        count = 1;
+    }
+
+    // chunk sizes stay near the average, so even counts make even work
+    RT_Chunk *first = chunks->data + from;
+    for (size_t t = 0, at = 0; t < count; ++t) {
+        const size_t to = total * (t + 1) / count;
+        tasks[t] = (RT__ChunkTask){ first + at, to - at, data + (first[at].offset - first[0].offset) };
+        at = to;
+    }
+
+    if (count == 1) rt__chunk_worker(tasks);
+    else rt_thread_run_tasks(tasks, sizeof(RT__ChunkTask), count, rt__chunk_worker);
+
+    if (tasks != &single) RT_FREE(tasks);
+}
+
+/* Cuts `data` into chunks and fingerprints them. Unless `last`, a tail that
+ * may still grow with the bytes that follow is left: *consumed says where
+ * it starts. */
+static bool rt__chunker_split(const RT_Chunker *chunker, const uint8_t *data, size_t size, uint64_t offset,
+                              bool last, RT_ChunkList *chunks, size_t *consumed)
+{
+    const size_t from = chunks->size;
+    size_t at = 0;
+    while (at < size) {
+        const size_t rest = size - at;
+        if (!last && rest < chunker->max) break;
+
+        const size_t length = rt_chunker_cut(chunker, data + at, rest);
+        const RT_Chunk chunk = { offset + at, length, {0, 0} };
+        if (!RT_ChunkList_push(chunks, chunk)) return false;
+        at += length;
+    }
+
+    rt__chunk_fingerprint(chunks, from, data, at);
+    *consumed = at;
+    return true;
+}
+
+bool rt_chunker_split(const RT_Chunker *chunker, const void *data, size_t size, uint64_t offset, RT_ChunkList *chunks)
+{
+    if (!chunker || !chunks || (!data && size)) return false;
+
+    size_t consumed;
+    return rt__chunker_split(chunker, data, size, offset, true, chunks, &consumed);
+}
+
+bool rt_fbuffer_chunks(const RT_FileBuffer *buffer, const RT_Chunker *chunker, RT_ChunkList *chunks)
+{
+    if (!buffer) return false;
+    return rt_chunker_split(chunker, buffer->data, buffer->size, 0, chunks);
+}
+
+/* Deduplicated snapshots */
+#define RT__DEDUP_OPEN_ATTEMPTS 4 // another writer may keep growing the pack in between
+
+static inline void rt__dedup_store32(uint8_t *p, uint32_t x)
+{
+    for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(x >> (8 * i));
+}
+
+static inline void rt__dedup_store64(uint8_t *p, uint64_t x)
+{
+    for (int i = 0; i < 8; ++i) p[i] = (uint8_t)(x >> (8 * i));
+}
+
+static inline uint32_t rt__dedup_read32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint64_t rt__dedup_read64(const uint8_t *p)
+{
+    return rt__dedup_read32(p) | (uint64_t)rt__dedup_read32(p + 4) << 32;
+}
+
+static void rt__dedup_header(uint8_t out[RT_DEDUP_HEADER_SIZE], uint32_t magic)
+{
+    rt__dedup_store32(out, magic);
+    out[4] = RT_DEDUP_VERSION;
+    out[5] = out[6] = out[7] = 0;
+}
+
+static bool rt__dedup_is(const uint8_t *data, size_t size, uint32_t magic)
+{
+    return size >= RT_DEDUP_HEADER_SIZE && rt__dedup_read32(data) == magic && data[4] == RT_DEDUP_VERSION;
+}
+
+/* Indexes the whole records past store->pack_size, stopping at a torn one,
+ * and moves pack_size to the end of the last of them. *seen gets the file
+ * size found. Only a missing or empty file counts as no pack; one that can
+ * not be read fails, so a write never truncates records it did not see. */
+static bool rt__dedup_load(RT_DedupStore *store, uint64_t *seen)
+{
+    struct stat file_stat;
+    if (stat(store->path, &file_stat) != 0) {
+        *seen = 0;
+        return errno == ENOENT && store->pack_size == 0;
+    }
+    *seen = (uint64_t)file_stat.st_size;
+    if (*seen == 0) return store->pack_size == 0;
+    if (*seen == store->pack_size) return true;
+
+    RT_FileBuffer pack = {0};
+    if (!rt_fbuffer_map_file(&pack, store->path, RT_FBUFFER_MAP_READ | RT_FBUFFER_MAP_SEQUENTIAL) &&
+        !rt_fbuffer_read_file(&pack, store->path)) {
+        return false;
+    }
+    *seen = pack.size;
+    if (!rt__dedup_is(pack.data, pack.size, RT_DEDUP_PACK_MAGIC) || pack.size < store->pack_size) {
+        rt_fbuffer_free(&pack);
+        return false;
+    }
+
+    bool ok = true;
+    size_t at = store->pack_size ? (size_t)store->pack_size : RT_DEDUP_HEADER_SIZE;
+    while (ok && pack.size - at >= RT_DEDUP_RECORD_SIZE) {
+        const uint8_t *record = pack.data + at;
+        const size_t size = rt__dedup_read32(record);
+        if (size > pack.size - at - RT_DEDUP_RECORD_SIZE) break;
+
+        const RT_Hash128 fingerprint = { rt__dedup_read64(record + 4), rt__dedup_read64(record + 12) };
+        RT_DedupEntry entry = { at + RT_DEDUP_RECORD_SIZE, size };
+        char key[RT_DEDUP_KEY_SIZE];
+        rt_dedup_key(key, fingerprint);
+        if (!rt_hashmap_contains(&store->index, key)) {
+            if (!(ok = rt_hashmap_insert(&store->index, key, &entry, sizeof(entry)))) break;
+            store->chunks++;
+            store->stored += size;
+        }
+        at += RT_DEDUP_RECORD_SIZE + size;
+    }
+
+    store->pack_size = at;
+    rt_fbuffer_free(&pack);
+    return ok;
+}
+
+bool rt_dedup_open(RT_DedupStore *store, const char *path, size_t chunk_avg)
+{
+    if (!store || !path) return false;
+
+    memset(store, 0, sizeof(*store));
+    rt_chunker_init(&store->chunker, chunk_avg);
+
+    const size_t len = strlen(path);
+    store->path = RT_MALLOC(len + 1);
+    if (!store->path) return false;
+    memcpy(store->path, path, len + 1);
+
+    uint64_t seen;
+    if (!rt_hashmap_init(&store->index, 0)) goto failure;
+    if (!rt__dedup_load(store, &seen)) goto failure;
+
+    return true;
+
+    failure:
+        rt_dedup_close(store);
+        return false;
+}
+
+void rt_dedup_close(RT_DedupStore *store)
+{
+    if (!store) return;
+
+    if (store->index.buckets) rt_hashmap_free(&store->index);
+    RT_FREE(store->path);
+    memset(store, 0, sizeof(*store));
+}
+
+/* A snapshot being written: new chunks go to the end of the pack, all of
+ * them to the recipe. The index and counters only take the new chunks once
+ * the pack is closed without errors. */
+typedef struct _RT__DedupSession {
+    HANDLE file;
+    RT_FileWriter pack;
+    RT_ChunkList recipe;  // offsets are pack offsets
+    RT_ChunkList added;   // inserted into the index by this snapshot
+    uint64_t end;         // of the pack as written so far
+    uint64_t size;
+    uint64_t deduped;
+    uint64_t stored;
+} RT__DedupSession;
+
+static bool rt__dedup_begin(RT_DedupStore *store, RT__DedupSession *session)
+{
+    memset(session, 0, sizeof(*session));
+
+    // records another store appended are indexed first; once the write handle
+    // is open (shared for reading only) the size must still be the one seen,
+    // and what lies past the last whole record is a torn write that goes
+    for (int attempt = 0;; ++attempt) {
+        uint64_t seen;
+        if (attempt == RT__DEDUP_OPEN_ATTEMPTS || !rt__dedup_load(store, &seen)) return false;
+
+        session->file = CreateFileA(store->path, GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS,
+                                    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (session->file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(session->file, &size)) {
+            CloseHandle(session->file);
+            return false;
+        }
+        if ((uint64_t)size.QuadPart == seen) break;
+        CloseHandle(session->file);
+    }
+    session->end = store->pack_size;
+
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)store->pack_size;
+    if (!SetFilePointerEx(session->file, end, NULL, FILE_BEGIN) || !SetEndOfFile(session->file) ||
+        !rt_fwriter_attach(&session->pack, session->file, 0)) {
+        CloseHandle(session->file);
+        return false;
+    }
+
+    if (session->end == 0) {
+        uint8_t header[RT_DEDUP_HEADER_SIZE];
+        rt__dedup_header(header, RT_DEDUP_PACK_MAGIC);
+        rt_fwriter_write(&session->pack, header, sizeof(header));
+        session->end = RT_DEDUP_HEADER_SIZE;
+    }
+    return true;
+}
+
+// chunks[from..] whose data starts at `data`
+static bool rt__dedup_put(RT_DedupStore *store, RT__DedupSession *session, const RT_ChunkList *chunks,
+                          size_t from, const uint8_t *data)
+{
+    const uint64_t base = from < chunks->size ? chunks->data[from].offset : 0;
+    for (size_t i = from; i < chunks->size; ++i) {
+        RT_Chunk chunk = chunks->data[i];
+        char key[RT_DEDUP_KEY_SIZE];
+        rt_dedup_key(key, chunk.fingerprint);
+
+        RT_DedupEntry entry;
+        if (rt_hashmap_get(&store->index, key, &entry, sizeof(entry)) && entry.size == chunk.size) {
+            session->deduped += chunk.size;
+        } else {
+            uint8_t record[RT_DEDUP_RECORD_SIZE];
+            rt__dedup_store32(record, (uint32_t)chunk.size);
+            rt__dedup_store64(record + 4, chunk.fingerprint.lo);
+            rt__dedup_store64(record + 12, chunk.fingerprint.hi);
+            if (!rt_fwriter_write(&session->pack, record, sizeof(record)) ||
+                !rt_fwriter_write(&session->pack, data + (chunk.offset - base), chunk.size)) {
+                return false;
+            }
+
+            entry = (RT_DedupEntry){ session->end + RT_DEDUP_RECORD_SIZE, chunk.size };
+            session->end = entry.offset + chunk.size;
+            session->stored += chunk.size;
+            if (!rt_hashmap_insert(&store->index, key, &entry, sizeof(entry)) ||
+                !RT_ChunkList_push(&session->added, chunk)) {
+                return false;
+            }
+        }
+
+        session->size += chunk.size;
+        chunk.offset = entry.offset;
+        if (!RT_ChunkList_push(&session->recipe, chunk)) return false;
+    }
+    return true;
+}
+
+static bool rt__dedup_write_recipe(const RT__DedupSession *session, const char *path)
+{
+    RT_FileWriter writer;
+    if (!rt_fwriter_open(&writer, path, 0, RT_FWRITER_ATOMIC)) return false;
+
+    uint8_t header[RT_DEDUP_RECIPE_HEADER_SIZE];
+    rt__dedup_header(header, RT_DEDUP_RECIPE_MAGIC);
+    rt__dedup_store64(header + 8, session->size);
+    rt__dedup_store64(header + 16, session->recipe.size);
+    rt_fwriter_write(&writer, header, sizeof(header));
+
+    for (size_t i = 0; i < session->recipe.size; ++i) {
+        const RT_Chunk *chunk = &session->recipe.data[i];
+        uint8_t *entry = rt_fwriter_reserve(&writer, RT_DEDUP_RECIPE_ENTRY_SIZE);
+        if (!entry) break;
+
+        rt__dedup_store64(entry, chunk->offset);
+        rt__dedup_store32(entry + 8, (uint32_t)chunk->size);
+        rt__dedup_store32(entry + 12, 0);
+        rt__dedup_store64(entry + 16, chunk->fingerprint.lo);
+        rt__dedup_store64(entry + 24, chunk->fingerprint.hi);
+        rt_fwriter_commit(&writer, RT_DEDUP_RECIPE_ENTRY_SIZE);
+    }
+    return rt_fwriter_close(&writer);
+}
+
+static bool rt__dedup_end(RT_DedupStore *store, RT__DedupSession *session, bool ok, const char *recipe_path)
+{
+    if (!rt_fwriter_close(&session->pack)) ok = false;
+    if (!CloseHandle(session->file)) ok = false;
+
+    if (ok) {
+        store->pack_size = session->end;
+        store->chunks += session->added.size;
+        store->stored += session->stored;
+        store->written += session->size;
+        store->deduped += session->deduped;
+        ok = rt__dedup_write_recipe(session, recipe_path);
+    } else {
+        // what this snapshot appended is cut off by the next write
+        for (size_t i = 0; i < session->added.size; ++i) {
+            char key[RT_DEDUP_KEY_SIZE];
+            rt_dedup_key(key, session->added.data[i].fingerprint);
+            rt_hashmap_remove(&store->index, key);
+        }
+    }
+
+    RT_ChunkList_free(&session->recipe);
+    RT_ChunkList_free(&session->added);
+    return ok;
+}
+
+bool rt_dedup_write(RT_DedupStore *store, const void *data, size_t size, const char *recipe_path)
+{
+    if (!store || !store->path || (!data && size) || !recipe_path) return false;
+
+    RT_ChunkList chunks = {0};
+    if (!rt_chunker_split(&store->chunker, data, size, 0, &chunks)) {
+        RT_ChunkList_free(&chunks);
+        return false;
+    }
+
+    RT__DedupSession session;
+    bool ok = rt__dedup_begin(store, &session);
+    if (ok) {
+        ok = rt__dedup_put(store, &session, &chunks, 0, data);
+        ok = rt__dedup_end(store, &session, ok, recipe_path);
+    }
+
+    RT_ChunkList_free(&chunks);
+    return ok;
+}
+
+bool rt_dedup_write_file(RT_DedupStore *store, const char *path, const char *recipe_path)
+{
+    if (!store || !store->path || !path || !recipe_path) return false;
+
+    RT_FileReader reader;
+    if (!rt_freader_open(&reader, path, RT_DEDUP_CHUNK, 0, 0)) return false;
+
+    // the uncut tail of a round moves to the front and the next chunk joins it
+    const size_t capacity = RT_DEDUP_CHUNK + store->chunker.max;
+    uint8_t *pending = RT_MALLOC(capacity);
+    RT_ChunkList chunks = {0};
+    RT__DedupSession session;
+    bool ok = pending && rt__dedup_begin(store, &session);
+    if (!ok) {
+        RT_FREE(pending);
+        rt_freader_close(&reader);
+        return false;
+    }
+
+    size_t held = 0;
+    uint64_t held_at = 0;
+    RT_FileChunk chunk;
+    while (ok) {
+        const bool more = rt_freader_next(&reader, &chunk);
+        if (more) {
+            memcpy(pending + held, chunk.data, chunk.size);
+            held += chunk.size;
+        }
+
+        size_t consumed = 0;
+        chunks.size = 0;
+        ok = rt__chunker_split(&store->chunker, pending, held, held_at, !more, &chunks, &consumed) &&
+             rt__dedup_put(store, &session, &chunks, 0, pending);
+
+        memmove(pending, pending + consumed, held - consumed);
+        held -= consumed;
+        held_at += consumed;
+        if (!more) break;
+    }
+    if (rt_freader_failed(&reader)) ok = false;
+
+    ok = rt__dedup_end(store, &session, ok, recipe_path);
+    RT_ChunkList_free(&chunks);
+    RT_FREE(pending);
+    rt_freader_close(&reader);
+    return ok;
+}
+
+typedef struct _RT__RestoreTask {
+    const RT_Chunk *chunks;
+    size_t count;
+    const uint8_t *pack;
+    uint8_t *out;
+    bool ok;
+} RT__RestoreTask;
+
+static DWORD rt__restore_worker(void *param)
+{
+    RT__RestoreTask *task = param;
+    uint8_t *out = task->out;
+    task->ok = true;
+    for (size_t i = 0; i < task->count && task->ok; ++i) {
+        const RT_Chunk *chunk = &task->chunks[i];
+        memcpy(out, task->pack + chunk->offset, chunk->size);
+
+        const RT_Hash128 check = rt_hash128(out, chunk->size, 0);
+        task->ok = check.lo == chunk->fingerprint.lo && check.hi == chunk->fingerprint.hi;
+        out += chunk->size;
+    }
+    return 0;
+}
+
+bool rt_dedup_restore(const char *pack_path, const char *recipe_path, RT_FileBuffer *out)
+{
+    if (!pack_path || !recipe_path || !out) return false;
+
+    RT_FileBuffer pack = {0}, recipe = {0};
+    RT_ChunkList chunks = {0};
+    RT__RestoreTask *tasks = NULL;
+    bool ok = false;
+
+    if (!rt_fbuffer_map_file(&recipe, recipe_path, RT_FBUFFER_MAP_READ) &&
+        !rt_fbuffer_read_file(&recipe, recipe_path)) goto done;
+    if (recipe.size < RT_DEDUP_RECIPE_HEADER_SIZE || !rt__dedup_is(recipe.data, recipe.size, RT_DEDUP_RECIPE_MAGIC)) goto done;
+
+    const uint64_t total = rt__dedup_read64(recipe.data + 8);
+    const uint64_t count = rt__dedup_read64(recipe.data + 16);
+    if (count > (recipe.size - RT_DEDUP_RECIPE_HEADER_SIZE) / RT_DEDUP_RECIPE_ENTRY_SIZE ||
+        recipe.size != RT_DEDUP_RECIPE_HEADER_SIZE + count * RT_DEDUP_RECIPE_ENTRY_SIZE ||
+        total > SIZE_MAX) goto done;
+
+    if (total > 0 && !rt_fbuffer_map_file(&pack, pack_path, RT_FBUFFER_MAP_READ) &&
+        !rt_fbuffer_read_file(&pack, pack_path)) goto done;
+
+    // every chunk must lie inside the pack and the sizes add up to the total
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t *entry = recipe.data + RT_DEDUP_RECIPE_HEADER_SIZE + i * RT_DEDUP_RECIPE_ENTRY_SIZE;
+        const RT_Chunk chunk = {
+            rt__dedup_read64(entry), rt__dedup_read32(entry + 8),
+            { rt__dedup_read64(entry + 16), rt__dedup_read64(entry + 24) }
+        };
+        if (chunk.offset > pack.size || chunk.size > pack.size - chunk.offset) goto done;
+        if (!RT_ChunkList_push(&chunks, chunk)) goto done;
+        sum += chunk.size;
+    }
+    if (sum != total) goto done;
+
+    if (total == 0) {
+        out->size = 0;
+        ok = true;
+        goto done;
+    }
+    if (!rt_fbuffer_reserve(out, (size_t)total)) goto done;
+
+    size_t workers = rt_thread_cpu_count();
+    if (workers > RT_THREAD_MAX_TASKS) workers = RT_THREAD_MAX_TASKS;
+    if (workers > total / RT_CHUNK_TASK_MIN) workers = (size_t)(total / RT_CHUNK_TASK_MIN);
+    if (workers > count) workers = (size_t)count;
+    if (workers == 0) workers = 1;
+
+    tasks = RT_MALLOC(workers * sizeof(RT__RestoreTask));
+    if (!tasks) goto done;
+
+    uint8_t *at = out->data;
+    for (size_t t = 0, from = 0; t < workers; ++t) {
+        const size_t to = (size_t)(count * (t + 1) / workers);
+        tasks[t] = (RT__RestoreTask){ chunks.data + from, to - from, pack.data, at, false };
+        for (size_t i = from; i < to; ++i) at += chunks.data[i].size;
+        from = to;
+    }
+
+    if (workers == 1) rt__restore_worker(tasks);
+    else rt_thread_run_tasks(tasks, sizeof(RT__RestoreTask), workers, rt__restore_worker);
+
+    ok = true;
+    for (size_t t = 0; t < workers; ++t) ok = ok && tasks[t].ok;
+    if (ok) out->size = (size_t)total;
+
+    done:
+        RT_FREE(tasks);
+        RT_ChunkList_free(&chunks);
+        rt_fbuffer_free(&pack);
+        rt_fbuffer_free(&recipe);
+        return ok;
+}
@@ -0,0 +1,119 @@
+#ifndef _INC_RT_DEDUP
+#define _INC_RT_DEDUP
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+#include "rt_typed.h"
+#include "rt_hash.h"
+
+/* Content-defined chunking
+ * FastCDC: a Gear rolling hash (shift left, add a random value per byte)
+ * cuts where its top bits are zero. Cut points depend on the nearby bytes
+ * only, so an insertion moves the cuts around it and leaves the rest of the
+ * chunks as they were. Below the average size a stricter mask applies and
+ * past it a looser one, which keeps chunk sizes close to the average; no
+ * chunk is shorter than min except the last, or longer than max.
+ * Chunks are fingerprinted with rt_hash128, in parallel. */
+#define RT_CHUNK_AVG 0x2000 // 8kb
+#define RT_CHUNK_AVG_MIN 0x100
+#define RT_CHUNK_AVG_MAX 0x100000
+#define RT_CHUNK_TASK_MIN 0x100000 // bytes worth fingerprinting on another thread
+
+typedef struct _RT_Chunker {
+    size_t min;
+    size_t avg;
+    size_t max;
+    uint64_t mask_small; // below avg, two bits more than log2(avg)
+    uint64_t mask_large; // past avg, two bits fewer
+} RT_Chunker;
+
+typedef struct _RT_Chunk {
+    uint64_t offset;
+    size_t size;
+    RT_Hash128 fingerprint;
+} RT_Chunk;
+
+RT_DEFINE_DARRAY(RT_ChunkList, RT_Chunk)
+
+/* avg is rounded to a power of two within [RT_CHUNK_AVG_MIN, RT_CHUNK_AVG_MAX],
+ * 0 picks RT_CHUNK_AVG; min is avg / 4 and max avg * 8 */
+void rt_chunker_init(RT_Chunker *chunker, size_t avg);
+
+/* Length of the first chunk of `data`. When the result is `size` and size is
+ * below chunker->max, the chunk may go on in bytes not seen yet. */
+size_t rt_chunker_cut(const RT_Chunker *chunker, const uint8_t *data, size_t size);
+
+/* Cuts and fingerprints all of `data`, whose first byte is at `offset` of
+ * the input, appending the chunks to the list. The end of data ends the
+ * last chunk. */
+bool rt_chunker_split(const RT_Chunker *chunker, const void *data, size_t size, uint64_t offset, RT_ChunkList *chunks);
+bool rt_fbuffer_chunks(const RT_FileBuffer *buffer, const RT_Chunker *chunker, RT_ChunkList *chunks);
+
+/* Deduplicated snapshots
+ * A pack file holds every distinct chunk once; a snapshot is written as a
+ * recipe, the list of pack chunks that make it up, so near-identical
+ * snapshots only add the chunks that changed.
+ *   pack    "RTDP", version, 3 reserved bytes, then records:
+ *           u32 size, 16-byte fingerprint, the chunk data
+ *   recipe  "RTDR", version, 3 reserved bytes, u64 snapshot size, u64 chunk
+ *           count, then per chunk: u64 pack offset of the data, u32 size,
+ *           u32 reserved, 16-byte fingerprint
+ * All numbers are little-endian. New chunks are appended to the pack and
+ * the pack is closed before the recipe is written, atomically. Before each
+ * write the store indexes records other stores appended since, and only a
+ * tail that is not a whole record, left by a crash, is cut off. Restores
+ * check every chunk against its fingerprint. The index lives in memory, an
+ * RT_HashMap from the fingerprint in hex to where the chunk is. */
+#define RT_DEDUP_PACK_MAGIC 0x50445452u // "RTDP"
+#define RT_DEDUP_RECIPE_MAGIC 0x52445452u // "RTDR"
+#define RT_DEDUP_VERSION 1
+#define RT_DEDUP_HEADER_SIZE 8
+#define RT_DEDUP_RECORD_SIZE 20
+#define RT_DEDUP_RECIPE_HEADER_SIZE 24
+#define RT_DEDUP_RECIPE_ENTRY_SIZE 32
+#define RT_DEDUP_KEY_SIZE 33 // 32 hex digits and the terminator
+#define RT_DEDUP_CHUNK 0x1000000 // read and chunked per round by rt_dedup_write_file
+
+typedef struct _RT_DedupEntry {
+    uint64_t offset; // of the chunk data in the pack
+    size_t size;
+} RT_DedupEntry;
+
+typedef struct _RT_DedupStore {
+    RT_HashMap index;
+    RT_Chunker chunker;
+    char *path;
+    uint64_t pack_size;  // end of the last whole record
+    uint64_t chunks;     // distinct chunks in the pack
+    uint64_t stored;     // chunk bytes in the pack
+    uint64_t written;    // snapshot bytes written through this store
+    uint64_t deduped;    // of which were already in the pack
+} RT_DedupStore;
+
+/* Loads the index of the pack at `path`, which is created on the first
+ * write if missing or empty; a file that can't be read or isn't a pack
+ * fails. chunk_avg of 0 picks RT_CHUNK_AVG; snapshots only share
+ * chunks when they are cut with the same average. */
+bool rt_dedup_open(RT_DedupStore *store, const char *path, size_t chunk_avg);
+void rt_dedup_close(RT_DedupStore *store);
+
+/* Stores `data` as a snapshot described by the recipe at recipe_path */
+bool rt_dedup_write(RT_DedupStore *store, const void *data, size_t size, const char *recipe_path);
+bool rt_dedup_write_file(RT_DedupStore *store, const char *path, const char *recipe_path); // streams the file
+
+/* Rebuilds a snapshot from its recipe and the pack at pack_path */
+bool rt_dedup_restore(const char *pack_path, const char *recipe_path, RT_FileBuffer *out);
+
+static inline void rt_dedup_key(char key[RT_DEDUP_KEY_SIZE], RT_Hash128 fingerprint)
+{
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < 16; ++i) {
+        key[i] = digits[(fingerprint.hi >> (60 - 4 * i)) & 0xF];
+        key[16 + i] = digits[(fingerprint.lo >> (60 - 4 * i)) & 0xF];
+    }
+    key[32] = '\0';
+}
+
+#endif // _INC_RT_DEDUP
@@ -0,0 +1,148 @@
+#include "rt_diff.h"
+#include "rt_hex.h"
+#include "rt_simd.h"
+#include "rt_thread.h"
+
+bool rt_diff_append(RT_DiffList *list, uint64_t offset, uint64_t size, size_t gap)
+{
+    if (!list) return false;
+    if (size == 0) return true;
+
+    if (list->size > 0) {
+        RT_DiffRange *last = &list->data[list->size - 1];
+        const uint64_t end = last->offset + last->size;
+        if (offset <= end || offset - end <= gap) {
+            if (offset + size > end) last->size = offset + size - last->offset;
+            return true;
+        }
+    }
+
+    return RT_DiffList_push(list, (RT_DiffRange){ offset, size });
+}
+
+/* Parallel comparison */
+typedef struct _RT__DiffTask {
+    const uint8_t *a;
+    const uint8_t *b;
+    size_t size;
+    uint64_t offset;
+    size_t gap;
+    RT_DiffList ranges;
+    bool ok;
+} RT__DiffTask;
+
+static DWORD rt__diff_worker(void *param)
+{
+    RT__DiffTask *task = param;
+    task->ok = true;
+
+    // alternate between the next differing and the next equal byte
+    size_t i = rt__simd_find_diff(task->a, task->b, task->size, 0, false);
+    while (i < task->size && task->ok) {
+        const size_t end = rt__simd_find_diff(task->a, task->b, task->size, i, true);
+        task->ok = rt_diff_append(&task->ranges, task->offset + i, end - i, task->gap);
+        i = rt__simd_find_diff(task->a, task->b, task->size, end, false);
+    }
+    return 0;
+}
+
+bool rt_diff_range(RT_DiffList *list, const uint8_t *a, const uint8_t *b, size_t size, uint64_t offset, size_t gap)
+{
+    if (!list || (size && (!a || !b))) return false;
+    if (size == 0) return true;
+
+    size_t count = rt_thread_cpu_count();
+    if (count > RT_THREAD_MAX_TASKS) count = RT_THREAD_MAX_TASKS;
+    if (count > size / RT_DIFF_TASK_MIN) count = size / RT_DIFF_TASK_MIN;
+    if (count == 0) count = 1;
+
+    RT__DiffTask *tasks = RT_MALLOC(count * sizeof(RT__DiffTask));
+    if (!tasks) return false;
+
+    // 64-byte aligned cuts keep every piece but the last on whole SIMD steps
+    for (size_t t = 0, from = 0; t < count; ++t) {
+        const size_t to = t + 1 < count ? (size_t)((uint64_t)size * (t + 1) / count) & ~(size_t)63 : size;
+        tasks[t] = (RT__DiffTask){ a + from, b + from, to - from, offset + from, gap, {0}, false };
+        from = to;
+    }
+
+    if (count == 1) rt__diff_worker(tasks);
+    else rt_thread_run_tasks(tasks, sizeof(RT__DiffTask), count, rt__diff_worker);
+
+    // a range cut by a piece boundary is joined again here
+    bool ok = true;
+    for (size_t t = 0; t < count; ++t) {
+        ok = ok && tasks[t].ok;
+        for (size_t r = 0; ok && r < tasks[t].ranges.size; ++r) {
+            ok = rt_diff_append(list, tasks[t].ranges.data[r].offset, tasks[t].ranges.data[r].size, gap);
+        }
+        RT_DiffList_free(&tasks[t].ranges);
+    }
+
+    RT_FREE(tasks);
+    return ok;
+}
+
+bool rt_diff(RT_DiffList *list, const uint8_t *a, size_t a_size, const uint8_t *b, size_t b_size, size_t gap)
+{
+    const size_t common = a_size < b_size ? a_size : b_size;
+    const size_t longest = a_size < b_size ? b_size : a_size;
+    return rt_diff_range(list, a, b, common, 0, gap) &&
+           rt_diff_append(list, common, longest - common, gap);
+}
+
+bool rt_fbuffer_diff(RT_DiffList *list, const RT_FileBuffer *a, const RT_FileBuffer *b, size_t gap)
+{
+    if (!a || !b) return false;
+    return rt_diff(list, a->data, a->size, b->data, b->size, gap);
+}
+
+/* Output */
+bool rt_diff_write_ranges(RT_FileWriter *writer, const RT_DiffList *list)
+{
+    if (!writer || !list) return false;
+
+    for (size_t i = 0; i < list->size; ++i) {
+        const RT_DiffRange *range = &list->data[i];
+        if (!rt_fwriter_printf(writer, "%08llx %llx\n",
+                               (unsigned long long)range->offset,
+                               (unsigned long long)range->size)) return false;
+    }
+    return true;
+}
+
+static bool rt__diff_write_row(RT_FileWriter *writer, char side, const uint8_t *data, size_t size, uint64_t row)
+{
+    if (row >= size) return true;
+
+    const size_t n = size - row < RT_HEXDUMP_ROW ? (size_t)(size - row) : RT_HEXDUMP_ROW;
+    char *out = (char*)rt_fwriter_reserve(writer, RT_HEXDUMP_LINE_MAX + 1);
+    if (!out) return false;
+
+    out[0] = side;
+    rt_fwriter_commit(writer, 1 + rt_hexdump_format(out + 1, data + row, n, row));
+    return true;
+}
+
+bool rt_diff_write_hexdump(RT_FileWriter *writer, const RT_DiffList *list,
+                           const uint8_t *a, size_t a_size, const uint8_t *b, size_t b_size)
+{
+    if (!writer || !list || (a_size && !a) || (b_size && !b)) return false;
+
+    uint64_t next = 0; // rows below were shown with an earlier range
+    for (size_t i = 0; i < list->size; ++i) {
+        const RT_DiffRange *range = &list->data[i];
+        if (!rt_fwriter_printf(writer, "@ %08llx %llx\n",
+                               (unsigned long long)range->offset,
+                               (unsigned long long)range->size)) return false;
+
+        uint64_t row = range->offset & ~(uint64_t)(RT_HEXDUMP_ROW - 1);
+        if (row < next) row = next;
+        for (; row < range->offset + range->size; row += RT_HEXDUMP_ROW) {
+            if (!rt__diff_write_row(writer, '-', a, a_size, row) ||
+                !rt__diff_write_row(writer, '+', b, b_size, row)) return false;
+        }
+        next = row;
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef _INC_RT_DIFF
+#define _INC_RT_DIFF
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+#include "rt_typed.h"
+#include "rt_stream.h"
+
+/* Binary diff
+ * Reports the byte ranges where two inputs differ, in offset order. Bytes
+ * are compared 64 at a time with AVX2 (32 with SSE2), so long equal stretches
+ * cost one compare and one mask test per step, and large inputs are cut into
+ * pieces compared in parallel whose ranges are joined back in order. Ranges
+ * at most `gap` equal bytes apart are merged into one, which keeps scattered
+ * edits readable; bytes past the end of the shorter input count as changed. */
+#define RT_DIFF_CHUNK 0x400000 // per round when streaming files
+#define RT_DIFF_TASK_MIN 0x40000 // bytes worth handing to another thread
+
+typedef struct _RT_DiffRange {
+    uint64_t offset;
+    uint64_t size;
+} RT_DiffRange;
+
+RT_DEFINE_DARRAY(RT_DiffList, RT_DiffRange) // a zeroed list is ready to use, RT_DiffList_free() releases it
+
+/* Adds a changed range after the last one, merging it in if it is at most
+ * `gap` bytes past its end. */
+bool rt_diff_append(RT_DiffList *list, uint64_t offset, uint64_t size, size_t gap);
+
+/* Compares `size` bytes of a and b, found at `offset` of the inputs, and
+ * appends the ranges that differ. Streaming callers feed consecutive pieces
+ * to the same list and ranges spanning them come out joined. */
+bool rt_diff_range(RT_DiffList *list, const uint8_t *a, const uint8_t *b, size_t size, uint64_t offset, size_t gap);
+
+bool rt_diff(RT_DiffList *list, const uint8_t *a, size_t a_size, const uint8_t *b, size_t b_size, size_t gap);
+bool rt_fbuffer_diff(RT_DiffList *list, const RT_FileBuffer *a, const RT_FileBuffer *b, size_t gap);
+
+/* Output formats
+ *   - RT_DIFF_RANGES:  one "offset size" line per range, both in hex
+ *   - RT_DIFF_HEXDUMP: an "@ offset size" line per range, then the rows it
+ *                      touches as rt_hexdump_format lines, "-" for a and "+"
+ *                      for b; a side that ended before the row is left out */
+#define RT_DIFF_RANGES  0
+#define RT_DIFF_HEXDUMP 1
+
+bool rt_diff_write_ranges(RT_FileWriter *writer, const RT_DiffList *list);
+bool rt_diff_write_hexdump(RT_FileWriter *writer, const RT_DiffList *list,
+                           const uint8_t *a, size_t a_size, const uint8_t *b, size_t b_size);
+
+#endif // _INC_RT_DIFF
@@ -0,0 +1,437 @@
+#include <math.h>
+
+#include "rt_filter.h"
+#include "rt_simd.h"
+
+/* Blocked Bloom filter */
+#define RT__BLOOM_BLOCK_BYTES (RT_BLOOM_BLOCK_WORDS * sizeof(uint32_t))
+#define RT__BLOOM_BLOCK_BITS (RT__BLOOM_BLOCK_BYTES * 8)
+
+// odd multipliers, one per word, that pick the bit a key sets in it
+static const uint32_t rt__bloom_salt[RT_BLOOM_BLOCK_WORDS] = {
+    0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+    0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u
+};
+
+// false-positive rate at a given load: keys per block are Poisson distributed
+static double rt__bloom_fpp(double bits_per_key)
+{
+    const double lambda = RT__BLOOM_BLOCK_BITS / bits_per_key;
+    const double limit = lambda + 10.0 * sqrt(lambda) + 20.0;
+    double weight = exp(-lambda), fpp = 0.0;
+    for (double j = 0.0; j < limit; j += 1.0) {
+        fpp += weight * pow(1.0 - pow(1.0 - 1.0 / 32.0, j), RT_BLOOM_BLOCK_WORDS);
+        weight *= lambda / (j + 1.0);
+    }
+    return fpp;
+}
+
+static double rt__bloom_bits_per_key(double fpp)
+{
+    double lo = 1.0, hi = 128.0;
+    for (int i = 0; i < 32; ++i) {
+        const double mid = (lo + hi) / 2.0;
+        if (rt__bloom_fpp(mid) > fpp) lo = mid;
+        else hi = mid;
+    }
+    return hi;
+}
+
+static inline uint32_t *rt__bloom_block(const RT_BloomFilter *filter, uint64_t hash)
+{
+    const size_t i = (size_t)(((uint64_t)(uint32_t)(hash >> 32) * filter->block_count) >> 32);
+    return filter->blocks + i * RT_BLOOM_BLOCK_WORDS;
+}
+
+#ifdef RT_SIMD_X86
+RT_TARGET_AVX2 static inline __m256i rt__bloom_mask_avx2(uint32_t h)
+{
+    __m256i x = _mm256_mullo_epi32(_mm256_set1_epi32((int)h), _mm256_loadu_si256((const __m256i*)rt__bloom_salt));
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(x, 27));
+}
+
+RT_TARGET_AVX2 static void rt__bloom_add_avx2(uint32_t *block, uint32_t h)
+{
+    __m256i *p = (__m256i*)block;
+    _mm256_store_si256(p, _mm256_or_si256(_mm256_load_si256(p), rt__bloom_mask_avx2(h)));
+}
+
+RT_TARGET_AVX2 static bool rt__bloom_contains_avx2(const uint32_t *block, uint32_t h)
+{
+    return _mm256_testc_si256(_mm256_load_si256((const __m256i*)block), rt__bloom_mask_avx2(h));
+}
+#endif // RT_SIMD_X86
+
+bool rt_bloom_init(RT_BloomFilter *filter, size_t expected, double fpp)
+{
+    if (!filter || !(fpp > 0.0 && fpp < 1.0)) return false;
+    if (expected == 0) expected = 1;
+
+    const double bits = rt__bloom_bits_per_key(fpp) * (double)expected;
+    const size_t block_count = (size_t)(bits / RT__BLOOM_BLOCK_BITS) + 1;
+    if (block_count > UINT32_MAX || block_count > SIZE_MAX / RT__BLOOM_BLOCK_BYTES - 1) return false;
+
+    void *raw = RT_CALLOC(block_count * RT__BLOOM_BLOCK_BYTES + RT__BLOOM_BLOCK_BYTES - 1, 1);
+    if (!raw) return false;
+
+    const uintptr_t align = RT__BLOOM_BLOCK_BYTES - 1;
+    filter->raw = raw;
+    filter->blocks = (uint32_t*)(((uintptr_t)raw + align) & ~align);
+    filter->block_count = block_count;
+    return true;
+}
+
+void rt_bloom_free(RT_BloomFilter *filter)
+{
+    if (!filter) return;
+
+    RT_FREE(filter->raw);
+    filter->raw = NULL;
+    filter->blocks = NULL;
+    filter->block_count = 0;
+}
+
+void rt_bloom_clear(RT_BloomFilter *filter)
+{
+    if (!filter || !filter->blocks) return;
+
+    memset(filter->blocks, 0, filter->block_count * RT__BLOOM_BLOCK_BYTES);
+}
+
+void rt_bloom_add_hash(RT_BloomFilter *filter, uint64_t hash)
+{
+    if (!filter || !filter->blocks) return;
+
+    uint32_t *block = rt__bloom_block(filter, hash);
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_AVX2)) {
+        rt__bloom_add_avx2(block, (uint32_t)hash);
+        return;
+    }
+#endif // RT_SIMD_X86
+
+    for (int i = 0; i < RT_BLOOM_BLOCK_WORDS; ++i) {
+        block[i] |= 1u << (((uint32_t)hash * rt__bloom_salt[i]) >> 27);
+    }
+}
+
+bool rt_bloom_contains_hash(const RT_BloomFilter *filter, uint64_t hash)
+{
+    if (!filter || !filter->blocks) return false;
+
+    const uint32_t *block = rt__bloom_block(filter, hash);
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_AVX2)) return rt__bloom_contains_avx2(block, (uint32_t)hash);
+#endif // RT_SIMD_X86
+
+    for (int i = 0; i < RT_BLOOM_BLOCK_WORDS; ++i) {
+        if (!(block[i] & (1u << (((uint32_t)hash * rt__bloom_salt[i]) >> 27)))) return false;
+    }
+    return true;
+}
+
+/* Cuckoo filter */
+#define RT__CUCKOO_LOAD 0.9 // planned occupancy, inserts start to fail around 95%
+
+static inline uint32_t rt__cuckoo_fp(const RT_CuckooFilter *filter, uint64_t hash)
+{
+    const uint32_t fp = (uint32_t)(hash >> 32) & (filter->fp_size == 1 ? 0xFFu : 0xFFFFu);
+    return fp ? fp : 1;
+}
+
+// partial-key cuckoo hashing: the other bucket only depends on the fingerprint
+static inline size_t rt__cuckoo_alt(const RT_CuckooFilter *filter, size_t bucket, uint32_t fp)
+{
+    return (bucket ^ (size_t)(fp * 0x5BD1E995u)) & filter->bucket_mask;
+}
+
+static inline uint8_t *rt__cuckoo_slot(const RT_CuckooFilter *filter, size_t bucket, unsigned slot)
+{
+    return filter->table + (bucket * RT_CUCKOO_SLOTS + slot) * filter->fp_size;
+}
+
+static inline uint32_t rt__cuckoo_get(const RT_CuckooFilter *filter, size_t bucket, unsigned slot)
+{
+    const uint8_t *p = rt__cuckoo_slot(filter, bucket, slot);
+    if (filter->fp_size == 1) return *p;
+
+    uint16_t fp;
+    memcpy(&fp, p, sizeof(fp));
+    return fp;
+}
+
+static inline void rt__cuckoo_set(RT_CuckooFilter *filter, size_t bucket, unsigned slot, uint32_t fp)
+{
+    uint8_t *p = rt__cuckoo_slot(filter, bucket, slot);
+    if (filter->fp_size == 1) {
+        *p = (uint8_t)fp;
+        return;
+    }
+
+    const uint16_t v = (uint16_t)fp;
+    memcpy(p, &v, sizeof(v));
+}
+
+// compares all four slots at once (zero-lane test on fp ^ slots)
+static inline bool rt__cuckoo_bucket_has(const RT_CuckooFilter *filter, size_t bucket, uint32_t fp)
+{
+    const uint8_t *p = rt__cuckoo_slot(filter, bucket, 0);
+    if (filter->fp_size == 1) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        v ^= fp * 0x01010101u;
+        return ((v - 0x01010101u) & ~v & 0x80808080u) != 0;
+    }
+
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    v ^= fp * 0x0001000100010001ull;
+    return ((v - 0x0001000100010001ull) & ~v & 0x8000800080008000ull) != 0;
+}
+
+static bool rt__cuckoo_put(RT_CuckooFilter *filter, size_t bucket, uint32_t fp)
+{
+    for (unsigned slot = 0; slot < RT_CUCKOO_SLOTS; ++slot) {
+        if (rt__cuckoo_get(filter, bucket, slot) == 0) {
+            rt__cuckoo_set(filter, bucket, slot, fp);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool rt__cuckoo_take(RT_CuckooFilter *filter, size_t bucket, uint32_t fp)
+{
+    for (unsigned slot = 0; slot < RT_CUCKOO_SLOTS; ++slot) {
+        if (rt__cuckoo_get(filter, bucket, slot) == fp) {
+            rt__cuckoo_set(filter, bucket, slot, 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint64_t rt__cuckoo_random(RT_CuckooFilter *filter)
+{
+    uint64_t x = filter->seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    filter->seed = x;
+    return x;
+}
+
+bool rt_cuckoo_init(RT_CuckooFilter *filter, size_t expected, double fpp)
+{
+    if (!filter || !(fpp > 0.0 && fpp < 1.0)) return false;
+    if (expected == 0) expected = 1;
+
+    // rate is about 2 * RT_CUCKOO_SLOTS / 2^bits
+    const uint32_t fp_size = fpp >= 2.0 * RT_CUCKOO_SLOTS / 256.0 ? 1 : 2;
+    const double wanted = (double)expected / (RT_CUCKOO_SLOTS * RT__CUCKOO_LOAD);
+    size_t buckets = 1;
+    while ((double)buckets < wanted) {
+        if (buckets > SIZE_MAX / (2 * RT_CUCKOO_SLOTS * fp_size)) return false;
+        buckets <<= 1;
+    }
+
+    filter->table = RT_CALLOC(buckets * RT_CUCKOO_SLOTS, fp_size);
+    if (!filter->table) return false;
+
+    filter->bucket_mask = buckets - 1;
+    filter->size = 0;
+    filter->victim_index = 0;
+    filter->victim_fp = 0;
+    filter->fp_size = fp_size;
+    filter->seed = 0x9E3779B97F4A7C15ull;
+    return true;
+}
+
+void rt_cuckoo_free(RT_CuckooFilter *filter)
+{
+    if (!filter) return;
+
+    RT_FREE(filter->table);
+    filter->table = NULL;
+    filter->bucket_mask = 0;
+    filter->size = 0;
+    filter->victim_fp = 0;
+}
+
+void rt_cuckoo_clear(RT_CuckooFilter *filter)
+{
+    if (!filter || !filter->table) return;
+
+    memset(filter->table, 0, (filter->bucket_mask + 1) * RT_CUCKOO_SLOTS * filter->fp_size);
+    filter->size = 0;
+    filter->victim_fp = 0;
+}
+
+bool rt_cuckoo_add_hash(RT_CuckooFilter *filter, uint64_t hash)
+{
+    if (!filter || !filter->table || filter->victim_fp) return false;
+
+    uint32_t fp = rt__cuckoo_fp(filter, hash);
+    size_t bucket = (size_t)hash & filter->bucket_mask;
+    if (rt__cuckoo_put(filter, bucket, fp) || rt__cuckoo_put(filter, rt__cuckoo_alt(filter, bucket, fp), fp)) {
+        filter->size++;
+        return true;
+    }
+
+    // both full: evict a random resident to its other bucket, and so on
+    if (rt__cuckoo_random(filter) & 1) bucket = rt__cuckoo_alt(filter, bucket, fp);
+    for (int kick = 0; kick < RT_CUCKOO_MAX_KICKS; ++kick) {
+        const unsigned slot = (unsigned)(rt__cuckoo_random(filter) % RT_CUCKOO_SLOTS);
+        const uint32_t evicted = rt__cuckoo_get(filter, bucket, slot);
+        rt__cuckoo_set(filter, bucket, slot, fp);
+        fp = evicted;
+        bucket = rt__cuckoo_alt(filter, bucket, fp);
+        if (rt__cuckoo_put(filter, bucket, fp)) {
+            filter->size++;
+            return true;
+        }
+    }
+
+    // the last evicted fingerprint is kept aside, the filter is full from now on
+    filter->victim_fp = fp;
+    filter->victim_index = bucket;
+    filter->size++;
+    return true;
+}
+
+bool rt_cuckoo_remove_hash(RT_CuckooFilter *filter, uint64_t hash)
+{
+    if (!filter || !filter->table) return false;
+
+    const uint32_t fp = rt__cuckoo_fp(filter, hash);
+    const size_t b1 = (size_t)hash & filter->bucket_mask, b2 = rt__cuckoo_alt(filter, b1, fp);
+    if (filter->victim_fp == fp && (filter->victim_index == b1 || filter->victim_index == b2)) {
+        filter->victim_fp = 0;
+    } else if (!rt__cuckoo_take(filter, b1, fp) && !rt__cuckoo_take(filter, b2, fp)) {
+        return false;
+    }
+    filter->size--;
+
+    // a slot opened up, try to bring the victim back in
+    if (filter->victim_fp) {
+        const size_t vb = filter->victim_index;
+        if (rt__cuckoo_put(filter, vb, filter->victim_fp) ||
+            rt__cuckoo_put(filter, rt__cuckoo_alt(filter, vb, filter->victim_fp), filter->victim_fp)) {
+            filter->victim_fp = 0;
+        }
+    }
+    return true;
+}
+
+bool rt_cuckoo_contains_hash(const RT_CuckooFilter *filter, uint64_t hash)
+{
+    if (!filter || !filter->table) return false;
+
+    const uint32_t fp = rt__cuckoo_fp(filter, hash);
+    const size_t b1 = (size_t)hash & filter->bucket_mask, b2 = rt__cuckoo_alt(filter, b1, fp);
+    if (rt__cuckoo_bucket_has(filter, b1, fp) || rt__cuckoo_bucket_has(filter, b2, fp)) return true;
+    return filter->victim_fp == fp && (filter->victim_index == b1 || filter->victim_index == b2);
+}
+
+/* Filtered hash map */
+static bool rt__fmap_rebuild(RT_FilteredMap *fmap, size_t expected)
+{
+    RT_CuckooFilter filter;
+    for (;;) {
+        if (!rt_cuckoo_init(&filter, expected, RT_FMAP_FPP)) return false;
+
+        bool full = false;
+        for (size_t i = 0; i < fmap->map.buckets_count && !full; ++i) {
+            for (RT_HTNode *node = fmap->map.buckets[i].head; node; node = node->next) {
+                if (!rt_cuckoo_add(&filter, node->key)) {
+                    full = true;
+                    break;
+                }
+            }
+        }
+        if (!full) break;
+
+        rt_cuckoo_free(&filter);
+        expected *= 2;
+    }
+
+    rt_cuckoo_free(&fmap->filter);
+    fmap->filter = filter;
+    return true;
+}
+
+bool rt_fmap_init(RT_FilteredMap *fmap, size_t expected)
+{
+    if (!fmap) return false;
+    if (expected == 0) expected = RT_HASHMAP_INIT_BUCKETS_COUNT;
+
+    if (!rt_hashmap_init(&fmap->map, (size_t)(expected / RT_HASHMAP_LFACTOR_MAX) + 1)) return false;
+    if (!rt_cuckoo_init(&fmap->filter, expected, RT_FMAP_FPP)) {
+        rt_hashmap_free(&fmap->map);
+        return false;
+    }
+    return true;
+}
+
+void rt_fmap_free(RT_FilteredMap *fmap)
+{
+    if (!fmap) return;
+
+    rt_hashmap_free(&fmap->map);
+    rt_cuckoo_free(&fmap->filter);
+}
+
+bool rt_fmap_insert(RT_FilteredMap *fmap, const char *key, void *value, size_t value_size)
+{
+    if (!fmap) return false;
+
+    const size_t size = fmap->map.size;
+    if (!rt_hashmap_insert(&fmap->map, key, value, value_size)) return false;
+    if (fmap->map.size == size) return true; // updated in place, already in the filter
+
+    if (rt_cuckoo_add(&fmap->filter, key)) return true;
+
+    // filter full: the rebuild picks up the new key from the map
+    if (rt__fmap_rebuild(fmap, (fmap->filter.bucket_mask + 1) * RT_CUCKOO_SLOTS * 2)) return true;
+
+    rt_hashmap_remove(&fmap->map, key);
+    return false;
+}
+
+// filter check and bucket walk share one pass over the key
+static RT_HTNode *rt__fmap_find(RT_FilteredMap *fmap, const char *key)
+{
+    const size_t hash = rt__hashmap_hash(key);
+    if (!rt_cuckoo_contains_hash(&fmap->filter, rt__filter_mix(hash))) return NULL;
+
+    RT_HTNode *node = fmap->map.buckets[hash % fmap->map.buckets_count].head;
+    while (node && strcmp(node->key, key) != 0) node = node->next;
+    return node;
+}
+
+bool rt_fmap_get(RT_FilteredMap *fmap, const char *key, void *out, size_t out_size)
+{
+    if (!fmap || !key || !out || out_size == 0) return false;
+
+    RT_HTNode *node = rt__fmap_find(fmap, key);
+    if (!node || out_size < node->value_size) return false;
+
+    memcpy(out, node->value, node->value_size);
+    return true;
+}
+
+bool rt_fmap_remove(RT_FilteredMap *fmap, const char *key)
+{
+    if (!fmap || !key || !rt_cuckoo_contains(&fmap->filter, key)) return false;
+    if (!rt_hashmap_remove(&fmap->map, key)) return false;
+
+    rt_cuckoo_remove(&fmap->filter, key);
+    return true;
+}
+
+bool rt_fmap_contains(RT_FilteredMap *fmap, const char *key)
+{
+    if (!fmap || !key) return false;
+
+    return rt__fmap_find(fmap, key) != NULL;
+}
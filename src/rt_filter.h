@@ -0,0 +1,122 @@
+#ifndef _INC_RT_FILTER
+#define _INC_RT_FILTER
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+
+/* Membership filters
+ * Probabilistic sets that answer "definitely absent" or "maybe present", so a
+ * caller can skip the real lookup for most absent keys. Keys are hashed with
+ * the hashmap's string hash, followed by a 64-bit finalizer that spreads it
+ * over all bits. The _hash variants take a hash the caller already has. */
+static inline uint64_t rt__filter_mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline uint64_t rt_filter_hash(const char *key)
+{
+    return rt__filter_mix(rt__hashmap_hash(key));
+}
+
+/* Blocked Bloom filter
+ * Each key sets 8 bits inside a single 256-bit block, one per 32-bit word,
+ * so a query touches one cache line and is a multiply, a shift and one AVX2
+ * test. Sized from the expected key count and a target false-positive rate.
+ * Keys cannot be removed. */
+#define RT_BLOOM_BLOCK_WORDS 8
+
+typedef struct _RT_BloomFilter {
+    uint32_t *blocks; // block_count * RT_BLOOM_BLOCK_WORDS, 32-byte aligned
+    void *raw;
+    size_t block_count;
+} RT_BloomFilter;
+
+bool rt_bloom_init(RT_BloomFilter *filter, size_t expected, double fpp);
+void rt_bloom_free(RT_BloomFilter *filter);
+void rt_bloom_clear(RT_BloomFilter *filter);
+void rt_bloom_add_hash(RT_BloomFilter *filter, uint64_t hash);
+bool rt_bloom_contains_hash(const RT_BloomFilter *filter, uint64_t hash);
+
+static inline void rt_bloom_add(RT_BloomFilter *filter, const char *key)
+{
+    rt_bloom_add_hash(filter, rt_filter_hash(key));
+}
+
+static inline bool rt_bloom_contains(const RT_BloomFilter *filter, const char *key)
+{
+    return rt_bloom_contains_hash(filter, rt_filter_hash(key));
+}
+
+/* Cuckoo filter
+ * Stores an 8 or 16 bit fingerprint per key in one of two 4-slot buckets,
+ * which makes removal possible. The fingerprint width is picked from the
+ * target rate (about 3% and 0.012% respectively). Adding the same key twice
+ * stores it twice, and only keys that were added may be removed. Once an
+ * insert cannot find room the filter is full and further adds fail. */
+#define RT_CUCKOO_SLOTS 4
+#define RT_CUCKOO_MAX_KICKS 500
+
+typedef struct _RT_CuckooFilter {
+    uint8_t *table;       // bucket_count * RT_CUCKOO_SLOTS fingerprints, 0 = empty slot
+    size_t bucket_mask;   // bucket_count - 1, a power of two
+    size_t size;
+    size_t victim_index;  // bucket of the fingerprint that found no slot
+    uint32_t victim_fp;   // 0 while the filter is not full
+    uint32_t fp_size;     // bytes per fingerprint
+    uint64_t seed;        // eviction choices
+} RT_CuckooFilter;
+
+bool rt_cuckoo_init(RT_CuckooFilter *filter, size_t expected, double fpp);
+void rt_cuckoo_free(RT_CuckooFilter *filter);
+void rt_cuckoo_clear(RT_CuckooFilter *filter);
+bool rt_cuckoo_add_hash(RT_CuckooFilter *filter, uint64_t hash);
+bool rt_cuckoo_remove_hash(RT_CuckooFilter *filter, uint64_t hash);
+bool rt_cuckoo_contains_hash(const RT_CuckooFilter *filter, uint64_t hash);
+
+static inline bool rt_cuckoo_add(RT_CuckooFilter *filter, const char *key)
+{
+    return rt_cuckoo_add_hash(filter, rt_filter_hash(key));
+}
+
+static inline bool rt_cuckoo_remove(RT_CuckooFilter *filter, const char *key)
+{
+    return rt_cuckoo_remove_hash(filter, rt_filter_hash(key));
+}
+
+static inline bool rt_cuckoo_contains(const RT_CuckooFilter *filter, const char *key)
+{
+    return rt_cuckoo_contains_hash(filter, rt_filter_hash(key));
+}
+
+/* Filtered hash map
+ * RT_HashMap with a cuckoo filter in front of it: lookups of absent keys
+ * usually stop at the filter instead of walking a bucket and comparing
+ * strings. The filter is rebuilt at twice the size when it fills up. */
+#define RT_FMAP_FPP 0.001
+
+typedef struct _RT_FilteredMap {
+    RT_HashMap map;
+    RT_CuckooFilter filter;
+} RT_FilteredMap;
+
+bool rt_fmap_init(RT_FilteredMap *fmap, size_t expected);
+void rt_fmap_free(RT_FilteredMap *fmap);
+bool rt_fmap_insert(RT_FilteredMap *fmap, const char *key, void *value, size_t value_size);
+bool rt_fmap_get(RT_FilteredMap *fmap, const char *key, void *out, size_t out_size);
+bool rt_fmap_remove(RT_FilteredMap *fmap, const char *key);
+bool rt_fmap_contains(RT_FilteredMap *fmap, const char *key);
+
+static inline bool rt_fmap_is_empty(RT_FilteredMap *fmap)
+{
+    return !fmap || fmap->map.size == 0;
+}
+
+#endif // _INC_RT_FILTER
@@ -0,0 +1,457 @@
+#include "rt_hash.h"
+#include "rt_simd.h"
+#include "rt_thread.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#   include <intrin.h>
+#endif
+
+/* CRC32C tables
+ * Built on first use. Threads racing here write the same values, so the
+ * only cost of the race is the duplicate work. */
+#define RT__CRC32C_POLY 0x82F63B78u // reflected
+#define RT__CRC32C_STRIDE 8192      // bytes per stream in the hardware loop
+
+static uint32_t rt__crc32c_table[8][256];   // slicing-by-8
+static uint32_t rt__crc32c_shift[4][256];   // multiplies by x^(8 * STRIDE), a byte at a time
+static uint32_t rt__crc32c_x2n[32];         // x^(2^n)
+static volatile unsigned rt__crc32c_ready;
+
+// a * b modulo the polynomial, both in reflected bit order
+static uint32_t rt__crc32c_mul(uint32_t a, uint32_t b)
+{
+    uint32_t m = 1u << 31, p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ RT__CRC32C_POLY : b >> 1;
+    }
+    return p;
+}
+
+// x^(n * 2^k) modulo the polynomial
+static uint32_t rt__crc32c_x2nmod(uint64_t n, unsigned k)
+{
+    uint32_t p = 1u << 31; // x^0
+    for (; n; n >>= 1, ++k) {
+        if (n & 1) p = rt__crc32c_mul(rt__crc32c_x2n[k & 31], p);
+    }
+    return p;
+}
+
+static void rt__crc32c_init(void)
+{
+    if (rt__crc32c_ready) return;
+
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = c & 1 ? (c >> 1) ^ RT__CRC32C_POLY : c >> 1;
+        rt__crc32c_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int t = 1; t < 8; ++t) {
+            const uint32_t c = rt__crc32c_table[t - 1][i];
+            rt__crc32c_table[t][i] = (c >> 8) ^ rt__crc32c_table[0][c & 0xFF];
+        }
+    }
+
+    uint32_t p = 1u << 30; // x^1
+    for (int n = 0; n < 32; ++n) {
+        rt__crc32c_x2n[n] = p;
+        p = rt__crc32c_mul(p, p);
+    }
+
+    const uint32_t stride = rt__crc32c_x2nmod(RT__CRC32C_STRIDE, 3);
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int t = 0; t < 4; ++t) rt__crc32c_shift[t][i] = rt__crc32c_mul(stride, i << (8 * t));
+    }
+
+    rt__crc32c_ready = 1;
+}
+
+/* CRC32C kernels, on the raw register (no pre/post inversion) */
+static uint32_t rt__crc32c_sw(uint32_t crc, const uint8_t *p, size_t n)
+{
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t x;
+        memcpy(&x, p, 8);
+        x ^= crc;
+        crc = rt__crc32c_table[7][x & 0xFF] ^ rt__crc32c_table[6][(x >> 8) & 0xFF] ^
+              rt__crc32c_table[5][(x >> 16) & 0xFF] ^ rt__crc32c_table[4][(x >> 24) & 0xFF] ^
+              rt__crc32c_table[3][(x >> 32) & 0xFF] ^ rt__crc32c_table[2][(x >> 40) & 0xFF] ^
+              rt__crc32c_table[1][(x >> 48) & 0xFF] ^ rt__crc32c_table[0][x >> 56];
+    }
+    for (; n; --n) crc = (crc >> 8) ^ rt__crc32c_table[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#ifdef RT_SIMD_X86
+static inline uint32_t rt__crc32c_stride(uint32_t crc)
+{
+    return rt__crc32c_shift[0][crc & 0xFF] ^ rt__crc32c_shift[1][(crc >> 8) & 0xFF] ^
+           rt__crc32c_shift[2][(crc >> 16) & 0xFF] ^ rt__crc32c_shift[3][crc >> 24];
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define RT__CRC32C_WORD 8
+#   define RT__CRC32C_STEP(crc, p) ((uint32_t)_mm_crc32_u64((crc), rt__crc32c_load64(p)))
+RT_TARGET_SSE42 static inline uint64_t rt__crc32c_load64(const uint8_t *p) { uint64_t x; memcpy(&x, p, 8); return x; }
+#else
+#   define RT__CRC32C_WORD 4
+#   define RT__CRC32C_STEP(crc, p) _mm_crc32_u32((crc), rt__crc32c_load32(p))
+RT_TARGET_SSE42 static inline uint32_t rt__crc32c_load32(const uint8_t *p) { uint32_t x; memcpy(&x, p, 4); return x; }
+#endif
+
+RT_TARGET_SSE42 static uint32_t rt__crc32c_hw(uint32_t crc, const uint8_t *p, size_t n)
+{
+    // three streams of STRIDE bytes, joined by shifting each over the next
+    for (; n >= 3 * RT__CRC32C_STRIDE; n -= 3 * RT__CRC32C_STRIDE, p += 3 * RT__CRC32C_STRIDE) {
+        uint32_t a = crc, b = 0, c = 0;
+        for (size_t i = 0; i < RT__CRC32C_STRIDE; i += RT__CRC32C_WORD) {
+            a = RT__CRC32C_STEP(a, p + i);
+            b = RT__CRC32C_STEP(b, p + RT__CRC32C_STRIDE + i);
+            c = RT__CRC32C_STEP(c, p + 2 * RT__CRC32C_STRIDE + i);
+        }
+        crc = rt__crc32c_stride(rt__crc32c_stride(a) ^ b) ^ c;
+    }
+    for (; n >= RT__CRC32C_WORD; n -= RT__CRC32C_WORD, p += RT__CRC32C_WORD) crc = RT__CRC32C_STEP(crc, p);
+    for (; n; --n) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+#endif // RT_SIMD_X86
+
+uint32_t rt_crc32c(uint32_t crc, const void *data, size_t size)
+{
+    if (!data || size == 0) return crc;
+    rt__crc32c_init();
+
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_SSE42)) return ~rt__crc32c_hw(~crc, data, size);
+#endif // RT_SIMD_X86
+
+    return ~rt__crc32c_sw(~crc, data, size);
+}
+
+uint32_t rt_crc32c_combine(uint32_t crc_a, uint32_t crc_b, uint64_t size_b)
+{
+    rt__crc32c_init();
+    return rt__crc32c_mul(rt__crc32c_x2nmod(size_b, 3), crc_a) ^ crc_b;
+}
+
+typedef struct _RT__CrcTask {
+    const uint8_t *data;
+    size_t size;
+    uint32_t crc;
+} RT__CrcTask;
+
+static DWORD rt__crc32c_worker(void *param)
+{
+    RT__CrcTask *task = param;
+    task->crc = rt_crc32c(0, task->data, task->size);
+    return 0;
+}
+
+uint32_t rt_crc32c_parallel(uint32_t crc, const void *data, size_t size)
+{
+    if (!data || size == 0) return crc;
+
+    size_t count = rt_thread_cpu_count();
+    if (count > RT_THREAD_MAX_TASKS) count = RT_THREAD_MAX_TASKS;
+    if (count > size / RT_CRC32C_TASK_MIN) count = size / RT_CRC32C_TASK_MIN;
+    if (count <= 1) return rt_crc32c(crc, data, size);
+
+    RT__CrcTask *tasks = RT_MALLOC(count * sizeof(RT__CrcTask));
+    if (!tasks) return rt_crc32c(crc, data, size);
+
+    const uint8_t *p = data;
+    for (size_t t = 0, from = 0; t < count; ++t) {
+        const size_t to = t + 1 < count ? (size_t)((uint64_t)size * (t + 1) / count) : size;
+        tasks[t] = (RT__CrcTask){ p + from, to - from, 0 };
+        from = to;
+    }
+    rt_thread_run_tasks(tasks, sizeof(RT__CrcTask), count, rt__crc32c_worker);
+
+    for (size_t t = 0; t < count; ++t) crc = rt_crc32c_combine(crc, tasks[t].crc, tasks[t].size);
+    RT_FREE(tasks);
+    return crc;
+}
+
+uint32_t rt_fbuffer_crc32c(const RT_FileBuffer *buffer)
+{
+    if (!buffer) return 0;
+    return rt_crc32c_parallel(0, buffer->data, buffer->size);
+}
+
+/* Content hash */
+#define RT__HASH_P32_1 0x9E3779B1u
+#define RT__HASH_P32_2 0x85EBCA77u
+#define RT__HASH_P32_3 0xC2B2AE3Du
+#define RT__HASH_P64_1 0x9E3779B185EBCA87ull
+#define RT__HASH_P64_2 0xC2B2AE3D27D4EB4Full
+#define RT__HASH_P64_3 0x165667B19E3779F9ull
+#define RT__HASH_P64_4 0x85EBCA77C2B2AE63ull
+#define RT__HASH_P64_5 0x27D4EB2F165667C5ull
+#define RT__HASH_STRIPES (RT_HASH_BLOCK / RT_HASH_STRIPE)
+
+// stripe s of a block is keyed with words s..s+7, the scramble with 16..23
+// and the final mixes with 24..31 (64-bit) and 16..23 (upper 128-bit half)
+static const uint64_t rt__hash_secret[32] = {
+    0x2CB0F69F4ABEA221ull, 0x9417034723148989ull, 0xDD555950609DFE03ull, 0xDBAFB150DEB12800ull,
+    0x7E789B2E6C442CB6ull, 0xF41E5636C7E4F8C4ull, 0x0959D150F8FBA7E4ull, 0xA97316F13CDB9EEAull,
+    0x74CD8258F9520068ull, 0x55C74A62E116868Bull, 0xD2F4C799A2023CBDull, 0xDF98CB79A37B51B9ull,
+    0x396F5885524F3905ull, 0xAF1D56386CA3B276ull, 0xA9FFBE6B5104E85Aull, 0x6BD0C51B9FD533B3ull,
+    0x980CE91C50AB4B56ull, 0x28AC395780FE62C5ull, 0x768912E3A6BCEDC7ull, 0x50B3E8C9332C7C88ull,
+    0xCE3BBFE520BD47DAull, 0xCBA6C8E8E0BB7C4Full, 0xBF194DB8434A346Dull, 0x7D8F2A7B60416D7Full,
+    0x0849D1F6E0E10A5Eull, 0x7654B590D064E22Full, 0x16D1DA9507DF3AF2ull, 0xF63AEF1089EA30E4ull,
+    0x9ADE6673CC6C522Bull, 0x4C75BC274E37087Cull, 0xD35E12B49F51F27Bull, 0x22DDF2FFCEE481EAull,
+};
+
+// the 128-bit product of a and b, halves xored
+static inline uint64_t rt__hash_fold(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t p = (__uint128_t)a * b;
+    return (uint64_t)p ^ (uint64_t)(p >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t hi;
+    const uint64_t lo = _umul128(a, b, &hi);
+    return lo ^ hi;
+#else
+    const uint64_t ll = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF), lh = (a & 0xFFFFFFFF) * (b >> 32);
+    const uint64_t hl = (a >> 32) * (b & 0xFFFFFFFF), hh = (a >> 32) * (b >> 32);
+    const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+    return ((ll & 0xFFFFFFFF) | mid << 32) ^ (hh + (lh >> 32) + (hl >> 32) + (mid >> 32));
+#endif
+}
+
+static inline uint64_t rt__hash_avalanche(uint64_t h)
+{
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ull;
+    return h ^ (h >> 32);
+}
+
+// each lane takes the product of its word's halves (keyed) plus its
+// neighbour's word, so a zero product still leaves the input in the sum
+static void rt__hash_stripes_scalar(uint64_t *acc, const uint8_t *p, size_t count, size_t first)
+{
+    for (size_t s = 0; s < count; ++s, p += RT_HASH_STRIPE) {
+        const uint64_t *key = rt__hash_secret + first + s;
+        uint64_t words[8];
+        memcpy(words, p, RT_HASH_STRIPE);
+        for (int i = 0; i < 8; ++i) {
+            const uint64_t x = words[i] ^ key[i];
+            acc[i] += (x & 0xFFFFFFFF) * (x >> 32) + words[i ^ 1];
+        }
+    }
+}
+
+static void rt__hash_scramble_scalar(uint64_t *acc)
+{
+    for (int i = 0; i < 8; ++i) {
+        acc[i] = (acc[i] ^ (acc[i] >> 47) ^ rt__hash_secret[16 + i]) * RT__HASH_P32_1;
+    }
+}
+
+#ifdef RT_SIMD_X86
+RT_TARGET_SSE2 static void rt__hash_stripes_sse2(uint64_t *acc, const uint8_t *p, size_t count, size_t first)
+{
+    __m128i a[4];
+    for (int i = 0; i < 4; ++i) a[i] = _mm_loadu_si128((const __m128i*)(acc + 2 * i));
+    for (size_t s = 0; s < count; ++s, p += RT_HASH_STRIPE) {
+        for (int i = 0; i < 4; ++i) {
+            const __m128i d = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+            const __m128i x = _mm_xor_si128(d, _mm_loadu_si128((const __m128i*)(rt__hash_secret + first + s + 2 * i)));
+            const __m128i product = _mm_mul_epu32(x, _mm_srli_epi64(x, 32));
+            a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+    }
+    for (int i = 0; i < 4; ++i) _mm_storeu_si128((__m128i*)(acc + 2 * i), a[i]);
+}
+
+RT_TARGET_SSE2 static void rt__hash_scramble_sse2(uint64_t *acc)
+{
+    const __m128i prime = _mm_set1_epi32((int)RT__HASH_P32_1);
+    for (int i = 0; i < 4; ++i) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(acc + 2 * i));
+        a = _mm_xor_si128(_mm_xor_si128(a, _mm_srli_epi64(a, 47)), _mm_loadu_si128((const __m128i*)(rt__hash_secret + 16 + 2 * i)));
+        // 64x32-bit multiply from two 32x32->64 ones
+        const __m128i lo = _mm_mul_epu32(a, prime);
+        const __m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+        _mm_storeu_si128((__m128i*)(acc + 2 * i), _mm_add_epi64(lo, _mm_slli_epi64(hi, 32)));
+    }
+}
+
+RT_TARGET_AVX2 static void rt__hash_stripes_avx2(uint64_t *acc, const uint8_t *p, size_t count, size_t first)
+{
+    __m256i a0 = _mm256_loadu_si256((const __m256i*)acc);
+    __m256i a1 = _mm256_loadu_si256((const __m256i*)(acc + 4));
+    for (size_t s = 0; s < count; ++s, p += RT_HASH_STRIPE) {
+        const __m256i d0 = _mm256_loadu_si256((const __m256i*)p);
+        const __m256i d1 = _mm256_loadu_si256((const __m256i*)(p + 32));
+        const __m256i x0 = _mm256_xor_si256(d0, _mm256_loadu_si256((const __m256i*)(rt__hash_secret + first + s)));
+        const __m256i x1 = _mm256_xor_si256(d1, _mm256_loadu_si256((const __m256i*)(rt__hash_secret + first + s + 4)));
+        a0 = _mm256_add_epi64(a0, _mm256_add_epi64(_mm256_mul_epu32(x0, _mm256_srli_epi64(x0, 32)),
+                                                   _mm256_shuffle_epi32(d0, _MM_SHUFFLE(1, 0, 3, 2))));
+        a1 = _mm256_add_epi64(a1, _mm256_add_epi64(_mm256_mul_epu32(x1, _mm256_srli_epi64(x1, 32)),
+                                                   _mm256_shuffle_epi32(d1, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+    _mm256_storeu_si256((__m256i*)acc, a0);
+    _mm256_storeu_si256((__m256i*)(acc + 4), a1);
+}
+#endif // RT_SIMD_X86
+
+static void rt__hash_stripes(uint64_t *acc, const uint8_t *p, size_t count, size_t first)
+{
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_AVX2)) {
+        rt__hash_stripes_avx2(acc, p, count, first);
+        return;
+    }
+    if (rt__cpu_has(RT_CPU_SSE2)) {
+        rt__hash_stripes_sse2(acc, p, count, first);
+        return;
+    }
+#endif // RT_SIMD_X86
+    rt__hash_stripes_scalar(acc, p, count, first);
+}
+
+static void rt__hash_blocks(uint64_t *acc, const uint8_t *p, size_t count)
+{
+    for (size_t b = 0; b < count; ++b, p += RT_HASH_BLOCK) {
+        rt__hash_stripes(acc, p, RT__HASH_STRIPES, 0);
+#ifdef RT_SIMD_X86
+        if (rt__cpu_has(RT_CPU_SSE2)) {
+            rt__hash_scramble_sse2(acc);
+            continue;
+        }
+#endif // RT_SIMD_X86
+        rt__hash_scramble_scalar(acc);
+    }
+}
+
+static void rt__hash_seed(uint64_t *acc, uint64_t seed)
+{
+    static const uint64_t init[8] = {
+        RT__HASH_P32_3, RT__HASH_P64_1, RT__HASH_P64_2, RT__HASH_P64_3,
+        RT__HASH_P64_4, RT__HASH_P32_2, RT__HASH_P64_5, RT__HASH_P32_1
+    };
+    for (int i = 0; i < 8; ++i) acc[i] = i & 1 ? init[i] - seed : init[i] + seed;
+}
+
+// the last partial block: whole stripes, then a zero-padded one; the length
+// mixed in later tells the padding from real zeros
+static void rt__hash_tail(uint64_t *acc, const uint8_t *p, size_t size)
+{
+    const size_t stripes = size / RT_HASH_STRIPE;
+    rt__hash_stripes(acc, p, stripes, 0);
+
+    const size_t rest = size % RT_HASH_STRIPE;
+    if (rest) {
+        uint8_t last[RT_HASH_STRIPE] = {0};
+        memcpy(last, p + stripes * RT_HASH_STRIPE, rest);
+        rt__hash_stripes(acc, last, 1, stripes);
+    }
+}
+
+static uint64_t rt__hash_merge(const uint64_t *acc, uint64_t start, int key_a, int key_b)
+{
+    uint64_t h = start;
+    for (int i = 0; i < 4; ++i) {
+        h += rt__hash_fold(acc[2 * i] ^ rt__hash_secret[key_a + 2 * i], acc[2 * i + 1] ^ rt__hash_secret[key_b + 2 * i]);
+    }
+    return rt__hash_avalanche(h);
+}
+
+static inline uint64_t rt__hash_lo(const uint64_t *acc, uint64_t length)
+{
+    return rt__hash_merge(acc, length * RT__HASH_P64_1, 24, 25);
+}
+
+static inline uint64_t rt__hash_hi(const uint64_t *acc, uint64_t length)
+{
+    return rt__hash_merge(acc, ~length * RT__HASH_P64_2, 17, 16);
+}
+
+uint64_t rt_hash64(const void *data, size_t size, uint64_t seed)
+{
+    if (!data) {
+        data = "";
+        size = 0;
+    }
+
+    uint64_t acc[8];
+    rt__hash_seed(acc, seed);
+    rt__hash_blocks(acc, data, size / RT_HASH_BLOCK);
+    rt__hash_tail(acc, (const uint8_t*)data + size / RT_HASH_BLOCK * RT_HASH_BLOCK, size % RT_HASH_BLOCK);
+    return rt__hash_lo(acc, size);
+}
+
+RT_Hash128 rt_hash128(const void *data, size_t size, uint64_t seed)
+{
+    if (!data) {
+        data = "";
+        size = 0;
+    }
+
+    uint64_t acc[8];
+    rt__hash_seed(acc, seed);
+    rt__hash_blocks(acc, data, size / RT_HASH_BLOCK);
+    rt__hash_tail(acc, (const uint8_t*)data + size / RT_HASH_BLOCK * RT_HASH_BLOCK, size % RT_HASH_BLOCK);
+    return (RT_Hash128){ rt__hash_lo(acc, size), rt__hash_hi(acc, size) };
+}
+
+void rt_hash_init(RT_HashState *state, uint64_t seed)
+{
+    if (!state) return;
+    rt__hash_seed(state->acc, seed);
+    state->length = 0;
+    state->buffered = 0;
+}
+
+void rt_hash_update(RT_HashState *state, const void *data, size_t size)
+{
+    if (!state || !data || size == 0) return;
+
+    const uint8_t *p = data;
+    state->length += size;
+
+    // complete blocks are hashed as soon as they are whole, like the one-shot form does
+    if (state->buffered > 0) {
+        const size_t take = size < RT_HASH_BLOCK - state->buffered ? size : RT_HASH_BLOCK - state->buffered;
+        memcpy(state->buffer + state->buffered, p, take);
+        state->buffered += take;
+        p += take;
+        size -= take;
+        if (state->buffered < RT_HASH_BLOCK) return;
+        rt__hash_blocks(state->acc, state->buffer, 1);
+        state->buffered = 0;
+    }
+
+    rt__hash_blocks(state->acc, p, size / RT_HASH_BLOCK);
+    p += size / RT_HASH_BLOCK * RT_HASH_BLOCK;
+    size %= RT_HASH_BLOCK;
+    memcpy(state->buffer, p, size);
+    state->buffered = size;
+}
+
+uint64_t rt_hash_final64(const RT_HashState *state)
+{
+    if (!state) return 0;
+    uint64_t acc[8];
+    memcpy(acc, state->acc, sizeof(acc));
+    rt__hash_tail(acc, state->buffer, state->buffered);
+    return rt__hash_lo(acc, state->length);
+}
+
+RT_Hash128 rt_hash_final128(const RT_HashState *state)
+{
+    if (!state) return (RT_Hash128){ 0, 0 };
+    uint64_t acc[8];
+    memcpy(acc, state->acc, sizeof(acc));
+    rt__hash_tail(acc, state->buffer, state->buffered);
+    return (RT_Hash128){ rt__hash_lo(acc, state->length), rt__hash_hi(acc, state->length) };
+}
@@ -0,0 +1,57 @@
+#ifndef _INC_RT_HASH
+#define _INC_RT_HASH
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+
+/* CRC32C
+ * The Castagnoli CRC, as used by iSCSI, ext4 and most storage formats. With
+ * SSE4.2 it runs on the crc32 instruction over three interleaved streams,
+ * which hides the instruction's latency; otherwise it falls back to
+ * slicing-by-8 tables. Calls chain: pass 0 to start and the previous result
+ * to continue, so rt_crc32c(rt_crc32c(0, a, n), b, m) is the CRC of a then b.
+ * rt_crc32c_combine() joins CRCs computed separately, which is how the
+ * parallel versions split a large buffer across threads. */
+#define RT_CRC32C_CHUNK 0x800000 // per round when streaming files
+#define RT_CRC32C_TASK_MIN 0x100000 // bytes worth handing to another thread
+
+uint32_t rt_crc32c(uint32_t crc, const void *data, size_t size);
+
+/* The CRC of a followed by b, from their CRCs and b's size */
+uint32_t rt_crc32c_combine(uint32_t crc_a, uint32_t crc_b, uint64_t size_b);
+
+uint32_t rt_crc32c_parallel(uint32_t crc, const void *data, size_t size);
+uint32_t rt_fbuffer_crc32c(const RT_FileBuffer *buffer);
+
+/* Content hash
+ * A fast non-cryptographic 64/128-bit hash for deduplication and change
+ * detection, not for hash tables keyed by attacker input. Eight 64-bit lanes
+ * take a 64-byte stripe per step with a 32x32->64 multiply each (AVX2/SSE2,
+ * same results in scalar code), and lanes are scrambled every 1 KiB block.
+ * The one-shot and streaming forms give the same result for the same bytes. */
+#define RT_HASH_STRIPE 64
+#define RT_HASH_BLOCK 1024
+
+typedef struct _RT_Hash128 {
+    uint64_t lo;
+    uint64_t hi;
+} RT_Hash128;
+
+typedef struct _RT_HashState {
+    uint64_t acc[8];
+    uint64_t length;
+    size_t buffered;
+    uint8_t buffer[RT_HASH_BLOCK];
+} RT_HashState;
+
+uint64_t rt_hash64(const void *data, size_t size, uint64_t seed);
+RT_Hash128 rt_hash128(const void *data, size_t size, uint64_t seed);
+
+void rt_hash_init(RT_HashState *state, uint64_t seed);
+void rt_hash_update(RT_HashState *state, const void *data, size_t size);
+uint64_t rt_hash_final64(const RT_HashState *state);
+RT_Hash128 rt_hash_final128(const RT_HashState *state);
+
+#endif // _INC_RT_HASH
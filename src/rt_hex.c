@@ -0,0 +1,237 @@
+#include "rt_hex.h"
+#include "rt_simd.h"
+
+static const char rt__hex_upper[] = "0123456789ABCDEF";
+static const char rt__hex_lower[] = "0123456789abcdef";
+
+/* Hex dump formatting */
+static inline char *rt__hexdump_offset(char *out, uint64_t offset)
+{
+    unsigned digits = 8;
+    while (digits < 16 && (offset >> (digits * 4))) digits++;
+
+    for (unsigned i = digits; i--; offset >>= 4) out[i] = rt__hex_lower[offset & 0xF];
+    memcpy(out + digits, " | ", 3);
+    return out + digits + 3;
+}
+
+static char *rt__hexdump_row(char *out, const uint8_t *row, size_t n)
+{
+    for (size_t j = 0; j < n; ++j, out += 3) {
+        out[0] = rt__hex_upper[row[j] >> 4];
+        out[1] = rt__hex_upper[row[j] & 0xF];
+        out[2] = ' ';
+    }
+    memset(out, ' ', (RT_HEXDUMP_ROW - n) * 3);
+    out += (RT_HEXDUMP_ROW - n) * 3;
+
+    *out++ = '|';
+    *out++ = ' ';
+    for (size_t j = 0; j < n; ++j) *out++ = (row[j] >= 0x20 && row[j] <= 0x7E) ? (char)row[j] : '.';
+    *out++ = '\n';
+    return out;
+}
+
+#ifdef RT_SIMD_X86
+// the 48 "XX " bytes are three stores, each gathered from the digit pairs of bytes 0-7 (a) and 8-15 (b)
+RT_TARGET_SSE42 static char *rt__hexdump_row_sse(char *out, const uint8_t *row)
+{
+    const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                         '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i v = _mm_loadu_si128((const __m128i*)row);
+    const __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+    const __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, nibble));
+    const __m128i a = _mm_unpacklo_epi8(hi, lo);
+    const __m128i b = _mm_unpackhi_epi8(hi, lo);
+
+    const __m128i s0 = _mm_shuffle_epi8(a, _mm_setr_epi8(0, 1, -128, 2, 3, -128, 4, 5, -128, 6, 7, -128, 8, 9, -128, 10));
+    const __m128i s1 = _mm_or_si128(
+        _mm_shuffle_epi8(a, _mm_setr_epi8(11, -128, 12, 13, -128, 14, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+        _mm_shuffle_epi8(b, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, 0, 1, -128, 2, 3, -128, 4, 5)));
+    const __m128i s2 = _mm_shuffle_epi8(b, _mm_setr_epi8(-128, 6, 7, -128, 8, 9, -128, 10, 11, -128, 12, 13, -128, 14, 15, -128));
+
+    const char sp = ' ';
+    _mm_storeu_si128((__m128i*)out, _mm_or_si128(s0, _mm_setr_epi8(0, 0, sp, 0, 0, sp, 0, 0, sp, 0, 0, sp, 0, 0, sp, 0)));
+    _mm_storeu_si128((__m128i*)(out + 16), _mm_or_si128(s1, _mm_setr_epi8(0, sp, 0, 0, sp, 0, 0, sp, 0, 0, sp, 0, 0, sp, 0, 0)));
+    _mm_storeu_si128((__m128i*)(out + 32), _mm_or_si128(s2, _mm_setr_epi8(sp, 0, 0, sp, 0, 0, sp, 0, 0, sp, 0, 0, sp, 0, 0, sp)));
+    out[48] = '|';
+    out[49] = ' ';
+
+    // signed compares: bytes from 0x80 up are negative and fail the first one
+    const __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x1F)),
+                                            _mm_cmplt_epi8(v, _mm_set1_epi8(0x7F)));
+    const __m128i ascii = _mm_or_si128(_mm_and_si128(printable, v),
+                                       _mm_andnot_si128(printable, _mm_set1_epi8('.')));
+    _mm_storeu_si128((__m128i*)(out + 50), ascii);
+    out[66] = '\n';
+    return out + 67;
+}
+#endif // RT_SIMD_X86
+
+size_t rt_hexdump_format(char *out, const uint8_t *data, size_t size, uint64_t offset)
+{
+    if (!out || (!data && size)) return 0;
+
+    char *p = out;
+    size_t i = 0;
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_SSE42)) {
+        for (; i + RT_HEXDUMP_ROW <= size; i += RT_HEXDUMP_ROW) {
+            p = rt__hexdump_offset(p, offset + i);
+            p = rt__hexdump_row_sse(p, data + i);
+        }
+    }
+#endif // RT_SIMD_X86
+    for (; i < size; i += RT_HEXDUMP_ROW) {
+        p = rt__hexdump_offset(p, offset + i);
+        p = rt__hexdump_row(p, data + i, size - i < RT_HEXDUMP_ROW ? size - i : RT_HEXDUMP_ROW);
+    }
+
+    return (size_t)(p - out);
+}
+
+/* Hex dump parsing */
+static inline int rt__hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// hex digits at the start of a line, 8 to 16 of them followed by " | "
+static size_t rt__hexdump_parse_offset(const char *line, size_t length, uint64_t *offset)
+{
+    uint64_t value = 0;
+    size_t p = 0;
+    for (int v; p < length && p < 16 && (v = rt__hex_value(line[p])) >= 0; ++p) value = value << 4 | (uint64_t)v;
+
+    if (p < 8 || length < p + 3 || memcmp(line + p, " | ", 3) != 0) return 0;
+    *offset = value;
+    return p + 3;
+}
+
+bool rt_hexdump_line_offset(const char *line, size_t length, uint64_t *offset)
+{
+    return line && offset && rt__hexdump_parse_offset(line, length, offset) != 0;
+}
+
+// the 48-char hex field and the "| " after it, returns the bytes in the row or -1
+static int rt__hexdump_parse_row(const char *hex, uint8_t *row)
+{
+    int n = 0;
+    for (; n < RT_HEXDUMP_ROW; ++n) {
+        const char *pair = hex + n * 3;
+        const int hi = rt__hex_value(pair[0]);
+        const int lo = rt__hex_value(pair[1]);
+        if (hi < 0 || lo < 0 || pair[2] != ' ') break;
+        row[n] = (uint8_t)(hi << 4 | lo);
+    }
+    for (int j = n; j < RT_HEXDUMP_ROW; ++j) {
+        if (memcmp(hex + j * 3, "   ", 3) != 0) return -1;
+    }
+
+    return (n > 0 && hex[48] == '|' && hex[49] == ' ') ? n : -1;
+}
+
+#ifdef RT_SIMD_X86
+RT_TARGET_SSE42 static inline __m128i rt__hex_nibbles_sse(__m128i c, int *valid)
+{
+    const __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    // unsigned x <= limit as min(x, limit) == x
+    const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+    *valid &= _mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) == 0xFFFF;
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+// full rows only: inverts the shuffles of rt__hexdump_row_sse
+RT_TARGET_SSE42 static bool rt__hexdump_parse_row_sse(const char *hex, uint8_t *row)
+{
+    const __m128i s0 = _mm_loadu_si128((const __m128i*)hex);
+    const __m128i s1 = _mm_loadu_si128((const __m128i*)(hex + 16));
+    const __m128i s2 = _mm_loadu_si128((const __m128i*)(hex + 32));
+
+    const __m128i blank = _mm_set1_epi8(' ');
+    const int separators =
+        (_mm_movemask_epi8(_mm_cmpeq_epi8(s0, blank)) & 0x4924) == 0x4924 &&
+        (_mm_movemask_epi8(_mm_cmpeq_epi8(s1, blank)) & 0x2492) == 0x2492 &&
+        (_mm_movemask_epi8(_mm_cmpeq_epi8(s2, blank)) & 0x9249) == 0x9249;
+    if (!separators || hex[48] != '|' || hex[49] != ' ') return false;
+
+    const __m128i a = _mm_or_si128(
+        _mm_shuffle_epi8(s0, _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, 12, 13, 15, -128, -128, -128, -128, -128)),
+        _mm_shuffle_epi8(s1, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 0, 2, 3, 5, 6)));
+    const __m128i b = _mm_or_si128(
+        _mm_shuffle_epi8(s1, _mm_setr_epi8(8, 9, 11, 12, 14, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+        _mm_shuffle_epi8(s2, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, 1, 2, 4, 5, 7, 8, 10, 11, 13, 14)));
+
+    int valid = 1;
+    const __m128i na = rt__hex_nibbles_sse(a, &valid);
+    const __m128i nb = rt__hex_nibbles_sse(b, &valid);
+    if (!valid) return false;
+
+    // (high nibble * 16 + low nibble) per pair, then narrowed back to bytes
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(na, weights), _mm_maddubs_epi16(nb, weights));
+    _mm_storeu_si128((__m128i*)row, bytes);
+    return true;
+}
+#endif // RT_SIMD_X86
+
+bool rt_hexdump_parse(RT_HexdumpParse *state, uint8_t *out, size_t capacity, const char *text, size_t length)
+{
+    if (!state || (!out && capacity) || (!text && length)) return false;
+
+#ifdef RT_SIMD_X86
+    const bool sse = rt__cpu_has(RT_CPU_SSE42);
+#endif // RT_SIMD_X86
+    size_t pos = 0, written = 0;
+    bool ok = true;
+
+    while (pos < length) {
+        const char *line = text + pos;
+        const char *eol = memchr(line, '\n', length - pos);
+        if (!eol) break; // the rest comes with the next call
+
+        size_t len = (size_t)(eol - line);
+        if (len && line[len - 1] == '\r') len--;
+        if (len == 0) {
+            pos += (size_t)(eol - line) + 1;
+            continue;
+        }
+
+        uint64_t offset;
+        const size_t head = rt__hexdump_parse_offset(line, len, &offset);
+        if (!head || offset != state->offset || state->done || len < head + 50) {
+            ok = false;
+            break;
+        }
+
+        uint8_t row[RT_HEXDUMP_ROW];
+        uint8_t *dst = capacity - written >= RT_HEXDUMP_ROW ? out + written : row;
+        int n = -1;
+#ifdef RT_SIMD_X86
+        if (sse && rt__hexdump_parse_row_sse(line + head, dst)) n = RT_HEXDUMP_ROW;
+#endif // RT_SIMD_X86
+        if (n < 0) n = rt__hexdump_parse_row(line + head, dst);
+        if (n < 0 || capacity - written < (size_t)n) {
+            ok = false;
+            break;
+        }
+
+        if (dst == row) memcpy(out + written, row, (size_t)n);
+        written += (size_t)n;
+        state->offset += (uint64_t)n;
+        state->done = n < RT_HEXDUMP_ROW;
+        pos += (size_t)(eol - line) + 1;
+    }
+
+    state->consumed = pos;
+    state->written = written;
+    return ok;
+}
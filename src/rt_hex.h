@@ -0,0 +1,64 @@
+#ifndef _INC_RT_HEX
+#define _INC_RT_HEX
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+
+/* Hex dump formatting
+ * The format rt_file_hexdump writes, one line per 16 bytes:
+ *   00000010 | 48 65 6C 6C 6F 2C 20 77 6F 72 6C 64 21 0A 00 FF | Hello, world!...
+ * a lowercase offset of at least 8 digits, the bytes in uppercase hex (the
+ * last line padded with spaces) and their printable ASCII, '.' otherwise.
+ * A line only depends on its bytes and offset, so a dump can be cut into
+ * row-aligned pieces and formatted in any order or in parallel. Full rows
+ * are converted 16 bytes at a time with SSSE3 shuffles where available. */
+#define RT_HEXDUMP_ROW 16
+#define RT_HEXDUMP_LINE 78 // full row with an 8-digit offset
+#define RT_HEXDUMP_LINE_MAX (RT_HEXDUMP_LINE + 8) // 16-digit offset
+#define RT_HEXDUMP_CHUNK 0x400000 // input read and formatted per round by rt_file_hexdump
+#define RT_HEXDUMP_TASK_MIN 0x10000 // input bytes worth handing to another thread
+
+static inline size_t rt_hexdump_bound(size_t size)
+{
+    return (size + RT_HEXDUMP_ROW - 1) / RT_HEXDUMP_ROW * RT_HEXDUMP_LINE_MAX;
+}
+
+/* Formats `size` bytes found at `offset` of the input into `out`, which must
+ * hold rt_hexdump_bound(size) bytes. Returns the text length. */
+size_t rt_hexdump_format(char *out, const uint8_t *data, size_t size, uint64_t offset);
+
+/* Hex dump parsing
+ * Turns rt_hexdump_format text back into bytes, for patching workflows that
+ * edit a dump and convert it back. Lines must follow each other: the first
+ * at state->offset, each next one 16 bytes later, and only the last may hold
+ * fewer than 16 bytes. The ASCII column is ignored, so edits to the hex
+ * field alone are enough; blank lines are skipped and "\r\n" is accepted.
+ * Full rows with 8-digit offsets are decoded 16 bytes at a time with SSSE3.
+ *
+ * Text can come in pieces: a call stops before an incomplete last line and
+ * leaves it to the next one, and the state carries the expected offset. */
+#define RT_HEXDUMP_LINE_MIN 62 // full hex field, one ASCII char and '\n'
+
+typedef struct _RT_HexdumpParse {
+    uint64_t offset;  // of the next line, advanced as rows are parsed
+    size_t consumed;  // text used by the last call, whole lines only
+    size_t written;   // bytes stored by the last call
+    bool done;        // a short row was parsed, no row may follow
+} RT_HexdumpParse;
+
+static inline size_t rt_hexdump_parse_bound(size_t length)
+{
+    return (length / RT_HEXDUMP_LINE_MIN + 1) * RT_HEXDUMP_ROW;
+}
+
+/* Parses the complete lines of `text` into `out`, which has room for
+ * `capacity` bytes. Returns false at the first malformed line, one out of
+ * sequence or one that does not fit; state->consumed then points at it. */
+bool rt_hexdump_parse(RT_HexdumpParse *state, uint8_t *out, size_t capacity, const char *text, size_t length);
+
+/* The offset a dump line starts with. */
+bool rt_hexdump_line_offset(const char *line, size_t length, uint64_t *offset);
+
+#endif // _INC_RT_HEX
@@ -0,0 +1,456 @@
+#include "rt_lz.h"
+#include "rt_hash.h"
+#include "rt_simd.h"
+#include "rt_thread.h"
+
+#define RT__LZ_MIN_MATCH 4
+#define RT__LZ_LAST_LITERALS 5 // the format ends on at least this many literals
+#define RT__LZ_MF_LIMIT 12     // and no match starts closer than this to the end
+#define RT__LZ_MAX_OFFSET 65535
+#define RT__LZ_HASH_LOG 12
+#define RT__LZ_SKIP_TRIGGER 6  // misses before the search step grows
+
+static inline uint32_t rt__lz_load32(const uint8_t *p)
+{
+    uint32_t x;
+    memcpy(&x, p, 4);
+    return x;
+}
+
+static inline uint64_t rt__lz_load64(const uint8_t *p)
+{
+    uint64_t x;
+    memcpy(&x, p, 8);
+    return x;
+}
+
+static inline void rt__lz_store32(uint8_t *p, uint32_t x)
+{
+    p[0] = (uint8_t)x;
+    p[1] = (uint8_t)(x >> 8);
+    p[2] = (uint8_t)(x >> 16);
+    p[3] = (uint8_t)(x >> 24);
+}
+
+static inline uint32_t rt__lz_read32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint32_t rt__lz_hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - RT__LZ_HASH_LOG);
+}
+
+// bytes equal at p and match, up to limit
+static inline size_t rt__lz_count(const uint8_t *p, const uint8_t *match, const uint8_t *limit)
+{
+    const uint8_t *start = p;
+    while (p + 8 <= limit) {
+        const uint64_t diff = rt__lz_load64(p) ^ rt__lz_load64(match);
+        if (diff) return (size_t)(p - start) + rt__ctz64(diff) / 8;
+        p += 8;
+        match += 8;
+    }
+    while (p < limit && *p == *match) {
+        p++;
+        match++;
+    }
+    return (size_t)(p - start);
+}
+
+static inline uint8_t *rt__lz_put_length(uint8_t *op, size_t length)
+{
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+/* Block format */
+size_t rt_lz_compress(const void *src, size_t size, void *dst, size_t capacity)
+{
+    if (!src || !dst || size > UINT32_MAX) return 0; // positions are kept as u32
+
+    const uint8_t *const in = src;
+    const uint8_t *const end = in + size;
+    const uint8_t *ip = in, *anchor = in;
+    uint8_t *op = dst;
+    uint8_t *const oend = op + capacity;
+
+    uint32_t table[1 << RT__LZ_HASH_LOG];
+    memset(table, 0, sizeof(table));
+
+    if (size > RT__LZ_MF_LIMIT) {
+        const uint8_t *const limit = end - RT__LZ_MF_LIMIT;
+        const uint8_t *const match_limit = end - RT__LZ_LAST_LITERALS;
+        unsigned misses = 0;
+        ip++;
+
+        while (ip < limit) {
+            const uint32_t sequence = rt__lz_load32(ip);
+            const uint32_t h = rt__lz_hash(sequence);
+            const uint8_t *match = in + table[h];
+            table[h] = (uint32_t)(ip - in);
+            if (match >= ip || ip - match > RT__LZ_MAX_OFFSET || rt__lz_load32(match) != sequence) {
+                ip += 1 + (misses++ >> RT__LZ_SKIP_TRIGGER);
+                continue;
+            }
+            misses = 0;
+
+            while (ip > anchor && match > in && ip[-1] == match[-1]) {
+                ip--;
+                match--;
+            }
+            const size_t length = RT__LZ_MIN_MATCH +
+                rt__lz_count(ip + RT__LZ_MIN_MATCH, match + RT__LZ_MIN_MATCH, match_limit);
+            const size_t literals = (size_t)(ip - anchor);
+
+            // token, literal run, literals, offset and match run
+            if ((size_t)(oend - op) < 1 + literals / 255 + 1 + literals + 2 + length / 255 + 1) return 0;
+            uint8_t *token = op++;
+            if (literals >= 15) {
+                *token = 15 << 4;
+                op = rt__lz_put_length(op, literals - 15);
+            } else {
+                *token = (uint8_t)(literals << 4);
+            }
+            memcpy(op, anchor, literals);
+            op += literals;
+
+            const size_t offset = (size_t)(ip - match);
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            const size_t extra = length - RT__LZ_MIN_MATCH;
+            if (extra >= 15) {
+                *token |= 15;
+                op = rt__lz_put_length(op, extra - 15);
+            } else {
+                *token |= (uint8_t)extra;
+            }
+
+            ip += length;
+            anchor = ip;
+            if (ip < limit) table[rt__lz_hash(rt__lz_load32(ip - 2))] = (uint32_t)(ip - 2 - in);
+        }
+    }
+
+    const size_t literals = (size_t)(end - anchor);
+    if ((size_t)(oend - op) < 1 + literals / 255 + 1 + literals) return 0;
+    if (literals >= 15) {
+        *op++ = 15 << 4;
+        op = rt__lz_put_length(op, literals - 15);
+    } else {
+        *op++ = (uint8_t)(literals << 4);
+    }
+    memcpy(op, anchor, literals);
+    op += literals;
+
+    return (size_t)(op - (uint8_t*)dst);
+}
+
+// a length nibble of 15 continues in the following bytes
+static inline bool rt__lz_get_length(const uint8_t **ip, const uint8_t *iend, size_t *length)
+{
+    if (*length != 15) return true;
+    uint8_t b;
+    do {
+        if (*ip >= iend) return false;
+        b = *(*ip)++;
+        *length += b;
+    } while (b == 255);
+    return true;
+}
+
+bool rt_lz_decompress(const void *src, size_t size, void *dst, size_t raw_size)
+{
+    if (!src || (!dst && raw_size)) return false;
+
+    const uint8_t *ip = src;
+    const uint8_t *const iend = ip + size;
+    uint8_t *op = dst;
+    uint8_t *const ostart = op;
+    uint8_t *const oend = op + raw_size;
+
+    while (ip < iend) {
+        const uint8_t token = *ip++;
+
+        // short sequences far from both ends: fixed-size copies, no length bytes
+        if (token >> 4 < 15 && (token & 15) < 15 && iend - ip >= 18 && oend - op >= 40) {
+            const size_t lit = token >> 4;
+            memcpy(op, ip, 16);
+            const size_t offset = ip[lit] | (size_t)ip[lit + 1] << 8;
+            if (offset >= 8 && offset <= (size_t)(op - ostart) + lit) {
+                op += lit;
+                ip += lit + 2;
+                const uint8_t *match = op - offset;
+                memcpy(op, match, 8);
+                memcpy(op + 8, match + 8, 8);
+                memcpy(op + 16, match + 16, 8);
+                op += (token & 15) + RT__LZ_MIN_MATCH;
+                continue;
+            }
+        }
+
+        size_t literals = token >> 4;
+        if (!rt__lz_get_length(&ip, iend, &literals)) return false;
+        if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op)) return false;
+        if ((size_t)(iend - ip) >= literals + 16 && (size_t)(oend - op) >= literals + 16) {
+            // fixed 16-byte steps, the overshoot is rewritten later
+            for (size_t i = 0; i < literals; i += 16) memcpy(op + i, ip + i, 16);
+        } else {
+            memcpy(op, ip, literals);
+        }
+        op += literals;
+        ip += literals;
+        if (ip == iend) break; // the last sequence has no match
+
+        if (iend - ip < 2) return false;
+        const size_t offset = ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - ostart)) return false;
+
+        size_t length = token & 15;
+        if (!rt__lz_get_length(&ip, iend, &length)) return false;
+        length += RT__LZ_MIN_MATCH;
+        if (length > (size_t)(oend - op)) return false;
+
+        const uint8_t *match = op - offset;
+        if (offset >= 16 && (size_t)(oend - op) >= length + 16) {
+            // steps no longer than the offset never read what they write
+            uint8_t *const stop = op + length;
+            for (uint8_t *p = op; p < stop; p += 16, match += 16) memcpy(p, match, 16);
+            op = stop;
+        } else if (offset >= 8 && (size_t)(oend - op) >= length + 8) {
+            uint8_t *const stop = op + length;
+            for (uint8_t *p = op; p < stop; p += 8, match += 8) memcpy(p, match, 8);
+            op = stop;
+        } else {
+            // the bytes copied so far repeat with the offset's period, so the
+            // run that can be copied from `match` at once doubles every step
+            for (size_t run = offset; length > 0; run *= 2) {
+                const size_t step = run < length ? run : length;
+                memcpy(op, match, step);
+                op += step;
+                length -= step;
+            }
+        }
+    }
+
+    return op == oend;
+}
+
+/* Frames */
+void rt_lz_frame_header(uint8_t out[RT_LZ_HEADER_SIZE], size_t block_size)
+{
+    uint8_t log = 0;
+    while (((size_t)1 << log) < block_size) log++;
+
+    rt__lz_store32(out, RT_LZ_MAGIC);
+    out[4] = RT_LZ_VERSION;
+    out[5] = log;
+    out[6] = out[7] = 0;
+}
+
+void rt_lz_frame_end(uint8_t out[RT_LZ_END_SIZE])
+{
+    rt__lz_store32(out, 0);
+}
+
+typedef struct _RT__LzBlock {
+    const uint8_t *src;   // raw data when packing, the stored data when unpacking
+    uint8_t *dst;         // the block record when packing, raw data when unpacking
+    uint32_t raw_size;
+    uint32_t stored;      // stored size and RT_LZ_STORED
+    uint32_t crc;
+} RT__LzBlock;
+
+typedef struct _RT__LzTask {
+    RT__LzBlock *blocks;
+    size_t count;
+    bool ok;
+} RT__LzTask;
+
+static DWORD rt__lz_pack_worker(void *param)
+{
+    RT__LzTask *task = param;
+    for (size_t i = 0; i < task->count; ++i) {
+        RT__LzBlock *block = &task->blocks[i];
+        uint8_t *data = block->dst + RT_LZ_BLOCK_HEADER_SIZE;
+
+        // anything not smaller than the input goes in as is
+        size_t size = rt_lz_compress(block->src, block->raw_size, data, block->raw_size - 1);
+        block->stored = (uint32_t)size;
+        if (size == 0) {
+            memcpy(data, block->src, block->raw_size);
+            block->stored = block->raw_size | RT_LZ_STORED;
+        }
+        block->crc = rt_crc32c(0, block->src, block->raw_size);
+
+        rt__lz_store32(block->dst, block->raw_size);
+        rt__lz_store32(block->dst + 4, block->stored);
+        rt__lz_store32(block->dst + 8, block->crc);
+    }
+    task->ok = true;
+    return 0;
+}
+
+static DWORD rt__lz_unpack_worker(void *param)
+{
+    RT__LzTask *task = param;
+    task->ok = true;
+    for (size_t i = 0; i < task->count && task->ok; ++i) {
+        const RT__LzBlock *block = &task->blocks[i];
+        const size_t size = block->stored & ~RT_LZ_STORED;
+        if (block->stored & RT_LZ_STORED) {
+            task->ok = size == block->raw_size;
+            if (task->ok) memcpy(block->dst, block->src, size);
+        } else {
+            task->ok = rt_lz_decompress(block->src, size, block->dst, block->raw_size);
+        }
+        task->ok = task->ok && rt_crc32c(0, block->dst, block->raw_size) == block->crc;
+    }
+    return 0;
+}
+
+// hands each thread a run of neighbouring blocks
+static bool rt__lz_run(RT__LzBlock *blocks, size_t count, DWORD (*worker)(void *param))
+{
+    size_t workers = rt_thread_cpu_count();
+    if (workers > RT_THREAD_MAX_TASKS) workers = RT_THREAD_MAX_TASKS;
+    if (workers > count) workers = count;
+    if (workers == 0) return true;
+
+    RT__LzTask *tasks = RT_MALLOC(workers * sizeof(RT__LzTask));
+    if (!tasks) return false;
+
+    for (size_t t = 0, from = 0; t < workers; ++t) {
+        const size_t to = count * (t + 1) / workers;
+        tasks[t] = (RT__LzTask){ blocks + from, to - from, false };
+        from = to;
+    }
+    if (workers == 1) worker(tasks);
+    else rt_thread_run_tasks(tasks, sizeof(RT__LzTask), workers, worker);
+
+    bool ok = true;
+    for (size_t t = 0; t < workers; ++t) ok = ok && tasks[t].ok;
+    RT_FREE(tasks);
+    return ok;
+}
+
+size_t rt_lz_frame_blocks(uint8_t *out, const void *data, size_t size, size_t block_size)
+{
+    if (!out || !data || size == 0) return 0;
+    if (block_size == 0 || block_size > RT_LZ_BLOCK_MAX) block_size = RT_LZ_BLOCK_SIZE;
+
+    const size_t count = (size + block_size - 1) / block_size;
+    RT__LzBlock *blocks = RT_MALLOC(count * sizeof(RT__LzBlock));
+    if (!blocks) return 0;
+
+    // every block gets a worst-case slot, then they are packed together in order
+    const uint8_t *src = data;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t from = i * block_size;
+        blocks[i] = (RT__LzBlock){ src + from, out + from + i * RT_LZ_BLOCK_HEADER_SIZE,
+                                   (uint32_t)(size - from < block_size ? size - from : block_size), 0, 0 };
+    }
+
+    size_t length = 0;
+    if (rt__lz_run(blocks, count, rt__lz_pack_worker)) {
+        for (size_t i = 0; i < count; ++i) {
+            const size_t record = RT_LZ_BLOCK_HEADER_SIZE + (blocks[i].stored & ~RT_LZ_STORED);
+            memmove(out + length, blocks[i].dst, record);
+            length += record;
+        }
+    }
+
+    RT_FREE(blocks);
+    return length;
+}
+
+bool rt_lz_frame_compress(RT_FileBuffer *out, const void *data, size_t size)
+{
+    if (!out || (!data && size)) return false;
+    if (!rt_fbuffer_reserve(out, rt_lz_frame_bound(size))) return false;
+
+    rt_lz_frame_header(out->data, RT_LZ_BLOCK_SIZE);
+    size_t length = RT_LZ_HEADER_SIZE;
+    if (size > 0) {
+        const size_t blocks = rt_lz_frame_blocks(out->data + length, data, size, RT_LZ_BLOCK_SIZE);
+        if (blocks == 0) return false;
+        length += blocks;
+    }
+    rt_lz_frame_end(out->data + length);
+    out->size = length + RT_LZ_END_SIZE;
+    return true;
+}
+
+bool rt_lz_frame_decompress(RT_FileBuffer *out, const void *frame, size_t size)
+{
+    if (!out || !rt_lz_is_frame(frame, size)) return false;
+
+    const uint8_t *p = frame;
+    const uint8_t *const end = p + size;
+    if (p[4] != RT_LZ_VERSION) return false;
+    p += RT_LZ_HEADER_SIZE;
+
+    // walk the block records first: they give the output size and where
+    // every block lands, so all of them can be unpacked at once
+    RT__LzBlock *blocks = NULL;
+    size_t count = 0, capacity = 0;
+    uint64_t total = 0;
+    bool ok = false;
+
+    for (;;) {
+        if (end - p < RT_LZ_END_SIZE) goto done;
+        const uint32_t raw_size = rt__lz_read32(p);
+        if (raw_size == 0) {
+            ok = p + RT_LZ_END_SIZE == end;
+            break;
+        }
+        if (end - p < RT_LZ_BLOCK_HEADER_SIZE || raw_size > RT_LZ_BLOCK_MAX) goto done;
+
+        const uint32_t stored = rt__lz_read32(p + 4);
+        const size_t stored_size = stored & ~RT_LZ_STORED;
+        if (stored_size > (size_t)(end - p) - RT_LZ_BLOCK_HEADER_SIZE) goto done;
+
+        // sizes no block could decode to are refused before they are reserved:
+        // a length byte adds at most 255 output bytes
+        if (stored & RT_LZ_STORED ? raw_size != stored_size : raw_size > (uint64_t)stored_size * 255 + 16) goto done;
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            RT__LzBlock *grown = RT_REALLOC(blocks, capacity * sizeof(RT__LzBlock));
+            if (!grown) goto done;
+            blocks = grown;
+        }
+        // dst holds the output offset until the buffer is sized
+        blocks[count++] = (RT__LzBlock){ p + RT_LZ_BLOCK_HEADER_SIZE, (uint8_t*)(uintptr_t)total,
+                                         raw_size, stored, rt__lz_read32(p + 8) };
+        total += raw_size;
+        p += RT_LZ_BLOCK_HEADER_SIZE + stored_size;
+    }
+
+    ok = ok && total <= SIZE_MAX;
+    if (ok && total > 0) ok = rt_fbuffer_reserve(out, (size_t)total);
+    if (ok) {
+        for (size_t i = 0; i < count; ++i) blocks[i].dst = out->data + (uintptr_t)blocks[i].dst;
+        ok = rt__lz_run(blocks, count, rt__lz_unpack_worker);
+    }
+    if (ok) out->size = (size_t)total;
+
+    done:
+        RT_FREE(blocks);
+        return ok;
+}
+
+bool rt_fbuffer_compress(RT_FileBuffer *dst, const RT_FileBuffer *src)
+{
+    if (!dst || !src || dst == src) return false;
+    return rt_lz_frame_compress(dst, src->data, src->size);
+}
+
+bool rt_fbuffer_decompress(RT_FileBuffer *dst, const RT_FileBuffer *src)
+{
+    if (!dst || !src || dst == src) return false;
+    return rt_lz_frame_decompress(dst, src->data, src->size);
+}
@@ -0,0 +1,78 @@
+#ifndef _INC_RT_LZ
+#define _INC_RT_LZ
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+
+/* LZ block compression
+ * Byte-oriented LZ77 in the LZ4 block format: a token with 4-bit literal
+ * and match lengths (extended by 255-runs), the literals, then a 16-bit
+ * offset into the last 64 KiB. Greedy matching over a hash of 4-byte
+ * sequences, skipping faster through data that does not compress.
+ * Decompression checks every length and offset against both buffers, so
+ * corrupt input fails instead of reading or writing out of bounds. */
+static inline size_t rt_lz_bound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+/* Returns the compressed size, 0 if it does not fit in `capacity` */
+size_t rt_lz_compress(const void *src, size_t size, void *dst, size_t capacity);
+
+/* Succeeds only if `src` decodes to exactly raw_size bytes */
+bool rt_lz_decompress(const void *src, size_t size, void *dst, size_t raw_size);
+
+/* Frames
+ * A stream of independently compressed blocks, so both directions split
+ * across threads block by block:
+ *   header  "RTLZ", version, log2 of the block size, 2 reserved bytes
+ *   block   raw size, stored size (top bit: stored uncompressed), CRC32C of
+ *           the raw bytes, then the data; all u32 little-endian
+ *   end     a raw size of 0
+ * Blocks that do not shrink are stored as they are. Frames can be written
+ * piece by piece: a header, any number of rt_lz_frame_blocks() calls, then
+ * the end mark, which is what RT_FWRITER_COMPRESS does. */
+#define RT_LZ_MAGIC 0x5A4C5452u // "RTLZ"
+#define RT_LZ_VERSION 1
+#define RT_LZ_HEADER_SIZE 8
+#define RT_LZ_BLOCK_HEADER_SIZE 12
+#define RT_LZ_END_SIZE 4
+#define RT_LZ_BLOCK_SIZE 0x40000 // 256kb
+#define RT_LZ_BLOCK_MAX 0x1000000
+#define RT_LZ_STORED 0x80000000u
+
+static inline size_t rt_lz_frame_blocks_bound(size_t size, size_t block_size)
+{
+    const size_t blocks = (size + block_size - 1) / block_size;
+    return size + blocks * RT_LZ_BLOCK_HEADER_SIZE;
+}
+
+static inline size_t rt_lz_frame_bound(size_t size)
+{
+    return RT_LZ_HEADER_SIZE + rt_lz_frame_blocks_bound(size, RT_LZ_BLOCK_SIZE) + RT_LZ_END_SIZE;
+}
+
+static inline bool rt_lz_is_frame(const void *data, size_t size)
+{
+    const uint8_t *p = data;
+    return p && size >= RT_LZ_HEADER_SIZE + RT_LZ_END_SIZE &&
+           (p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24) == RT_LZ_MAGIC;
+}
+
+void rt_lz_frame_header(uint8_t out[RT_LZ_HEADER_SIZE], size_t block_size);
+void rt_lz_frame_end(uint8_t out[RT_LZ_END_SIZE]);
+
+/* Compresses `size` bytes as blocks of block_size, in parallel, into `out`,
+ * which must hold rt_lz_frame_blocks_bound(size, block_size). Returns the
+ * bytes written. */
+size_t rt_lz_frame_blocks(uint8_t *out, const void *data, size_t size, size_t block_size);
+
+bool rt_lz_frame_compress(RT_FileBuffer *out, const void *data, size_t size);
+bool rt_lz_frame_decompress(RT_FileBuffer *out, const void *frame, size_t size);
+
+bool rt_fbuffer_compress(RT_FileBuffer *dst, const RT_FileBuffer *src);
+bool rt_fbuffer_decompress(RT_FileBuffer *dst, const RT_FileBuffer *src);
+
+#endif // _INC_RT_LZ
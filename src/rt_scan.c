@@ -0,0 +1,399 @@
+#include "rt_scan.h"
+#include "rt_simd.h"
+#include "rt_thread.h"
+
+bool rt_scanner_init(RT_Scanner *scanner)
+{
+    if (!scanner) return false;
+    memset(scanner, 0, sizeof(*scanner));
+    return true;
+}
+
+void rt_scanner_free(RT_Scanner *scanner)
+{
+    if (!scanner) return;
+    for (size_t i = 0; i < scanner->count; ++i) RT_FREE(scanner->patterns[i].bytes);
+    RT_FREE(scanner->patterns);
+    memset(scanner, 0, sizeof(*scanner));
+}
+
+/* Signatures */
+static inline int rt__scan_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return c == '?' ? 16 : -1;
+}
+
+// marks the bucket in the nibble tables for every byte the pattern accepts at `index`
+static void rt__scan_bucket(RT_Scanner *scanner, int table, const RT_ScanPattern *pattern, size_t index, uint8_t bit)
+{
+    const uint8_t mask = index < pattern->size ? pattern->mask[index] : 0;
+    const uint8_t value = index < pattern->size ? pattern->bytes[index] : 0;
+    for (int n = 0; n < 16; ++n) {
+        if ((mask & 0x0F) != 0x0F || (value & 0x0F) == n) scanner->lo[table][n] |= bit;
+        if ((mask & 0xF0) != 0xF0 || (value >> 4) == n) scanner->hi[table][n] |= bit;
+    }
+}
+
+size_t rt_scanner_add_bytes(RT_Scanner *scanner, const uint8_t *bytes, const uint8_t *mask, size_t size)
+{
+    if (!scanner || !bytes || size == 0) return RT_SCAN_NONE;
+
+    RT_ScanPattern pattern = { .size = size, .anchor = RT_SCAN_NONE, .first = RT_SCAN_NONE, .last = RT_SCAN_NONE };
+    pattern.bytes = RT_MALLOC(size * 2);
+    if (!pattern.bytes) return RT_SCAN_NONE;
+    pattern.mask = pattern.bytes + size;
+
+    size_t partial = RT_SCAN_NONE;
+    for (size_t i = 0; i < size; ++i) {
+        pattern.mask[i] = mask ? mask[i] : 0xFF;
+        pattern.bytes[i] = bytes[i] & pattern.mask[i];
+    }
+    for (size_t i = 0; i < size; ++i) {
+        if (pattern.mask[i] == 0) continue;
+        if (partial == RT_SCAN_NONE) partial = i;
+        if (pattern.mask[i] != 0xFF) continue;
+        if (pattern.first == RT_SCAN_NONE) pattern.first = i;
+        pattern.last = i;
+        // the filter does best on two fixed bytes in a row
+        if (pattern.anchor == RT_SCAN_NONE && i + 1 < size && pattern.mask[i + 1] == 0xFF) pattern.anchor = i;
+    }
+    if (pattern.anchor == RT_SCAN_NONE) pattern.anchor = pattern.first != RT_SCAN_NONE ? pattern.first : partial;
+    if (pattern.anchor == RT_SCAN_NONE) goto fail; // nothing to look for
+
+    if (scanner->count == scanner->capacity) {
+        const size_t capacity = scanner->capacity ? scanner->capacity * 2 : 8;
+        RT_ScanPattern *patterns = RT_REALLOC(scanner->patterns, capacity * sizeof(RT_ScanPattern));
+        if (!patterns) goto fail;
+        scanner->patterns = patterns;
+        scanner->capacity = capacity;
+    }
+
+    const size_t id = scanner->count++;
+    const uint8_t bit = (uint8_t)(1u << (id % RT_SCAN_BUCKETS));
+    rt__scan_bucket(scanner, 0, &pattern, pattern.anchor, bit);
+    rt__scan_bucket(scanner, 1, &pattern, pattern.anchor + 1, bit);
+    scanner->patterns[id] = pattern;
+    if (size > scanner->max_size) scanner->max_size = size;
+    return id;
+
+    fail:
+        RT_FREE(pattern.bytes);
+        return RT_SCAN_NONE;
+}
+
+size_t rt_scanner_add(RT_Scanner *scanner, const char *signature)
+{
+    if (!scanner || !signature) return RT_SCAN_NONE;
+
+    const size_t length = strlen(signature);
+    uint8_t *bytes = RT_MALLOC(length * 2 + 2);
+    if (!bytes) return RT_SCAN_NONE;
+    uint8_t *mask = bytes + length + 1;
+
+    size_t size = 0, id = RT_SCAN_NONE;
+    for (const char *p = signature; *p; ) {
+        if (*p == ' ' || *p == '\t') {
+            p++;
+            continue;
+        }
+        const int hi = rt__scan_nibble(p[0]);
+        const int lo = hi >= 0 ? rt__scan_nibble(p[1]) : -1;
+        if (hi == 16 && lo < 0) { // a lone "?"
+            bytes[size] = mask[size] = 0;
+            size++;
+            p++;
+            continue;
+        }
+        if (hi < 0 || lo < 0) goto done;
+
+        bytes[size] = (uint8_t)((hi & 0xF) << 4 | (lo & 0xF));
+        mask[size] = (uint8_t)((hi == 16 ? 0 : 0xF0) | (lo == 16 ? 0 : 0x0F));
+        size++;
+        p += 2;
+    }
+    id = rt_scanner_add_bytes(scanner, bytes, mask, size);
+
+    done:
+        RT_FREE(bytes);
+        return id;
+}
+
+/* Scanning */
+typedef struct _RT__ScanTask {
+    const RT_Scanner *scanner;
+    const uint8_t *data;
+    size_t size;     // bytes that may be read
+    size_t from;     // matches reported start in [from, to)
+    size_t to;
+    uint64_t offset; // of data[0]
+    RT_ScanMatchList matches;
+    bool ok;
+} RT__ScanTask;
+
+static inline bool rt__scan_verify(const RT_ScanPattern *pattern, const uint8_t *data)
+{
+    size_t i = 0;
+    for (; i + 8 <= pattern->size; i += 8) {
+        uint64_t x, mask, value;
+        memcpy(&x, data + i, 8);
+        memcpy(&mask, pattern->mask + i, 8);
+        memcpy(&value, pattern->bytes + i, 8);
+        if ((x & mask) != value) return false;
+    }
+    for (; i < pattern->size; ++i) {
+        if ((data[i] & pattern->mask[i]) != pattern->bytes[i]) return false;
+    }
+    return true;
+}
+
+static inline void rt__scan_emit(RT__ScanTask *task, size_t id, size_t start)
+{
+    if (!RT_ScanMatchList_push(&task->matches, (RT_ScanMatch){ task->offset + start, id })) task->ok = false;
+}
+
+// single signature: the caller made sure start + size fits for starts below `end`
+static inline void rt__scan_single_check(RT__ScanTask *task, size_t start)
+{
+    if (rt__scan_verify(task->scanner->patterns, task->data + start)) rt__scan_emit(task, 0, start);
+}
+
+static void rt__scan_single_scalar(RT__ScanTask *task, size_t start, size_t end)
+{
+    const RT_ScanPattern *pattern = task->scanner->patterns;
+    const uint8_t *data = task->data + pattern->first;
+    const int first = pattern->bytes[pattern->first];
+    while (start < end) {
+        const uint8_t *hit = memchr(data + start, first, end - start);
+        if (!hit) break;
+        start = (size_t)(hit - data);
+        if (task->data[start + pattern->last] == pattern->bytes[pattern->last]) rt__scan_single_check(task, start);
+        start++;
+    }
+}
+
+// several signatures, or one without a fully fixed byte: anchor positions
+// [at, end) are tested against the bucket tables
+static inline void rt__scan_buckets_check(RT__ScanTask *task, size_t at, unsigned buckets)
+{
+    const RT_Scanner *scanner = task->scanner;
+    while (buckets) {
+        const unsigned bucket = rt__ctz32(buckets);
+        buckets &= buckets - 1;
+        for (size_t id = bucket; id < scanner->count; id += RT_SCAN_BUCKETS) {
+            const RT_ScanPattern *pattern = &scanner->patterns[id];
+            if (at < pattern->anchor) continue;
+            const size_t start = at - pattern->anchor;
+            if (start < task->from || start >= task->to || pattern->size > task->size - start) continue;
+            if (rt__scan_verify(pattern, task->data + start)) rt__scan_emit(task, id, start);
+        }
+    }
+}
+
+static void rt__scan_buckets_scalar(RT__ScanTask *task, size_t at, size_t end)
+{
+    const RT_Scanner *scanner = task->scanner;
+    for (; at < end; ++at) {
+        const uint8_t x = task->data[at];
+        unsigned buckets = scanner->lo[0][x & 0xF] & scanner->hi[0][x >> 4];
+        if (buckets && at + 1 < task->size) {
+            const uint8_t y = task->data[at + 1];
+            buckets &= scanner->lo[1][y & 0xF] & scanner->hi[1][y >> 4];
+        }
+        if (buckets) rt__scan_buckets_check(task, at, buckets);
+    }
+}
+
+#ifdef RT_SIMD_X86
+RT_TARGET_SSE2 static size_t rt__scan_single_sse2(RT__ScanTask *task, size_t start, size_t end)
+{
+    const RT_ScanPattern *pattern = task->scanner->patterns;
+    const __m128i first = _mm_set1_epi8((char)pattern->bytes[pattern->first]);
+    const __m128i last = _mm_set1_epi8((char)pattern->bytes[pattern->last]);
+    const uint8_t *p = task->data + pattern->first;
+    const uint8_t *q = task->data + pattern->last;
+    for (; start + 16 <= end; start += 16) {
+        const __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + start)), first);
+        const __m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(q + start)), last);
+        for (uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_and_si128(a, b)); m; m &= m - 1) {
+            rt__scan_single_check(task, start + rt__ctz32(m));
+        }
+    }
+    return start;
+}
+
+RT_TARGET_AVX2 static size_t rt__scan_single_avx2(RT__ScanTask *task, size_t start, size_t end)
+{
+    const RT_ScanPattern *pattern = task->scanner->patterns;
+    const __m256i first = _mm256_set1_epi8((char)pattern->bytes[pattern->first]);
+    const __m256i last = _mm256_set1_epi8((char)pattern->bytes[pattern->last]);
+    const uint8_t *p = task->data + pattern->first;
+    const uint8_t *q = task->data + pattern->last;
+    for (; start + 32 <= end; start += 32) {
+        const __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + start)), first);
+        const __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(q + start)), last);
+        for (uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(a, b)); m; m &= m - 1) {
+            rt__scan_single_check(task, start + rt__ctz32(m));
+        }
+    }
+    return start;
+}
+
+// a byte per position holding the buckets whose anchor bytes both fit
+RT_TARGET_SSE42 static inline __m128i rt__scan_buckets_sse(const RT_Scanner *scanner, __m128i x, __m128i y)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i c0 = _mm_and_si128(
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)scanner->lo[0]), _mm_and_si128(x, nibble)),
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)scanner->hi[0]), _mm_and_si128(_mm_srli_epi16(x, 4), nibble)));
+    const __m128i c1 = _mm_and_si128(
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)scanner->lo[1]), _mm_and_si128(y, nibble)),
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)scanner->hi[1]), _mm_and_si128(_mm_srli_epi16(y, 4), nibble)));
+    return _mm_and_si128(c0, c1);
+}
+
+RT_TARGET_SSE42 static size_t rt__scan_buckets_ssse3(RT__ScanTask *task, size_t at, size_t end)
+{
+    // the second anchor byte is read one past each position
+    uint8_t buckets[16];
+    for (; at + 16 <= end && at + 17 <= task->size; at += 16) {
+        const __m128i c = rt__scan_buckets_sse(task->scanner,
+            _mm_loadu_si128((const __m128i*)(task->data + at)),
+            _mm_loadu_si128((const __m128i*)(task->data + at + 1)));
+        uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_setzero_si128())) ^ 0xFFFF;
+        if (!m) continue;
+        _mm_storeu_si128((__m128i*)buckets, c);
+        for (; m; m &= m - 1) {
+            const unsigned lane = rt__ctz32(m);
+            rt__scan_buckets_check(task, at + lane, buckets[lane]);
+        }
+    }
+    return at;
+}
+
+RT_TARGET_AVX2 static size_t rt__scan_buckets_avx2(RT__ScanTask *task, size_t at, size_t end)
+{
+    const RT_Scanner *scanner = task->scanner;
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i lo0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)scanner->lo[0]));
+    const __m256i hi0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)scanner->hi[0]));
+    const __m256i lo1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)scanner->lo[1]));
+    const __m256i hi1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)scanner->hi[1]));
+
+    uint8_t buckets[32];
+    for (; at + 32 <= end && at + 33 <= task->size; at += 32) {
+        const __m256i x = _mm256_loadu_si256((const __m256i*)(task->data + at));
+        const __m256i y = _mm256_loadu_si256((const __m256i*)(task->data + at + 1));
+        const __m256i c = _mm256_and_si256(
+            _mm256_and_si256(_mm256_shuffle_epi8(lo0, _mm256_and_si256(x, nibble)),
+                             _mm256_shuffle_epi8(hi0, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble))),
+            _mm256_and_si256(_mm256_shuffle_epi8(lo1, _mm256_and_si256(y, nibble)),
+                             _mm256_shuffle_epi8(hi1, _mm256_and_si256(_mm256_srli_epi16(y, 4), nibble))));
+        uint32_t m = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_setzero_si256()));
+        if (!m) continue;
+        _mm256_storeu_si256((__m256i*)buckets, c);
+        for (; m; m &= m - 1) {
+            const unsigned lane = rt__ctz32(m);
+            rt__scan_buckets_check(task, at + lane, buckets[lane]);
+        }
+    }
+    return at;
+}
+#endif // RT_SIMD_X86
+
+// bucket hits come out of anchor order when anchors differ; the disorder
+// spans at most one signature length, so insertion sort is close to linear
+static void rt__scan_sort(RT_ScanMatchList *matches)
+{
+    for (size_t i = 1; i < matches->size; ++i) {
+        const RT_ScanMatch match = matches->data[i];
+        size_t j = i;
+        while (j > 0 && (matches->data[j - 1].offset > match.offset ||
+                         (matches->data[j - 1].offset == match.offset && matches->data[j - 1].pattern > match.pattern))) {
+            matches->data[j] = matches->data[j - 1];
+            j--;
+        }
+        matches->data[j] = match;
+    }
+}
+
+static DWORD rt__scan_worker(void *param)
+{
+    RT__ScanTask *task = param;
+    const RT_Scanner *scanner = task->scanner;
+    task->ok = true;
+
+    if (scanner->count == 1 && scanner->patterns[0].first != RT_SCAN_NONE) {
+        // starts whose match fits before the end of the readable bytes
+        const size_t size = scanner->patterns[0].size;
+        if (size > task->size) return 0;
+        const size_t end = task->to < task->size - size + 1 ? task->to : task->size - size + 1;
+        size_t start = task->from;
+#ifdef RT_SIMD_X86
+        if (rt__cpu_has(RT_CPU_AVX2)) start = rt__scan_single_avx2(task, start, end);
+        else if (rt__cpu_has(RT_CPU_SSE2)) start = rt__scan_single_sse2(task, start, end);
+#endif // RT_SIMD_X86
+        rt__scan_single_scalar(task, start, end);
+        return 0;
+    }
+
+    // anchors sit at most max_size - 1 bytes past the start they belong to
+    size_t at = task->from;
+    const size_t end = task->size - task->to > scanner->max_size ? task->to + scanner->max_size : task->size;
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_AVX2)) at = rt__scan_buckets_avx2(task, at, end);
+    else if (rt__cpu_has(RT_CPU_SSE42)) at = rt__scan_buckets_ssse3(task, at, end);
+#endif // RT_SIMD_X86
+    rt__scan_buckets_scalar(task, at, end);
+    rt__scan_sort(&task->matches);
+    return 0;
+}
+
+bool rt_scanner_find_range(const RT_Scanner *scanner, const uint8_t *data, size_t size,
+                           size_t from, size_t to, uint64_t offset, RT_ScanMatchList *matches)
+{
+    if (!scanner || !matches || (size && !data)) return false;
+    if (to > size) to = size;
+    if (scanner->count == 0 || from >= to) return true;
+
+    const size_t span = to - from;
+    size_t count = rt_thread_cpu_count();
+    if (count > RT_THREAD_MAX_TASKS) count = RT_THREAD_MAX_TASKS;
+    if (count > span / RT_SCAN_TASK_MIN) count = span / RT_SCAN_TASK_MIN;
+    if (count == 0) count = 1;
+
+    RT__ScanTask *tasks = RT_MALLOC(count * sizeof(RT__ScanTask));
+    if (!tasks) return false;
+
+    // every piece may read to the end, so matches across a cut are whole
+    for (size_t t = 0, start = from; t < count; ++t) {
+        const size_t end = t + 1 < count ? from + (size_t)((uint64_t)span * (t + 1) / count) : to;
+        tasks[t] = (RT__ScanTask){ scanner, data, size, start, end, offset, {0}, false };
+        start = end;
+    }
+
+    if (count == 1) rt__scan_worker(tasks);
+    else rt_thread_run_tasks(tasks, sizeof(RT__ScanTask), count, rt__scan_worker);
+
+    bool ok = true;
+    for (size_t t = 0; t < count; ++t) {
+        ok = ok && tasks[t].ok && RT_ScanMatchList_push_n(matches, tasks[t].matches.data, tasks[t].matches.size);
+        RT_ScanMatchList_free(&tasks[t].matches);
+    }
+
+    RT_FREE(tasks);
+    return ok;
+}
+
+bool rt_scanner_find(const RT_Scanner *scanner, const uint8_t *data, size_t size, uint64_t offset, RT_ScanMatchList *matches)
+{
+    return rt_scanner_find_range(scanner, data, size, 0, size, offset, matches);
+}
+
+bool rt_fbuffer_scan(const RT_Scanner *scanner, const RT_FileBuffer *buffer, RT_ScanMatchList *matches)
+{
+    if (!buffer) return false;
+    return rt_scanner_find(scanner, buffer->data, buffer->size, 0, matches);
+}
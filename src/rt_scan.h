@@ -0,0 +1,77 @@
+#ifndef _INC_RT_SCAN
+#define _INC_RT_SCAN
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+#include "rt_typed.h"
+
+/* Signature scanner
+ * Finds byte signatures with wildcards, written the usual way:
+ *   "48 8B ?? ?? 89"   "E8 ? ? ? ?"   "4? 8B 05"
+ * "??" or "?" skips a byte, "4?" or "?5" matches only one nibble; spaces are
+ * optional between full bytes. Each signature needs at least one byte that
+ * is not a wildcard. Signatures get ids in the order they are added.
+ *
+ * Candidates are found with SIMD filters and then verified against the
+ * masks 8 bytes at a time:
+ *   - a single signature compares its first and last fixed bytes at 32
+ *     (AVX2) or 16 (SSE2) positions per step
+ *   - several signatures use Teddy-style nibble tables: signatures are dealt
+ *     round-robin into 8 buckets, and two shuffles per byte test two
+ *     adjacent bytes of every bucket at once (SSSE3/AVX2)
+ * Large inputs are cut into pieces scanned in parallel. A piece only reports
+ * matches starting inside it but reads on past its end, so matches spanning
+ * a cut are found exactly once. Matches come out ordered by offset, then id. */
+#define RT_SCAN_BUCKETS 8
+#define RT_SCAN_CHUNK 0x400000 // per round when streaming files
+#define RT_SCAN_TASK_MIN 0x40000 // bytes worth handing to another thread
+#define RT_SCAN_NONE SIZE_MAX
+
+typedef struct _RT_ScanPattern {
+    uint8_t *bytes;  // already masked
+    uint8_t *mask;
+    size_t size;
+    size_t anchor;   // the bucket filter looks at bytes anchor and anchor + 1
+    size_t first;    // first and last fully fixed bytes, RT_SCAN_NONE if none
+    size_t last;
+} RT_ScanPattern;
+
+typedef struct _RT_Scanner {
+    RT_ScanPattern *patterns;
+    size_t count;
+    size_t capacity;
+    size_t max_size;
+    uint8_t lo[2][16]; // bucket bits by low and high nibble, for the two
+    uint8_t hi[2][16]; // anchor bytes
+} RT_Scanner;
+
+typedef struct _RT_ScanMatch {
+    uint64_t offset;
+    size_t pattern;
+} RT_ScanMatch;
+
+RT_DEFINE_DARRAY(RT_ScanMatchList, RT_ScanMatch) // a zeroed list is ready to use
+
+bool rt_scanner_init(RT_Scanner *scanner);
+void rt_scanner_free(RT_Scanner *scanner);
+
+/* Both return the new signature's id, RT_SCAN_NONE if it is malformed or
+ * all wildcards. mask bits that are 0 are not compared. */
+size_t rt_scanner_add(RT_Scanner *scanner, const char *signature);
+size_t rt_scanner_add_bytes(RT_Scanner *scanner, const uint8_t *bytes, const uint8_t *mask, size_t size);
+
+/* Appends the matches in `size` bytes at `data`, reported as offset + index.
+ * The scanner may be shared by concurrent scans. */
+bool rt_scanner_find(const RT_Scanner *scanner, const uint8_t *data, size_t size, uint64_t offset, RT_ScanMatchList *matches);
+
+/* Same, for the matches that start in [from, to) of `data`; the bytes after
+ * `to` are only read to complete them. Streaming callers use this to look
+ * across the seam between two chunks. */
+bool rt_scanner_find_range(const RT_Scanner *scanner, const uint8_t *data, size_t size,
+                           size_t from, size_t to, uint64_t offset, RT_ScanMatchList *matches);
+
+bool rt_fbuffer_scan(const RT_Scanner *scanner, const RT_FileBuffer *buffer, RT_ScanMatchList *matches);
+
+#endif // _INC_RT_SCAN
@@ -0,0 +1,840 @@
+#include "rt_simd.h"
+
+#if defined(RT_SIMD_X86) && defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+static volatile unsigned rt__cpu_flags; // bit 31 marks "detected"
+
+unsigned rt__cpu_features(void)
+{
+    unsigned flags = rt__cpu_flags;
+    if (flags) return flags;
+
+#if defined(RT_SIMD_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) flags |= RT_CPU_SSE2;
+    if (__builtin_cpu_supports("sse4.1")) flags |= RT_CPU_SSE41;
+    if (__builtin_cpu_supports("sse4.2")) flags |= RT_CPU_SSE42;
+    if (__builtin_cpu_supports("popcnt")) flags |= RT_CPU_POPCNT;
+    if (__builtin_cpu_supports("avx2")) flags |= RT_CPU_AVX2;
+#elif defined(RT_SIMD_X86)
+    int r[4];
+    __cpuid(r, 1);
+    if (r[3] & (1 << 26)) flags |= RT_CPU_SSE2;
+    if (r[2] & (1 << 19)) flags |= RT_CPU_SSE41;
+    if (r[2] & (1 << 20)) flags |= RT_CPU_SSE42;
+    if (r[2] & (1 << 23)) flags |= RT_CPU_POPCNT;
+    const bool osxsave = (r[2] & (1 << 27)) != 0;
+    __cpuidex(r, 7, 0);
+    if (osxsave && (r[1] & (1 << 5)) && (_xgetbv(0) & 6) == 6) flags |= RT_CPU_AVX2;
+#endif
+
+    flags |= 1u << 31;
+    rt__cpu_flags = flags;
+    return flags;
+}
+
+/* Scalar fallbacks */
+static inline bool rt__record_eq(const uint8_t *a, const uint8_t *b, size_t esize)
+{
+    // fixed-width loads that overlap instead of a byte loop / memcmp call
+    if (esize >= 8) {
+        uint64_t x, y;
+        size_t i = 0;
+        for (; i + 8 <= esize; i += 8) {
+            memcpy(&x, a + i, 8);
+            memcpy(&y, b + i, 8);
+            if (x != y) return false;
+        }
+        if (i == esize) return true;
+        memcpy(&x, a + esize - 8, 8);
+        memcpy(&y, b + esize - 8, 8);
+        return x == y;
+    }
+    if (esize >= 4) {
+        uint32_t x0, y0, x1, y1;
+        memcpy(&x0, a, 4); memcpy(&y0, b, 4);
+        memcpy(&x1, a + esize - 4, 4); memcpy(&y1, b + esize - 4, 4);
+        return x0 == y0 && x1 == y1;
+    }
+    if (esize >= 2) {
+        uint16_t x0, y0, x1, y1;
+        memcpy(&x0, a, 2); memcpy(&y0, b, 2);
+        memcpy(&x1, a + esize - 2, 2); memcpy(&y1, b + esize - 2, 2);
+        return x0 == y0 && x1 == y1;
+    }
+    return *a == *b;
+}
+
+#define RT__DEFINE_SCALAR_EQ(bits)                                                    \
+static size_t rt__find_eq##bits##_scalar(const uint8_t *p, size_t n, const void *key, size_t from) \
+{                                                                                     \
+    uint##bits##_t k, v;                                                              \
+    memcpy(&k, key, sizeof(k));                                                       \
+    for (size_t i = from; i < n; ++i) {                                               \
+        memcpy(&v, p + i * sizeof(v), sizeof(v));                                     \
+        if (v == k) return i;                                                         \
+    }                                                                                 \
+    return n;                                                                         \
+}                                                                                     \
+                                                                                      \
+static size_t rt__count_eq##bits##_scalar(const uint8_t *p, size_t n, const void *key, size_t from) \
+{                                                                                     \
+    uint##bits##_t k, v;                                                              \
+    size_t c = 0;                                                                     \
+    memcpy(&k, key, sizeof(k));                                                       \
+    for (size_t i = from; i < n; ++i) {                                               \
+        memcpy(&v, p + i * sizeof(v), sizeof(v));                                     \
+        c += (v == k);                                                                \
+    }                                                                                 \
+    return c;                                                                         \
+}
+
+RT__DEFINE_SCALAR_EQ(8)
+RT__DEFINE_SCALAR_EQ(16)
+RT__DEFINE_SCALAR_EQ(32)
+RT__DEFINE_SCALAR_EQ(64)
+
+static size_t rt__find_eq_scalar(const uint8_t *p, size_t n, size_t esize, const void *key, size_t from)
+{
+    switch (esize) {
+    case 1: return rt__find_eq8_scalar(p, n, key, from);
+    case 2: return rt__find_eq16_scalar(p, n, key, from);
+    case 4: return rt__find_eq32_scalar(p, n, key, from);
+    case 8: return rt__find_eq64_scalar(p, n, key, from);
+    default:
+        for (size_t i = from; i < n; ++i) {
+            if (rt__record_eq(p + i * esize, key, esize)) return i;
+        }
+        return n;
+    }
+}
+
+static size_t rt__count_eq_scalar(const uint8_t *p, size_t n, size_t esize, const void *key, size_t from)
+{
+    switch (esize) {
+    case 1: return rt__count_eq8_scalar(p, n, key, from);
+    case 2: return rt__count_eq16_scalar(p, n, key, from);
+    case 4: return rt__count_eq32_scalar(p, n, key, from);
+    case 8: return rt__count_eq64_scalar(p, n, key, from);
+    default: {
+        size_t c = 0;
+        for (size_t i = from; i < n; ++i) c += rt__record_eq(p + i * esize, key, esize);
+        return c;
+    }
+    }
+}
+
+#ifdef RT_SIMD_X86
+/* Equality kernels. Lanes are compared at their own width, then reduced to a
+ * byte mask, so a match of element i always shows up as bit i*esize. */
+RT_TARGET_SSE2 static inline __m128i rt__sse2_cmpeq64(__m128i a, __m128i b)
+{
+    __m128i e = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+RT_TARGET_SSE2 static inline __m128i rt__sse2_key8(const void *k) { int8_t v; memcpy(&v, k, 1); return _mm_set1_epi8(v); }
+RT_TARGET_SSE2 static inline __m128i rt__sse2_key16(const void *k) { int16_t v; memcpy(&v, k, 2); return _mm_set1_epi16(v); }
+RT_TARGET_SSE2 static inline __m128i rt__sse2_key32(const void *k) { int32_t v; memcpy(&v, k, 4); return _mm_set1_epi32(v); }
+RT_TARGET_SSE2 static inline __m128i rt__sse2_key64(const void *k) { int64_t v; memcpy(&v, k, 8); return _mm_set1_epi64x(v); }
+RT_TARGET_AVX2 static inline __m256i rt__avx2_key8(const void *k) { int8_t v; memcpy(&v, k, 1); return _mm256_set1_epi8(v); }
+RT_TARGET_AVX2 static inline __m256i rt__avx2_key16(const void *k) { int16_t v; memcpy(&v, k, 2); return _mm256_set1_epi16(v); }
+RT_TARGET_AVX2 static inline __m256i rt__avx2_key32(const void *k) { int32_t v; memcpy(&v, k, 4); return _mm256_set1_epi32(v); }
+RT_TARGET_AVX2 static inline __m256i rt__avx2_key64(const void *k) { int64_t v; memcpy(&v, k, 8); return _mm256_set1_epi64x(v); }
+
+#define RT__DEFINE_SSE2_EQ(bits, CMPEQ)                                               \
+RT_TARGET_SSE2 static size_t rt__find_eq##bits##_sse2(const uint8_t *p, size_t n, const void *key, size_t from) \
+{                                                                                     \
+    const size_t es = bits / 8, end = n * es;                                         \
+    const __m128i k = rt__sse2_key##bits(key);                                        \
+    size_t i = from * es;                                                             \
+    for (; i + 64 <= end; i += 64) {                                                  \
+        __m128i a = CMPEQ(_mm_loadu_si128((const __m128i*)(p + i)), k);               \
+        __m128i b = CMPEQ(_mm_loadu_si128((const __m128i*)(p + i + 16)), k);          \
+        __m128i c = CMPEQ(_mm_loadu_si128((const __m128i*)(p + i + 32)), k);          \
+        __m128i d = CMPEQ(_mm_loadu_si128((const __m128i*)(p + i + 48)), k);          \
+        uint32_t m = (uint32_t)_mm_movemask_epi8(a)                                   \
+            | (uint32_t)_mm_movemask_epi8(b) << 16;                                   \
+        if (m) return (i + rt__ctz32(m)) / es;                                        \
+        m = (uint32_t)_mm_movemask_epi8(c) | (uint32_t)_mm_movemask_epi8(d) << 16;    \
+        if (m) return (i + 32 + rt__ctz32(m)) / es;                                   \
+    }                                                                                 \
+    for (; i + 16 <= end; i += 16) {                                                  \
+        uint32_t m = (uint32_t)_mm_movemask_epi8(                                     \
+            CMPEQ(_mm_loadu_si128((const __m128i*)(p + i)), k));                      \
+        if (m) return (i + rt__ctz32(m)) / es;                                        \
+    }                                                                                 \
+    return rt__find_eq##bits##_scalar(p, n, key, i / es);                             \
+}                                                                                     \
+                                                                                      \
+RT_TARGET_SSE2 static size_t rt__count_eq##bits##_sse2(const uint8_t *p, size_t n, const void *key) \
+{                                                                                     \
+    const size_t es = bits / 8, end = n * es;                                         \
+    const __m128i k = rt__sse2_key##bits(key);                                        \
+    size_t i = 0, matched = 0;                                                        \
+    for (; i + 32 <= end; i += 32) {                                                  \
+        __m128i a = CMPEQ(_mm_loadu_si128((const __m128i*)(p + i)), k);               \
+        __m128i b = CMPEQ(_mm_loadu_si128((const __m128i*)(p + i + 16)), k);          \
+        matched += rt__popcount32((uint32_t)_mm_movemask_epi8(a)                      \
+            | (uint32_t)_mm_movemask_epi8(b) << 16);                                  \
+    }                                                                                 \
+    return matched / es + rt__count_eq##bits##_scalar(p, n, key, i / es);             \
+}
+
+#define RT__DEFINE_AVX2_EQ(bits, CMPEQ)                                               \
+RT_TARGET_AVX2 static size_t rt__find_eq##bits##_avx2(const uint8_t *p, size_t n, const void *key, size_t from) \
+{                                                                                     \
+    const size_t es = bits / 8, end = n * es;                                         \
+    const __m256i k = rt__avx2_key##bits(key);                                        \
+    size_t i = from * es;                                                             \
+    for (; i + 128 <= end; i += 128) {                                                \
+        __m256i a = CMPEQ(_mm256_loadu_si256((const __m256i*)(p + i)), k);            \
+        __m256i b = CMPEQ(_mm256_loadu_si256((const __m256i*)(p + i + 32)), k);       \
+        __m256i c = CMPEQ(_mm256_loadu_si256((const __m256i*)(p + i + 64)), k);       \
+        __m256i d = CMPEQ(_mm256_loadu_si256((const __m256i*)(p + i + 96)), k);       \
+        __m256i any = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));  \
+        if (_mm256_testz_si256(any, any)) continue;                                   \
+        uint32_t m;                                                                   \
+        if ((m = (uint32_t)_mm256_movemask_epi8(a))) return (i + rt__ctz32(m)) / es;  \
+        if ((m = (uint32_t)_mm256_movemask_epi8(b))) return (i + 32 + rt__ctz32(m)) / es; \
+        if ((m = (uint32_t)_mm256_movemask_epi8(c))) return (i + 64 + rt__ctz32(m)) / es; \
+        m = (uint32_t)_mm256_movemask_epi8(d);                                        \
+        return (i + 96 + rt__ctz32(m)) / es;                                          \
+    }                                                                                 \
+    for (; i + 32 <= end; i += 32) {                                                  \
+        uint32_t m = (uint32_t)_mm256_movemask_epi8(                                  \
+            CMPEQ(_mm256_loadu_si256((const __m256i*)(p + i)), k));                   \
+        if (m) return (i + rt__ctz32(m)) / es;                                        \
+    }                                                                                 \
+    return rt__find_eq##bits##_scalar(p, n, key, i / es);                            \
+}                                                                                     \
+                                                                                      \
+RT_TARGET_AVX2 static size_t rt__count_eq##bits##_avx2(const uint8_t *p, size_t n, const void *key) \
+{                                                                                     \
+    const size_t es = bits / 8, end = n * es;                                         \
+    const __m256i k = rt__avx2_key##bits(key);                                        \
+    size_t i = 0, matched = 0;                                                        \
+    for (; i + 64 <= end; i += 64) {                                                  \
+        __m256i a = CMPEQ(_mm256_loadu_si256((const __m256i*)(p + i)), k);            \
+        __m256i b = CMPEQ(_mm256_loadu_si256((const __m256i*)(p + i + 32)), k);       \
+        matched += rt__popcount32((uint32_t)_mm256_movemask_epi8(a))                  \
+            + rt__popcount32((uint32_t)_mm256_movemask_epi8(b));                      \
+    }                                                                                 \
+    return matched / es + rt__count_eq##bits##_scalar(p, n, key, i / es);             \
+}
+
+RT__DEFINE_SSE2_EQ(8, _mm_cmpeq_epi8)
+RT__DEFINE_SSE2_EQ(16, _mm_cmpeq_epi16)
+RT__DEFINE_SSE2_EQ(32, _mm_cmpeq_epi32)
+RT__DEFINE_SSE2_EQ(64, rt__sse2_cmpeq64)
+RT__DEFINE_AVX2_EQ(8, _mm256_cmpeq_epi8)
+RT__DEFINE_AVX2_EQ(16, _mm256_cmpeq_epi16)
+RT__DEFINE_AVX2_EQ(32, _mm256_cmpeq_epi32)
+RT__DEFINE_AVX2_EQ(64, _mm256_cmpeq_epi64)
+
+/* Records of other sizes: compare 16 bytes at a time, last chunk overlaps */
+RT_TARGET_SSE2 static inline bool rt__record_eq_sse2(const uint8_t *a, const uint8_t *b, size_t esize)
+{
+    size_t i = 0;
+    for (; i + 16 <= esize; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF) return false;
+    }
+    if (i == esize) return true;
+    __m128i x = _mm_loadu_si128((const __m128i*)(a + esize - 16));
+    __m128i y = _mm_loadu_si128((const __m128i*)(b + esize - 16));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) == 0xFFFF;
+}
+#endif // RT_SIMD_X86
+
+size_t rt__simd_find_eq(const void *data, size_t n, size_t esize, const void *key, size_t from)
+{
+    const uint8_t *p = data;
+    if (!p || !key || esize == 0 || from >= n) return n;
+
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_AVX2)) {
+        switch (esize) {
+        case 1: return rt__find_eq8_avx2(p, n, key, from);
+        case 2: return rt__find_eq16_avx2(p, n, key, from);
+        case 4: return rt__find_eq32_avx2(p, n, key, from);
+        case 8: return rt__find_eq64_avx2(p, n, key, from);
+        }
+    }
+    if (rt__cpu_has(RT_CPU_SSE2)) {
+        switch (esize) {
+        case 1: return rt__find_eq8_sse2(p, n, key, from);
+        case 2: return rt__find_eq16_sse2(p, n, key, from);
+        case 4: return rt__find_eq32_sse2(p, n, key, from);
+        case 8: return rt__find_eq64_sse2(p, n, key, from);
+        default:
+            if (esize < 16) break;
+            for (size_t i = from; i < n; ++i) {
+                if (rt__record_eq_sse2(p + i * esize, key, esize)) return i;
+            }
+            return n;
+        }
+    }
+#endif // RT_SIMD_X86
+
+    return rt__find_eq_scalar(p, n, esize, key, from);
+}
+
+size_t rt__simd_count_eq(const void *data, size_t n, size_t esize, const void *key)
+{
+    const uint8_t *p = data;
+    if (!p || !key || esize == 0 || n == 0) return 0;
+
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_AVX2)) {
+        switch (esize) {
+        case 1: return rt__count_eq8_avx2(p, n, key);
+        case 2: return rt__count_eq16_avx2(p, n, key);
+        case 4: return rt__count_eq32_avx2(p, n, key);
+        case 8: return rt__count_eq64_avx2(p, n, key);
+        }
+    }
+    if (rt__cpu_has(RT_CPU_SSE2)) {
+        switch (esize) {
+        case 1: return rt__count_eq8_sse2(p, n, key);
+        case 2: return rt__count_eq16_sse2(p, n, key);
+        case 4: return rt__count_eq32_sse2(p, n, key);
+        case 8: return rt__count_eq64_sse2(p, n, key);
+        default:
+            if (esize < 16) break;
+            size_t c = 0;
+            for (size_t i = 0; i < n; ++i) c += rt__record_eq_sse2(p + i * esize, key, esize);
+            return c;
+        }
+    }
+#endif // RT_SIMD_X86
+
+    return rt__count_eq_scalar(p, n, esize, key, 0);
+}
+
+/* Min/max. NaNs are not ordered, the result is unspecified if any are present. */
+#define RT__DEFINE_SCALAR_MINMAX(sfx, T)                                              \
+static void rt__minmax_##sfx##_scalar(const T *p, size_t n, size_t from, T *mn, T *mx) \
+{                                                                                     \
+    T lo = *mn, hi = *mx;                                                             \
+    for (size_t i = from; i < n; ++i) {                                               \
+        if (p[i] < lo) lo = p[i];                                                     \
+        if (p[i] > hi) hi = p[i];                                                     \
+    }                                                                                 \
+    *mn = lo;                                                                         \
+    *mx = hi;                                                                         \
+}
+
+RT__DEFINE_SCALAR_MINMAX(i8, int8_t)
+RT__DEFINE_SCALAR_MINMAX(u8, uint8_t)
+RT__DEFINE_SCALAR_MINMAX(i16, int16_t)
+RT__DEFINE_SCALAR_MINMAX(u16, uint16_t)
+RT__DEFINE_SCALAR_MINMAX(i32, int32_t)
+RT__DEFINE_SCALAR_MINMAX(u32, uint32_t)
+RT__DEFINE_SCALAR_MINMAX(i64, int64_t)
+RT__DEFINE_SCALAR_MINMAX(u64, uint64_t)
+RT__DEFINE_SCALAR_MINMAX(f32, float)
+RT__DEFINE_SCALAR_MINMAX(f64, double)
+
+#ifdef RT_SIMD_X86
+RT_TARGET_AVX2 static inline __m256i rt__mm256_min_epi64(__m256i a, __m256i b)
+{
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+RT_TARGET_AVX2 static inline __m256i rt__mm256_max_epi64(__m256i a, __m256i b)
+{
+    return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+}
+
+RT_TARGET_AVX2 static inline __m256i rt__mm256_min_epu64(__m256i a, __m256i b)
+{
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+    __m256i gt = _mm256_cmpgt_epi64(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+    return _mm256_blendv_epi8(a, b, gt);
+}
+
+RT_TARGET_AVX2 static inline __m256i rt__mm256_max_epu64(__m256i a, __m256i b)
+{
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+    __m256i gt = _mm256_cmpgt_epi64(_mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+    return _mm256_blendv_epi8(b, a, gt);
+}
+
+#define RT__LOADI(p) _mm256_loadu_si256((const __m256i*)(p))
+#define RT__STOREI(p, v) _mm256_storeu_si256((__m256i*)(p), (v))
+
+#define RT__DEFINE_AVX2_MINMAX(sfx, T, VT, LOAD, STORE, VMIN, VMAX)                   \
+RT_TARGET_AVX2 static void rt__minmax_##sfx##_avx2(const T *p, size_t n, T *mn, T *mx) \
+{                                                                                     \
+    enum { L = 32 / sizeof(T) };                                                      \
+    T lo = p[0], hi = p[0];                                                           \
+    size_t i = 0;                                                                     \
+    if (n >= 2 * L) {                                                                 \
+        VT lo0 = LOAD(p), hi0 = lo0, lo1 = LOAD(p + L), hi1 = lo1;                    \
+        for (i = 2 * L; i + 2 * L <= n; i += 2 * L) {                                 \
+            VT a = LOAD(p + i), b = LOAD(p + i + L);                                  \
+            lo0 = VMIN(lo0, a); hi0 = VMAX(hi0, a);                                   \
+            lo1 = VMIN(lo1, b); hi1 = VMAX(hi1, b);                                   \
+        }                                                                             \
+        T tmp[L];                                                                     \
+        STORE(tmp, VMIN(lo0, lo1));                                                   \
+        for (size_t j = 0; j < L; ++j) if (tmp[j] < lo) lo = tmp[j];                  \
+        STORE(tmp, VMAX(hi0, hi1));                                                   \
+        for (size_t j = 0; j < L; ++j) if (tmp[j] > hi) hi = tmp[j];                  \
+    }                                                                                 \
+    *mn = lo;                                                                         \
+    *mx = hi;                                                                         \
+    rt__minmax_##sfx##_scalar(p, n, i, mn, mx);                                       \
+}
+
+RT__DEFINE_AVX2_MINMAX(i8, int8_t, __m256i, RT__LOADI, RT__STOREI, _mm256_min_epi8, _mm256_max_epi8)
+RT__DEFINE_AVX2_MINMAX(u8, uint8_t, __m256i, RT__LOADI, RT__STOREI, _mm256_min_epu8, _mm256_max_epu8)
+RT__DEFINE_AVX2_MINMAX(i16, int16_t, __m256i, RT__LOADI, RT__STOREI, _mm256_min_epi16, _mm256_max_epi16)
+RT__DEFINE_AVX2_MINMAX(u16, uint16_t, __m256i, RT__LOADI, RT__STOREI, _mm256_min_epu16, _mm256_max_epu16)
+RT__DEFINE_AVX2_MINMAX(i32, int32_t, __m256i, RT__LOADI, RT__STOREI, _mm256_min_epi32, _mm256_max_epi32)
+RT__DEFINE_AVX2_MINMAX(u32, uint32_t, __m256i, RT__LOADI, RT__STOREI, _mm256_min_epu32, _mm256_max_epu32)
+RT__DEFINE_AVX2_MINMAX(i64, int64_t, __m256i, RT__LOADI, RT__STOREI, rt__mm256_min_epi64, rt__mm256_max_epi64)
+RT__DEFINE_AVX2_MINMAX(u64, uint64_t, __m256i, RT__LOADI, RT__STOREI, rt__mm256_min_epu64, rt__mm256_max_epu64)
+RT__DEFINE_AVX2_MINMAX(f32, float, __m256, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_min_ps, _mm256_max_ps)
+RT__DEFINE_AVX2_MINMAX(f64, double, __m256d, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_min_pd, _mm256_max_pd)
+#endif // RT_SIMD_X86
+
+#ifdef RT_SIMD_X86
+#   define RT__MINMAX_CASE(tag, sfx, T)                                               \
+    case tag: {                                                                       \
+        T lo = ((const T*)data)[0], hi = lo;                                          \
+        if (avx2) rt__minmax_##sfx##_avx2(data, n, &lo, &hi);                         \
+        else rt__minmax_##sfx##_scalar(data, n, 1, &lo, &hi);                         \
+        if (min_out) memcpy(min_out, &lo, sizeof(T));                                 \
+        if (max_out) memcpy(max_out, &hi, sizeof(T));                                 \
+        return true;                                                                  \
+    }
+#else
+#   define RT__MINMAX_CASE(tag, sfx, T)                                               \
+    case tag: {                                                                       \
+        T lo = ((const T*)data)[0], hi = lo;                                          \
+        rt__minmax_##sfx##_scalar(data, n, 1, &lo, &hi);                              \
+        if (min_out) memcpy(min_out, &lo, sizeof(T));                                 \
+        if (max_out) memcpy(max_out, &hi, sizeof(T));                                 \
+        return true;                                                                  \
+    }
+#endif // RT_SIMD_X86
+
+bool rt__simd_minmax(const void *data, size_t n, RT_ElemType type, void *min_out, void *max_out)
+{
+    if (!data || n == 0) return false;
+
+#ifdef RT_SIMD_X86
+    const bool avx2 = rt__cpu_has(RT_CPU_AVX2);
+#endif // RT_SIMD_X86
+
+    switch (type) {
+    RT__MINMAX_CASE(RT_ELEM_I8, i8, int8_t)
+    RT__MINMAX_CASE(RT_ELEM_U8, u8, uint8_t)
+    RT__MINMAX_CASE(RT_ELEM_I16, i16, int16_t)
+    RT__MINMAX_CASE(RT_ELEM_U16, u16, uint16_t)
+    RT__MINMAX_CASE(RT_ELEM_I32, i32, int32_t)
+    RT__MINMAX_CASE(RT_ELEM_U32, u32, uint32_t)
+    RT__MINMAX_CASE(RT_ELEM_I64, i64, int64_t)
+    RT__MINMAX_CASE(RT_ELEM_U64, u64, uint64_t)
+    RT__MINMAX_CASE(RT_ELEM_F32, f32, float)
+    RT__MINMAX_CASE(RT_ELEM_F64, f64, double)
+    }
+
+    return false;
+}
+
+/* Stream compaction */
+#define RT__DEFINE_SCALAR_COMPACT(sfx, T)                                             \
+static size_t rt__compact_##sfx##_scalar(T *p, size_t i, size_t j, size_t n, RT_CmpOp op, T k) \
+{                                                                                     \
+    for (; i < n; ++i) {                                                              \
+        T v = p[i];                                                                   \
+        bool match;                                                                   \
+        switch (op) {                                                                 \
+        case RT_CMP_EQ: match = v == k; break;                                        \
+        case RT_CMP_NE: match = v != k; break;                                        \
+        case RT_CMP_LT: match = v < k; break;                                         \
+        case RT_CMP_LE: match = v <= k; break;                                        \
+        case RT_CMP_GT: match = v > k; break;                                         \
+        default: match = v >= k; break;                                               \
+        }                                                                             \
+        p[j] = v; /* branch-free: always store, only advance past kept elements */   \
+        j += !match;                                                                  \
+    }                                                                                 \
+    return j;                                                                         \
+}
+
+RT__DEFINE_SCALAR_COMPACT(i8, int8_t)
+RT__DEFINE_SCALAR_COMPACT(u8, uint8_t)
+RT__DEFINE_SCALAR_COMPACT(i16, int16_t)
+RT__DEFINE_SCALAR_COMPACT(u16, uint16_t)
+RT__DEFINE_SCALAR_COMPACT(i32, int32_t)
+RT__DEFINE_SCALAR_COMPACT(u32, uint32_t)
+RT__DEFINE_SCALAR_COMPACT(i64, int64_t)
+RT__DEFINE_SCALAR_COMPACT(u64, uint64_t)
+RT__DEFINE_SCALAR_COMPACT(f32, float)
+RT__DEFINE_SCALAR_COMPACT(f64, double)
+
+#ifdef RT_SIMD_X86
+/* Left-pack permutations: row m lists the lanes set in m, in order. Built by
+ * the preprocessor so there is no runtime init to race on. */
+#define RT__POP8(x) (((x) & 1) + (((x) >> 1) & 1) + (((x) >> 2) & 1) + (((x) >> 3) & 1) \
+                   + (((x) >> 4) & 1) + (((x) >> 5) & 1) + (((x) >> 6) & 1) + (((x) >> 7) & 1))
+#define RT__NTH(m, j, l) (((((m) >> (l)) & 1) && RT__POP8((m) & ((1u << (l)) - 1)) == (j)) ? (l) : 0)
+#define RT__LANE(m, j) (RT__NTH(m, j, 0) + RT__NTH(m, j, 1) + RT__NTH(m, j, 2) + RT__NTH(m, j, 3) \
+                      + RT__NTH(m, j, 4) + RT__NTH(m, j, 5) + RT__NTH(m, j, 6) + RT__NTH(m, j, 7))
+#define RT__ROW32(m) {RT__LANE(m, 0), RT__LANE(m, 1), RT__LANE(m, 2), RT__LANE(m, 3), \
+                      RT__LANE(m, 4), RT__LANE(m, 5), RT__LANE(m, 6), RT__LANE(m, 7)}
+#define RT__ROW64(m) {2 * RT__LANE(m, 0), 2 * RT__LANE(m, 0) + 1, 2 * RT__LANE(m, 1), 2 * RT__LANE(m, 1) + 1, \
+                      2 * RT__LANE(m, 2), 2 * RT__LANE(m, 2) + 1, 2 * RT__LANE(m, 3), 2 * RT__LANE(m, 3) + 1}
+#define RT__ROWS4(R, b) R((b) + 0), R((b) + 1), R((b) + 2), R((b) + 3)
+#define RT__ROWS16(R, b) RT__ROWS4(R, (b) + 0), RT__ROWS4(R, (b) + 4), RT__ROWS4(R, (b) + 8), RT__ROWS4(R, (b) + 12)
+#define RT__ROWS64(R, b) RT__ROWS16(R, (b) + 0), RT__ROWS16(R, (b) + 16), RT__ROWS16(R, (b) + 32), RT__ROWS16(R, (b) + 48)
+
+static const uint32_t rt__pack_lut32[256][8] = {
+    RT__ROWS64(RT__ROW32, 0u), RT__ROWS64(RT__ROW32, 64u), RT__ROWS64(RT__ROW32, 128u), RT__ROWS64(RT__ROW32, 192u)
+};
+static const uint32_t rt__pack_lut64[16][8] = {
+    RT__ROWS16(RT__ROW64, 0u)
+};
+
+RT_TARGET_AVX2 static inline __m256i rt__avx2_match_epi32(__m256i v, __m256i k, RT_CmpOp op)
+{
+    switch (op) {
+    case RT_CMP_EQ: return _mm256_cmpeq_epi32(v, k);
+    case RT_CMP_NE: return _mm256_xor_si256(_mm256_cmpeq_epi32(v, k), _mm256_set1_epi32(-1));
+    case RT_CMP_LT: return _mm256_cmpgt_epi32(k, v);
+    case RT_CMP_LE: return _mm256_xor_si256(_mm256_cmpgt_epi32(v, k), _mm256_set1_epi32(-1));
+    case RT_CMP_GT: return _mm256_cmpgt_epi32(v, k);
+    default: return _mm256_xor_si256(_mm256_cmpgt_epi32(k, v), _mm256_set1_epi32(-1));
+    }
+}
+
+RT_TARGET_AVX2 static inline __m256i rt__avx2_match_epi64(__m256i v, __m256i k, RT_CmpOp op)
+{
+    switch (op) {
+    case RT_CMP_EQ: return _mm256_cmpeq_epi64(v, k);
+    case RT_CMP_NE: return _mm256_xor_si256(_mm256_cmpeq_epi64(v, k), _mm256_set1_epi32(-1));
+    case RT_CMP_LT: return _mm256_cmpgt_epi64(k, v);
+    case RT_CMP_LE: return _mm256_xor_si256(_mm256_cmpgt_epi64(v, k), _mm256_set1_epi32(-1));
+    case RT_CMP_GT: return _mm256_cmpgt_epi64(v, k);
+    default: return _mm256_xor_si256(_mm256_cmpgt_epi64(k, v), _mm256_set1_epi32(-1));
+    }
+}
+
+// ordered predicates, except NE which like C's != is true for NaN
+RT_TARGET_AVX2 static inline __m256i rt__avx2_match_ps(__m256 v, __m256 k, RT_CmpOp op)
+{
+    switch (op) {
+    case RT_CMP_EQ: return _mm256_castps_si256(_mm256_cmp_ps(v, k, _CMP_EQ_OQ));
+    case RT_CMP_NE: return _mm256_castps_si256(_mm256_cmp_ps(v, k, _CMP_NEQ_UQ));
+    case RT_CMP_LT: return _mm256_castps_si256(_mm256_cmp_ps(v, k, _CMP_LT_OQ));
+    case RT_CMP_LE: return _mm256_castps_si256(_mm256_cmp_ps(v, k, _CMP_LE_OQ));
+    case RT_CMP_GT: return _mm256_castps_si256(_mm256_cmp_ps(v, k, _CMP_GT_OQ));
+    default: return _mm256_castps_si256(_mm256_cmp_ps(v, k, _CMP_GE_OQ));
+    }
+}
+
+RT_TARGET_AVX2 static inline __m256i rt__avx2_match_pd(__m256d v, __m256d k, RT_CmpOp op)
+{
+    switch (op) {
+    case RT_CMP_EQ: return _mm256_castpd_si256(_mm256_cmp_pd(v, k, _CMP_EQ_OQ));
+    case RT_CMP_NE: return _mm256_castpd_si256(_mm256_cmp_pd(v, k, _CMP_NEQ_UQ));
+    case RT_CMP_LT: return _mm256_castpd_si256(_mm256_cmp_pd(v, k, _CMP_LT_OQ));
+    case RT_CMP_LE: return _mm256_castpd_si256(_mm256_cmp_pd(v, k, _CMP_LE_OQ));
+    case RT_CMP_GT: return _mm256_castpd_si256(_mm256_cmp_pd(v, k, _CMP_GT_OQ));
+    default: return _mm256_castpd_si256(_mm256_cmp_pd(v, k, _CMP_GE_OQ));
+    }
+}
+
+/* 8 (4) lanes per step: compare, permute the kept lanes to the front, store
+ * the whole vector at the write cursor and advance it by the kept count. The
+ * store never reaches past the block just loaded, since j <= i. Unsigned
+ * keys are compared signed after flipping the sign bit. Returns the write
+ * cursor, the caller finishes the tail from (n & ~7) / (n & ~3). */
+RT_TARGET_AVX2 static size_t rt__compact32_avx2(uint32_t *p, size_t n, RT_ElemType type, RT_CmpOp op, uint32_t key)
+{
+    const __m256i flip = _mm256_set1_epi32(type == RT_ELEM_U32 ? INT32_MIN : 0);
+    const __m256i k = _mm256_xor_si256(_mm256_set1_epi32((int32_t)key), flip);
+    size_t j = 0;
+
+    for (size_t i = 0; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i m = type == RT_ELEM_F32
+            ? rt__avx2_match_ps(_mm256_castsi256_ps(v), _mm256_castsi256_ps(k), op)
+            : rt__avx2_match_epi32(_mm256_xor_si256(v, flip), k, op);
+        unsigned keep = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(m)) & 0xFF;
+        __m256i perm = _mm256_loadu_si256((const __m256i*)rt__pack_lut32[keep]);
+        _mm256_storeu_si256((__m256i*)(p + j), _mm256_permutevar8x32_epi32(v, perm));
+        j += rt__popcount32(keep);
+    }
+
+    return j;
+}
+
+RT_TARGET_AVX2 static size_t rt__compact64_avx2(uint64_t *p, size_t n, RT_ElemType type, RT_CmpOp op, uint64_t key)
+{
+    const __m256i flip = _mm256_set1_epi64x(type == RT_ELEM_U64 ? INT64_MIN : 0);
+    const __m256i k = _mm256_xor_si256(_mm256_set1_epi64x((int64_t)key), flip);
+    size_t j = 0;
+
+    for (size_t i = 0; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i m = type == RT_ELEM_F64
+            ? rt__avx2_match_pd(_mm256_castsi256_pd(v), _mm256_castsi256_pd(k), op)
+            : rt__avx2_match_epi64(_mm256_xor_si256(v, flip), k, op);
+        unsigned keep = ~(unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(m)) & 0xF;
+        __m256i perm = _mm256_loadu_si256((const __m256i*)rt__pack_lut64[keep]);
+        _mm256_storeu_si256((__m256i*)(p + j), _mm256_permutevar8x32_epi32(v, perm));
+        j += rt__popcount32(keep);
+    }
+
+    return j;
+}
+#endif // RT_SIMD_X86
+
+#ifdef RT_SIMD_X86
+#   define RT__COMPACT_CASE(tag, sfx, T, bits, step)                                 \
+    case tag: {                                                                       \
+        T k;                                                                          \
+        memcpy(&k, key, sizeof(T));                                                   \
+        if (avx2) {                                                                   \
+            uint##bits##_t uk;                                                        \
+            memcpy(&uk, key, sizeof(T));                                              \
+            size_t j = rt__compact##bits##_avx2(data, n, type, op, uk);               \
+            return rt__compact_##sfx##_scalar(data, n & ~(size_t)((step) - 1), j, n, op, k); \
+        }                                                                             \
+        return rt__compact_##sfx##_scalar(data, 0, 0, n, op, k);                      \
+    }
+#else
+#   define RT__COMPACT_CASE(tag, sfx, T, bits, step)                                 \
+    case tag: {                                                                       \
+        T k;                                                                          \
+        memcpy(&k, key, sizeof(T));                                                   \
+        return rt__compact_##sfx##_scalar(data, 0, 0, n, op, k);                      \
+    }
+#endif // RT_SIMD_X86
+
+#define RT__COMPACT_SCALAR_CASE(tag, sfx, T)                                          \
+    case tag: {                                                                       \
+        T k;                                                                          \
+        memcpy(&k, key, sizeof(T));                                                   \
+        return rt__compact_##sfx##_scalar(data, 0, 0, n, op, k);                      \
+    }
+
+size_t rt__simd_compact(void *data, size_t n, RT_ElemType type, RT_CmpOp op, const void *key)
+{
+    if (!data || !key || n == 0) return 0;
+
+#ifdef RT_SIMD_X86
+    const bool avx2 = rt__cpu_has(RT_CPU_AVX2);
+#endif // RT_SIMD_X86
+
+    switch (type) {
+    RT__COMPACT_SCALAR_CASE(RT_ELEM_I8, i8, int8_t)
+    RT__COMPACT_SCALAR_CASE(RT_ELEM_U8, u8, uint8_t)
+    RT__COMPACT_SCALAR_CASE(RT_ELEM_I16, i16, int16_t)
+    RT__COMPACT_SCALAR_CASE(RT_ELEM_U16, u16, uint16_t)
+    RT__COMPACT_CASE(RT_ELEM_I32, i32, int32_t, 32, 8)
+    RT__COMPACT_CASE(RT_ELEM_U32, u32, uint32_t, 32, 8)
+    RT__COMPACT_CASE(RT_ELEM_F32, f32, float, 32, 8)
+    RT__COMPACT_CASE(RT_ELEM_I64, i64, int64_t, 64, 4)
+    RT__COMPACT_CASE(RT_ELEM_U64, u64, uint64_t, 64, 4)
+    RT__COMPACT_CASE(RT_ELEM_F64, f64, double, 64, 4)
+    }
+
+    return n;
+}
+
+/* Bitwise set operations. The AVX2 path counts bits with the nibble lookup
+ * (vpshufb) and sums bytes with vpsadbw, so the result costs no extra pass. */
+#define RT__DEFINE_SCALAR_BITWISE(name, attr, EXPR)                                   \
+attr static size_t rt__bitwise_##name(uint64_t *d, const uint64_t *a, const uint64_t *b, size_t from, size_t n) \
+{                                                                                     \
+    size_t c = 0;                                                                     \
+    for (size_t i = from; i < n; ++i) {                                               \
+        const uint64_t x = a[i], y = b[i];                                            \
+        d[i] = (EXPR);                                                                \
+        c += rt__popcount64(d[i]);                                                    \
+    }                                                                                 \
+    return c;                                                                         \
+}
+
+RT__DEFINE_SCALAR_BITWISE(and_scalar, , x & y)
+RT__DEFINE_SCALAR_BITWISE(or_scalar, , x | y)
+RT__DEFINE_SCALAR_BITWISE(xor_scalar, , x ^ y)
+RT__DEFINE_SCALAR_BITWISE(andnot_scalar, , x & ~y)
+
+static size_t rt__popcount_scalar(const uint64_t *p, size_t from, size_t n)
+{
+    size_t c = 0;
+    for (size_t i = from; i < n; ++i) c += rt__popcount64(p[i]);
+    return c;
+}
+
+#ifdef RT_SIMD_X86
+RT__DEFINE_SCALAR_BITWISE(and_popcnt, RT_TARGET_POPCNT, x & y)
+RT__DEFINE_SCALAR_BITWISE(or_popcnt, RT_TARGET_POPCNT, x | y)
+RT__DEFINE_SCALAR_BITWISE(xor_popcnt, RT_TARGET_POPCNT, x ^ y)
+RT__DEFINE_SCALAR_BITWISE(andnot_popcnt, RT_TARGET_POPCNT, x & ~y)
+
+RT_TARGET_POPCNT static size_t rt__popcount_popcnt(const uint64_t *p, size_t from, size_t n)
+{
+    size_t c = 0;
+    for (size_t i = from; i < n; ++i) c += rt__popcount64(p[i]);
+    return c;
+}
+
+// per-qword bit counts of v
+RT_TARGET_AVX2 static inline __m256i rt__avx2_popcount_epi64(__m256i v)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, low));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+RT_TARGET_AVX2 static inline size_t rt__avx2_hsum_epi64(__m256i v)
+{
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, v);
+    return (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+#define RT__DEFINE_AVX2_BITWISE(name, VEXPR)                                          \
+RT_TARGET_AVX2 static size_t rt__bitwise_##name##_avx2(uint64_t *d, const uint64_t *a, const uint64_t *b, size_t n) \
+{                                                                                     \
+    __m256i acc = _mm256_setzero_si256();                                             \
+    size_t i = 0;                                                                     \
+    for (; i + 4 <= n; i += 4) {                                                      \
+        const __m256i x = RT__LOADI(a + i), y = RT__LOADI(b + i);                     \
+        const __m256i r = (VEXPR);                                                    \
+        RT__STOREI(d + i, r);                                                         \
+        acc = _mm256_add_epi64(acc, rt__avx2_popcount_epi64(r));                      \
+    }                                                                                 \
+    return rt__avx2_hsum_epi64(acc) + rt__bitwise_##name##_popcnt(d, a, b, i, n);     \
+}
+
+RT__DEFINE_AVX2_BITWISE(and, _mm256_and_si256(x, y))
+RT__DEFINE_AVX2_BITWISE(or, _mm256_or_si256(x, y))
+RT__DEFINE_AVX2_BITWISE(xor, _mm256_xor_si256(x, y))
+RT__DEFINE_AVX2_BITWISE(andnot, _mm256_andnot_si256(y, x))
+
+RT_TARGET_AVX2 static size_t rt__popcount_avx2(const uint64_t *p, size_t n)
+{
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_epi64(acc, rt__avx2_popcount_epi64(RT__LOADI(p + i)));
+    }
+    return rt__avx2_hsum_epi64(acc) + rt__popcount_popcnt(p, i, n);
+}
+#endif // RT_SIMD_X86
+
+#ifdef RT_SIMD_X86
+#   define RT__BITWISE_CASE(tag, name)                                                \
+    case tag:                                                                         \
+        if (avx2) return rt__bitwise_##name##_avx2(dst, a, b, n);                     \
+        if (popcnt) return rt__bitwise_##name##_popcnt(dst, a, b, 0, n);              \
+        return rt__bitwise_##name##_scalar(dst, a, b, 0, n);
+#else
+#   define RT__BITWISE_CASE(tag, name)                                                \
+    case tag: return rt__bitwise_##name##_scalar(dst, a, b, 0, n);
+#endif // RT_SIMD_X86
+
+size_t rt__simd_bitwise(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n, RT__BitOp op)
+{
+    if (!dst || !a || !b || n == 0) return 0;
+
+#ifdef RT_SIMD_X86
+    const bool avx2 = rt__cpu_has(RT_CPU_AVX2);
+    const bool popcnt = rt__cpu_has(RT_CPU_POPCNT);
+#endif // RT_SIMD_X86
+
+    switch (op) {
+    RT__BITWISE_CASE(RT__BIT_AND, and)
+    RT__BITWISE_CASE(RT__BIT_OR, or)
+    RT__BITWISE_CASE(RT__BIT_XOR, xor)
+    RT__BITWISE_CASE(RT__BIT_ANDNOT, andnot)
+    }
+
+    return 0;
+}
+
+size_t rt__simd_popcount(const uint64_t *words, size_t n)
+{
+    if (!words || n == 0) return 0;
+
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_AVX2)) return rt__popcount_avx2(words, n);
+    if (rt__cpu_has(RT_CPU_POPCNT)) return rt__popcount_popcnt(words, 0, n);
+#endif // RT_SIMD_X86
+
+    return rt__popcount_scalar(words, 0, n);
+}
+
+/* Buffer comparison */
+static size_t rt__find_diff_scalar(const uint8_t *a, const uint8_t *b, size_t n, size_t from, bool same)
+{
+    size_t i = from;
+    if (!same) {
+        for (; i + 8 <= n; i += 8) {
+            uint64_t x, y;
+            memcpy(&x, a + i, 8);
+            memcpy(&y, b + i, 8);
+            if (x != y) break;
+        }
+    }
+    for (; i < n; ++i) {
+        if ((a[i] == b[i]) == same) return i;
+    }
+    return n;
+}
+
+#ifdef RT_SIMD_X86
+RT_TARGET_SSE2 static size_t rt__find_diff_sse2(const uint8_t *a, const uint8_t *b, size_t n, size_t from, bool same)
+{
+    const uint32_t flip = same ? 0 : 0xFFFFFFFFu;
+    size_t i = from;
+    for (; i + 32 <= n; i += 32) {
+        const __m128i e0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        const __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i + 16)), _mm_loadu_si128((const __m128i*)(b + i + 16)));
+        const uint32_t m = ((uint32_t)_mm_movemask_epi8(e0) | (uint32_t)_mm_movemask_epi8(e1) << 16) ^ flip;
+        if (m) return i + rt__ctz32(m);
+    }
+    return rt__find_diff_scalar(a, b, n, i, same);
+}
+
+RT_TARGET_AVX2 static size_t rt__find_diff_avx2(const uint8_t *a, const uint8_t *b, size_t n, size_t from, bool same)
+{
+    const uint64_t flip = same ? 0 : ~(uint64_t)0;
+    size_t i = from;
+    for (; i + 64 <= n; i += 64) {
+        const __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)));
+        const __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i + 32)), _mm256_loadu_si256((const __m256i*)(b + i + 32)));
+        const uint64_t m = ((uint64_t)(uint32_t)_mm256_movemask_epi8(e0) |
+                            (uint64_t)(uint32_t)_mm256_movemask_epi8(e1) << 32) ^ flip;
+        if (m) return i + rt__ctz64(m);
+    }
+    return rt__find_diff_sse2(a, b, n, i, same);
+}
+#endif // RT_SIMD_X86
+
+size_t rt__simd_find_diff(const void *a, const void *b, size_t n, size_t from, bool same)
+{
+    if (!a || !b || from >= n) return n;
+
+#ifdef RT_SIMD_X86
+    if (rt__cpu_has(RT_CPU_AVX2)) return rt__find_diff_avx2(a, b, n, from, same);
+    if (rt__cpu_has(RT_CPU_SSE2)) return rt__find_diff_sse2(a, b, n, from, same);
+#endif // RT_SIMD_X86
+
+    return rt__find_diff_scalar(a, b, n, from, same);
+}
@@ -0,0 +1,112 @@
+#ifndef _INC_RT_SIMD
+#define _INC_RT_SIMD
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "rt_collections.h"
+
+/* SIMD helpers & kernels
+ * Kernels are compiled for SSE2/AVX2 with per-function target attributes and
+ * picked at runtime by rt__cpu_has(), so the library itself keeps building
+ * with plain -O2. Everything falls back to scalar code elsewhere. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define RT_SIMD_X86 1
+#   define RT_TARGET_SSE2 __attribute__((target("sse2")))
+#   define RT_TARGET_SSE42 __attribute__((target("sse4.2")))
+#   define RT_TARGET_AVX2 __attribute__((target("avx2")))
+#   define RT_TARGET_POPCNT __attribute__((target("popcnt")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   define RT_SIMD_X86 1
+#   define RT_TARGET_SSE2
+#   define RT_TARGET_SSE42
+#   define RT_TARGET_AVX2
+#   define RT_TARGET_POPCNT
+#endif
+
+#ifdef RT_SIMD_X86
+#   include <immintrin.h>
+#endif // RT_SIMD_X86
+
+#define RT_CPU_SSE2   (1u << 0)
+#define RT_CPU_SSE41  (1u << 1)
+#define RT_CPU_SSE42  (1u << 2)
+#define RT_CPU_POPCNT (1u << 3)
+#define RT_CPU_AVX2   (1u << 4)
+
+unsigned rt__cpu_features(void);
+
+static inline bool rt__cpu_has(unsigned features)
+{
+    return (rt__cpu_features() & features) == features;
+}
+
+static inline unsigned rt__ctz32(uint32_t x)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctz(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1u)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+static inline unsigned rt__ctz64(uint64_t x)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    return (uint32_t)x ? rt__ctz32((uint32_t)x) : 32 + rt__ctz32((uint32_t)(x >> 32));
+#endif
+}
+
+static inline unsigned rt__popcount32(uint32_t x)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    return (((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+}
+
+static inline unsigned rt__popcount64(uint64_t x)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_popcountll(x);
+#else
+    return rt__popcount32((uint32_t)x) + rt__popcount32((uint32_t)(x >> 32));
+#endif
+}
+
+/* Equality search over `n` elements of `esize` bytes, compared bytewise.
+ * find returns the first index >= from, or n if there is none. */
+size_t rt__simd_find_eq(const void *data, size_t n, size_t esize, const void *key, size_t from);
+size_t rt__simd_count_eq(const void *data, size_t n, size_t esize, const void *key);
+bool rt__simd_minmax(const void *data, size_t n, RT_ElemType type, void *min_out, void *max_out);
+
+/* In-place stream compaction: drops the elements for which `elem op key`
+ * holds, keeps the order of the rest and returns how many are left. */
+size_t rt__simd_compact(void *data, size_t n, RT_ElemType type, RT_CmpOp op, const void *key);
+
+/* Word-wise set operations over bit arrays */
+typedef enum _RT__BitOp {
+    RT__BIT_AND,
+    RT__BIT_OR,
+    RT__BIT_XOR,
+    RT__BIT_ANDNOT // a & ~b
+} RT__BitOp;
+
+/* dst[i] = a[i] op b[i] for `n` words, dst may alias a or b. Returns the
+ * number of bits set in the result, counted in the same pass. */
+size_t rt__simd_bitwise(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n, RT__BitOp op);
+size_t rt__simd_popcount(const uint64_t *words, size_t n);
+
+/* Byte-wise comparison of two buffers of `n` bytes: the first index >= from
+ * where a and b differ (or agree, with `same`), n if there is none. */
+size_t rt__simd_find_diff(const void *a, const void *b, size_t n, size_t from, bool same);
+
+#endif // _INC_RT_SIMD
@@ -0,0 +1,609 @@
+#include "rt_sort.h"
+#include "rt_thread.h"
+
+#define RT__SORT_INSERTION_THRESHOLD 24
+#define RT__SORT_NINTHER_THRESHOLD 128
+#define RT__SORT_PARTIAL_INSERTION_LIMIT 8
+#define RT__SORT_RUN 32
+
+static inline void rt__sort_swap(char *a, char *b, size_t es)
+{
+    unsigned char t[64];
+    while (es > sizeof(t)) {
+        memcpy(t, a, sizeof(t));
+        memcpy(a, b, sizeof(t));
+        memcpy(b, t, sizeof(t));
+        a += sizeof(t);
+        b += sizeof(t);
+        es -= sizeof(t);
+    }
+    memcpy(t, a, es);
+    memcpy(a, b, es);
+    memcpy(b, t, es);
+}
+
+static inline int rt__sort_log2(size_t n)
+{
+    int log = 0;
+    while (n >>= 1) log++;
+    return log;
+}
+
+/* Sort kernels, instantiated once per element width. `ES` is either a
+ * constant (so element moves compile down to plain loads/stores) or the
+ * runtime `esize` argument for the generic version. */
+#define RT__DEFINE_SORT(sfx, ES)                                                      \
+static void rt__insertion_sort_##sfx(char *begin, char *end, size_t esize, RT_CompareFunc cmp) \
+{                                                                                     \
+    (void)esize;                                                                      \
+    if (begin == end) return;                                                         \
+    for (char *cur = begin + (ES); cur != end; cur += (ES)) {                         \
+        for (char *s = cur; s != begin && cmp(s, s - (ES)) < 0; s -= (ES)) {          \
+            rt__sort_swap(s, s - (ES), (ES));                                         \
+        }                                                                             \
+    }                                                                                 \
+}                                                                                     \
+                                                                                      \
+static bool rt__partial_insertion_sort_##sfx(char *begin, char *end, size_t esize, RT_CompareFunc cmp) \
+{                                                                                     \
+    (void)esize;                                                                      \
+    if (begin == end) return true;                                                    \
+    size_t moves = 0;                                                                 \
+    for (char *cur = begin + (ES); cur != end; cur += (ES)) {                         \
+        if (moves > RT__SORT_PARTIAL_INSERTION_LIMIT) return false;                   \
+        char *s = cur;                                                                \
+        while (s != begin && cmp(s, s - (ES)) < 0) {                                  \
+            rt__sort_swap(s, s - (ES), (ES));                                         \
+            s -= (ES);                                                                \
+        }                                                                             \
+        moves += (size_t)(cur - s) / (ES);                                            \
+    }                                                                                 \
+    return true;                                                                      \
+}                                                                                     \
+                                                                                      \
+static inline void rt__sort2_##sfx(char *a, char *b, size_t esize, RT_CompareFunc cmp) \
+{                                                                                     \
+    (void)esize;                                                                      \
+    if (cmp(b, a) < 0) rt__sort_swap(a, b, (ES));                                     \
+}                                                                                     \
+                                                                                      \
+static inline void rt__sort3_##sfx(char *a, char *b, char *c, size_t esize, RT_CompareFunc cmp) \
+{                                                                                     \
+    rt__sort2_##sfx(a, b, esize, cmp);                                                \
+    rt__sort2_##sfx(b, c, esize, cmp);                                                \
+    rt__sort2_##sfx(a, b, esize, cmp);                                                \
+}                                                                                     \
+                                                                                      \
+/* The pivot stays at *begin while partitioning and is swapped into place last. */   \
+static char *rt__partition_right_##sfx(char *begin, char *end, size_t esize,          \
+    RT_CompareFunc cmp, bool *already_partitioned)                                    \
+{                                                                                     \
+    (void)esize;                                                                      \
+    char *first = begin, *last = end;                                                 \
+    while (cmp((first += (ES)), begin) < 0);                                          \
+    if (first - (ES) == begin) {                                                      \
+        while (first < last && !(cmp((last -= (ES)), begin) < 0));                    \
+    } else {                                                                          \
+        while (!(cmp((last -= (ES)), begin) < 0));                                    \
+    }                                                                                 \
+    *already_partitioned = first >= last;                                             \
+    while (first < last) {                                                            \
+        rt__sort_swap(first, last, (ES));                                             \
+        while (cmp((first += (ES)), begin) < 0);                                      \
+        while (!(cmp((last -= (ES)), begin) < 0));                                    \
+    }                                                                                 \
+    char *pivot_pos = first - (ES);                                                   \
+    if (pivot_pos != begin) rt__sort_swap(begin, pivot_pos, (ES));                    \
+    return pivot_pos;                                                                 \
+}                                                                                     \
+                                                                                      \
+static char *rt__partition_left_##sfx(char *begin, char *end, size_t esize, RT_CompareFunc cmp) \
+{                                                                                     \
+    (void)esize;                                                                      \
+    char *first = begin, *last = end;                                                 \
+    while (cmp(begin, (last -= (ES))) < 0);                                           \
+    if (last + (ES) == end) {                                                         \
+        while (first < last && !(cmp(begin, (first += (ES))) < 0));                   \
+    } else {                                                                          \
+        while (!(cmp(begin, (first += (ES))) < 0));                                   \
+    }                                                                                 \
+    while (first < last) {                                                            \
+        rt__sort_swap(first, last, (ES));                                             \
+        while (cmp(begin, (last -= (ES))) < 0);                                       \
+        while (!(cmp(begin, (first += (ES))) < 0));                                   \
+    }                                                                                 \
+    if (last != begin) rt__sort_swap(begin, last, (ES));                              \
+    return last;                                                                      \
+}                                                                                     \
+                                                                                      \
+static void rt__heap_sift_##sfx(char *base, size_t root, size_t n, size_t esize, RT_CompareFunc cmp) \
+{                                                                                     \
+    (void)esize;                                                                      \
+    for (;;) {                                                                        \
+        size_t child = 2 * root + 1;                                                  \
+        if (child >= n) break;                                                        \
+        if (child + 1 < n && cmp(base + child * (ES), base + (child + 1) * (ES)) < 0) child++; \
+        if (!(cmp(base + root * (ES), base + child * (ES)) < 0)) break;               \
+        rt__sort_swap(base + root * (ES), base + child * (ES), (ES));                 \
+        root = child;                                                                 \
+    }                                                                                 \
+}                                                                                     \
+                                                                                      \
+static void rt__heapsort_##sfx(char *begin, char *end, size_t esize, RT_CompareFunc cmp) \
+{                                                                                     \
+    size_t n = (size_t)(end - begin) / (ES);                                          \
+    for (size_t i = n / 2; i-- > 0;) rt__heap_sift_##sfx(begin, i, n, esize, cmp);    \
+    for (size_t i = n; i-- > 1;) {                                                    \
+        rt__sort_swap(begin, begin + i * (ES), (ES));                                 \
+        rt__heap_sift_##sfx(begin, 0, i, esize, cmp);                                 \
+    }                                                                                 \
+}                                                                                     \
+                                                                                      \
+static void rt__pdqsort_##sfx(char *begin, char *end, size_t esize, RT_CompareFunc cmp, \
+    int bad_allowed, bool leftmost)                                                   \
+{                                                                                     \
+    for (;;) {                                                                        \
+        size_t size = (size_t)(end - begin) / (ES);                                   \
+        if (size < RT__SORT_INSERTION_THRESHOLD) {                                    \
+            rt__insertion_sort_##sfx(begin, end, esize, cmp);                         \
+            return;                                                                   \
+        }                                                                             \
+                                                                                      \
+        size_t s2 = size / 2;                                                         \
+        if (size > RT__SORT_NINTHER_THRESHOLD) {                                      \
+            rt__sort3_##sfx(begin, begin + s2 * (ES), end - (ES), esize, cmp);        \
+            rt__sort3_##sfx(begin + (ES), begin + (s2 - 1) * (ES), end - 2 * (ES), esize, cmp); \
+            rt__sort3_##sfx(begin + 2 * (ES), begin + (s2 + 1) * (ES), end - 3 * (ES), esize, cmp); \
+            rt__sort3_##sfx(begin + (s2 - 1) * (ES), begin + s2 * (ES), begin + (s2 + 1) * (ES), esize, cmp); \
+            rt__sort_swap(begin, begin + s2 * (ES), (ES));                            \
+        } else {                                                                      \
+            rt__sort3_##sfx(begin + s2 * (ES), begin, end - (ES), esize, cmp);        \
+        }                                                                             \
+                                                                                      \
+        /* equal to the element before this range: put all equal keys left, skip them */ \
+        if (!leftmost && !(cmp(begin - (ES), begin) < 0)) {                           \
+            begin = rt__partition_left_##sfx(begin, end, esize, cmp) + (ES);          \
+            continue;                                                                 \
+        }                                                                             \
+                                                                                      \
+        bool already_partitioned;                                                     \
+        char *pivot = rt__partition_right_##sfx(begin, end, esize, cmp, &already_partitioned); \
+        size_t l_size = (size_t)(pivot - begin) / (ES);                               \
+        size_t r_size = (size_t)(end - (pivot + (ES))) / (ES);                        \
+                                                                                      \
+        if (l_size < size / 8 || r_size < size / 8) {                                 \
+            if (--bad_allowed == 0) {                                                 \
+                rt__heapsort_##sfx(begin, end, esize, cmp);                           \
+                return;                                                               \
+            }                                                                         \
+            /* break up patterns that keep producing bad partitions */                \
+            if (l_size >= RT__SORT_INSERTION_THRESHOLD) {                             \
+                rt__sort_swap(begin, begin + (l_size / 4) * (ES), (ES));              \
+                rt__sort_swap(pivot - (ES), pivot - (l_size / 4) * (ES), (ES));       \
+                if (l_size > RT__SORT_NINTHER_THRESHOLD) {                            \
+                    rt__sort_swap(begin + (ES), begin + (l_size / 4 + 1) * (ES), (ES)); \
+                    rt__sort_swap(begin + 2 * (ES), begin + (l_size / 4 + 2) * (ES), (ES)); \
+                    rt__sort_swap(pivot - 2 * (ES), pivot - (l_size / 4 + 1) * (ES), (ES)); \
+                    rt__sort_swap(pivot - 3 * (ES), pivot - (l_size / 4 + 2) * (ES), (ES)); \
+                }                                                                     \
+            }                                                                         \
+            if (r_size >= RT__SORT_INSERTION_THRESHOLD) {                             \
+                rt__sort_swap(pivot + (ES), pivot + (1 + r_size / 4) * (ES), (ES));   \
+                rt__sort_swap(end - (ES), end - (r_size / 4) * (ES), (ES));           \
+                if (r_size > RT__SORT_NINTHER_THRESHOLD) {                            \
+                    rt__sort_swap(pivot + 2 * (ES), pivot + (2 + r_size / 4) * (ES), (ES)); \
+                    rt__sort_swap(pivot + 3 * (ES), pivot + (3 + r_size / 4) * (ES), (ES)); \
+                    rt__sort_swap(end - 2 * (ES), end - (1 + r_size / 4) * (ES), (ES)); \
+                    rt__sort_swap(end - 3 * (ES), end - (2 + r_size / 4) * (ES), (ES)); \
+                }                                                                     \
+            }                                                                         \
+        } else if (already_partitioned                                                \
+            && rt__partial_insertion_sort_##sfx(begin, pivot, esize, cmp)             \
+            && rt__partial_insertion_sort_##sfx(pivot + (ES), end, esize, cmp)) {     \
+            return;                                                                   \
+        }                                                                             \
+                                                                                      \
+        /* recurse into the smaller side, loop on the bigger one */                   \
+        if (l_size < r_size) {                                                        \
+            rt__pdqsort_##sfx(begin, pivot, esize, cmp, bad_allowed, leftmost);       \
+            begin = pivot + (ES);                                                     \
+            leftmost = false;                                                         \
+        } else {                                                                      \
+            rt__pdqsort_##sfx(pivot + (ES), end, esize, cmp, bad_allowed, false);     \
+            end = pivot;                                                              \
+        }                                                                             \
+    }                                                                                 \
+}                                                                                     \
+                                                                                      \
+static void rt__merge_##sfx(const char *a, size_t na, const char *b, size_t nb,       \
+    char *out, size_t esize, RT_CompareFunc cmp)                                      \
+{                                                                                     \
+    (void)esize;                                                                      \
+    const char *ae = a + na * (ES), *be = b + nb * (ES);                              \
+    while (a < ae && b < be) {                                                        \
+        if (cmp(b, a) < 0) {                                                          \
+            memcpy(out, b, (ES));                                                     \
+            b += (ES);                                                                \
+        } else {                                                                      \
+            memcpy(out, a, (ES));                                                     \
+            a += (ES);                                                                \
+        }                                                                             \
+        out += (ES);                                                                  \
+    }                                                                                 \
+    memcpy(out, a, (size_t)(ae - a));                                                 \
+    memcpy(out + (ae - a), b, (size_t)(be - b));                                      \
+}                                                                                     \
+                                                                                      \
+static void rt__merge_sort_##sfx(char *data, size_t n, char *tmp, size_t esize, RT_CompareFunc cmp) \
+{                                                                                     \
+    for (size_t i = 0; i < n; i += RT__SORT_RUN) {                                    \
+        size_t hi = i + RT__SORT_RUN < n ? i + RT__SORT_RUN : n;                      \
+        rt__insertion_sort_##sfx(data + i * (ES), data + hi * (ES), esize, cmp);      \
+    }                                                                                 \
+    char *src = data, *dst = tmp;                                                     \
+    for (size_t w = RT__SORT_RUN; w < n; w *= 2) {                                    \
+        for (size_t i = 0; i < n; i += 2 * w) {                                       \
+            size_t mid = i + w < n ? i + w : n;                                       \
+            size_t hi = i + 2 * w < n ? i + 2 * w : n;                                \
+            if (mid == hi || !(cmp(src + mid * (ES), src + (mid - 1) * (ES)) < 0)) {  \
+                memcpy(dst + i * (ES), src + i * (ES), (hi - i) * (ES));              \
+            } else {                                                                  \
+                rt__merge_##sfx(src + i * (ES), mid - i, src + mid * (ES), hi - mid,  \
+                    dst + i * (ES), esize, cmp);                                      \
+            }                                                                         \
+        }                                                                             \
+        char *t = src; src = dst; dst = t;                                            \
+    }                                                                                 \
+    if (src != data) memcpy(data, src, n * (ES));                                     \
+}
+
+RT__DEFINE_SORT(4, 4)
+RT__DEFINE_SORT(8, 8)
+RT__DEFINE_SORT(16, 16)
+RT__DEFINE_SORT(generic, esize)
+
+typedef struct _RT__SortOps {
+    void (*pdqsort)(char *begin, char *end, size_t esize, RT_CompareFunc cmp, int bad_allowed, bool leftmost);
+    void (*merge_sort)(char *data, size_t n, char *tmp, size_t esize, RT_CompareFunc cmp);
+    void (*merge)(const char *a, size_t na, const char *b, size_t nb, char *out, size_t esize, RT_CompareFunc cmp);
+} RT__SortOps;
+
+static const RT__SortOps rt__sort_ops_table[] = {
+    { rt__pdqsort_4, rt__merge_sort_4, rt__merge_4 },
+    { rt__pdqsort_8, rt__merge_sort_8, rt__merge_8 },
+    { rt__pdqsort_16, rt__merge_sort_16, rt__merge_16 },
+    { rt__pdqsort_generic, rt__merge_sort_generic, rt__merge_generic },
+};
+
+static const RT__SortOps *rt__sort_ops(size_t esize)
+{
+    switch (esize) {
+    case 4: return &rt__sort_ops_table[0];
+    case 8: return &rt__sort_ops_table[1];
+    case 16: return &rt__sort_ops_table[2];
+    default: return &rt__sort_ops_table[3];
+    }
+}
+
+bool rt_sort(void *data, size_t count, size_t elem_size, RT_CompareFunc cmp)
+{
+    if (!data || elem_size == 0 || !cmp) return false;
+    if (count < 2) return true;
+
+    char *begin = data;
+    rt__sort_ops(elem_size)->pdqsort(begin, begin + count * elem_size, elem_size, cmp,
+        rt__sort_log2(count), true);
+
+    return true;
+}
+
+bool rt_sort_stable(void *data, size_t count, size_t elem_size, RT_CompareFunc cmp)
+{
+    if (!data || elem_size == 0 || !cmp) return false;
+    if (count < 2) return true;
+    if (count > SIZE_MAX / elem_size) return false;
+
+    char *tmp = RT_MALLOC(count * elem_size);
+    if (!tmp) return false;
+
+    rt__sort_ops(elem_size)->merge_sort(data, count, tmp, elem_size, cmp);
+
+    RT_FREE(tmp);
+    return true;
+}
+
+/* Parallel merge sort */
+typedef struct _RT__SortTask {
+    const RT__SortOps *ops;
+    RT_CompareFunc cmp;
+    size_t esize;
+    char *data; // sort: range to sort, tmp is the matching scratch range
+    char *tmp;
+    size_t n;
+    const char *a; // merge: a[0..na) + b[0..nb) -> out
+    const char *b;
+    size_t na;
+    size_t nb;
+    char *out;
+} RT__SortTask;
+
+static DWORD rt__sort_chunk_worker(void *param)
+{
+    RT__SortTask *t = param;
+    t->ops->merge_sort(t->data, t->n, t->tmp, t->esize, t->cmp);
+    return 0;
+}
+
+static DWORD rt__sort_merge_worker(void *param)
+{
+    RT__SortTask *t = param;
+    t->ops->merge(t->a, t->na, t->b, t->nb, t->out, t->esize, t->cmp);
+    return 0;
+}
+
+/* Number of elements taken from `a` among the first k merged outputs,
+ * ties going to `a` so the merge stays stable. */
+static size_t rt__sort_corank(size_t k, const char *a, size_t na, const char *b, size_t nb,
+    size_t es, RT_CompareFunc cmp)
+{
+    size_t lo = k > nb ? k - nb : 0;
+    size_t hi = k < na ? k : na;
+
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        size_t j = k - i;
+        if (j > 0 && i < na && !(cmp(b + (j - 1) * es, a + i * es) < 0)) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+
+    return lo;
+}
+
+bool rt_sort_parallel(void *data, size_t count, size_t elem_size, RT_CompareFunc cmp, size_t threads)
+{
+    if (!data || elem_size == 0 || !cmp) return false;
+
+    if (threads == 0) {
+        threads = rt_thread_cpu_count();
+    }
+    if (threads > RT_SORT_MAX_THREADS) threads = RT_SORT_MAX_THREADS;
+    if (threads < 2 || count < RT_SORT_PARALLEL_MIN) return rt_sort_stable(data, count, elem_size, cmp);
+    if (count > SIZE_MAX / elem_size) return false;
+
+    char *tmp = RT_MALLOC(count * elem_size);
+    if (!tmp) return false;
+
+    const RT__SortOps *ops = rt__sort_ops(elem_size);
+    const RT__SortTask proto = { .ops = ops, .cmp = cmp, .esize = elem_size };
+    RT__SortTask tasks[RT_SORT_MAX_THREADS + 1];
+    size_t bounds[RT_SORT_MAX_THREADS + 1];
+    size_t runs = threads;
+
+    for (size_t i = 0; i <= runs; ++i) bounds[i] = count * i / runs;
+
+    for (size_t i = 0; i < runs; ++i) {
+        tasks[i] = proto;
+        tasks[i].data = (char*)data + bounds[i] * elem_size;
+        tasks[i].tmp = tmp + bounds[i] * elem_size;
+        tasks[i].n = bounds[i + 1] - bounds[i];
+    }
+    rt_thread_run_tasks(tasks, sizeof(RT__SortTask), runs, rt__sort_chunk_worker);
+
+    // merge runs pairwise; each pair is cut into equal output slices so all
+    // threads stay busy even in the last rounds
+    char *src = data, *dst = tmp;
+    while (runs > 1) {
+        const size_t pairs = runs / 2;
+        const size_t parts = threads / pairs ? threads / pairs : 1;
+        size_t ntasks = 0;
+
+        for (size_t p = 0; p < pairs; ++p) {
+            const size_t lo = bounds[2 * p], mid = bounds[2 * p + 1], hi = bounds[2 * p + 2];
+            const char *a = src + lo * elem_size, *b = src + mid * elem_size;
+            const size_t na = mid - lo, nb = hi - mid;
+            size_t i0 = 0, k0 = 0;
+
+            for (size_t q = 1; q <= parts; ++q) {
+                size_t k1 = (na + nb) * q / parts;
+                size_t i1 = rt__sort_corank(k1, a, na, b, nb, elem_size, cmp);
+                RT__SortTask *t = &tasks[ntasks++];
+                *t = proto;
+                t->a = a + i0 * elem_size;
+                t->na = i1 - i0;
+                t->b = b + (k0 - i0) * elem_size;
+                t->nb = (k1 - i1) - (k0 - i0);
+                t->out = dst + (lo + k0) * elem_size;
+                i0 = i1;
+                k0 = k1;
+            }
+        }
+        if (runs & 1) { // odd run out, carried over as is
+            const size_t lo = bounds[runs - 1], hi = bounds[runs];
+            RT__SortTask *t = &tasks[ntasks++];
+            *t = proto;
+            t->a = src + lo * elem_size;
+            t->na = hi - lo;
+            t->b = NULL;
+            t->nb = 0;
+            t->out = dst + lo * elem_size;
+        }
+
+        rt_thread_run_tasks(tasks, sizeof(RT__SortTask), ntasks, rt__sort_merge_worker);
+
+        for (size_t p = 0; p < pairs; ++p) bounds[p + 1] = bounds[2 * p + 2];
+        if (runs & 1) bounds[pairs + 1] = bounds[runs];
+        runs = (runs + 1) / 2;
+
+        char *t = src; src = dst; dst = t;
+    }
+
+    if (src != data) memcpy(data, src, count * elem_size);
+
+    RT_FREE(tmp);
+    return true;
+}
+
+/* LSD radix sort */
+#define RT__SIGN32 0x80000000u
+#define RT__SIGN64 0x8000000000000000ull
+
+static inline uint64_t rt__radix_key(const void *p, RT_ElemType type)
+{
+    switch (type) {
+    case RT_ELEM_I8: { uint8_t v; memcpy(&v, p, 1); return (uint8_t)(v ^ 0x80u); }
+    case RT_ELEM_U8: { uint8_t v; memcpy(&v, p, 1); return v; }
+    case RT_ELEM_I16: { uint16_t v; memcpy(&v, p, 2); return (uint16_t)(v ^ 0x8000u); }
+    case RT_ELEM_U16: { uint16_t v; memcpy(&v, p, 2); return v; }
+    case RT_ELEM_I32: { uint32_t v; memcpy(&v, p, 4); return v ^ RT__SIGN32; }
+    case RT_ELEM_U32: { uint32_t v; memcpy(&v, p, 4); return v; }
+    case RT_ELEM_I64: { uint64_t v; memcpy(&v, p, 8); return v ^ RT__SIGN64; }
+    case RT_ELEM_U64: { uint64_t v; memcpy(&v, p, 8); return v; }
+    case RT_ELEM_F32: { uint32_t v; memcpy(&v, p, 4); return (v & RT__SIGN32) ? ~v : v ^ RT__SIGN32; }
+    case RT_ELEM_F64: { uint64_t v; memcpy(&v, p, 8); return (v & RT__SIGN64) ? ~v : v ^ RT__SIGN64; }
+    }
+    return 0;
+}
+
+/* Keys are the elements themselves: sort them as unsigned integers in place */
+#define RT__DEFINE_RADIX(bits)                                                        \
+static void rt__radix_sort_u##bits(uint##bits##_t *data, size_t n, uint##bits##_t *tmp) \
+{                                                                                     \
+    enum { W = bits / 8 };                                                            \
+    size_t counts[W][256];                                                            \
+    memset(counts, 0, sizeof(counts));                                                \
+    for (size_t i = 0; i < n; ++i) {                                                  \
+        uint##bits##_t v = data[i];                                                   \
+        for (int b = 0; b < W; ++b) counts[b][(v >> (8 * b)) & 0xFF]++;               \
+    }                                                                                 \
+    uint##bits##_t *src = data, *dst = tmp;                                           \
+    for (int b = 0; b < W; ++b) {                                                     \
+        size_t *c = counts[b];                                                        \
+        if (c[(src[0] >> (8 * b)) & 0xFF] == n) continue; /* all share this byte */   \
+        size_t sum = 0;                                                               \
+        for (int d = 0; d < 256; ++d) {                                               \
+            size_t t = c[d];                                                          \
+            c[d] = sum;                                                               \
+            sum += t;                                                                 \
+        }                                                                             \
+        for (size_t i = 0; i < n; ++i) {                                              \
+            uint##bits##_t v = src[i];                                                \
+            dst[c[(v >> (8 * b)) & 0xFF]++] = v;                                      \
+        }                                                                             \
+        uint##bits##_t *t = src; src = dst; dst = t;                                  \
+    }                                                                                 \
+    if (src != data) memcpy(data, src, n * sizeof(*data));                            \
+}
+
+RT__DEFINE_RADIX(8)
+RT__DEFINE_RADIX(16)
+RT__DEFINE_RADIX(32)
+RT__DEFINE_RADIX(64)
+
+/* Map values to/from an unsigned order in place (the mapping for integers is its own inverse) */
+static void rt__radix_map(void *data, size_t n, RT_ElemType type, bool inverse)
+{
+    switch (type) {
+    case RT_ELEM_I8: for (size_t i = 0; i < n; ++i) ((uint8_t*)data)[i] ^= 0x80u; break;
+    case RT_ELEM_I16: for (size_t i = 0; i < n; ++i) ((uint16_t*)data)[i] ^= 0x8000u; break;
+    case RT_ELEM_I32: for (size_t i = 0; i < n; ++i) ((uint32_t*)data)[i] ^= RT__SIGN32; break;
+    case RT_ELEM_I64: for (size_t i = 0; i < n; ++i) ((uint64_t*)data)[i] ^= RT__SIGN64; break;
+    case RT_ELEM_F32:
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t v = ((uint32_t*)data)[i];
+            if (inverse) ((uint32_t*)data)[i] = (v & RT__SIGN32) ? v ^ RT__SIGN32 : ~v;
+            else ((uint32_t*)data)[i] = (v & RT__SIGN32) ? ~v : v ^ RT__SIGN32;
+        }
+        break;
+    case RT_ELEM_F64:
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t v = ((uint64_t*)data)[i];
+            if (inverse) ((uint64_t*)data)[i] = (v & RT__SIGN64) ? v ^ RT__SIGN64 : ~v;
+            else ((uint64_t*)data)[i] = (v & RT__SIGN64) ? ~v : v ^ RT__SIGN64;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+typedef struct _RT__RadixPair {
+    uint64_t key;
+    size_t index;
+} RT__RadixPair;
+
+static bool rt__radix_sort_pairs(char *data, size_t n, size_t es, const RT_SortKey *key, size_t key_bytes)
+{
+    RT__RadixPair *pairs = RT_MALLOC(2 * n * sizeof(RT__RadixPair));
+    if (!pairs) return false;
+
+    RT__RadixPair *src = pairs, *dst = pairs + n;
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts));
+
+    for (size_t i = 0; i < n; ++i) {
+        const char *e = data + i * es;
+        uint64_t k = key->extract ? key->extract(e) : rt__radix_key(e + key->offset, key->type);
+        src[i].key = k;
+        src[i].index = i;
+        for (size_t b = 0; b < key_bytes; ++b) counts[b][(k >> (8 * b)) & 0xFF]++;
+    }
+
+    for (size_t b = 0; b < key_bytes; ++b) {
+        size_t *c = counts[b];
+        if (c[(src[0].key >> (8 * b)) & 0xFF] == n) continue;
+        size_t sum = 0;
+        for (int d = 0; d < 256; ++d) {
+            size_t t = c[d];
+            c[d] = sum;
+            sum += t;
+        }
+        for (size_t i = 0; i < n; ++i) dst[c[(src[i].key >> (8 * b)) & 0xFF]++] = src[i];
+        RT__RadixPair *t = src; src = dst; dst = t;
+    }
+
+    // apply the permutation through a scratch copy of the elements
+    char *tmp = RT_MALLOC(n * es);
+    if (!tmp) {
+        RT_FREE(pairs);
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i) memcpy(tmp + i * es, data + src[i].index * es, es);
+    memcpy(data, tmp, n * es);
+
+    RT_FREE(tmp);
+    RT_FREE(pairs);
+    return true;
+}
+
+bool rt_sort_radix(void *data, size_t count, size_t elem_size, const RT_SortKey *key)
+{
+    if (!data || elem_size == 0 || !key) return false;
+
+    const size_t key_bytes = key->extract ? 8 : rt_elem_type_size(key->type);
+    if (key_bytes == 0) return false;
+    if (!key->extract && (key->offset > elem_size || key_bytes > elem_size - key->offset)) return false;
+    if (count < 2) return true;
+    if (count > SIZE_MAX / elem_size / 2) return false;
+
+    if (key->extract || key->offset != 0 || key_bytes != elem_size) {
+        return rt__radix_sort_pairs(data, count, elem_size, key, key_bytes);
+    }
+
+    void *tmp = RT_MALLOC(count * elem_size);
+    if (!tmp) return false;
+
+    rt__radix_map(data, count, key->type, false);
+    switch (elem_size) {
+    case 1: rt__radix_sort_u8(data, count, tmp); break;
+    case 2: rt__radix_sort_u16(data, count, tmp); break;
+    case 4: rt__radix_sort_u32(data, count, tmp); break;
+    case 8: rt__radix_sort_u64(data, count, tmp); break;
+    }
+    rt__radix_map(data, count, key->type, true);
+
+    RT_FREE(tmp);
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef _INC_RT_SORT
+#define _INC_RT_SORT
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+
+/* Sorting
+ * rt_sort         - pattern-defeating quicksort, in place, not stable
+ * rt_sort_stable  - bottom-up merge sort, needs count * elem_size scratch
+ * rt_sort_parallel- stable: chunks are merge sorted on worker threads, then
+ *                   merged pairwise with the work split by merge path
+ * rt_sort_radix   - stable LSD radix sort on an integer/float key
+ * Element moves are specialized for 4, 8 and 16 byte elements. */
+#define RT_SORT_PARALLEL_MIN 0x10000 // below this rt_sort_parallel runs on the caller's thread
+#define RT_SORT_MAX_THREADS 64
+
+/* Radix key: `type` at byte `offset` inside the element. If `extract` is set
+ * it is used instead and must return a key whose unsigned order is the
+ * wanted order. */
+typedef struct _RT_SortKey {
+    RT_ElemType type;
+    size_t offset;
+    uint64_t (*extract)(const void *elem);
+} RT_SortKey;
+
+bool rt_sort(void *data, size_t count, size_t elem_size, RT_CompareFunc cmp);
+bool rt_sort_stable(void *data, size_t count, size_t elem_size, RT_CompareFunc cmp);
+bool rt_sort_parallel(void *data, size_t count, size_t elem_size, RT_CompareFunc cmp, size_t threads);
+bool rt_sort_radix(void *data, size_t count, size_t elem_size, const RT_SortKey *key);
+
+static inline bool rt_array_sort(RT_Array *arr, RT_CompareFunc cmp)
+{
+    return arr && rt_sort(arr->data, arr->size, arr->elem_size, cmp);
+}
+
+static inline bool rt_array_sort_stable(RT_Array *arr, RT_CompareFunc cmp)
+{
+    return arr && rt_sort_stable(arr->data, arr->size, arr->elem_size, cmp);
+}
+
+static inline bool rt_array_sort_parallel(RT_Array *arr, RT_CompareFunc cmp, size_t threads)
+{
+    return arr && rt_sort_parallel(arr->data, arr->size, arr->elem_size, cmp, threads);
+}
+
+static inline bool rt_array_sort_radix(RT_Array *arr, const RT_SortKey *key)
+{
+    return arr && rt_sort_radix(arr->data, arr->size, arr->elem_size, key);
+}
+
+static inline bool rt_darray_sort(RT_DynamicArray *arr, RT_CompareFunc cmp)
+{
+    return arr && rt_sort(arr->data, arr->size, arr->element_size, cmp);
+}
+
+static inline bool rt_darray_sort_stable(RT_DynamicArray *arr, RT_CompareFunc cmp)
+{
+    return arr && rt_sort_stable(arr->data, arr->size, arr->element_size, cmp);
+}
+
+static inline bool rt_darray_sort_parallel(RT_DynamicArray *arr, RT_CompareFunc cmp, size_t threads)
+{
+    return arr && rt_sort_parallel(arr->data, arr->size, arr->element_size, cmp, threads);
+}
+
+static inline bool rt_darray_sort_radix(RT_DynamicArray *arr, const RT_SortKey *key)
+{
+    return arr && rt_sort_radix(arr->data, arr->size, arr->element_size, key);
+}
+
+#endif // _INC_RT_SORT
@@ -0,0 +1,432 @@
+#include <stdarg.h>
+
+#include "rt_stream.h"
+#include "rt_lz.h"
+
+#define RT__FREADER_MAX_CHUNK 0x40000000 // ReadFile takes a DWORD count
+#define RT__FWRITER_MAX_WRITE 0x40000000 // so does WriteFile
+
+/* Streaming file reader */
+static DWORD rt__freader_worker(void *param)
+{
+    RT_FileReader *reader = param;
+
+    EnterCriticalSection(&reader->lock);
+    while (!reader->stop && !reader->eof) {
+        // the buffer the caller holds stays counted in `filled` until handed back
+        if (reader->filled == reader->depth) {
+            SleepConditionVariableCS(&reader->free_cv, &reader->lock, INFINITE);
+            continue;
+        }
+
+        const size_t slot = (reader->head + reader->filled) % reader->depth;
+        LeaveCriticalSection(&reader->lock);
+
+        DWORD got = 0;
+        const BOOL ok = ReadFile(reader->file, reader->buffers + slot * reader->chunk_size,
+                                 (DWORD)reader->chunk_size, &got, NULL);
+        const DWORD error = ok ? 0 : GetLastError();
+
+        EnterCriticalSection(&reader->lock);
+        if (got) {
+            reader->sizes[slot] = got;
+            reader->offsets[slot] = reader->read_offset;
+            reader->read_offset += got;
+            reader->filled++;
+        }
+        if (error) reader->error = error;
+        if (error || got < reader->chunk_size) reader->eof = true;
+        WakeConditionVariable(&reader->filled_cv);
+    }
+    LeaveCriticalSection(&reader->lock);
+
+    return 0;
+}
+
+bool rt_freader_open(RT_FileReader *reader, const char *path, size_t chunk_size, size_t depth, int flags)
+{
+    if (!reader || !path) return false;
+    if (chunk_size == 0) chunk_size = RT_FREADER_CHUNK_SIZE;
+    if (depth == 0) depth = RT_FREADER_DEPTH;
+    if (chunk_size > RT__FREADER_MAX_CHUNK || depth > RT_FREADER_MAX_DEPTH) return false;
+
+    const bool unbuffered = flags & RT_FREADER_UNBUFFERED;
+    if (unbuffered) chunk_size = (chunk_size + RT_FREADER_ALIGN - 1) & ~(size_t)(RT_FREADER_ALIGN - 1);
+
+    memset(reader, 0, sizeof(*reader));
+    reader->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN | (unbuffered ? FILE_FLAG_NO_BUFFERING : 0), NULL);
+    if (reader->file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fsize;
+    if (!GetFileSizeEx(reader->file, &fsize)) goto failure_file;
+
+    // VirtualAlloc's page alignment is what unbuffered reads need
+    reader->buffers = VirtualAlloc(NULL, chunk_size * depth, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!reader->buffers) goto failure_file;
+
+    reader->chunk_size = chunk_size;
+    reader->depth = depth;
+    reader->file_size = (uint64_t)fsize.QuadPart;
+    InitializeCriticalSection(&reader->lock);
+    InitializeConditionVariable(&reader->filled_cv);
+    InitializeConditionVariable(&reader->free_cv);
+
+    if (!rt_thread_create(&reader->worker, reader, rt__freader_worker)) goto failure_thread;
+
+    return true;
+
+    failure_thread:
+        DeleteCriticalSection(&reader->lock);
+        VirtualFree(reader->buffers, 0, MEM_RELEASE);
+        reader->buffers = NULL;
+    failure_file:
+        CloseHandle(reader->file);
+        reader->file = INVALID_HANDLE_VALUE;
+        return false;
+}
+
+void rt_freader_close(RT_FileReader *reader)
+{
+    if (!reader || !reader->buffers) return;
+
+    EnterCriticalSection(&reader->lock);
+    reader->stop = true;
+    WakeConditionVariable(&reader->free_cv);
+    LeaveCriticalSection(&reader->lock);
+
+    rt_thread_join(&reader->worker);
+    DeleteCriticalSection(&reader->lock);
+    CloseHandle(reader->file);
+    VirtualFree(reader->buffers, 0, MEM_RELEASE);
+    reader->file = INVALID_HANDLE_VALUE;
+    reader->buffers = NULL;
+}
+
+bool rt_freader_next(RT_FileReader *reader, RT_FileChunk *chunk)
+{
+    if (!reader || !reader->buffers || !chunk) return false;
+
+    EnterCriticalSection(&reader->lock);
+    if (reader->held) {
+        reader->head = (reader->head + 1) % reader->depth;
+        reader->filled--;
+        reader->held = false;
+        WakeConditionVariable(&reader->free_cv);
+    }
+
+    while (reader->filled == 0 && !reader->eof) {
+        SleepConditionVariableCS(&reader->filled_cv, &reader->lock, INFINITE);
+    }
+
+    const bool available = reader->filled != 0;
+    if (available) {
+        const size_t slot = reader->head;
+        chunk->data = reader->buffers + slot * reader->chunk_size;
+        chunk->size = reader->sizes[slot];
+        chunk->offset = reader->offsets[slot];
+        reader->held = true;
+    }
+    LeaveCriticalSection(&reader->lock);
+
+    return available;
+}
+
+/* Buffered file writer */
+static volatile LONG rt__fwriter_temp_counter;
+
+static bool rt__fwriter_fail(RT_FileWriter *writer, DWORD error)
+{
+    if (!writer->error) writer->error = error ? error : ERROR_WRITE_FAULT;
+    return false;
+}
+
+// straight to the file, in pieces WriteFile can take
+static bool rt__fwriter_send(RT_FileWriter *writer, const uint8_t *data, size_t size)
+{
+    if (size == 0) return true;
+
+    while (size) {
+        const DWORD chunk = (DWORD)(size < RT__FWRITER_MAX_WRITE ? size : RT__FWRITER_MAX_WRITE);
+        DWORD put = 0;
+        if (!WriteFile(writer->file, data, chunk, &put, NULL) || put != chunk) {
+            return rt__fwriter_fail(writer, GetLastError());
+        }
+        data += chunk;
+        size -= chunk;
+        writer->written += chunk;
+    }
+
+    if ((writer->flags & RT_FWRITER_SYNC) && writer->written - writer->synced >= RT_FWRITER_SYNC_INTERVAL) {
+        return rt_fwriter_sync(writer);
+    }
+    return true;
+}
+
+// RT_FWRITER_COMPRESS packs the bytes into frame blocks on the way out
+static bool rt__fwriter_put(RT_FileWriter *writer, const uint8_t *data, size_t size)
+{
+    if (!(writer->flags & RT_FWRITER_COMPRESS)) return rt__fwriter_send(writer, data, size);
+
+    while (size) {
+        const size_t piece = size < writer->capacity ? size : writer->capacity;
+        const size_t packed = rt_lz_frame_blocks(writer->packed, data, piece, RT_LZ_BLOCK_SIZE);
+        if (packed == 0) return rt__fwriter_fail(writer, ERROR_NOT_ENOUGH_MEMORY);
+        if (!rt__fwriter_send(writer, writer->packed, packed)) return false;
+        data += piece;
+        size -= piece;
+    }
+    return true;
+}
+
+static bool rt__fwriter_init(RT_FileWriter *writer, size_t buffer_size)
+{
+    writer->buffer = RT_MALLOC(buffer_size);
+    if (!writer->buffer) return false;
+
+    writer->capacity = buffer_size;
+    return true;
+}
+
+bool rt_fwriter_open(RT_FileWriter *writer, const char *path, size_t buffer_size, int flags)
+{
+    if (!writer || !path) return false;
+    if (buffer_size == 0) {
+        buffer_size = flags & RT_FWRITER_COMPRESS ? RT_FWRITER_COMPRESS_BUFFER_SIZE : RT_FWRITER_BUFFER_SIZE;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    writer->file = INVALID_HANDLE_VALUE;
+    writer->flags = flags;
+    writer->owns_file = true;
+    if (!rt__fwriter_init(writer, buffer_size)) return false;
+
+    if (flags & RT_FWRITER_COMPRESS) {
+        writer->packed = RT_MALLOC(rt_lz_frame_blocks_bound(buffer_size, RT_LZ_BLOCK_SIZE));
+        if (!writer->packed) goto failure;
+    }
+
+    const char *target = path;
+    if (flags & RT_FWRITER_ATOMIC) {
+        // same directory as the target, so the final rename never crosses volumes
+        const size_t len = strlen(path);
+        writer->path = RT_MALLOC(len + 1);
+        writer->temp_path = RT_MALLOC(len + 32);
+        if (!writer->path || !writer->temp_path) goto failure;
+
+        memcpy(writer->path, path, len + 1);
+        snprintf(writer->temp_path, len + 32, "%s.%lx.%lx.tmp", path,
+                 (unsigned long)GetCurrentProcessId(),
+                 (unsigned long)InterlockedIncrement(&rt__fwriter_temp_counter));
+        target = writer->temp_path;
+    }
+
+    writer->file = CreateFileA(target, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (writer->file == INVALID_HANDLE_VALUE) goto failure;
+
+    if (flags & RT_FWRITER_COMPRESS) {
+        uint8_t header[RT_LZ_HEADER_SIZE];
+        rt_lz_frame_header(header, RT_LZ_BLOCK_SIZE);
+        rt__fwriter_send(writer, header, sizeof(header)); // a failure sticks until close
+    }
+
+    return true;
+
+    failure:
+        RT_FREE(writer->buffer);
+        RT_FREE(writer->packed);
+        RT_FREE(writer->path);
+        RT_FREE(writer->temp_path);
+        memset(writer, 0, sizeof(*writer));
+        writer->file = INVALID_HANDLE_VALUE;
+        return false;
+}
+
+bool rt_fwriter_attach(RT_FileWriter *writer, HANDLE file, size_t buffer_size)
+{
+    if (!writer || !file || file == INVALID_HANDLE_VALUE) return false;
+    if (buffer_size == 0) buffer_size = RT_FWRITER_BUFFER_SIZE;
+
+    memset(writer, 0, sizeof(*writer));
+    writer->file = file;
+    if (!rt__fwriter_init(writer, buffer_size)) {
+        writer->file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    return true;
+}
+
+static void rt__fwriter_release(RT_FileWriter *writer)
+{
+    RT_FREE(writer->buffer);
+    RT_FREE(writer->packed);
+    RT_FREE(writer->path);
+    RT_FREE(writer->temp_path);
+    writer->buffer = NULL;
+    writer->packed = NULL;
+    writer->path = NULL;
+    writer->temp_path = NULL;
+    writer->file = INVALID_HANDLE_VALUE;
+    writer->capacity = 0;
+    writer->size = 0;
+}
+
+bool rt_fwriter_close(RT_FileWriter *writer)
+{
+    if (!writer || !writer->buffer) return false;
+
+    if (rt_fwriter_flush(writer) && (writer->flags & RT_FWRITER_COMPRESS)) {
+        uint8_t end[RT_LZ_END_SIZE];
+        rt_lz_frame_end(end);
+        rt__fwriter_send(writer, end, sizeof(end));
+    }
+    if (writer->flags & RT_FWRITER_SYNC) rt_fwriter_sync(writer);
+    if (writer->owns_file && !CloseHandle(writer->file)) rt__fwriter_fail(writer, GetLastError());
+
+    if (writer->temp_path) {
+        const DWORD move = MOVEFILE_REPLACE_EXISTING | (writer->flags & RT_FWRITER_SYNC ? MOVEFILE_WRITE_THROUGH : 0);
+        if (writer->error || !MoveFileExA(writer->temp_path, writer->path, move)) {
+            rt__fwriter_fail(writer, GetLastError());
+            DeleteFileA(writer->temp_path);
+        }
+    }
+
+    const bool ok = writer->error == 0;
+    rt__fwriter_release(writer);
+    return ok;
+}
+
+void rt_fwriter_abort(RT_FileWriter *writer)
+{
+    if (!writer || !writer->buffer) return;
+
+    if (writer->owns_file) CloseHandle(writer->file);
+    if (writer->temp_path) DeleteFileA(writer->temp_path);
+    rt__fwriter_release(writer);
+}
+
+bool rt_fwriter_flush(RT_FileWriter *writer)
+{
+    if (!writer || !writer->buffer || writer->error) return false;
+
+    const size_t size = writer->size;
+    writer->size = 0;
+    return rt__fwriter_put(writer, writer->buffer, size);
+}
+
+bool rt_fwriter_sync(RT_FileWriter *writer)
+{
+    if (!rt_fwriter_flush(writer)) return false;
+    if (!FlushFileBuffers(writer->file)) return rt__fwriter_fail(writer, GetLastError());
+
+    writer->synced = writer->written;
+    return true;
+}
+
+bool rt_fwriter_write(RT_FileWriter *writer, const void *data, size_t size)
+{
+    if (!writer || !writer->buffer || (!data && size) || writer->error) return false;
+
+    const uint8_t *bytes = data;
+    const size_t room = writer->capacity - writer->size;
+    if (size <= room) {
+        memcpy(writer->buffer + writer->size, bytes, size);
+        writer->size += size;
+        return true;
+    }
+
+    // top the buffer up so it goes out full, then either buffer the rest or
+    // send it as is if it would fill the buffer again anyway
+    memcpy(writer->buffer + writer->size, bytes, room);
+    writer->size += room;
+    bytes += room;
+    size -= room;
+    if (!rt_fwriter_flush(writer)) return false;
+
+    if (size >= writer->capacity) return rt__fwriter_put(writer, bytes, size);
+
+    memcpy(writer->buffer, bytes, size);
+    writer->size = size;
+    return true;
+}
+
+uint8_t *rt_fwriter_reserve(RT_FileWriter *writer, size_t size)
+{
+    if (!writer || !writer->buffer || size > writer->capacity || writer->error) return NULL;
+    if (writer->capacity - writer->size < size && !rt_fwriter_flush(writer)) return NULL;
+
+    return writer->buffer + writer->size;
+}
+
+bool rt_fwriter_printf(RT_FileWriter *writer, const char *format, ...)
+{
+    if (!writer || !writer->buffer || !format || writer->error) return false;
+
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf((char*)writer->buffer + writer->size, writer->capacity - writer->size, format, args);
+    va_end(args);
+    if (len < 0) return false;
+
+    // vsnprintf needs room for the terminator it writes
+    if ((size_t)len < writer->capacity - writer->size) {
+        writer->size += (size_t)len;
+        return true;
+    }
+
+    if ((size_t)len < writer->capacity) {
+        if (!rt_fwriter_flush(writer)) return false;
+        va_start(args, format);
+        vsnprintf((char*)writer->buffer, writer->capacity, format, args);
+        va_end(args);
+        writer->size = (size_t)len;
+        return true;
+    }
+
+    char *text = RT_MALLOC((size_t)len + 1);
+    if (!text) return false;
+    va_start(args, format);
+    vsnprintf(text, (size_t)len + 1, format, args);
+    va_end(args);
+
+    const bool ok = rt_fwriter_write(writer, text, (size_t)len);
+    RT_FREE(text);
+    return ok;
+}
+
+bool rt_fwriter_u64(RT_FileWriter *writer, uint64_t value)
+{
+    char digits[20];
+    size_t n = sizeof(digits);
+    do {
+        digits[--n] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    return rt_fwriter_write(writer, digits + n, sizeof(digits) - n);
+}
+
+bool rt_fwriter_i64(RT_FileWriter *writer, int64_t value)
+{
+    if (value >= 0) return rt_fwriter_u64(writer, (uint64_t)value);
+    return rt_fwriter_putc(writer, '-') && rt_fwriter_u64(writer, 0 - (uint64_t)value);
+}
+
+bool rt_fwriter_hex(RT_FileWriter *writer, uint64_t value, int width)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char digits[16];
+    size_t n = sizeof(digits);
+    if (width < 0) width = 0;
+    if (width > 16) width = 16;
+
+    do {
+        digits[--n] = hex[value & 0xF];
+        value >>= 4;
+    } while (value);
+    while (sizeof(digits) - n < (size_t)width) digits[--n] = '0';
+
+    return rt_fwriter_write(writer, digits + n, sizeof(digits) - n);
+}
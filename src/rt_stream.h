@@ -0,0 +1,147 @@
+#ifndef _INC_RT_STREAM
+#define _INC_RT_STREAM
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+#include "rt_thread.h"
+
+/* Streaming file reader
+ * Delivers a file as consecutive fixed-size chunks from a ring of `depth`
+ * buffers. A prefetch thread keeps reading into the free buffers while the
+ * caller works on the chunk it holds, so I/O overlaps with processing and
+ * memory stays at chunk_size * depth whatever the file size. With
+ * RT_FREADER_UNBUFFERED reads bypass the system cache, which keeps a single
+ * pass over a huge file from evicting everything else; the chunk size is
+ * then rounded up to the sector-friendly RT_FREADER_ALIGN. */
+#define RT_FREADER_CHUNK_SIZE 0x100000 // 1mb
+#define RT_FREADER_DEPTH 3
+#define RT_FREADER_MAX_DEPTH 16
+#define RT_FREADER_ALIGN 0x1000
+#define RT_FREADER_UNBUFFERED 0x1
+
+typedef struct _RT_FileChunk {
+    const uint8_t *data;
+    size_t size;
+    uint64_t offset; // of data[0] in the file
+} RT_FileChunk;
+
+typedef struct _RT_FileReader {
+    HANDLE file;
+    uint8_t *buffers;        // depth * chunk_size, page aligned
+    size_t sizes[RT_FREADER_MAX_DEPTH];
+    uint64_t offsets[RT_FREADER_MAX_DEPTH];
+    size_t chunk_size;
+    size_t depth;
+    size_t head;             // oldest filled buffer
+    size_t filled;
+    uint64_t file_size;
+    uint64_t read_offset;    // where the prefetcher reads next
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE filled_cv;
+    CONDITION_VARIABLE free_cv;
+    RT_Thread worker;
+    DWORD error;             // GetLastError() of a failed read, 0 if none
+    bool held;               // the caller holds buffer `head`
+    bool eof;
+    bool stop;
+} RT_FileReader;
+
+/* chunk_size and depth of 0 pick the defaults */
+bool rt_freader_open(RT_FileReader *reader, const char *path, size_t chunk_size, size_t depth, int flags);
+void rt_freader_close(RT_FileReader *reader);
+
+/* Hands out the next chunk, giving back the previous one. Blocks until it is
+ * read; returns false at the end of the file or after a read error. The
+ * chunk stays valid until the next call. */
+bool rt_freader_next(RT_FileReader *reader, RT_FileChunk *chunk);
+
+static inline bool rt_freader_failed(const RT_FileReader *reader)
+{
+    return reader && reader->error != 0;
+}
+
+static inline uint64_t rt_freader_size(const RT_FileReader *reader)
+{
+    return reader ? reader->file_size : 0;
+}
+
+/* Buffered file writer
+ * Collects small writes in a large buffer and hands it to the OS in one
+ * WriteFile once full; writes at least as large as the buffer skip it after
+ * flushing what is pending. Numbers are formatted straight into the buffer,
+ * and rt_fwriter_reserve()/rt_fwriter_commit() let a caller do the same.
+ * Errors are sticky: after the first failed write every call returns false.
+ *   - RT_FWRITER_ATOMIC: output goes to a temporary file next to `path` that
+ *     replaces it on a successful close, so readers never see a partial file
+ *   - RT_FWRITER_SYNC:   the file is flushed to disk every
+ *     RT_FWRITER_SYNC_INTERVAL bytes and on close, before any rename
+ *   - RT_FWRITER_COMPRESS: the file is an rt_lz frame; every flush packs the
+ *     buffer into blocks in parallel, so a larger buffer is the default */
+#define RT_FWRITER_BUFFER_SIZE 0x100000 // 1mb
+#define RT_FWRITER_COMPRESS_BUFFER_SIZE 0x800000 // 8mb
+#define RT_FWRITER_SYNC_INTERVAL 0x4000000 // 64mb
+#define RT_FWRITER_ATOMIC   0x1
+#define RT_FWRITER_SYNC     0x2
+#define RT_FWRITER_COMPRESS 0x4
+
+typedef struct _RT_FileWriter {
+    HANDLE file;
+    uint8_t *buffer;
+    size_t capacity;
+    size_t size;
+    uint64_t written;     // bytes handed to the OS
+    uint64_t synced;      // `written` at the last sync
+    DWORD error;          // GetLastError() of the first failure, 0 if none
+    int flags;
+    bool owns_file;
+    char *path;           // RT_FWRITER_ATOMIC: the file to replace on close
+    char *temp_path;
+    uint8_t *packed;      // RT_FWRITER_COMPRESS: the frame blocks of one buffer
+} RT_FileWriter;
+
+/* buffer_size of 0 picks the default */
+bool rt_fwriter_open(RT_FileWriter *writer, const char *path, size_t buffer_size, int flags);
+bool rt_fwriter_attach(RT_FileWriter *writer, HANDLE file, size_t buffer_size); // close leaves the handle open
+
+/* Flushes, syncs and renames as the flags ask. Returns false if any write
+ * failed, in which case an atomic writer leaves the target untouched. */
+bool rt_fwriter_close(RT_FileWriter *writer);
+void rt_fwriter_abort(RT_FileWriter *writer); // closes without flushing, drops an atomic writer's output
+bool rt_fwriter_flush(RT_FileWriter *writer);
+bool rt_fwriter_sync(RT_FileWriter *writer);
+
+bool rt_fwriter_write(RT_FileWriter *writer, const void *data, size_t size);
+bool rt_fwriter_printf(RT_FileWriter *writer, const char *format, ...);
+bool rt_fwriter_u64(RT_FileWriter *writer, uint64_t value);
+bool rt_fwriter_i64(RT_FileWriter *writer, int64_t value);
+bool rt_fwriter_hex(RT_FileWriter *writer, uint64_t value, int width); // uppercase, zero-padded to width digits
+
+/* Space for `size` bytes in the buffer, flushing first if needed. NULL if
+ * size exceeds the buffer or the flush failed. */
+uint8_t *rt_fwriter_reserve(RT_FileWriter *writer, size_t size);
+
+static inline void rt_fwriter_commit(RT_FileWriter *writer, size_t size)
+{
+    writer->size += size;
+}
+
+static inline bool rt_fwriter_putc(RT_FileWriter *writer, char c)
+{
+    if (writer->size == writer->capacity && !rt_fwriter_flush(writer)) return false;
+    writer->buffer[writer->size++] = (uint8_t)c;
+    return true;
+}
+
+static inline bool rt_fwriter_puts(RT_FileWriter *writer, const char *str)
+{
+    return rt_fwriter_write(writer, str, strlen(str));
+}
+
+static inline bool rt_fwriter_failed(const RT_FileWriter *writer)
+{
+    return writer && writer->error != 0;
+}
+
+#endif // _INC_RT_STREAM
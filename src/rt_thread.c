@@ -72,4 +72,41 @@ bool rt_thread_detach_all(RT_Thread *threads, size_t count)
     }
     
     return true;
-}
\ No newline at end of file
+}
+
+size_t rt_thread_cpu_count(void)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors ? si.dwNumberOfProcessors : 1;
+}
+
+/* Fork/join over an array of `count` task structs of `task_size` bytes each.
+ * The calling thread takes the first task of every batch; a task whose
+ * thread can't be started runs inline instead. */
+void rt_thread_run_tasks(void *tasks, size_t task_size, size_t count, DWORD (*worker)(void *param))
+{
+    if (!tasks || !worker) return;
+
+    RT_Thread threads[RT_THREAD_MAX_TASKS];
+    bool started[RT_THREAD_MAX_TASKS];
+    char *task = tasks;
+
+    while (count > 0) {
+        size_t batch = count < RT_THREAD_MAX_TASKS ? count : RT_THREAD_MAX_TASKS;
+
+        for (size_t i = 1; i < batch; ++i) {
+            started[i] = rt_thread_create(&threads[i], task + i * task_size, worker);
+            if (!started[i]) worker(task + i * task_size);
+        }
+
+        worker(task);
+
+        for (size_t i = 1; i < batch; ++i) {
+            if (started[i]) rt_thread_join(&threads[i]);
+        }
+
+        task += batch * task_size;
+        count -= batch;
+    }
+}
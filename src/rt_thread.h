@@ -12,6 +12,7 @@
 #define RT_THREAD_STATE_STOPPED 0
 #define RT_THREAD_STATE_INTERRUPTED 1
 #define RT_THREAD_STATE_UNKNOWN 2
+#define RT_THREAD_MAX_TASKS 128 // tasks started at once by rt_thread_run_tasks, more run in batches
 
 /* Threading section */
 typedef struct _RT_Thread {
@@ -27,6 +28,8 @@ bool rt_thread_join(RT_Thread *thread);
 bool rt_thread_detach(RT_Thread *thread);
 bool rt_thread_join_all(RT_Thread *threads, size_t count);
 bool rt_thread_detach_all(RT_Thread *threads, size_t count);
+size_t rt_thread_cpu_count(void);
+void rt_thread_run_tasks(void *tasks, size_t task_size, size_t count, DWORD (*worker)(void *param));
 
 static inline void rt_thread_sleep(DWORD ms)
 {
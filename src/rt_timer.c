@@ -0,0 +1,359 @@
+#include "rt_timer.h"
+
+#define RT__TIMER_NIL UINT32_MAX
+#define RT__TIMER_FIRING (UINT32_MAX - 1) // slot of a timer whose callback is queued
+#define RT__TIMER_ROOT_SIZE (1u << RT_TIMER_ROOT_BITS)
+#define RT__TIMER_ROOT_MASK (RT__TIMER_ROOT_SIZE - 1)
+#define RT__TIMER_LEVEL_SIZE (1u << RT_TIMER_LEVEL_BITS)
+#define RT__TIMER_LEVEL_MASK (RT__TIMER_LEVEL_SIZE - 1)
+#define RT__TIMER_MAX_DELTA ((((uint64_t)1) << (RT_TIMER_ROOT_BITS + (RT_TIMER_LEVELS - 1) * RT_TIMER_LEVEL_BITS)) - 1)
+
+typedef struct _RT__TimerFire {
+    uint32_t index;
+    uint32_t generation;
+} RT__TimerFire;
+
+uint64_t rt_timer_now_ms(void)
+{
+    static LONGLONG frequency;
+    LARGE_INTEGER counter;
+
+    if (!frequency) {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        frequency = f.QuadPart;
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency * 1000 + counter.QuadPart % frequency * 1000 / frequency);
+}
+
+// wheel slot for a deadline, relative to the tick being processed
+static uint32_t rt__timer_slot_for(const RT_TimerWheel *wheel, uint64_t expires)
+{
+    uint64_t delta = expires - wheel->current;
+    if (delta > RT__TIMER_MAX_DELTA) {
+        delta = RT__TIMER_MAX_DELTA;
+        expires = wheel->current + delta;
+    }
+    if (delta < RT__TIMER_ROOT_SIZE) return (uint32_t)(expires & RT__TIMER_ROOT_MASK);
+
+    uint32_t base = RT__TIMER_ROOT_SIZE;
+    unsigned shift = RT_TIMER_ROOT_BITS;
+    for (int level = 1; level < RT_TIMER_LEVELS - 1; ++level) {
+        if (delta < ((uint64_t)1 << (shift + RT_TIMER_LEVEL_BITS))) break;
+        base += RT__TIMER_LEVEL_SIZE;
+        shift += RT_TIMER_LEVEL_BITS;
+    }
+    return base + (uint32_t)((expires >> shift) & RT__TIMER_LEVEL_MASK);
+}
+
+static void rt__timer_link(RT_TimerWheel *wheel, uint32_t index, uint32_t slot)
+{
+    RT_Timer *timer = &wheel->timers[index];
+    timer->prev = RT__TIMER_NIL;
+    timer->next = wheel->heads[slot];
+    timer->slot = slot;
+    if (timer->next != RT__TIMER_NIL) wheel->timers[timer->next].prev = index;
+    wheel->heads[slot] = index;
+}
+
+static void rt__timer_unlink(RT_TimerWheel *wheel, uint32_t index)
+{
+    RT_Timer *timer = &wheel->timers[index];
+    if (timer->prev != RT__TIMER_NIL) wheel->timers[timer->prev].next = timer->next;
+    else wheel->heads[timer->slot] = timer->next;
+    if (timer->next != RT__TIMER_NIL) wheel->timers[timer->next].prev = timer->prev;
+    timer->slot = RT__TIMER_NIL;
+}
+
+static uint32_t rt__timer_alloc(RT_TimerWheel *wheel)
+{
+    uint32_t index = wheel->free_head;
+    if (index != RT__TIMER_NIL) {
+        wheel->free_head = wheel->timers[index].next;
+        return index;
+    }
+
+    if (wheel->timers_count >= RT__TIMER_NIL) return RT__TIMER_NIL;
+    if (wheel->timers_count == wheel->timers_capacity) {
+        size_t capacity = wheel->timers_capacity * 2;
+        RT_Timer *timers = RT_REALLOC(wheel->timers, capacity * sizeof(RT_Timer));
+        if (!timers) return RT__TIMER_NIL;
+        wheel->timers = timers;
+        wheel->timers_capacity = capacity;
+    }
+
+    index = (uint32_t)wheel->timers_count++;
+    wheel->timers[index].generation = 1;
+    wheel->timers[index].slot = RT__TIMER_NIL;
+    return index;
+}
+
+static void rt__timer_release(RT_TimerWheel *wheel, uint32_t index)
+{
+    // a timer whose generation would wrap is retired rather than reused
+    RT_Timer *timer = &wheel->timers[index];
+    if (++timer->generation != 0) {
+        timer->next = wheel->free_head;
+        wheel->free_head = index;
+    }
+    wheel->active--;
+}
+
+// the upper slots the wheel below has just wrapped into move down a level
+static void rt__timer_cascade(RT_TimerWheel *wheel, uint64_t tick)
+{
+    uint32_t base = RT__TIMER_ROOT_SIZE;
+    unsigned shift = RT_TIMER_ROOT_BITS;
+    for (int level = 1; level < RT_TIMER_LEVELS; ++level) {
+        const uint32_t index = (uint32_t)((tick >> shift) & RT__TIMER_LEVEL_MASK);
+        uint32_t i = wheel->heads[base + index];
+        wheel->heads[base + index] = RT__TIMER_NIL;
+        while (i != RT__TIMER_NIL) {
+            const uint32_t next = wheel->timers[i].next;
+            rt__timer_link(wheel, i, rt__timer_slot_for(wheel, wheel->timers[i].expires));
+            i = next;
+        }
+        if (index) break;
+
+        base += RT__TIMER_LEVEL_SIZE;
+        shift += RT_TIMER_LEVEL_BITS;
+    }
+}
+
+// called and returns with the lock held, drops it around each callback.
+// A timer cancelled while queued is skipped; a periodic one is re-armed
+// once its callback has returned, no earlier than tick `next`.
+static size_t rt__timer_run(RT_TimerWheel *wheel, const RT__TimerFire *batch, size_t count, uint64_t next)
+{
+    size_t fired = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t index = batch[i].index;
+        if (wheel->timers[index].generation != batch[i].generation) continue;
+
+        const RT_TimerCallback callback = wheel->timers[index].callback;
+        void *user_data = wheel->timers[index].user_data;
+        wheel->calling = index;
+        wheel->calling_generation = batch[i].generation;
+        LeaveCriticalSection(&wheel->lock);
+        callback(user_data);
+        EnterCriticalSection(&wheel->lock);
+        wheel->calling = RT__TIMER_NIL;
+        WakeAllConditionVariable(&wheel->returned);
+        fired++;
+
+        RT_Timer *timer = &wheel->timers[index]; // the callback may have grown the array
+        if (timer->generation != batch[i].generation) continue;
+        if (timer->period) {
+            if (timer->expires < next) timer->expires = next; // missed periods fold into one call
+            rt__timer_link(wheel, index, rt__timer_slot_for(wheel, timer->expires));
+        } else {
+            timer->slot = RT__TIMER_NIL;
+            rt__timer_release(wheel, index);
+        }
+    }
+    return fired;
+}
+
+static size_t rt__timer_advance_locked(RT_TimerWheel *wheel, uint64_t now_ms)
+{
+    if (wheel->advancing || now_ms < wheel->start_ms) return 0;
+
+    const uint64_t due = (now_ms - wheel->start_ms) / wheel->tick_ms;
+    RT__TimerFire batch[RT_TIMER_BATCH];
+    size_t pending = 0, fired = 0;
+
+    wheel->advancing = true;
+    wheel->advancer = GetCurrentThreadId();
+    while (wheel->current <= due) {
+        if (wheel->active == 0) { // nothing to walk through
+            wheel->current = due + 1;
+            break;
+        }
+
+        const uint64_t tick = wheel->current;
+        const uint32_t slot = (uint32_t)(tick & RT__TIMER_ROOT_MASK);
+        if (slot == 0) rt__timer_cascade(wheel, tick);
+
+        uint32_t i;
+        while ((i = wheel->heads[slot]) != RT__TIMER_NIL) {
+            RT_Timer *timer = &wheel->timers[i];
+            rt__timer_unlink(wheel, i);
+            timer->slot = RT__TIMER_FIRING;
+            timer->expires = tick + timer->period;
+            batch[pending].index = i;
+            batch[pending].generation = timer->generation;
+            pending++;
+
+            if (pending == RT_TIMER_BATCH) {
+                fired += rt__timer_run(wheel, batch, pending, tick + 1);
+                pending = 0;
+            }
+        }
+        wheel->current = tick + 1;
+    }
+    if (pending) fired += rt__timer_run(wheel, batch, pending, wheel->current);
+    wheel->advancing = false;
+
+    return fired;
+}
+
+static DWORD rt__timer_worker(void *param)
+{
+    RT_TimerWheel *wheel = param;
+
+    EnterCriticalSection(&wheel->lock);
+    while (wheel->running) {
+        if (wheel->active == 0) {
+            SleepConditionVariableCS(&wheel->wake, &wheel->lock, INFINITE);
+            continue;
+        }
+
+        // tick `current` is due once the clock reaches its start
+        const uint64_t now = rt_timer_now_ms();
+        const uint64_t next = wheel->start_ms + wheel->current * wheel->tick_ms;
+        if (now < next) {
+            SleepConditionVariableCS(&wheel->wake, &wheel->lock, (DWORD)(next - now));
+            continue;
+        }
+        rt__timer_advance_locked(wheel, now);
+    }
+    LeaveCriticalSection(&wheel->lock);
+
+    return 0;
+}
+
+bool rt_timer_wheel_init(RT_TimerWheel *wheel, uint32_t tick_ms)
+{
+    if (!wheel || tick_ms == 0) return false;
+
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->timers = RT_MALLOC(RT_TIMER_INIT_CAP * sizeof(RT_Timer));
+    if (!wheel->timers) return false;
+
+    wheel->timers_capacity = RT_TIMER_INIT_CAP;
+    wheel->free_head = RT__TIMER_NIL;
+    wheel->calling = RT__TIMER_NIL;
+    for (size_t i = 0; i < RT_TIMER_SLOTS; ++i) wheel->heads[i] = RT__TIMER_NIL;
+    wheel->tick_ms = tick_ms;
+    wheel->start_ms = rt_timer_now_ms();
+    InitializeCriticalSection(&wheel->lock);
+    InitializeConditionVariable(&wheel->wake);
+    InitializeConditionVariable(&wheel->returned);
+
+    return true;
+}
+
+void rt_timer_wheel_free(RT_TimerWheel *wheel)
+{
+    if (!wheel || !wheel->timers) return;
+
+    rt_timer_wheel_stop(wheel);
+    DeleteCriticalSection(&wheel->lock);
+    RT_FREE(wheel->timers);
+    wheel->timers = NULL;
+    wheel->timers_count = 0;
+    wheel->timers_capacity = 0;
+    wheel->active = 0;
+}
+
+bool rt_timer_wheel_start(RT_TimerWheel *wheel)
+{
+    if (!wheel || !wheel->timers || wheel->running) return false;
+
+    wheel->running = 1;
+    if (!rt_thread_create(&wheel->worker, wheel, rt__timer_worker)) {
+        wheel->running = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void rt_timer_wheel_stop(RT_TimerWheel *wheel)
+{
+    if (!wheel || !wheel->running) return;
+
+    EnterCriticalSection(&wheel->lock);
+    wheel->running = 0;
+    WakeConditionVariable(&wheel->wake);
+    LeaveCriticalSection(&wheel->lock);
+
+    rt_thread_join(&wheel->worker);
+}
+
+size_t rt_timer_wheel_advance(RT_TimerWheel *wheel)
+{
+    if (!wheel || !wheel->timers) return 0;
+
+    EnterCriticalSection(&wheel->lock);
+    size_t fired = rt__timer_advance_locked(wheel, rt_timer_now_ms());
+    LeaveCriticalSection(&wheel->lock);
+
+    return fired;
+}
+
+RT_SlotHandle rt_timer_schedule(RT_TimerWheel *wheel, uint64_t delay_ms, uint64_t period_ms,
+                                RT_TimerCallback callback, void *user_data)
+{
+    if (!wheel || !wheel->timers || !callback) return RT_SLOT_HANDLE_NULL;
+
+    const uint64_t tick = wheel->tick_ms;
+    EnterCriticalSection(&wheel->lock);
+
+    const uint32_t index = rt__timer_alloc(wheel);
+    if (index == RT__TIMER_NIL) {
+        LeaveCriticalSection(&wheel->lock);
+        return RT_SLOT_HANDLE_NULL;
+    }
+
+    // first tick that starts at or after the deadline
+    const uint64_t now = rt_timer_now_ms();
+    uint64_t expires = (now - wheel->start_ms + delay_ms + tick - 1) / tick;
+    if (expires < wheel->current) expires = wheel->current;
+
+    RT_Timer *timer = &wheel->timers[index];
+    timer->expires = expires;
+    timer->period = period_ms ? (period_ms + tick - 1) / tick : 0;
+    timer->callback = callback;
+    timer->user_data = user_data;
+    rt__timer_link(wheel, index, rt__timer_slot_for(wheel, expires));
+
+    const bool wake = wheel->active++ == 0;
+    const RT_SlotHandle handle = ((RT_SlotHandle)timer->generation << 32) | index;
+    LeaveCriticalSection(&wheel->lock);
+
+    if (wake) WakeConditionVariable(&wheel->wake);
+    return handle;
+}
+
+bool rt_timer_cancel(RT_TimerWheel *wheel, RT_SlotHandle timer)
+{
+    if (!wheel || !wheel->timers) return false;
+
+    const uint32_t index = (uint32_t)timer;
+    const uint32_t generation = (uint32_t)(timer >> 32);
+    bool cancelled = false;
+
+    // a queued callback is skipped, being released; one that is running
+    // returns before cancel does, unless cancel comes from that callback
+    EnterCriticalSection(&wheel->lock);
+    if (index < wheel->timers_count && wheel->timers[index].generation == generation
+        && wheel->timers[index].slot != RT__TIMER_NIL) {
+        RT_Timer *t = &wheel->timers[index];
+        const bool running = t->slot == RT__TIMER_FIRING && wheel->calling == index;
+        cancelled = !running || t->period;
+        if (t->slot != RT__TIMER_FIRING) rt__timer_unlink(wheel, index);
+        t->slot = RT__TIMER_NIL;
+        rt__timer_release(wheel, index);
+
+        if (running && wheel->advancer != GetCurrentThreadId()) {
+            while (wheel->calling == index && wheel->calling_generation == generation) {
+                SleepConditionVariableCS(&wheel->returned, &wheel->lock, INFINITE);
+            }
+        }
+    }
+    LeaveCriticalSection(&wheel->lock);
+
+    return cancelled;
+}
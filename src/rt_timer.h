@@ -0,0 +1,89 @@
+#ifndef _INC_RT_TIMER
+#define _INC_RT_TIMER
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rt_collections.h"
+#include "rt_thread.h"
+
+/* Hierarchical timer wheel
+ * Deadlines are rounded up to ticks of `tick_ms` and linked into one of
+ * RT_TIMER_LEVELS wheels: the first has one slot per tick for the next 256
+ * ticks, each further level has 64 slots that are 64 times coarser. Timers in
+ * an upper slot are redistributed downwards when the wheel below wraps, so
+ * schedule and cancel are O(1) and a tick only looks at the slots that are
+ * due. Deadlines past the top level wait there and are re-filed until due.
+ *
+ * Due timers are collected under the wheel's lock in batches and their
+ * callbacks run with it released, so a callback may schedule or cancel
+ * timers. A periodic timer is re-armed once its callback has returned: it
+ * is never queued twice, and periods missed while catching up fold into one
+ * call. Callbacks run on the thread started by rt_timer_wheel_start, or on
+ * whoever calls rt_timer_wheel_advance when no worker is used. The worker
+ * sleeps between ticks and indefinitely while no timer is pending; the OS
+ * timer resolution bounds how close to the tick it wakes up. */
+#define RT_TIMER_LEVELS 5
+#define RT_TIMER_ROOT_BITS 8
+#define RT_TIMER_LEVEL_BITS 6
+#define RT_TIMER_SLOTS ((1 << RT_TIMER_ROOT_BITS) + (RT_TIMER_LEVELS - 1) * (1 << RT_TIMER_LEVEL_BITS))
+#define RT_TIMER_BATCH 256 // callbacks collected before the lock is dropped to run them
+#define RT_TIMER_INIT_CAP 256
+
+typedef void (*RT_TimerCallback)(void *user_data);
+
+typedef struct _RT_Timer {
+    uint64_t expires;        // tick
+    uint64_t period;         // ticks, 0 = one-shot
+    RT_TimerCallback callback;
+    void *user_data;
+    uint32_t prev;           // neighbours in the slot list, `next` links free timers
+    uint32_t next;
+    uint32_t slot;           // wheel slot, RT__TIMER_NIL while not scheduled
+    uint32_t generation;
+} RT_Timer;
+
+typedef struct _RT_TimerWheel {
+    RT_Timer *timers;
+    size_t timers_count;
+    size_t timers_capacity;  // elements
+    size_t active;
+    uint32_t free_head;
+    uint32_t heads[RT_TIMER_SLOTS];
+    uint64_t tick_ms;
+    uint64_t current;        // next tick to process
+    uint64_t start_ms;       // clock at tick 0
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE wake;
+    CONDITION_VARIABLE returned; // signalled after each callback
+    RT_Thread worker;
+    volatile LONG running;
+    bool advancing;
+    DWORD advancer;           // thread running the callbacks while advancing
+    uint32_t calling;         // timer whose callback is running
+    uint32_t calling_generation;
+} RT_TimerWheel;
+
+bool rt_timer_wheel_init(RT_TimerWheel *wheel, uint32_t tick_ms);
+void rt_timer_wheel_free(RT_TimerWheel *wheel); // pending timers are dropped without firing
+bool rt_timer_wheel_start(RT_TimerWheel *wheel);
+void rt_timer_wheel_stop(RT_TimerWheel *wheel);
+size_t rt_timer_wheel_advance(RT_TimerWheel *wheel); // fires what is due, returns how many fired
+
+/* A timer fires once after `delay_ms`, then every `period_ms` if that is not
+ * zero. The handle stays valid until the timer is cancelled or, for a
+ * one-shot timer, fires. Cancel returns true when it kept a call from
+ * happening; no callback of the timer starts after cancel returns, and one
+ * already running on another thread is waited for, so user_data can be
+ * freed right away. Don't cancel while holding a lock that callback takes. */
+RT_SlotHandle rt_timer_schedule(RT_TimerWheel *wheel, uint64_t delay_ms, uint64_t period_ms,
+                                RT_TimerCallback callback, void *user_data);
+bool rt_timer_cancel(RT_TimerWheel *wheel, RT_SlotHandle timer);
+uint64_t rt_timer_now_ms(void);
+
+static inline size_t rt_timer_wheel_size(RT_TimerWheel *wheel)
+{
+    return wheel ? wheel->active : 0;
+}
+
+#endif // _INC_RT_TIMER
@@ -0,0 +1,588 @@
+#ifndef _INC_RT_TYPED
+#define _INC_RT_TYPED
+
+#include "rt_collections.h"
+
+/* Typed containers
+ * Same semantics as RT_Array, RT_DynamicArray, RT_SmallArray, RT_List and
+ * RT_RingBuffer, but the element type is known at compile time. Element moves
+ * become plain assignments, and every operation is static inline so hot
+ * loops can be inlined and vectorized. Each macro defines `name` (the container type) and
+ * `name_<op>` functions, e.g.:
+ *
+ *     RT_DEFINE_DARRAY(rt_darray_i32, int32_t)
+ *     rt_darray_i32 a = {0};
+ *     rt_darray_i32_init(&a);
+ *     rt_darray_i32_push(&a, 42);
+ *     int32_t x = *rt_darray_i32_at(&a, 0);
+ */
+
+/* Static array */
+#define RT_DEFINE_ARRAY(name, T)                                                \
+typedef struct _##name {                                                        \
+    T *data;                                                                    \
+    size_t size;                                                                \
+    size_t capacity;                                                            \
+} name;                                                                         \
+                                                                                \
+static inline bool name##_init(name *arr, size_t capacity)                      \
+{                                                                               \
+    if (!arr || capacity == 0 || arr->data) return false;                       \
+    arr->data = RT_MALLOC(capacity * sizeof(T));                                \
+    if (!arr->data) return false;                                               \
+    arr->capacity = capacity;                                                   \
+    arr->size = 0;                                                              \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline void name##_free(name *arr)                                       \
+{                                                                               \
+    if (!arr || !arr->data) return;                                             \
+    RT_FREE(arr->data);                                                         \
+    arr->data = NULL;                                                           \
+    arr->size = 0;                                                              \
+    arr->capacity = 0;                                                          \
+}                                                                               \
+                                                                                \
+static inline bool name##_is_empty(const name *arr)                             \
+{                                                                               \
+    return !(arr && arr->data) || arr->size == 0;                               \
+}                                                                               \
+                                                                                \
+static inline bool name##_is_full(const name *arr)                              \
+{                                                                               \
+    return (arr && arr->data) && arr->size >= arr->capacity;                    \
+}                                                                               \
+                                                                                \
+static inline bool name##_push(name *arr, T value)                              \
+{                                                                               \
+    if (!arr || name##_is_full(arr)) return false;                              \
+    arr->data[arr->size++] = value;                                             \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_pop(name *arr, T *out)                                \
+{                                                                               \
+    if (!arr || arr->size == 0) return false;                                   \
+    arr->size--;                                                                \
+    if (out) *out = arr->data[arr->size];                                       \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_del(name *arr, size_t index)                          \
+{                                                                               \
+    if (!arr || index >= arr->size) return false;                               \
+    memmove(arr->data + index, arr->data + index + 1,                           \
+        (arr->size - index - 1) * sizeof(T));                                   \
+    arr->size--;                                                                \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_set(name *arr, size_t index, T value)                 \
+{                                                                               \
+    if (!arr || index >= arr->size) return false;                               \
+    arr->data[index] = value;                                                   \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_get(const name *arr, size_t index, T *out)            \
+{                                                                               \
+    if (!arr || index >= arr->size || !out) return false;                       \
+    *out = arr->data[index];                                                    \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline T *name##_at(const name *arr, size_t index)                       \
+{                                                                               \
+    return (arr && index < arr->size) ? &arr->data[index] : NULL;               \
+}
+
+/* Dynamic array */
+#define RT_DEFINE_DARRAY(name, T)                                               \
+typedef struct _##name {                                                        \
+    T *data;                                                                    \
+    size_t size;                                                                \
+    size_t capacity;                                                            \
+    double growth_factor;                                                       \
+} name;                                                                         \
+                                                                                \
+static inline bool name##__realloc(name *arr, size_t new_cap)                   \
+{                                                                               \
+    if (new_cap > SIZE_MAX / sizeof(T)) return false;                           \
+    T *new_data = RT_REALLOC(arr->data, new_cap * sizeof(T));                   \
+    if (!new_data) return false;                                                \
+    arr->data = new_data;                                                       \
+    arr->capacity = new_cap;                                                    \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##__grow(name *arr, size_t min_cap)                      \
+{                                                                               \
+    if (arr->capacity >= min_cap) return true;                                  \
+    double growth = arr->growth_factor > 1.0                                    \
+        ? arr->growth_factor : RT_DARRAY_GROWTH_FACTOR;                         \
+    double grown = (double)arr->capacity * growth;                              \
+    size_t new_cap = grown < (double)SIZE_MAX ? (size_t)grown : SIZE_MAX;       \
+    if (new_cap <= arr->capacity) new_cap = arr->capacity + 1;                  \
+    if (new_cap < min_cap) new_cap = min_cap;                                   \
+    return name##__realloc(arr, new_cap);                                       \
+}                                                                               \
+                                                                                \
+static inline bool name##_init(name *arr)                                       \
+{                                                                               \
+    if (!arr) return false;                                                     \
+    size_t cap = RT_DARRAY_INIT_CAP / sizeof(T);                                \
+    if (cap == 0) cap = 1;                                                      \
+    arr->data = RT_MALLOC(cap * sizeof(T));                                     \
+    if (!arr->data) return false;                                               \
+    arr->capacity = cap;                                                        \
+    arr->size = 0;                                                              \
+    arr->growth_factor = RT_DARRAY_GROWTH_FACTOR;                               \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline void name##_free(name *arr)                                       \
+{                                                                               \
+    if (!arr) return;                                                           \
+    RT_FREE(arr->data);                                                         \
+    arr->data = NULL;                                                           \
+    arr->size = 0;                                                              \
+    arr->capacity = 0;                                                          \
+}                                                                               \
+                                                                                \
+static inline bool name##_push(name *arr, T value)                              \
+{                                                                               \
+    if (!arr) return false;                                                     \
+    if (arr->size >= arr->capacity && !name##__grow(arr, arr->size + 1))        \
+        return false;                                                           \
+    arr->data[arr->size++] = value;                                             \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline size_t name##__index_of(const name *arr, const T *values)         \
+{                                                                               \
+    const uintptr_t p = (uintptr_t)values, data = (uintptr_t)arr->data;         \
+    return data && p >= data && p < data + arr->size * sizeof(T)                \
+        ? (size_t)(p - data) / sizeof(T) : SIZE_MAX;                            \
+}                                                                               \
+                                                                                \
+static inline bool name##_push_n(name *arr, const T *values, size_t count)      \
+{                                                                               \
+    if (!arr || (!values && count)) return false;                               \
+    if (count == 0) return true;                                                \
+    if (count > SIZE_MAX - arr->size) return false;                             \
+    const size_t from = name##__index_of(arr, values);                          \
+    if (!name##__grow(arr, arr->size + count)) return false;                    \
+    if (from != SIZE_MAX) values = arr->data + from;                            \
+    memcpy(arr->data + arr->size, values, count * sizeof(T));                   \
+    arr->size += count;                                                         \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_insert_n(name *arr, size_t index,                     \
+    const T *values, size_t count)                                              \
+{                                                                               \
+    if (!arr || (!values && count) || index > arr->size) return false;          \
+    if (count == 0) return true;                                                \
+    if (count > SIZE_MAX - arr->size) return false;                             \
+    const size_t from = name##__index_of(arr, values);                          \
+    if (!name##__grow(arr, arr->size + count)) return false;                    \
+    memmove(arr->data + index + count, arr->data + index,                       \
+        (arr->size - index) * sizeof(T));                                       \
+    if (from == SIZE_MAX) {                                                     \
+        memcpy(arr->data + index, values, count * sizeof(T));                   \
+    } else {                                                                    \
+        const size_t head = from < index                                        \
+            ? (index - from < count ? index - from : count) : 0;                \
+        memcpy(arr->data + index, arr->data + from, head * sizeof(T));          \
+        memcpy(arr->data + index + head, arr->data + from + head + count,       \
+            (count - head) * sizeof(T));                                        \
+    }                                                                           \
+    arr->size += count;                                                         \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_get(const name *arr, size_t index, T *out)            \
+{                                                                               \
+    if (!arr || !out || index >= arr->size) return false;                       \
+    *out = arr->data[index];                                                    \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_set(name *arr, size_t index, T value)                 \
+{                                                                               \
+    if (!arr || index >= arr->size) return false;                               \
+    arr->data[index] = value;                                                   \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline T *name##_at(const name *arr, size_t index)                       \
+{                                                                               \
+    return (arr && index < arr->size) ? &arr->data[index] : NULL;               \
+}                                                                               \
+                                                                                \
+static inline bool name##_pop(name *arr, T *out)                                \
+{                                                                               \
+    if (!arr || arr->size == 0) return false;                                   \
+    arr->size--;                                                                \
+    if (out) *out = arr->data[arr->size];                                       \
+    const double growth = arr->growth_factor > 1.0                              \
+        ? arr->growth_factor : RT_DARRAY_GROWTH_FACTOR;                         \
+    size_t min_cap = RT_DARRAY_INIT_CAP / sizeof(T);                            \
+    if (arr->size > 0 && arr->capacity > min_cap                                \
+        && (double)arr->size * growth * growth <= (double)arr->capacity) {      \
+        size_t new_cap = (size_t)((double)arr->size * growth);                  \
+        if (new_cap < min_cap) new_cap = min_cap;                               \
+        if (new_cap < arr->capacity) name##__realloc(arr, new_cap);             \
+    }                                                                           \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_reserve(name *arr, size_t capacity)                   \
+{                                                                               \
+    if (!arr) return false;                                                     \
+    if (arr->capacity >= capacity) return true;                                 \
+    return name##__realloc(arr, capacity);                                      \
+}                                                                               \
+                                                                                \
+static inline bool name##_shrink_to_fit(name *arr)                              \
+{                                                                               \
+    if (!arr) return false;                                                     \
+    if (arr->capacity == arr->size || arr->size == 0) return true;              \
+    return name##__realloc(arr, arr->size);                                     \
+}
+
+/* Small array: the first N elements live inside the struct (see RT_SmallArray) */
+#define RT_DEFINE_SMALL_ARRAY(name, T, N)                                       \
+typedef struct _##name {                                                        \
+    T *data;                                                                    \
+    size_t size;                                                                \
+    size_t capacity;                                                            \
+    T inline_data[N];                                                           \
+} name;                                                                         \
+                                                                                \
+static inline void name##_init(name *arr)                                       \
+{                                                                               \
+    if (!arr) return;                                                           \
+    arr->data = arr->inline_data;                                               \
+    arr->size = 0;                                                              \
+    arr->capacity = N;                                                          \
+}                                                                               \
+                                                                                \
+static inline bool name##_is_inline(const name *arr)                            \
+{                                                                               \
+    return arr && arr->data == arr->inline_data;                                \
+}                                                                               \
+                                                                                \
+static inline void name##_free(name *arr)                                       \
+{                                                                               \
+    if (!arr || !arr->data) return;                                             \
+    if (!name##_is_inline(arr)) RT_FREE(arr->data);                             \
+    name##_init(arr);                                                           \
+}                                                                               \
+                                                                                \
+static inline bool name##__grow(name *arr, size_t min_cap)                      \
+{                                                                               \
+    if (arr->capacity >= min_cap) return true;                                  \
+    double grown = (double)arr->capacity * RT_DARRAY_GROWTH_FACTOR;             \
+    size_t new_cap = grown < (double)SIZE_MAX ? (size_t)grown : SIZE_MAX;       \
+    if (new_cap < min_cap) new_cap = min_cap;                                   \
+    if (new_cap > SIZE_MAX / sizeof(T)) return false;                           \
+    T *new_data;                                                                \
+    if (name##_is_inline(arr)) {                                                \
+        new_data = RT_MALLOC(new_cap * sizeof(T));                              \
+        if (!new_data) return false;                                            \
+        memcpy(new_data, arr->data, arr->size * sizeof(T));                     \
+    } else {                                                                    \
+        new_data = RT_REALLOC(arr->data, new_cap * sizeof(T));                  \
+        if (!new_data) return false;                                            \
+    }                                                                           \
+    arr->data = new_data;                                                       \
+    arr->capacity = new_cap;                                                    \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_push(name *arr, T value)                              \
+{                                                                               \
+    if (!arr) return false;                                                     \
+    if (arr->size >= arr->capacity && !name##__grow(arr, arr->size + 1))        \
+        return false;                                                           \
+    arr->data[arr->size++] = value;                                             \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_push_n(name *arr, const T *values, size_t count)      \
+{                                                                               \
+    if (!arr || (!values && count)) return false;                               \
+    if (count == 0) return true;                                                \
+    if (count > SIZE_MAX - arr->size) return false;                             \
+    const uintptr_t p = (uintptr_t)values, data = (uintptr_t)arr->data;         \
+    const size_t from = p >= data && p < data + arr->size * sizeof(T)           \
+        ? (size_t)(p - data) / sizeof(T) : SIZE_MAX;                            \
+    if (!name##__grow(arr, arr->size + count)) return false;                    \
+    if (from != SIZE_MAX) values = arr->data + from;                            \
+    memcpy(arr->data + arr->size, values, count * sizeof(T));                   \
+    arr->size += count;                                                         \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_get(const name *arr, size_t index, T *out)            \
+{                                                                               \
+    if (!arr || !out || index >= arr->size) return false;                       \
+    *out = arr->data[index];                                                    \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_set(name *arr, size_t index, T value)                 \
+{                                                                               \
+    if (!arr || index >= arr->size) return false;                               \
+    arr->data[index] = value;                                                   \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline T *name##_at(const name *arr, size_t index)                       \
+{                                                                               \
+    return (arr && index < arr->size) ? &arr->data[index] : NULL;               \
+}                                                                               \
+                                                                                \
+static inline bool name##_pop(name *arr, T *out)                                \
+{                                                                               \
+    if (!arr || arr->size == 0) return false;                                   \
+    arr->size--;                                                                \
+    if (out) *out = arr->data[arr->size];                                       \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_reserve(name *arr, size_t capacity)                   \
+{                                                                               \
+    return arr && name##__grow(arr, capacity);                                  \
+}                                                                               \
+                                                                                \
+static inline void name##_move(name *dst, name *src)                            \
+{                                                                               \
+    if (!dst || !src || dst == src) return;                                     \
+    if (dst->data && !name##_is_inline(dst)) RT_FREE(dst->data);                \
+    dst->size = src->size;                                                      \
+    dst->capacity = src->capacity;                                              \
+    if (name##_is_inline(src)) {                                                \
+        dst->data = dst->inline_data;                                           \
+        memcpy(dst->inline_data, src->inline_data, src->size * sizeof(T));      \
+    } else {                                                                    \
+        dst->data = src->data;                                                  \
+    }                                                                           \
+    name##_init(src);                                                           \
+}
+
+/* name_steal hands a small array's elements to a typed dynamic array of the
+ * same T, defined with RT_DEFINE_DARRAY, taking over the heap block once the
+ * array has spilled; `out` must not own anything (see rt_sarray_steal) */
+#define RT_DEFINE_SMALL_ARRAY_STEAL(name, darray)                               \
+static inline bool name##_steal(name *arr, darray *out)                         \
+{                                                                               \
+    if (!arr || !arr->data || !out) return false;                               \
+    if (name##_is_inline(arr)) {                                                \
+        size_t cap = arr->size ? arr->size : 1;                                 \
+        out->data = RT_MALLOC(cap * sizeof(*arr->data));                        \
+        if (!out->data) return false;                                           \
+        memcpy(out->data, arr->data, arr->size * sizeof(*arr->data));           \
+        out->capacity = cap;                                                    \
+    } else {                                                                    \
+        out->data = arr->data;                                                  \
+        out->capacity = arr->capacity;                                          \
+    }                                                                           \
+    out->size = arr->size;                                                      \
+    out->growth_factor = RT_DARRAY_GROWTH_FACTOR;                               \
+    name##_init(arr);                                                           \
+    return true;                                                                \
+}
+
+/* D-Linked List (values are stored inside the node) */
+#define RT_DEFINE_LIST(name, T)                                                 \
+typedef struct _##name##_node {                                                 \
+    T data;                                                                     \
+    struct _##name##_node *next;                                                \
+    struct _##name##_node *prev;                                                \
+} name##_node;                                                                  \
+                                                                                \
+typedef struct _##name {                                                        \
+    name##_node *head;                                                          \
+    name##_node *tail;                                                          \
+    size_t size;                                                                \
+} name;                                                                         \
+                                                                                \
+static inline void name##_init(name *list)                                      \
+{                                                                               \
+    if (!list) return;                                                          \
+    list->head = NULL;                                                          \
+    list->tail = NULL;                                                          \
+    list->size = 0;                                                             \
+}                                                                               \
+                                                                                \
+static inline void name##_free(name *list)                                      \
+{                                                                               \
+    if (!list) return;                                                          \
+    name##_node *node = list->head;                                             \
+    while (node) {                                                              \
+        name##_node *next = node->next;                                         \
+        RT_FREE(node);                                                          \
+        node = next;                                                            \
+    }                                                                           \
+    list->head = NULL;                                                          \
+    list->tail = NULL;                                                          \
+    list->size = 0;                                                             \
+}                                                                               \
+                                                                                \
+static inline bool name##_push(name *list, T value, int where)                  \
+{                                                                               \
+    if (!list) return false;                                                    \
+    name##_node *node = RT_MALLOC(sizeof(name##_node));                         \
+    if (!node) return false;                                                    \
+    node->data = value;                                                         \
+    node->next = NULL;                                                          \
+    node->prev = NULL;                                                          \
+    if (list->size == 0) {                                                      \
+        list->head = node;                                                      \
+        list->tail = node;                                                      \
+    } else if (where == RT_LIST_FRONT) {                                        \
+        node->next = list->head;                                                \
+        list->head->prev = node;                                                \
+        list->head = node;                                                      \
+    } else {                                                                    \
+        node->prev = list->tail;                                                \
+        list->tail->next = node;                                                \
+        list->tail = node;                                                      \
+    }                                                                           \
+    list->size++;                                                               \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_remove_node(name *list, name##_node *node)            \
+{                                                                               \
+    if (!list || !node || list->size == 0) return false;                        \
+    if (node->prev) node->prev->next = node->next;                              \
+    if (node->next) node->next->prev = node->prev;                              \
+    if (node == list->head) list->head = node->next;                            \
+    if (node == list->tail) list->tail = node->prev;                            \
+    RT_FREE(node);                                                              \
+    list->size--;                                                               \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_pop(name *list, T *out, int where)                    \
+{                                                                               \
+    if (!list || list->size == 0) return false;                                 \
+    name##_node *node = (where == RT_LIST_FRONT) ? list->head : list->tail;     \
+    if (out) *out = node->data;                                                 \
+    return name##_remove_node(list, node);                                      \
+}                                                                               \
+                                                                                \
+static inline bool name##_push_back(name *list, T value)                        \
+{                                                                               \
+    return name##_push(list, value, RT_LIST_BACK);                              \
+}                                                                               \
+                                                                                \
+static inline bool name##_push_front(name *list, T value)                       \
+{                                                                               \
+    return name##_push(list, value, RT_LIST_FRONT);                             \
+}                                                                               \
+                                                                                \
+static inline bool name##_pop_back(name *list, T *out)                          \
+{                                                                               \
+    return name##_pop(list, out, RT_LIST_BACK);                                 \
+}                                                                               \
+                                                                                \
+static inline bool name##_pop_front(name *list, T *out)                         \
+{                                                                               \
+    return name##_pop(list, out, RT_LIST_FRONT);                                \
+}                                                                               \
+                                                                                \
+static inline name##_node *name##_find(const name *list, T value)               \
+{                                                                               \
+    if (!list) return NULL;                                                     \
+    for (name##_node *node = list->head; node; node = node->next) {             \
+        if (memcmp(&node->data, &value, sizeof(T)) == 0) return node;           \
+    }                                                                           \
+    return NULL;                                                                \
+}                                                                               \
+                                                                                \
+static inline size_t name##_size(const name *list)                              \
+{                                                                               \
+    return list ? list->size : 0;                                               \
+}                                                                               \
+                                                                                \
+static inline bool name##_is_empty(const name *list)                            \
+{                                                                               \
+    return !list || list->size == 0;                                            \
+}
+
+/* Ring Buffer */
+#define RT_DEFINE_RBUFFER(name, T)                                              \
+typedef struct _##name {                                                        \
+    T *data;                                                                    \
+    size_t capacity;                                                            \
+    size_t size;                                                                \
+    size_t head;                                                                \
+    size_t tail;                                                                \
+} name;                                                                         \
+                                                                                \
+static inline bool name##_init(name *buffer, size_t capacity)                   \
+{                                                                               \
+    if (!buffer) return false;                                                  \
+    if (capacity == 0) capacity = RT_RBUFFER_INIT_CAP / sizeof(T);              \
+    if (capacity == 0) capacity = 1;                                            \
+    buffer->data = RT_MALLOC(capacity * sizeof(T));                             \
+    if (!buffer->data) return false;                                            \
+    buffer->capacity = capacity;                                                \
+    buffer->size = 0;                                                           \
+    buffer->head = 0;                                                           \
+    buffer->tail = 0;                                                           \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline void name##_free(name *buffer)                                    \
+{                                                                               \
+    if (!buffer || !buffer->data) return;                                       \
+    RT_FREE(buffer->data);                                                      \
+    buffer->data = NULL;                                                        \
+    buffer->capacity = 0;                                                       \
+    buffer->size = 0;                                                           \
+    buffer->head = 0;                                                           \
+    buffer->tail = 0;                                                           \
+}                                                                               \
+                                                                                \
+static inline bool name##_is_empty(const name *buffer)                          \
+{                                                                               \
+    return !buffer || buffer->size == 0;                                        \
+}                                                                               \
+                                                                                \
+static inline bool name##_is_full(const name *buffer)                           \
+{                                                                               \
+    return buffer && buffer->size >= buffer->capacity;                          \
+}                                                                               \
+                                                                                \
+static inline bool name##_write(name *buffer, T value)                          \
+{                                                                               \
+    if (!buffer || !buffer->data || name##_is_full(buffer)) return false;       \
+    buffer->data[buffer->tail] = value;                                         \
+    if (++buffer->tail == buffer->capacity) buffer->tail = 0;                   \
+    buffer->size++;                                                             \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_read(name *buffer, T *out)                            \
+{                                                                               \
+    if (!buffer || !out || buffer->size == 0) return false;                     \
+    *out = buffer->data[buffer->head];                                          \
+    if (++buffer->head == buffer->capacity) buffer->head = 0;                   \
+    buffer->size--;                                                             \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline bool name##_peek(const name *buffer, T *out)                      \
+{                                                                               \
+    if (!buffer || !out || buffer->size == 0) return false;                     \
+    *out = buffer->data[buffer->head];                                          \
+    return true;                                                                \
+}
+
+#endif // _INC_RT_TYPED
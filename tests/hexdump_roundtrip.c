@@ -0,0 +1,69 @@
+#include <string.h>
+
+#include "rt.h"
+
+/* Dumps inputs of several sizes with rt_file_hexdump and parses them back
+ * with rt_file_unhexdump: empty, a partial last line, exactly one chunk and
+ * several chunks with a partial line at the end. The data comes from a fixed
+ * seed, so every run checks the same bytes. */
+
+#define IN_PATH "hexdump_roundtrip.bin"
+#define DUMP_PATH "hexdump_roundtrip.txt"
+
+static uint64_t seed = 0x9E3779B97F4A7C15ull;
+
+static uint8_t next_byte(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint8_t)(seed >> 32);
+}
+
+static bool roundtrip(size_t size, RT_FileBuffer *parsed)
+{
+    uint8_t *data = malloc(size ? size : 1);
+    if (!data) return false;
+    for (size_t i = 0; i < size; ++i) data[i] = next_byte();
+
+    bool ok = false;
+    FILE *f = fopen(IN_PATH, "wb");
+    if (!f) goto done;
+    const bool written = fwrite(data, 1, size, f) == size;
+    if (fclose(f) != 0 || !written) goto done;
+
+    remove(DUMP_PATH);
+    if (rt_file_hexdump(IN_PATH, DUMP_PATH) != size) goto done;
+    if (!rt_file_unhexdump(DUMP_PATH, parsed)) goto done;
+    ok = parsed->size == size && (size == 0 || memcmp(parsed->data, data, size) == 0);
+
+    done:
+        free(data);
+        return ok;
+}
+
+int main(void)
+{
+    static const size_t sizes[] = {
+        0,
+        1,
+        RT_HEXDUMP_ROW,
+        RT_HEXDUMP_ROW + 1,                 // partial last line
+        RT_HEXDUMP_ROW * 1000 - 3,
+        RT_HEXDUMP_CHUNK,
+        RT_HEXDUMP_CHUNK * 3 + RT_HEXDUMP_ROW / 2, // several chunks, partial last line
+    };
+
+    RT_FileBuffer parsed = {0};
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        const bool ok = roundtrip(sizes[i], &parsed);
+        printf("%-10zu %s\n", sizes[i], ok ? "ok" : "FAILED");
+        if (!ok) failed++;
+    }
+
+    rt_fbuffer_free(&parsed);
+    remove(IN_PATH);
+    remove(DUMP_PATH);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+#include <string.h>
+
+#include "rt.h"
+
+/* No timer callback may run after rt_timer_cancel returned true: neither
+ * when the cancel comes from another callback of the same catch-up batch
+ * nor when it races the worker thread from outside. user_data is freed right
+ * after cancel, as callers do, so a late call reads freed memory. */
+
+typedef struct {
+    volatile LONG calls;
+    volatile LONG inside;
+    volatile LONG late; // calls that started after a successful cancel
+    volatile LONG cancelled;
+} Counter;
+
+typedef struct {
+    RT_TimerWheel *wheel;
+    RT_SlotHandle victim;
+    Counter *counter;
+    bool result;
+} Canceller;
+
+static void count_call(void *user_data)
+{
+    Counter *counter = user_data;
+    if (counter->cancelled) InterlockedIncrement(&counter->late);
+    InterlockedIncrement(&counter->inside);
+    InterlockedIncrement(&counter->calls);
+    Sleep(1);
+    InterlockedExchange(&counter->inside, 0);
+}
+
+static void cancel_victim(void *user_data)
+{
+    Canceller *canceller = user_data;
+    canceller->result = rt_timer_cancel(canceller->wheel, canceller->victim);
+    if (canceller->result) canceller->counter->cancelled = 1;
+}
+
+static void cancel_self(void *user_data)
+{
+    Canceller *canceller = user_data;
+    canceller->counter->calls++;
+    canceller->result = rt_timer_cancel(canceller->wheel, canceller->victim);
+}
+
+// the wheel falls behind, then one advance catches up: the periodic timer
+// is queued once, and an earlier callback of the same batch cancels it
+static bool cancel_in_catch_up(void)
+{
+    RT_TimerWheel wheel;
+    if (!rt_timer_wheel_init(&wheel, 1)) return false;
+
+    Counter *counter = calloc(1, sizeof(Counter));
+    Canceller canceller = { &wheel, RT_SLOT_HANDLE_NULL, counter, false };
+    canceller.victim = rt_timer_schedule(&wheel, 5, 1, count_call, counter);
+    if (!rt_timer_schedule(&wheel, 3, 0, cancel_victim, &canceller)) return false;
+    Sleep(40);
+    rt_timer_wheel_advance(&wheel);
+
+    const bool ok = canceller.result && counter->calls == 0 && rt_timer_wheel_size(&wheel) == 0;
+    free(counter);
+    rt_timer_wheel_free(&wheel);
+    return ok;
+}
+
+static bool periodic_catch_up_folds(void)
+{
+    RT_TimerWheel wheel;
+    if (!rt_timer_wheel_init(&wheel, 1)) return false;
+
+    Counter counter = {0};
+    const RT_SlotHandle timer = rt_timer_schedule(&wheel, 1, 1, count_call, &counter);
+    Sleep(40);
+    rt_timer_wheel_advance(&wheel);
+    const LONG calls = counter.calls;
+
+    const bool ok = calls == 1 && rt_timer_cancel(&wheel, timer);
+    rt_timer_wheel_free(&wheel);
+    return ok;
+}
+
+static bool cancel_self_from_callback(void)
+{
+    RT_TimerWheel wheel;
+    if (!rt_timer_wheel_init(&wheel, 1)) return false;
+
+    Counter counter = {0};
+    Canceller periodic = { &wheel, RT_SLOT_HANDLE_NULL, &counter, false };
+    periodic.victim = rt_timer_schedule(&wheel, 1, 1, cancel_self, &periodic);
+    Sleep(5);
+    rt_timer_wheel_advance(&wheel);
+    Sleep(5);
+    rt_timer_wheel_advance(&wheel);
+    bool ok = periodic.result && counter.calls == 1;
+
+    Counter once = {0};
+    Canceller oneshot = { &wheel, RT_SLOT_HANDLE_NULL, &once, true };
+    oneshot.victim = rt_timer_schedule(&wheel, 1, 0, cancel_self, &oneshot);
+    Sleep(5);
+    rt_timer_wheel_advance(&wheel);
+    ok = ok && !oneshot.result && once.calls == 1 && rt_timer_wheel_size(&wheel) == 0;
+
+    rt_timer_wheel_free(&wheel);
+    return ok;
+}
+
+// the worker keeps firing a periodic timer while this thread cancels it
+static bool cancel_from_other_thread(void)
+{
+    RT_TimerWheel wheel;
+    if (!rt_timer_wheel_init(&wheel, 1) || !rt_timer_wheel_start(&wheel)) return false;
+
+    bool ok = true;
+    for (int round = 0; round < 50 && ok; ++round) {
+        Counter *counter = calloc(1, sizeof(Counter));
+        const RT_SlotHandle timer = rt_timer_schedule(&wheel, 1, 1, count_call, counter);
+        Sleep(1 + round % 4);
+
+        if (rt_timer_cancel(&wheel, timer)) {
+            counter->cancelled = 1;
+            ok = counter->inside == 0;
+        } else {
+            ok = false;
+        }
+        const LONG calls = counter->calls;
+        Sleep(3);
+        ok = ok && counter->calls == calls && counter->late == 0;
+        free(counter);
+    }
+
+    // a one-shot timer that already fired can't be cancelled
+    Counter once = {0};
+    const RT_SlotHandle timer = rt_timer_schedule(&wheel, 1, 0, count_call, &once);
+    while (once.calls == 0) Sleep(1);
+    ok = ok && !rt_timer_cancel(&wheel, timer) && rt_timer_wheel_size(&wheel) == 0;
+
+    rt_timer_wheel_free(&wheel);
+    return ok;
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        bool (*run)(void);
+    } cases[] = {
+        { "cancel in catch-up batch", cancel_in_catch_up },
+        { "periodic catch-up folds", periodic_catch_up_folds },
+        { "cancel self in callback", cancel_self_from_callback },
+        { "cancel from other thread", cancel_from_other_thread },
+    };
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        const bool ok = cases[i].run();
+        printf("%-26s %s\n", cases[i].name, ok ? "ok" : "FAILED");
+        if (!ok) failed++;
+    }
+    return failed ? 1 : 0;
+}